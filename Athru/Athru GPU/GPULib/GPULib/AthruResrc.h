@@ -139,6 +139,31 @@ namespace AthruGPU
                 assert(SUCCEEDED(hr));
 			}
 
+			// Initialize a persistently-mapped upload buffer with no bindable views (e.g. staging memory for streamed uploads)
+			void InitUploBuf(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
+							 GPUMemory& gpuMem,
+							 const u4Byte& numBytes,
+							 address* mappedCPUAddr) // The CPU-side address that will process upload writes
+			{
+				// Allocate the buffer + record resource state (upload-heap resources are always [GENERIC_READ])
+				HRESULT hr = gpuMem.AllocBuf(device, numBytes,
+											 bufResrcDesc(numBytes, DXGI_FORMAT_UNKNOWN),
+											 D3D12_RESOURCE_STATE_GENERIC_READ, resrc,
+											 AthruGPU::HEAP_TYPES::UPLO);
+				resrcState = D3D12_RESOURCE_STATE_GENERIC_READ;
+				assert(SUCCEEDED(hr));
+
+				// Map the buffer for the lifetime of the resource
+				D3D12_RANGE range;
+				range.Begin = 0;
+				range.End = 0; // Upload buffers are implicitly write-only for the CPU
+				hr = resrc->Map(0, &range, mappedCPUAddr);
+				assert(SUCCEEDED(hr));
+
+				// Send [resrcViewAddr] to the zeroth address since upload buffers are only ever read by copies
+				resrcViewAddr.ptr = NULL;
+			}
+
 			// Initialize the readback buffer
 			void InitReadbkBuf(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
 							   GPUMemory& gpuMem)
@@ -0,0 +1,347 @@
+#include <assert.h>
+#include "UtilityServiceCentre.h"
+#include "BarrierPlanner.h"
+#include "BenchUtils.h"
+#include <algorithm>
+#include <chrono>
+
+BarrierPlanner::BarrierPlanner() :
+	numResrcs(0),
+	numPasses(0),
+	numUses(0),
+	numBarriers(0)
+{
+	for (u4Byte i = 0; i < (MAX_PASSES + 2); i += 1) { batchStarts[i] = 0; }
+}
+
+u4Byte BarrierPlanner::DeclareResrc(const char* name, RESRC_STATES initialState, bool writtenBefore)
+{
+	assert(numResrcs < MAX_RESOURCES);
+	resrcs[numResrcs] = { name, initialState, writtenBefore };
+	numResrcs += 1;
+	return numResrcs - 1;
+}
+
+u4Byte BarrierPlanner::DeclarePass(const char* name)
+{
+	assert(numPasses < MAX_PASSES);
+	passes[numPasses] = { name, numUses, 0 };
+	numPasses += 1;
+	return numPasses - 1;
+}
+
+void BarrierPlanner::Reads(u4Byte resrc, RESRC_STATES state)
+{
+	Access(resrc, state, false);
+}
+
+void BarrierPlanner::Writes(u4Byte resrc, RESRC_STATES state)
+{
+	assert(state == RESRC_STATES::UNORDERED_ACCESS || state == RESRC_STATES::COPY_DEST || state == RESRC_STATES::COMMON);
+	Access(resrc, state, true);
+}
+
+void BarrierPlanner::Plan()
+{
+	// Walk passes in order, tracking each resource's state, the last pass touching it, + whether unordered
+	// reads/writes have happened since its last barrier
+	// Barriers come out of the walk tagged with the pass they're recorded before; split barriers begin
+	// before earlier passes than they end, so sort everything into batches afterward
+	struct Track
+	{
+		RESRC_STATES state;
+		u4Byte lastUse; // [MAX_PASSES] before the first use
+		bool pendingWrite;
+		bool pendingRead;
+	};
+	Track tracks[MAX_RESOURCES];
+	for (u4Byte i = 0; i < numResrcs; i += 1)
+	{
+		tracks[i] = { resrcs[i].initialState, MAX_PASSES, resrcs[i].writtenBefore, false };
+	}
+
+	Barrier planned[MAX_BARRIERS];
+	u4Byte plannedBatches[MAX_BARRIERS];
+	u4Byte numPlanned = 0;
+	auto emit = [&](u4Byte batch, const Barrier& barrier)
+	{
+		assert(numPlanned < MAX_BARRIERS);
+		planned[numPlanned] = barrier;
+		plannedBatches[numPlanned] = batch;
+		numPlanned += 1;
+	};
+	auto transition = [&](u4Byte resrc, RESRC_STATES state, u4Byte pass)
+	{
+		// Begin the transition straight after the resource's last use; if no other passes run before [pass],
+		// there's nothing to overlap with, so issue it whole
+		Track& track = tracks[resrc];
+		const u4Byte beginBatch = (track.lastUse == MAX_PASSES) ? 0 : track.lastUse + 1;
+		if (beginBatch < pass)
+		{
+			emit(beginBatch, { resrc, BARRIER_TYPES::TRANSITION, track.state, state, BARRIER_SPLITS::BEGIN_ONLY });
+			emit(pass, { resrc, BARRIER_TYPES::TRANSITION, track.state, state, BARRIER_SPLITS::END_ONLY });
+		}
+		else
+		{
+			emit(pass, { resrc, BARRIER_TYPES::TRANSITION, track.state, state, BARRIER_SPLITS::NONE });
+		}
+		track.state = state;
+		track.pendingWrite = false; // Transitions flush outstanding writes
+		track.pendingRead = false;
+	};
+
+	for (u4Byte i = 0; i < numPasses; i += 1)
+	{
+		const Pass& pass = passes[i];
+		for (u4Byte j = pass.firstUse; j < (pass.firstUse + pass.numUses); j += 1)
+		{
+			const Use& use = uses[j];
+			Track& track = tracks[use.resrc];
+			if (track.state != use.state) { transition(use.resrc, use.state, i); }
+			else if (use.state == RESRC_STATES::UNORDERED_ACCESS && (track.pendingWrite || (use.writes && track.pendingRead)))
+			{
+				emit(i, { use.resrc, BARRIER_TYPES::UAV, use.state, use.state, BARRIER_SPLITS::NONE });
+				track.pendingWrite = false;
+				track.pendingRead = false;
+			}
+			track.pendingWrite = track.pendingWrite || use.writes;
+			track.pendingRead = track.pendingRead || !use.writes;
+			track.lastUse = i;
+		}
+	}
+
+	// Return resources to their starting states after the last pass
+	for (u4Byte i = 0; i < numResrcs; i += 1)
+	{
+		if (tracks[i].state != resrcs[i].initialState) { transition(i, resrcs[i].initialState, numPasses); }
+	}
+
+	// Counting-sort barriers into batches (stable, so batches keep the order barriers were planned in)
+	u4Byte counts[MAX_PASSES + 2] = {};
+	for (u4Byte i = 0; i < numPlanned; i += 1) { counts[plannedBatches[i] + 1] += 1; }
+	for (u4Byte i = 0; i <= numPasses; i += 1) { counts[i + 1] += counts[i]; }
+	for (u4Byte i = 0; i < (numPasses + 2); i += 1) { batchStarts[i] = counts[i]; }
+	for (u4Byte i = 0; i < numPlanned; i += 1)
+	{
+		barriers[counts[plannedBatches[i]]] = planned[i];
+		counts[plannedBatches[i]] += 1;
+	}
+	numBarriers = numPlanned;
+}
+
+void BarrierPlanner::Record(u4Byte pass, Recorder& recorder) const
+{
+	assert(pass <= numPasses);
+	const u4Byte count = batchStarts[pass + 1] - batchStarts[pass];
+	if (count > 0) { recorder.Barriers(barriers + batchStarts[pass], count); }
+}
+
+u4Byte BarrierPlanner::NumBarriers() const
+{
+	return numBarriers;
+}
+
+u4Byte BarrierPlanner::NumBatches() const
+{
+	u4Byte batches = 0;
+	for (u4Byte i = 0; i <= numPasses; i += 1)
+	{
+		if (batchStarts[i + 1] > batchStarts[i]) { batches += 1; }
+	}
+	return batches;
+}
+
+// Mock command list for [Valid()]; applies barriers + accesses to a CPU model of each resource, flagging
+// anything a GPU validation layer would reject (or anything that could race)
+class MockCmdList : public BarrierPlanner::Recorder
+{
+	public:
+		MockCmdList(const BarrierPlanner::RESRC_STATES* initialStates, const bool* writtenBefore, u4Byte numResrcs) :
+			numResrcs(numResrcs),
+			valid(true)
+		{
+			for (u4Byte i = 0; i < numResrcs; i += 1)
+			{
+				resrcs[i] = { initialStates[i], initialStates[i], false, writtenBefore[i], false };
+			}
+		}
+
+		void Barriers(const BarrierPlanner::Barrier* barriers, u4Byte numBarriers) override
+		{
+			for (u4Byte i = 0; i < numBarriers && valid; i += 1)
+			{
+				const BarrierPlanner::Barrier& barrier = barriers[i];
+				valid = barrier.resrc < numResrcs;
+				if (!valid) { break; }
+
+				MockResrc& resrc = resrcs[barrier.resrc];
+				if (barrier.type == BarrierPlanner::BARRIER_TYPES::UAV)
+				{
+					valid = !resrc.splitting && resrc.state == BarrierPlanner::RESRC_STATES::UNORDERED_ACCESS;
+				}
+				else if (barrier.split == BarrierPlanner::BARRIER_SPLITS::BEGIN_ONLY)
+				{
+					valid = !resrc.splitting && resrc.state == barrier.before && barrier.before != barrier.after;
+					resrc.splitting = true;
+					resrc.splitTo = barrier.after;
+					continue; // Nothing settles until the matching [END_ONLY]
+				}
+				else if (barrier.split == BarrierPlanner::BARRIER_SPLITS::END_ONLY)
+				{
+					valid = resrc.splitting && resrc.state == barrier.before && resrc.splitTo == barrier.after;
+					resrc.splitting = false;
+					resrc.state = barrier.after;
+				}
+				else
+				{
+					valid = !resrc.splitting && resrc.state == barrier.before && barrier.before != barrier.after;
+					resrc.state = barrier.after;
+				}
+				resrc.pendingWrite = false;
+				resrc.pendingRead = false;
+			}
+		}
+
+		void Access(u4Byte resrcIndex, BarrierPlanner::RESRC_STATES state, bool writes)
+		{
+			MockResrc& resrc = resrcs[resrcIndex];
+			valid = valid && !resrc.splitting && resrc.state == state;
+			if (state == BarrierPlanner::RESRC_STATES::UNORDERED_ACCESS)
+			{
+				valid = valid && !resrc.pendingWrite && !(writes && resrc.pendingRead);
+			}
+			resrc.pendingWrite = resrc.pendingWrite || writes;
+			resrc.pendingRead = resrc.pendingRead || !writes;
+		}
+
+		bool Finished(const BarrierPlanner::RESRC_STATES* initialStates) const
+		{
+			bool finished = valid;
+			for (u4Byte i = 0; i < numResrcs; i += 1)
+			{
+				finished = finished && !resrcs[i].splitting && resrcs[i].state == initialStates[i];
+			}
+			return finished;
+		}
+
+	private:
+		struct MockResrc
+		{
+			BarrierPlanner::RESRC_STATES state;
+			BarrierPlanner::RESRC_STATES splitTo;
+			bool splitting;
+			bool pendingWrite;
+			bool pendingRead;
+		};
+
+		MockResrc resrcs[BarrierPlanner::MAX_RESOURCES];
+		u4Byte numResrcs;
+		bool valid;
+};
+
+bool BarrierPlanner::Valid() const
+{
+	RESRC_STATES initialStates[MAX_RESOURCES];
+	bool writtenBefore[MAX_RESOURCES];
+	for (u4Byte i = 0; i < numResrcs; i += 1)
+	{
+		initialStates[i] = resrcs[i].initialState;
+		writtenBefore[i] = resrcs[i].writtenBefore;
+	}
+
+	MockCmdList cmdList(initialStates, writtenBefore, numResrcs);
+	for (u4Byte i = 0; i < numPasses; i += 1)
+	{
+		Record(i, cmdList);
+		for (u4Byte j = passes[i].firstUse; j < (passes[i].firstUse + passes[i].numUses); j += 1)
+		{
+			cmdList.Access(uses[j].resrc, uses[j].state, uses[j].writes);
+		}
+	}
+	Record(numPasses, cmdList);
+	return cmdList.Finished(initialStates);
+}
+
+float BarrierPlanner::Simulate(u4Byte numGraphs)
+{
+	BenchRand next;
+	constexpr RESRC_STATES readStates[4] = { RESRC_STATES::UNORDERED_ACCESS, RESRC_STATES::COPY_SOURCE,
+											 RESRC_STATES::INDIRECT_ARGUMENT, RESRC_STATES::COMMON };
+	constexpr RESRC_STATES writeStates[2] = { RESRC_STATES::UNORDERED_ACCESS, RESRC_STATES::COPY_DEST };
+
+	bool valid = true;
+	u8Byte numPassesTotal = 0;
+	u8Byte numBarriersTotal = 0;
+	u8Byte numBatchesTotal = 0;
+	u8Byte numSplitsTotal = 0;
+	u8Byte numNaiveTotal = 0;
+	std::chrono::steady_clock::duration planTime(0);
+	for (u4Byte i = 0; i < numGraphs; i += 1)
+	{
+		// Unordered access is the common case in [Renderer], so weight accesses toward it
+		BarrierPlanner planner;
+		const u4Byte numResrcs = (next() % (MAX_RESOURCES / 2)) + 1;
+		for (u4Byte j = 0; j < numResrcs; j += 1)
+		{
+			const RESRC_STATES initialState = (next() % 3) ? RESRC_STATES::UNORDERED_ACCESS : readStates[next() % 4];
+			planner.DeclareResrc("simulated resource", initialState, (next() & 1) != 0);
+		}
+		const u4Byte numPasses = (next() % MAX_PASSES) + 1;
+		for (u4Byte j = 0; j < numPasses; j += 1)
+		{
+			planner.DeclarePass("simulated pass");
+			const u4Byte numAccesses = std::min((next() % 4) + 1, numResrcs);
+			const u4Byte firstResrc = next() % numResrcs;
+			for (u4Byte k = 0; k < numAccesses; k += 1)
+			{
+				// Consecutive resources, so no resource is accessed twice in one pass
+				const u4Byte resrc = (firstResrc + k) % numResrcs;
+				const bool unordered = (next() % 3) != 0;
+				if (next() & 1) { planner.Writes(resrc, unordered ? RESRC_STATES::UNORDERED_ACCESS : writeStates[1]); }
+				else { planner.Reads(resrc, unordered ? RESRC_STATES::UNORDERED_ACCESS : readStates[(next() % 3) + 1]); }
+
+				// Hand-authored barriers transition into + back out of every access away from a resource's
+				// starting state, + place a UAV barrier before every unordered access
+				const Use& use = planner.uses[planner.numUses - 1];
+				if (use.state != planner.resrcs[resrc].initialState) { numNaiveTotal += 2; }
+				else if (use.state == RESRC_STATES::UNORDERED_ACCESS) { numNaiveTotal += 1; }
+			}
+		}
+
+		const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		planner.Plan();
+		planTime += std::chrono::steady_clock::now() - t0;
+
+		valid = valid && planner.Valid();
+		numPassesTotal += numPasses;
+		numBarriersTotal += planner.NumBarriers();
+		numBatchesTotal += planner.NumBatches();
+		for (u4Byte j = 0; j < planner.numBarriers; j += 1)
+		{
+			if (planner.barriers[j].split == BARRIER_SPLITS::BEGIN_ONLY) { numSplitsTotal += 1; }
+		}
+	}
+
+	const float barriersPerPass = (float)((double)numBarriersTotal / numPassesTotal);
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	logger->Log((float)(planTime.count() * TimeStuff::nsToSecs * 1e6 / numGraphs), "Barrier planner simulation, time per plan (microseconds)");
+	logger->Log(barriersPerPass, "Barrier planner simulation, mean barriers per pass");
+	logger->Log((float)((double)numBatchesTotal / numPassesTotal), "Barrier planner simulation, mean barrier batches per pass");
+	logger->Log((float)((double)numBarriersTotal / numNaiveTotal), "Barrier planner simulation, planned barriers over hand-authored barriers");
+	logger->Log((float)((double)(numSplitsTotal * 2) / numBarriersTotal), "Barrier planner simulation, share of barriers split");
+	return BenchUtils::ReportChecks(valid, "Barrier planner simulation", barriersPerPass);
+}
+
+void BarrierPlanner::Access(u4Byte resrc, RESRC_STATES state, bool writes)
+{
+	assert(numPasses > 0 && resrc < numResrcs);
+	assert(numUses < MAX_USES);
+	Pass& pass = passes[numPasses - 1];
+	for (u4Byte i = pass.firstUse; i < (pass.firstUse + pass.numUses); i += 1)
+	{
+		assert(uses[i].resrc != resrc); // Resources should be accessed at most once per pass
+	}
+	uses[numUses] = { resrc, state, writes };
+	numUses += 1;
+	pass.numUses += 1;
+}
@@ -0,0 +1,178 @@
+#include <assert.h>
+#include "UtilityServiceCentre.h"
+#include "BufferPlanner.h"
+#include "BenchUtils.h"
+#include <algorithm>
+#include <chrono>
+
+BufferPlanner::BufferPlanner() :
+	numDecls(0),
+	peakBytes(0)
+{
+}
+
+u4Byte BufferPlanner::Declare(const char* name, u8Byte bytes, u8Byte alignment, u4Byte firstPass, u4Byte lastPass)
+{
+	assert(numDecls < MAX_BUFFERS);
+	assert(alignment > 0 && firstPass <= lastPass);
+	decls[numDecls] = { name, bytes, alignment, firstPass, lastPass, 0 };
+	numDecls += 1;
+	return numDecls - 1;
+}
+
+void BufferPlanner::Plan()
+{
+	// Place big, long-lived buffers first; they're the hardest to fit around
+	// everything else
+	u4Byte order[MAX_BUFFERS];
+	for (u4Byte i = 0; i < numDecls; i += 1) { order[i] = i; }
+	std::sort(order, order + numDecls, [this](u4Byte a, u4Byte b)
+	{
+		const Decl& da = decls[a];
+		const Decl& db = decls[b];
+		if (da.bytes != db.bytes) { return da.bytes > db.bytes; }
+		if ((da.lastPass - da.firstPass) != (db.lastPass - db.firstPass)) { return (da.lastPass - da.firstPass) > (db.lastPass - db.firstPass); }
+		return a < b;
+	});
+
+	peakBytes = 0;
+	u4Byte placed[MAX_BUFFERS];
+	for (u4Byte i = 0; i < numDecls; i += 1)
+	{
+		Decl& decl = decls[order[i]];
+
+		// Collect placed buffers sharing passes with [decl], sorted by offset
+		u4Byte conflicts[MAX_BUFFERS];
+		u4Byte numConflicts = 0;
+		for (u4Byte j = 0; j < i; j += 1)
+		{
+			if (Overlapping(decls[placed[j]], decl)) { conflicts[numConflicts] = placed[j]; numConflicts += 1; }
+		}
+		std::sort(conflicts, conflicts + numConflicts, [this](u4Byte a, u4Byte b) { return decls[a].offset < decls[b].offset; });
+
+		// Sweep the gaps between conflicting buffers + keep the tightest one that fits;
+		// fall back to the end of the conflicting buffers if nothing does
+		u8Byte prevEnd = 0;
+		u8Byte bestOffset = 0;
+		u8Byte bestGap = ~0ull;
+		for (u4Byte j = 0; j < numConflicts; j += 1)
+		{
+			const Decl& conflict = decls[conflicts[j]];
+			const u8Byte gapStart = AlignUp(prevEnd, decl.alignment);
+			if (conflict.offset >= (gapStart + decl.bytes))
+			{
+				const u8Byte gap = conflict.offset - gapStart;
+				if (gap < bestGap) { bestGap = gap; bestOffset = gapStart; }
+			}
+			prevEnd = std::max(prevEnd, conflict.offset + conflict.bytes);
+		}
+		if (bestGap == ~0ull) { bestOffset = AlignUp(prevEnd, decl.alignment); }
+
+		decl.offset = bestOffset;
+		peakBytes = std::max(peakBytes, decl.offset + decl.bytes);
+		placed[i] = order[i];
+	}
+}
+
+u8Byte BufferPlanner::Offset(u4Byte buffer) const
+{
+	assert(buffer < numDecls);
+	return decls[buffer].offset;
+}
+
+u8Byte BufferPlanner::PeakBytes() const
+{
+	return peakBytes;
+}
+
+u8Byte BufferPlanner::UnaliasedBytes() const
+{
+	u8Byte bytes = 0;
+	for (u4Byte i = 0; i < numDecls; i += 1)
+	{
+		bytes = AlignUp(bytes, decls[i].alignment) + decls[i].bytes;
+	}
+	return bytes;
+}
+
+u8Byte BufferPlanner::LowerBound() const
+{
+	u4Byte numPasses = 0;
+	for (u4Byte i = 0; i < numDecls; i += 1) { numPasses = std::max(numPasses, decls[i].lastPass + 1); }
+
+	u8Byte bound = 0;
+	for (u4Byte pass = 0; pass < numPasses; pass += 1)
+	{
+		u8Byte liveBytes = 0;
+		for (u4Byte i = 0; i < numDecls; i += 1)
+		{
+			if (decls[i].firstPass <= pass && pass <= decls[i].lastPass) { liveBytes += decls[i].bytes; }
+		}
+		bound = std::max(bound, liveBytes);
+	}
+	return bound;
+}
+
+bool BufferPlanner::Valid() const
+{
+	for (u4Byte i = 0; i < numDecls; i += 1)
+	{
+		const Decl& a = decls[i];
+		if ((a.offset % a.alignment) != 0 || (a.offset + a.bytes) > peakBytes) { return false; }
+		for (u4Byte j = i + 1; j < numDecls; j += 1)
+		{
+			const Decl& b = decls[j];
+			if (a.bytes == 0 || b.bytes == 0 || !Overlapping(a, b)) { continue; }
+			if (a.offset < (b.offset + b.bytes) && b.offset < (a.offset + a.bytes)) { return false; }
+		}
+	}
+	return true;
+}
+
+float BufferPlanner::Benchmark(u4Byte numLayouts)
+{
+	BenchRand next;
+	constexpr u8Byte alignments[6] = { 4, 12, 16, 24, 32, 256 }; // Element sizes seen in [Renderer], plus raw-buffer alignment
+
+	bool valid = true;
+	double ratioSum = 0.0;
+	double savedSum = 0.0;
+	std::chrono::steady_clock::duration planTime(0);
+	for (u4Byte i = 0; i < numLayouts; i += 1)
+	{
+		BufferPlanner planner;
+		const u4Byte numPasses = (next() % 8) + 1;
+		const u4Byte numBuffers = (next() % (MAX_BUFFERS - 3)) + 4;
+		for (u4Byte j = 0; j < numBuffers; j += 1)
+		{
+			const u4Byte firstPass = next() % numPasses;
+			const u4Byte lastPass = firstPass + (next() % (numPasses - firstPass));
+			planner.Declare("benchmark buffer", (next() % (1 << 20)) + 1, alignments[next() % 6], firstPass, lastPass);
+		}
+
+		const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		planner.Plan();
+		planTime += std::chrono::steady_clock::now() - t0;
+
+		valid = valid && planner.Valid();
+		ratioSum += (double)planner.PeakBytes() / (double)planner.LowerBound();
+		savedSum += 1.0 - ((double)planner.PeakBytes() / (double)planner.UnaliasedBytes());
+	}
+
+	const float meanRatio = (float)(ratioSum / numLayouts);
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	logger->Log((float)(planTime.count() * TimeStuff::nsToSecs * 1e6 / numLayouts), "Buffer planner benchmark, time per plan (microseconds)");
+	logger->Log(meanRatio, "Buffer planner benchmark, mean planned bytes over lower bound");
+	logger->Log((float)(savedSum / numLayouts), "Buffer planner benchmark, mean fraction of memory saved by aliasing");
+	return BenchUtils::ReportChecks(valid, "Buffer planner benchmark", meanRatio);
+}
+
+bool BufferPlanner::Overlapping(const Decl& a, const Decl& b)
+{
+	return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+}
+
+u8Byte BufferPlanner::AlignUp(u8Byte offset, u8Byte alignment)
+{
+	return ((offset + alignment - 1) / alignment) * alignment;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Typedefs.h"
+
+// Aliased layout planner for sub-buffers sharing one GPU buffer
+// Buffers are declared with their size, alignment, and the range of passes
+// they're live in; [Plan()] then places them so buffers with overlapping
+// lifetimes never overlap in memory, while buffers with disjoint lifetimes
+// can share the same bytes
+// Placement is greedy (largest buffers first, each into the tightest gap
+// that fits beside the buffers already placed), which is usually within a
+// few percent of [LowerBound()] for small pass graphs
+// Nothing here touches the graphics API, so plans can be built + checked
+// entirely on the CPU
+class BufferPlanner
+{
+	public:
+		// Maximum number of buffers per plan
+		static constexpr u4Byte MAX_BUFFERS = 32;
+
+		BufferPlanner();
+		~BufferPlanner() = default;
+
+		// Declare a buffer of [bytes] bytes, live from [firstPass] through
+		// [lastPass] (inclusive); returns the buffer's index in the plan
+		// Buffers read across frame boundaries (e.g. temporal history) should
+		// cover every pass
+		// Alignments don't have to be powers of two (structured views need
+		// offsets that are multiples of their element size)
+		u4Byte Declare(const char* name, u8Byte bytes, u8Byte alignment, u4Byte firstPass, u4Byte lastPass);
+
+		// Place every declared buffer
+		void Plan();
+
+		// Offset of the given buffer within the planned layout
+		u8Byte Offset(u4Byte buffer) const;
+
+		// Bytes spanned by the planned layout
+		u8Byte PeakBytes() const;
+
+		// Bytes needed to lay every buffer out back-to-back, without aliasing
+		u8Byte UnaliasedBytes() const;
+
+		// Largest number of bytes live during any one pass; no layout can be
+		// smaller than this
+		u8Byte LowerBound() const;
+
+		// Check the planned layout: every buffer aligned, + no two buffers with
+		// overlapping lifetimes overlapping in memory
+		bool Valid() const;
+
+		// Plan [numLayouts] random buffer sets, checking each with [Valid()];
+		// logs mean planning time + how close plans come to [LowerBound()]
+		// Returns the mean ratio between [PeakBytes()] and [LowerBound()], or a
+		// negative value if any plan was invalid
+		static float Benchmark(u4Byte numLayouts);
+
+	private:
+		struct Decl
+		{
+			const char* name;
+			u8Byte bytes;
+			u8Byte alignment;
+			u4Byte firstPass;
+			u4Byte lastPass;
+			u8Byte offset;
+		};
+
+		// Whether two buffers are ever live at the same time
+		static bool Overlapping(const Decl& a, const Decl& b);
+
+		// Round [offset] up to a multiple of [alignment]
+		static u8Byte AlignUp(u8Byte offset, u8Byte alignment);
+
+		Decl decls[MAX_BUFFERS];
+		u4Byte numDecls;
+		u8Byte peakBytes;
+};
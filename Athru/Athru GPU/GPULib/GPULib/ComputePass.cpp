@@ -1,16 +1,30 @@
 #include "UtilityServiceCentre.h"
 #include "ComputePass.h"
 #include <filesystem>
+#include <cstring>
+
+ComputePass::PrefetchedDXIL ComputePass::prefetched[AthruGPU::NUM_RENDER_SHADERS] = {};
+std::atomic<u4Byte> ComputePass::numPrefetched(0);
 
 ComputePass::ComputePass(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
 						 HWND windowHandle,
 						 const char* shaderFilePath,
 						 const u4Byte& numCBVs, const u4Byte& numSRVs, const u4Byte& numUAVs)
 {
-	// Import the given file into Athru with an ordinary C++ binary input/output stream
-	std::ifstream strm = std::ifstream(shaderFilePath, std::ios::binary);
-	u8Byte len = std::filesystem::file_size(shaderFilePath); // File size in bytes
-	strm.read(dxilMem, len); // Read bytecode into the subset of Athru's memory stack associated with [this]
+	// Reuse prefetched bytecode where we can, otherwise load it here
+	dxil = nullptr;
+	const u4Byte numFetched = numPrefetched.load(std::memory_order_acquire);
+	for (u4Byte i = 0; i < numFetched; i += 1)
+	{
+		const char* fetchedPath = prefetched[i].path.load(std::memory_order_acquire);
+		if (fetchedPath != nullptr && strcmp(fetchedPath, shaderFilePath) == 0)
+		{
+			dxil = prefetched[i].dxil;
+			dxilBytes = prefetched[i].dxilBytes;
+			break;
+		}
+	}
+	if (dxil == nullptr) { dxil = LoadDXIL(shaderFilePath, &dxilBytes); }
 
 	// Compose descriptor ranges
 	u4Byte numRanges = 3;
@@ -74,13 +88,40 @@ ComputePass::ComputePass(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
 	// Assemble pipeline state
 	D3D12_COMPUTE_PIPELINE_STATE_DESC pipeDesc = { };
 	pipeDesc.pRootSignature = rootSig.Get();
-	pipeDesc.CS.pShaderBytecode = (void*)dxilMem;
-	pipeDesc.CS.BytecodeLength = len;
+	pipeDesc.CS.pShaderBytecode = (const void*)dxil;
+	pipeDesc.CS.BytecodeLength = dxilBytes;
 	pipeDesc.NodeMask = 0x1; // Athru only uses one GPU atm
 	result = device->CreateComputePipelineState(&pipeDesc, __uuidof(ID3D12PipelineState), (void**)&shadingState);
 	assert(SUCCEEDED(result));
 }
 
+void ComputePass::Prefetch(const char* shaderFilePath)
+{
+	u8Byte numBytes = 0;
+	const uByte* bytecode = LoadDXIL(shaderFilePath, &numBytes);
+	AssetPack::Prefault(bytecode, numBytes); // Pages packed bytecode in; loose bytecode was just read, so this is nearly free
+
+	const u4Byte slot = numPrefetched.fetch_add(1, std::memory_order_acq_rel);
+	assert(slot < AthruGPU::NUM_RENDER_SHADERS);
+	prefetched[slot].dxil = bytecode;
+	prefetched[slot].dxilBytes = numBytes;
+	prefetched[slot].path.store(shaderFilePath, std::memory_order_release);
+}
+
+const uByte* ComputePass::LoadDXIL(const char* shaderFilePath, u8Byte* numBytes)
+{
+	// Look for packed bytecode first (zero-copy); otherwise import the given file through Athru's
+	// I/O service (pipeline creation needs the bytecode straight away, so wait for the read here)
+	const uByte* packed = AthruCore::Utility::AccessAssets()->Find(shaderFilePath, ASSET_TYPES::SHADER, numBytes);
+	if (packed != nullptr) { return packed; }
+
+	*numBytes = std::filesystem::file_size(shaderFilePath); // File size in bytes
+	uByte* dxilMem = (uByte*)AthruCore::Utility::AccessMemory()->AlignedAlloc(*numBytes, 16, false);
+	AsyncIO* io = AthruCore::Utility::AccessIO();
+	io->Wait(io->Read(shaderFilePath, dxilMem, *numBytes)); // Read bytecode onto Athru's memory stack
+	return dxilMem;
+}
+
 ComputePass::~ComputePass()
 {
 	rootSig = nullptr;
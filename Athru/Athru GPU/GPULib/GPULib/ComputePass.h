@@ -1,6 +1,7 @@
 #pragma once
 
 #include <d3d12.h>
+#include <atomic>
 #include <windows.h>
 #include <wrl\client.h>
 #include "GPUGlobals.h"
@@ -15,15 +16,38 @@ class ComputePass
 					const u4Byte& numCBVs, const u4Byte& numSRVs, const u4Byte& numUAVs);
 		~ComputePass();
 
+		// Fetch bytecode for [shaderFilePath] ahead of time (e.g. on a worker during start-up); passes
+		// created for the same file afterward skip their own load
+		// Packed shaders are paged in, loose shaders are read onto Athru's memory stack
+		// Safe to call for several shaders at once, but prefetches should finish before any pass using
+		// their bytecode is created
+		static void Prefetch(const char* shaderFilePath);
+
 		// Overload the standard allocation/de-allocation operators
 		void* operator new(size_t size);
 		void operator delete(void* target);
 
 	public:
-		// Per-pass shader bytecode storage
-		nsByte dxilMem[GraphicsStuff::SHADER_DXIL_ALLOC];
+		// Per-pass shader bytecode; a view into the asset pack when [this] was packed, otherwise
+		// a copy of the loose shader file on Athru's memory stack
+		const uByte* dxil;
+		u8Byte dxilBytes;
 		// The resource context (root signature) associated with [this]
 		Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSig;
 		// The pipeline state associated with [this]
 		Microsoft::WRL::ComPtr<ID3D12PipelineState> shadingState;
+
+	private:
+		// Load bytecode for [shaderFilePath] from the asset pack or the loose file
+		static const uByte* LoadDXIL(const char* shaderFilePath, u8Byte* numBytes);
+
+		// Prefetched bytecode; paths are published last, so readers only see filled-in entries
+		struct PrefetchedDXIL
+		{
+			std::atomic<const char*> path;
+			const uByte* dxil;
+			u8Byte dxilBytes;
+		};
+		static PrefetchedDXIL prefetched[AthruGPU::NUM_RENDER_SHADERS];
+		static std::atomic<u4Byte> numPrefetched;
 };
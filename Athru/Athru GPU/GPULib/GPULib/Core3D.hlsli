@@ -348,9 +348,13 @@ float2x3 StarDF(float3 pt,
     }
 }
 
-// Analytical Julia gradient is giving different + discontinuous results compared to
-// approximate gradient; optionally enable tetrahedral finite-differences gradient here
-#define APPROX_PLANET_GRAD
+// Planet gradients come from differentiating the Julia iteration with dual
+// quaternions ([JuliaDual(...)]) by default; that costs about as much as four
+// taps (one iteration, but every step carries three tangents), + avoids the
+// tetrahedral taps' precision loss (offsets of [eps] barely register on
+// coordinates hundreds of units from the origin); optionally enable tetrahedral
+// finite-differences gradient here
+//#define APPROX_PLANET_GRAD
 
 // Extract planetary tetrahedral gradient; marginally
 // faster than a six-point cuboid approximation, but
@@ -376,7 +380,7 @@ float4 tetGrad(float3 samplePoint,
     return float4(gradVec / gradMag, gradMag);
 }
 
-// Planet-specific gradient; just outputs analytical Julia gradient for now,
+// Planet-specific gradient; just outputs the Julia gradient for now,
 // will update for physical displacement later
 float3 PlanetGrad(float3 samplePoint,
                   Figure fig,
@@ -385,8 +389,18 @@ float3 PlanetGrad(float3 samplePoint,
     #ifdef APPROX_PLANET_GRAD
         return tetGrad(samplePoint, fig, eps).xyz;
     #else
-        return JuliaGrad(fig.distCoeffs[0],
-                         samplePoint);
+        // Planet-space gradient; scaling the planet scales its distances back, so
+        // gradients only need rotating back out of the system disc's symmetry
+        // ([SysSymmet(...)] rotates points by [thetaOffs - theta])
+        float3 grad = JuliaDual(fig.distCoeffs[0],
+                                PtToPlanet(samplePoint, fig.scale.x)).xyz;
+        float theta = SysSymmet(samplePoint).w;
+        float thetaOffs = fmod(theta, RADS_PER_PLANET * 2.0f) - RADS_PER_PLANET;
+        float2 scFold;
+        sincos(theta - thetaOffs, scFold.y, scFold.x);
+        return normalize(float3(scFold.x * grad.x - scFold.y * grad.z,
+                                grad.y,
+                                scFold.y * grad.x + scFold.x * grad.z));
     #endif
 }
 
@@ -49,3 +49,92 @@ float Julia(float4 juliaCoeffs,
     float r = length(z);
     return (0.5 * log(r) * r / length(dz));
 }
+
+// Dual quaternions for forward-mode differentiation; [d[i]] carries the
+// derivative of [v] along planet-space axis [i]
+struct DualQtn
+{
+    float4 v;
+    float4 d[3];
+};
+
+// Product rule over [QtnProduct2]
+DualQtn DualQtnProduct(DualQtn qtnA,
+                       DualQtn qtnB)
+{
+    DualQtn p;
+    p.v = QtnProduct2(qtnA.v, qtnB.v);
+    [unroll]
+    for (uint i = 0; i < 3; i += 1)
+    {
+        p.d[i] = QtnProduct2(qtnA.d[i], qtnB.v) +
+                 QtnProduct2(qtnA.v, qtnB.d[i]);
+    }
+    return p;
+}
+
+// Dual squares; the cross products in [a'a + aa'] cancel, so these are
+// cheaper than general products
+DualQtn DualQtnSquare(DualQtn qtn)
+{
+    DualQtn p;
+    p.v = QtnProduct2(qtn.v, qtn.v);
+    [unroll]
+    for (uint i = 0; i < 3; i += 1)
+    {
+        float4 dq = qtn.d[i];
+        p.d[i] = 2.0f * float4(qtn.v.x * dq.x - dot(qtn.v.yzw, dq.yzw),
+                               (qtn.v.x * dq.yzw) + (dq.x * qtn.v.yzw));
+    }
+    return p;
+}
+
+// Quaternionic Julia distance estimate (as in [Julia(...)]) in [w], with its
+// planet-space gradient in [xyz]; [z] + [dz] are differentiated alongside the
+// iteration, so the gradient is exact (up to float rounding) rather than
+// finite-differenced
+float4 JuliaDual(float4 juliaCoeffs,
+                 float3 coord)
+{
+    // Initialise the iteration point (z) + escape-time derivative (dz); the
+    // w-slice is fixed, so only [xyz] vary with [coord]
+    DualQtn z;
+    z.v = float4(coord, juliaCoeffs.w);
+    z.d[0] = float4(1.0f, 0.0f.xxx);
+    z.d[1] = float4(0.0f, 1.0f, 0.0f.xx);
+    z.d[2] = float4(0.0f.xx, 1.0f, 0.0f);
+    DualQtn dz;
+    dz.v = float4(1.0f, 0.0f.xxx);
+    dz.d[0] = 0.0f.xxxx;
+    dz.d[1] = 0.0f.xxxx;
+    dz.d[2] = 0.0f.xxxx;
+
+    // Iterate the fractal
+    float i = 0;
+    float sqrBailout = BAILOUT_JULIA_DE;
+    while (i < ITERATIONS_JULIA &&
+           dot(z.v, z.v) < sqrBailout)
+    {
+        dz = DualQtnProduct(z, dz);
+        dz.v *= 2.0f;
+        dz.d[0] *= 2.0f;
+        dz.d[1] *= 2.0f;
+        dz.d[2] *= 2.0f;
+        z = DualQtnSquare(z);
+        z.v += juliaCoeffs;
+        i += 1.0f;
+    }
+
+    // Differentiate [0.5 * log(r) * r / |dz|] with the product/quotient rules
+    float r = length(z.v);
+    float dzLen = length(dz.v);
+    float logR = log(r);
+    float3 dr = float3(dot(z.v, z.d[0]),
+                       dot(z.v, z.d[1]),
+                       dot(z.v, z.d[2])) / r;
+    float3 dDzLen = float3(dot(dz.v, dz.d[0]),
+                           dot(dz.v, dz.d[1]),
+                           dot(dz.v, dz.d[2])) / dzLen;
+    float3 grad = 0.5f * ((dr * (1.0f + logR)) - (logR * r * dDzLen / dzLen)) / dzLen;
+    return float4(grad, 0.5f * logR * r / dzLen);
+}
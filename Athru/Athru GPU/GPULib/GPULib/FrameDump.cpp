@@ -0,0 +1,240 @@
+#include <assert.h>
+#include "UtilityServiceCentre.h"
+#include "FrameDump.h"
+#include "BenchUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <emmintrin.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Marker at the start of every Y4M frame record
+static constexpr char Y4M_FRAME_MARKER[] = "FRAME\n";
+static constexpr u4Byte Y4M_FRAME_MARKER_BYTES = sizeof(Y4M_FRAME_MARKER) - 1;
+
+// Studio-range BT.601 in 8.8 fixed point; offsets are folded into the rounding terms, so every sum
+// lands in [0, 65535] (-> 16-bit lanes can wrap freely while summing) + fits its output range after
+// shifting, without clamping
+static constexpr s4Byte Y4M_Y_COEFFS[4] = { 66, 129, 25, 4224 };
+static constexpr s4Byte Y4M_U_COEFFS[4] = { -38, -74, 112, 32896 };
+static constexpr s4Byte Y4M_V_COEFFS[4] = { 112, -94, -18, 32896 };
+
+// Convert eight RGBA pixels (two vectors of four) into eight 16-bit samples for one output plane
+static __m128i Y4MPlane8(__m128i r, __m128i g, __m128i b, const s4Byte (&coeffs)[4])
+{
+	__m128i sum = _mm_mullo_epi16(r, _mm_set1_epi16((s2Byte)coeffs[0]));
+	sum = _mm_add_epi16(sum, _mm_mullo_epi16(g, _mm_set1_epi16((s2Byte)coeffs[1])));
+	sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, _mm_set1_epi16((s2Byte)coeffs[2])));
+	sum = _mm_add_epi16(sum, _mm_set1_epi16((s2Byte)coeffs[3]));
+	return _mm_srli_epi16(sum, 8);
+}
+
+// Scalar version of [Y4MPlane8(...)], for rows that don't divide evenly into vectors
+static uByte Y4MPlane1(s4Byte r, s4Byte g, s4Byte b, const s4Byte (&coeffs)[4])
+{
+	return (uByte)(((coeffs[0] * r) + (coeffs[1] * g) + (coeffs[2] * b) + coeffs[3]) >> 8);
+}
+
+uByte* FrameDump::EncodePFM(const float* rgba, u4Byte width, u4Byte height, size_t* pfmSize)
+{
+	*pfmSize = 0;
+	if (width == 0 || height == 0) { return nullptr; }
+
+	// Negative scales mark little-endian samples
+	char header[64];
+	const u4Byte headerBytes = (u4Byte)snprintf(header, sizeof(header), "PF\n%u %u\n-1.0\n", width, height);
+	const size_t rowBytes = (size_t)width * 3 * sizeof(float);
+	const size_t numBytes = headerBytes + (rowBytes * height);
+	uByte* pfm = (uByte*)malloc(numBytes);
+	if (pfm == nullptr) { return nullptr; }
+	memcpy(pfm, header, headerBytes);
+
+	// PFM rows run bottom-to-top; drop alpha while flipping rows into place
+	uByte* pixels = pfm + headerBytes;
+	const u4Byte numStrips = (height + AthruGPU::FRAME_DUMP_STRIP_ROWS - 1) / AthruGPU::FRAME_DUMP_STRIP_ROWS;
+	AthruCore::Utility::AccessJobs()->ParallelFor(0, numStrips, 1, [&](u4Byte begin, u4Byte end)
+	{
+		const u4Byte firstRow = begin * AthruGPU::FRAME_DUMP_STRIP_ROWS;
+		const u4Byte endRow = std::min(end * AthruGPU::FRAME_DUMP_STRIP_ROWS, height);
+		for (u4Byte y = firstRow; y < endRow; y += 1)
+		{
+			const float* src = rgba + ((size_t)y * width * 4);
+			float* dst = (float*)(pixels + ((size_t)(height - 1 - y) * rowBytes));
+			for (u4Byte x = 0; x < width; x += 1)
+			{
+				dst[0] = src[0];
+				dst[1] = src[1];
+				dst[2] = src[2];
+				dst += 3;
+				src += 4;
+			}
+		}
+	});
+
+	*pfmSize = numBytes;
+	return pfm;
+}
+
+u4Byte FrameDump::Y4MHeader(char* header, u4Byte width, u4Byte height, u4Byte fps)
+{
+	// Progressive, square pixels, full-resolution chroma
+	const s4Byte numBytes = snprintf(header, MAX_Y4M_HEADER_BYTES, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", width, height, fps);
+	assert(numBytes > 0 && (u4Byte)numBytes < MAX_Y4M_HEADER_BYTES);
+	return (u4Byte)numBytes;
+}
+
+size_t FrameDump::Y4MFrameBytes(u4Byte width, u4Byte height)
+{
+	return Y4M_FRAME_MARKER_BYTES + ((size_t)width * height * 3);
+}
+
+void FrameDump::EncodeY4MFrame(const uByte* rgba, u4Byte width, u4Byte height, uByte* frame)
+{
+	memcpy(frame, Y4M_FRAME_MARKER, Y4M_FRAME_MARKER_BYTES);
+	const size_t planeBytes = (size_t)width * height;
+	uByte* yPlane = frame + Y4M_FRAME_MARKER_BYTES;
+	uByte* uPlane = yPlane + planeBytes;
+	uByte* vPlane = uPlane + planeBytes;
+
+	// Convert sixteen pixels at a time; channels are split out of each pixel in 32-bit lanes, then packed down
+	// to 16-bit lanes for the multiply-adds
+	const u4Byte numStrips = (height + AthruGPU::FRAME_DUMP_STRIP_ROWS - 1) / AthruGPU::FRAME_DUMP_STRIP_ROWS;
+	AthruCore::Utility::AccessJobs()->ParallelFor(0, numStrips, 1, [&](u4Byte begin, u4Byte end)
+	{
+		const size_t firstPixel = (size_t)begin * AthruGPU::FRAME_DUMP_STRIP_ROWS * width;
+		const size_t endPixel = (size_t)std::min(end * AthruGPU::FRAME_DUMP_STRIP_ROWS, height) * width;
+		const __m128i channelMask = _mm_set1_epi32(0xFF);
+		size_t i = firstPixel;
+		for (; (i + 16) <= endPixel; i += 16)
+		{
+			__m128i planes[3][2];
+			for (u4Byte half = 0; half < 2; half += 1)
+			{
+				const __m128i* src = (const __m128i*)(rgba + ((i + (half * 8)) * 4));
+				const __m128i px0 = _mm_loadu_si128(src);
+				const __m128i px1 = _mm_loadu_si128(src + 1);
+				const __m128i r = _mm_packs_epi32(_mm_and_si128(px0, channelMask),
+												  _mm_and_si128(px1, channelMask));
+				const __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(px0, 8), channelMask),
+												  _mm_and_si128(_mm_srli_epi32(px1, 8), channelMask));
+				const __m128i b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(px0, 16), channelMask),
+												  _mm_and_si128(_mm_srli_epi32(px1, 16), channelMask));
+				planes[0][half] = Y4MPlane8(r, g, b, Y4M_Y_COEFFS);
+				planes[1][half] = Y4MPlane8(r, g, b, Y4M_U_COEFFS);
+				planes[2][half] = Y4MPlane8(r, g, b, Y4M_V_COEFFS);
+			}
+			_mm_storeu_si128((__m128i*)(yPlane + i), _mm_packus_epi16(planes[0][0], planes[0][1]));
+			_mm_storeu_si128((__m128i*)(uPlane + i), _mm_packus_epi16(planes[1][0], planes[1][1]));
+			_mm_storeu_si128((__m128i*)(vPlane + i), _mm_packus_epi16(planes[2][0], planes[2][1]));
+		}
+		for (; i < endPixel; i += 1)
+		{
+			const s4Byte r = rgba[(i * 4)];
+			const s4Byte g = rgba[(i * 4) + 1];
+			const s4Byte b = rgba[(i * 4) + 2];
+			yPlane[i] = Y4MPlane1(r, g, b, Y4M_Y_COEFFS);
+			uPlane[i] = Y4MPlane1(r, g, b, Y4M_U_COEFFS);
+			vPlane[i] = Y4MPlane1(r, g, b, Y4M_V_COEFFS);
+		}
+	});
+}
+
+float FrameDump::Benchmark(u4Byte width, u4Byte height)
+{
+	// Smooth gradients + per-pixel noise, roughly like a partially-converged path-traced frame
+	const size_t numPixels = (size_t)width * height;
+	float* hdr = (float*)malloc(numPixels * 4 * sizeof(float));
+	uByte* ldr = (uByte*)malloc(numPixels * 4);
+	BenchRand next;
+	for (size_t i = 0; i < numPixels; i += 1)
+	{
+		const u4Byte rng = next();
+		const float noise = (float)(rng & 255) / 255.0f;
+		const u4Byte x = (u4Byte)(i % width);
+		const u4Byte y = (u4Byte)(i / width);
+		hdr[(i * 4)] = ((float)x / width) * 4.0f + noise;
+		hdr[(i * 4) + 1] = ((float)y / height) * 4.0f + noise;
+		hdr[(i * 4) + 2] = noise * 16.0f;
+		hdr[(i * 4) + 3] = 1.0f;
+		ldr[(i * 4)] = (uByte)std::min((s4Byte)((x * 255) / width) + (s4Byte)(rng & 15), 255);
+		ldr[(i * 4) + 1] = (uByte)std::min((s4Byte)((y * 255) / height) + (s4Byte)(rng & 15), 255);
+		ldr[(i * 4) + 2] = (uByte)(rng >> 24);
+		ldr[(i * 4) + 3] = 255;
+	}
+
+	// Take the best of a few runs, so timings aren't dominated by first-touch page faults
+	constexpr u4Byte NUM_RUNS = 4;
+	auto bestSecs = [](const auto& fn)
+	{
+		double best = 1e30;
+		for (u4Byte i = 0; i < NUM_RUNS; i += 1)
+		{
+			const auto t0 = std::chrono::steady_clock::now();
+			fn();
+			best = std::min(best, (std::chrono::steady_clock::now() - t0).count() * TimeStuff::nsToSecs);
+		}
+		return std::max(best, 1e-9);
+	};
+
+	// Baselines; plain copies of each source image (called through a volatile pointer, so the copies
+	// can't be optimized out)
+	void* (*volatile copyFn)(void*, const void*, size_t) = memcpy;
+	uByte* copy = (uByte*)malloc(numPixels * 4 * sizeof(float));
+	const double hdrCopySecs = bestSecs([&]() { copyFn(copy, hdr, numPixels * 4 * sizeof(float)); });
+	const double ldrCopySecs = bestSecs([&]() { copyFn(copy, ldr, numPixels * 4); });
+	free(copy);
+
+	// PFM conversion, then check that rows were flipped + alpha dropped
+	uByte* pfm = nullptr;
+	size_t pfmSize = 0;
+	const double pfmSecs = bestSecs([&]()
+	{
+		free(pfm);
+		pfm = EncodePFM(hdr, width, height, &pfmSize);
+	});
+	const float* pfmPixels = (const float*)(pfm + (pfmSize - (numPixels * 3 * sizeof(float))));
+	bool pfmMatches = true;
+	for (size_t i = 0; i < numPixels && pfmMatches; i += 1)
+	{
+		const size_t src = (((height - 1 - (i / width)) * width) + (i % width)) * 4;
+		pfmMatches = (memcmp(pfmPixels + (i * 3), hdr + src, sizeof(float) * 3) == 0);
+	}
+	free(pfm);
+
+	// Y4M conversion, then check against floating-point BT.601
+	uByte* frame = (uByte*)malloc(Y4MFrameBytes(width, height));
+	const double y4mSecs = bestSecs([&]() { EncodeY4MFrame(ldr, width, height, frame); });
+	const uByte* planes = frame + Y4M_FRAME_MARKER_BYTES;
+	bool y4mMatches = (memcmp(frame, Y4M_FRAME_MARKER, Y4M_FRAME_MARKER_BYTES) == 0);
+	for (size_t i = 0; i < numPixels && y4mMatches; i += 1)
+	{
+		const float r = ldr[(i * 4)];
+		const float g = ldr[(i * 4) + 1];
+		const float b = ldr[(i * 4) + 2];
+		const float yuv[3] = { 16.0f + (0.257f * r) + (0.504f * g) + (0.098f * b),
+							   128.0f - (0.148f * r) - (0.291f * g) + (0.439f * b),
+							   128.0f + (0.439f * r) - (0.368f * g) - (0.071f * b) };
+		for (u4Byte c = 0; c < 3; c += 1)
+		{
+			y4mMatches = y4mMatches && (fabsf(planes[(c * numPixels) + i] - yuv[c]) <= 1.0f);
+		}
+	}
+	free(frame);
+	free(hdr);
+	free(ldr);
+
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	const float pfmRatio = (float)(hdrCopySecs / pfmSecs);
+	const float y4mRatio = (float)(ldrCopySecs / y4mSecs);
+	logger->Log(hdrCopySecs * 1000.0, "HDR image copy milliseconds");
+	logger->Log(pfmSecs * 1000.0, "PFM convert milliseconds");
+	logger->Log(pfmRatio, "PFM throughput relative to copying");
+	logger->Log((u4Byte)pfmMatches, "PFM matches source image");
+	logger->Log(ldrCopySecs * 1000.0, "LDR image copy milliseconds");
+	logger->Log(y4mSecs * 1000.0, "Y4M convert milliseconds");
+	logger->Log(y4mRatio, "Y4M throughput relative to copying");
+	logger->Log((u4Byte)y4mMatches, "Y4M matches source image");
+	return BenchUtils::ReportChecks(pfmMatches && y4mMatches, "Frame dump benchmark", std::min(pfmRatio, y4mRatio));
+}
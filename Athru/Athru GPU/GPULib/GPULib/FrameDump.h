@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "GPUGlobals.h"
+
+// Uncompressed frame-capture formats
+// PFM images keep the full 32-bit float range of the HDR display texture (one header, then RGB floats
+// bottom row first); Y4M videos keep every frame of a capture in one file (one stream header, then a
+// fixed-size "FRAME" record per image), so frame [n] always lands at (header size + n * [Y4MFrameBytes(...)])
+// and frames can be written as soon as they're converted, in any order
+// Neither format compresses anything, so conversion is just a re-layout of captured pixels + runs at close to
+// copy speed; both conversions run in parallel strips of [AthruGPU::FRAME_DUMP_STRIP_ROWS] rows
+class FrameDump
+{
+	public:
+		FrameDump() = delete;
+		~FrameDump() = delete;
+
+		// Convert a 32-bit float RGBA image (top row first) into a PFM; returns a [malloc]'d file (release it
+		// with [free]) + writes its size into [pfmSize], or returns [nullptr] if conversion fails
+		static uByte* EncodePFM(const float* rgba, u4Byte width, u4Byte height, size_t* pfmSize);
+
+		// Longest possible Y4M stream header
+		static constexpr u4Byte MAX_Y4M_HEADER_BYTES = 64;
+
+		// Write a Y4M stream header into [header] (at least [MAX_Y4M_HEADER_BYTES] long); returns the number
+		// of bytes written
+		static u4Byte Y4MHeader(char* header, u4Byte width, u4Byte height, u4Byte fps);
+
+		// Size of a single Y4M frame record (marker + 4:4:4 planes)
+		static size_t Y4MFrameBytes(u4Byte width, u4Byte height);
+
+		// Convert an 8bpc RGBA image (top row first) into a Y4M frame record (BT.601, 4:4:4) at [frame], which
+		// should have room for [Y4MFrameBytes(...)]
+		static void EncodeY4MFrame(const uByte* rgba, u4Byte width, u4Byte height, uByte* frame);
+
+		// Convert a synthetic [width]x[height] image to PFM + Y4M, then compare each conversion's throughput
+		// against a plain [memcpy] of the same source; verifies the converted pixels + logs timings
+		// Returns the slower format's throughput as a fraction of [memcpy] throughput, or a negative
+		// value if either format's pixels don't match the source
+		static float Benchmark(u4Byte width, u4Byte height);
+};
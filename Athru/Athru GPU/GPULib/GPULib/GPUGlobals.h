@@ -6,9 +6,6 @@
 
 namespace GraphicsStuff
 {
-	// Each shader gets one megabyte of local memory for bytecode
-	extern constexpr u4Byte SHADER_DXIL_ALLOC = 1048576;
-
 	// Rendering information
 	extern constexpr u4Byte MAX_NUM_BOUNCES = 7;
 	extern constexpr u4Byte MAX_NUM_SSURF_BOUNCES = 512;
@@ -62,21 +59,115 @@ namespace AthruGPU
 	// Minimal byte footprint for aligned D3D12 buffer resources
 	extern constexpr u4Byte MINIMAL_D3D12_ALIGNED_BUFFER_MEM = 65536;
 
-	// Expected maximum shared GPU memory usage (for resource upload)
-	extern constexpr u4Byte EXPECTED_SHARED_GPU_UPLO_MEM = MINIMAL_D3D12_ALIGNED_BUFFER_MEM;
+	// Staging memory for streamed uploads (see [UploadRing]); payloads larger than this still stream in,
+	// just over more frames
+	extern constexpr u4Byte UPLOAD_RING_MEM = 16 * 1024 * 1024;
+
+	// Most bytes staged for streamed uploads in any one frame, so large payloads spread their copies out
+	// instead of stalling a single frame
+	extern constexpr u4Byte UPLOAD_FRAME_BUDGET = 4 * 1024 * 1024;
+
+	// Maximum number of upload submissions in flight at once
+	extern constexpr u4Byte MAX_UPLOAD_SUBMISSIONS = 16;
+
+	// Maximum number of payloads queued for streaming at once
+	extern constexpr u4Byte MAX_UPLOAD_STREAMS = 32;
+
+	// Expected maximum shared GPU memory usage (for resource upload); one aligned region for the message
+	// buffer, then the streaming upload ring
+	extern constexpr u4Byte EXPECTED_SHARED_GPU_UPLO_MEM = MINIMAL_D3D12_ALIGNED_BUFFER_MEM + UPLOAD_RING_MEM;
 
 	// Memory requirement for each 8bpc output texture (backbuffer & screenshot data)
 	extern constexpr u4Byte LDR_OUTPUT_TEX_MEM = GraphicsStuff::DISPLAY_AREA * 4;
 
+	// Number of frame captures allowed in flight at once; each capture owns a region of readback memory until
+	// its image has been encoded
+	extern constexpr u4Byte NUM_CAPTURE_SLOTS = 4;
+
+	// Readback memory for each capture; (DISPLAY_AREA * 4) bytes worth of screenshot memory (one set of 8bpc RGB
+	// values/pixel) + padding to meet 64KB alignment
+	extern constexpr u4Byte CAPTURE_SLOT_MEM = (LDR_OUTPUT_TEX_MEM) + (65536 - LDR_OUTPUT_TEX_MEM % 65536);
+
+	// Memory requirement for the floating-point display texture (four 32-bit channels/pixel); rows are
+	// (DISPLAY_WIDTH * 16) bytes wide, which already meets D3D12's 256-byte pitch alignment for texture copies
+	extern constexpr u4Byte HDR_OUTPUT_TEX_MEM = GraphicsStuff::DISPLAY_AREA * 16;
+
+	// Readback memory for HDR captures; only one HDR capture is allowed in flight at once, since each
+	// needs four times the memory of an LDR capture
+	extern constexpr u4Byte HDR_CAPTURE_SLOT_MEM = (HDR_OUTPUT_TEX_MEM) + (65536 - HDR_OUTPUT_TEX_MEM % 65536);
+
 	// Expected maximum shared GPU memory usage (for resource download/readback)
-	// Includes (DISPLAY_AREA * 4) bytes worth of screenshot memory (one set of 8bpc RGB values/pixel) + padding to meet
-	// 64KB alignment
-	extern constexpr u4Byte EXPECTED_SHARED_GPU_RDBK_MEM = (LDR_OUTPUT_TEX_MEM) + (65536 - LDR_OUTPUT_TEX_MEM % 65536);
+	// Includes one capture region for every capture slot, then one HDR capture region
+	extern constexpr u4Byte EXPECTED_SHARED_GPU_RDBK_MEM = (CAPTURE_SLOT_MEM * NUM_CAPTURE_SLOTS) + HDR_CAPTURE_SLOT_MEM;
+
+	// Per-frame rendering passes, in submission order; sub-buffers of the rendering buffer are declared
+	// live across ranges of these (see [BufferPlanner])
+	enum class RNDR_PASSES
+	{
+		LENS_SAMPLING,
+		PATH_TRACING, // Every bounce of tracing, dispatch editing + surface sampling
+		POST_PROCESSING,
+		CAPTURE // Screenshot/video copies out of the rendering buffer
+	};
+
+	// File formats for frame captures
+	// [PNG] writes compressed 8bpc images (see [PNGEncoder]), [PFM] writes raw 32-bit float images from
+	// the HDR display texture, and [Y4M] streams 8bpc frames into a single uncompressed video file
+	// (see [FrameDump])
+	enum class CAPTURE_FORMATS
+	{
+		PNG,
+		PFM,
+		Y4M
+	};
+
+	// Frame-rate recorded in captured video headers; frames are written as they're rendered, so
+	// playback only runs in real time when the renderer holds this rate
+	extern constexpr u4Byte CAPTURE_VIDEO_FPS = 60;
+
+	// Uncompressed captures (PFM images, Y4M frames) are converted in parallel strips of [FRAME_DUMP_STRIP_ROWS]
+	// rows each
+	extern constexpr u4Byte FRAME_DUMP_STRIP_ROWS = 64;
+
+	// Speed/size tradeoffs for capture encoding (see [PNGEncoder])
+	// [STORED] skips compression entirely; [FASTEST], [FAST], and [SMALLEST] check one, eight, and
+	// 128 earlier positions (respectively) for each match search
+	enum class PNG_SPEEDS
+	{
+		STORED,
+		FASTEST,
+		FAST,
+		SMALLEST
+	};
+
+	// Compression level used for frame captures
+	extern constexpr PNG_SPEEDS CAPTURE_PNG_SPEED = PNG_SPEEDS::FAST;
+
+	// Captures are filtered + compressed in parallel strips of [PNG_STRIP_ROWS] rows each
+	extern constexpr u4Byte PNG_STRIP_ROWS = 32;
+
+	// Blue-noise dither texture; packed assets carry it pre-converted to [DXGI_FORMAT_R32G32_FLOAT]
+	// (see [Renderer::ConvertDitherTexels(...)])
+	extern constexpr char DITHER_TEX_PATH[] = "Third Party/Moments In Graphics/LDR_RG01_0.png";
+	extern constexpr u4Byte DITHER_TEX_WIDTH = 128;
+
+	// Compiled shaders used by [Renderer]; listed here so start-up can fetch them
+	// ahead of pipeline creation (see [ComputePass::Prefetch(...)])
+	extern constexpr u4Byte NUM_RENDER_SHADERS = 5;
+	extern constexpr const char* RENDER_SHADER_PATHS[NUM_RENDER_SHADERS] = { "LensSampler.cso",
+																			  "RayMarch.cso",
+																			  "RnderDispEditor.cso",
+																			  "SurfSampler.cso",
+																			  "RasterPrep.cso" };
 
 	// Expected maximum number of shader-visible resource views
 	// Likely to grow after I implement physics + ecology systems
 	extern constexpr u4Byte EXPECTED_NUM_GPU_SHADER_VIEWS = 70;
 
+	// Upper bound on live allocations within any one GPU heap (see [GPUMemory]); heaps smaller than this
+	// (in 64KB pages) are bounded by their page count instead
+	extern constexpr u4Byte MAX_GPU_HEAP_ALLOCS = 1024;
+
 	// Byte footprint for constant data in the CPU->GPU message buffer
 	extern constexpr u2Byte EXPECTED_GPU_CONSTANT_MEM = 256;
 
@@ -17,7 +17,7 @@ AthruGPU::GPUMemory::GPUMemory(const Microsoft::WRL::ComPtr<ID3D12Device>& devic
 											  // Athru for multiple adapters
 	memDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
 	memDesc.Flags = D3D12_HEAP_FLAG_DENY_RT_DS_TEXTURES | D3D12_HEAP_FLAG_DENY_NON_RT_DS_TEXTURES;
-	resrcMem = GPUStackedMem<ID3D12Heap>(memDesc, device);
+	resrcMem = GPUHeapMem<ID3D12Heap>(memDesc, device);
 
 	// Create the upload heap
 	memDesc.SizeInBytes = AthruGPU::EXPECTED_SHARED_GPU_UPLO_MEM;
@@ -27,7 +27,7 @@ AthruGPU::GPUMemory::GPUMemory(const Microsoft::WRL::ComPtr<ID3D12Device>& devic
 	memDesc.Properties.CreationNodeMask = 0x1; // Only one adapter atm
 	memDesc.Properties.VisibleNodeMask = 0x1;
 	// Alignment & flags are the same as main memory
-	uploMem = GPUStackedMem<ID3D12Heap>(memDesc, device);
+	uploMem = GPUHeapMem<ID3D12Heap>(memDesc, device);
 
     // Create the readback heap
     memDesc.SizeInBytes = AthruGPU::EXPECTED_SHARED_GPU_RDBK_MEM;
@@ -36,7 +36,7 @@ AthruGPU::GPUMemory::GPUMemory(const Microsoft::WRL::ComPtr<ID3D12Device>& devic
     memDesc.Properties.CreationNodeMask = 0x1; // Only one adapter atm
     memDesc.Properties.VisibleNodeMask = 0x1;
     // Alignment + flags are the same as main memory
-    rdbkMem = GPUStackedMem<ID3D12Heap>(memDesc, device);
+    rdbkMem = GPUHeapMem<ID3D12Heap>(memDesc, device);
 
 	// Create the shader-visible descriptor heap
 	D3D12_DESCRIPTOR_HEAP_DESC descHeapDesc;
@@ -44,14 +44,22 @@ AthruGPU::GPUMemory::GPUMemory(const Microsoft::WRL::ComPtr<ID3D12Device>& devic
 	descHeapDesc.NumDescriptors = AthruGPU::EXPECTED_NUM_GPU_SHADER_VIEWS;
 	descHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 	descHeapDesc.NodeMask = 0x1; // Only one adapter atm
-	shaderViewMem = GPUStackedMem<ID3D12DescriptorHeap>(descHeapDesc, device);
+	shaderViewMem = GPUHeapMem<ID3D12DescriptorHeap>(descHeapDesc, device);
 	rnderCtxStart = shaderViewMem.mem->GetGPUDescriptorHandleForHeapStart(); // Discrete per-context heaps are unimplemented atm
+	viewHeapStart = shaderViewMem.mem->GetCPUDescriptorHandleForHeapStart();
+	viewIncrement = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
 	// -- No render-targets or depth-stencils used by Athru, compute-shading only -- //
 }
 
 AthruGPU::GPUMemory::~GPUMemory()
 {
+	// Explicitly destroy heap allocators
+	resrcMem.alloc->~OffsetAllocator();
+	uploMem.alloc->~OffsetAllocator();
+	rdbkMem.alloc->~OffsetAllocator();
+	shaderViewMem.alloc->~OffsetAllocator();
+
 	// Explicitly reset smart pointers
 	resrcMem.mem = nullptr;
 	uploMem.mem = nullptr;
@@ -64,19 +72,38 @@ HRESULT AthruGPU::GPUMemory::AllocBuf(const Microsoft::WRL::ComPtr<ID3D12Device>
 									  const D3D12_RESOURCE_DESC bufDesc,
 									  const D3D12_RESOURCE_STATES initState,
 									  const Microsoft::WRL::ComPtr<ID3D12Resource>& bufPttr,
-									  const AthruGPU::HEAP_TYPES heap)
+									  const AthruGPU::HEAP_TYPES heap,
+									  OffsetAllocator::Allocation* heapRange)
+{
+	// Select a heap by pointer (rather than binding a reference and re-assigning it, which would copy [rdbkMem] over [uploMem])
+	GPUHeapMem<ID3D12Heap>* mem = HeapFor(heap);
+
+	// Find space for the buffer
+	constexpr u4Byte pageSize = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	const OffsetAllocator::Allocation range = mem->alloc->Allocate((bufSize + pageSize - 1) / pageSize);
+	if (range.offset == OffsetAllocator::NO_SPACE) { return E_OUTOFMEMORY; }
+
+	// Place the buffer, returning its range to the heap if placement fails
+	HRESULT hr = device->CreatePlacedResource(mem->mem.Get(),
+											  (u8Byte)range.offset * pageSize,
+											  &bufDesc,
+											  initState,
+											  nullptr,
+											  __uuidof(bufPttr),
+											  (void**)bufPttr.GetAddressOf());
+	if (FAILED(hr))
+	{
+		mem->alloc->Free(range);
+		return hr;
+	}
+	if (heapRange != nullptr) { *heapRange = range; }
+	return hr;
+}
+
+void AthruGPU::GPUMemory::FreeBuf(const OffsetAllocator::Allocation& heapRange,
+								  const AthruGPU::HEAP_TYPES heap)
 {
-	GPUStackedMem<ID3D12Heap>& mem = (heap == AthruGPU::HEAP_TYPES::GPU_ACCESS_ONLY) ? resrcMem : uploMem;
-    if (heap == AthruGPU::HEAP_TYPES::READBACK) { mem = rdbkMem;}
-	u8Byte offs = mem.offs;
-	mem.offs += bufSize;
-	return device->CreatePlacedResource(mem.mem.Get(),
-										offs,
-										&bufDesc,
-										initState,
-										nullptr,
-										__uuidof(bufPttr),
-										(void**)bufPttr.GetAddressOf());
+	HeapFor(heap)->alloc->Free(heapRange);
 }
 
 HRESULT AthruGPU::GPUMemory::AllocTex(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
@@ -149,6 +176,31 @@ D3D12_CPU_DESCRIPTOR_HANDLE AthruGPU::GPUMemory::AllocUAV(const Microsoft::WRL::
 					 ctrResrc);
 }
 
+void AthruGPU::GPUMemory::FreeView(const D3D12_CPU_DESCRIPTOR_HANDLE& view)
+{
+	if (view.ptr == 0) { return; } // Failed allocations have no slot to free
+	const u4Byte slot = (u4Byte)((view.ptr - viewHeapStart.ptr) / viewIncrement);
+	assert(slot < AthruGPU::EXPECTED_NUM_GPU_SHADER_VIEWS);
+	shaderViewMem.alloc->Free(viewSlots[slot]);
+	viewSlots[slot] = OffsetAllocator::Allocation();
+}
+
+void AthruGPU::GPUMemory::ViewHeapFull()
+{
+	AthruCore::Utility::AccessLogger()->Log("shader-visible descriptor heap is full; raise [EXPECTED_NUM_GPU_SHADER_VIEWS]", "GPU memory message");
+	assert(false); // Debug builds stop here; release builds continue without the view
+}
+
+OffsetAllocator::StorageReport AthruGPU::GPUMemory::HeapStats(const AthruGPU::HEAP_TYPES heap)
+{
+	return HeapFor(heap)->alloc->Stats();
+}
+
+OffsetAllocator::StorageReport AthruGPU::GPUMemory::ViewStats()
+{
+	return shaderViewMem.alloc->Stats();
+}
+
 const Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>& AthruGPU::GPUMemory::GetShaderViewMem()
 {
     return shaderViewMem.mem;
@@ -171,6 +223,19 @@ const D3D12_GPU_DESCRIPTOR_HANDLE AthruGPU::GPUMemory::GetBaseDescriptor(const A
 	}
 }
 
+AthruGPU::GPUMemory::GPUHeapMem<ID3D12Heap>* AthruGPU::GPUMemory::HeapFor(const AthruGPU::HEAP_TYPES heap)
+{
+	switch (heap)
+	{
+		case AthruGPU::HEAP_TYPES::UPLO:
+			return &uploMem;
+		case AthruGPU::HEAP_TYPES::READBACK:
+			return &rdbkMem;
+		default:
+			return &resrcMem;
+	}
+}
+
 // Push constructions for this class through Athru's custom allocator
 void* AthruGPU::GPUMemory::operator new(size_t size)
 {
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <d3d12.h>
+#include <algorithm>
 #include <wrl/client.h>
 #include "GPUGlobals.h"
+#include "OffsetAllocator.h"
 
 namespace AthruGPU
 {
@@ -23,12 +25,20 @@ namespace AthruGPU
 			~GPUMemory();
 
 			// [GPUMemory] expects aligned Buffer/Texture/View allocations
+			// Buffers are placed on 64KB boundaries, so sizes round up to the next 64KB; pass [heapRange] to receive the
+			// buffer's range within its heap, if you expect to release the buffer later on (see [FreeBuf(...)])
 			HRESULT AllocBuf(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
 							 const u4Byte& bufSize,
 							 const D3D12_RESOURCE_DESC bufDesc,
 							 const D3D12_RESOURCE_STATES initState,
 							 const Microsoft::WRL::ComPtr<ID3D12Resource>& bufPttr,
-							 const AthruGPU::HEAP_TYPES = AthruGPU::HEAP_TYPES::GPU_ACCESS_ONLY);
+							 const AthruGPU::HEAP_TYPES = AthruGPU::HEAP_TYPES::GPU_ACCESS_ONLY,
+							 OffsetAllocator::Allocation* heapRange = nullptr);
+
+			// Return a buffer's heap range (from [AllocBuf(...)]) for re-use
+			// The buffer itself should be released first, + the GPU should have finished with it
+			void FreeBuf(const OffsetAllocator::Allocation& heapRange,
+						 const AthruGPU::HEAP_TYPES heap);
 
 			// [GPUMemory] expects aligned Buffer/Texture/View allocations
 			HRESULT AllocTex(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
@@ -39,6 +49,8 @@ namespace AthruGPU
 							 const Microsoft::WRL::ComPtr<ID3D12Resource>& texPttr);
 
 			// Allocate a shader view over a resource described by [viewDesc], and return a handle to the allocated view
+			// Returns a null handle ([ptr] zero, like the handles held by view-less resources) + logs an error if the
+			// shader-visible descriptor heap is full
 			D3D12_CPU_DESCRIPTOR_HANDLE GPUMemory::AllocCBV(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
 															const D3D12_CONSTANT_BUFFER_VIEW_DESC* viewDesc);
 			D3D12_CPU_DESCRIPTOR_HANDLE GPUMemory::AllocSRV(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
@@ -49,6 +61,16 @@ namespace AthruGPU
 															const Microsoft::WRL::ComPtr<ID3D12Resource>& dataResrc,
 															const Microsoft::WRL::ComPtr<ID3D12Resource>& ctrResrc);
 
+			// Return a view allocated with [AllocCBV(...)]/[AllocSRV(...)]/[AllocUAV(...)] for re-use; null handles are ignored
+			// Descriptor tables expect views in allocation order, so only free views that aren't referenced by any table
+			// (or free + re-allocate whole tables together)
+			void FreeView(const D3D12_CPU_DESCRIPTOR_HANDLE& view);
+
+			// Free-space + fragmentation statistics for the given heap (in 64KB pages), or for the shader-visible
+			// descriptor heap (in descriptors)
+			OffsetAllocator::StorageReport HeapStats(const AthruGPU::HEAP_TYPES heap);
+			OffsetAllocator::StorageReport ViewStats();
+
             // Return a reference to the shader descriptor heap ([shaderViewMem])
             const Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>& GetShaderViewMem();
 
@@ -68,8 +90,18 @@ namespace AthruGPU
 											      const Microsoft::WRL::ComPtr<ID3D12Resource>& dataResrc = nullptr,
 											      const Microsoft::WRL::ComPtr<ID3D12Resource>& ctrResrc = nullptr)
 			{
-				// Cache view handle
-				D3D12_CPU_DESCRIPTOR_HANDLE viewHandle = shaderViewMem.offs;
+				// Find space for the view
+				// Fresh descriptor heaps hand out slots in order, so views allocated back-to-back stay contiguous (as descriptor
+				// tables expect)
+				const OffsetAllocator::Allocation slot = shaderViewMem.alloc->Allocate(1);
+				if (slot.offset == OffsetAllocator::NO_SPACE)
+				{
+					ViewHeapFull();
+					return D3D12_CPU_DESCRIPTOR_HANDLE { 0 };
+				}
+				viewSlots[slot.offset] = slot;
+				D3D12_CPU_DESCRIPTOR_HANDLE viewHandle = viewHeapStart;
+				viewHandle.ptr += (SIZE_T)slot.offset * viewIncrement;
 
 				// Allocate view & return descriptor handle
 				if constexpr (std::is_same<viewDescType, D3D12_CONSTANT_BUFFER_VIEW_DESC>::value)
@@ -90,53 +122,60 @@ namespace AthruGPU
 													  (const D3D12_UNORDERED_ACCESS_VIEW_DESC*)viewDesc,
 													  viewHandle);
 				}
-				// Update descriptor-heap offset
-				shaderViewMem.offs.ptr += device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 				return viewHandle;
 			}
 
-			// Abstraction for stack-like GPU memory chunks, defining an offset (zero-initialized integer for resources,
-			// procedurally-initialized handle for descriptors) and a chunk type (resource heap/descriptor heap)
+			// Report a failed view allocation (kept out of line so [AllocView(...)] doesn't need the logger)
+			void ViewHeapFull();
+
+			// Abstraction for GPU memory chunks, defining an allocator (64KB pages for resource heaps, single descriptors
+			// for descriptor heaps) and a chunk type (resource heap/descriptor heap)
 			template<typename HeapType> // Should limit to [ID3D12Heap]/[ID3D12DescriptorHeap] with C++20 concepts
-			struct GPUStackedMem
+			struct GPUHeapMem
 			{
-				GPUStackedMem() {}; // Empty constructor to simplify broader [GPUMemory] setup
-				typedef typename std::conditional<std::is_same<HeapType, ID3D12Heap>::value,
-												  u8Byte,
-												  D3D12_CPU_DESCRIPTOR_HANDLE>::type offsType;
+				GPUHeapMem() {}; // Empty constructor to simplify broader [GPUMemory] setup
 				typedef typename std::conditional<std::is_same<HeapType, ID3D12Heap>::value,
 												  D3D12_HEAP_DESC,
 												  D3D12_DESCRIPTOR_HEAP_DESC>::type memDescType;
-				GPUStackedMem(const memDescType& memDesc, const Microsoft::WRL::ComPtr<ID3D12Device>& device)
+				GPUHeapMem(const memDescType& memDesc, const Microsoft::WRL::ComPtr<ID3D12Device>& device)
 				{
 					// Initialize GPU memory
-					constexpr bool resrcStack = std::is_same<HeapType, ID3D12Heap>::value;
-					if constexpr (resrcStack) { assert(SUCCEEDED(device->CreateHeap(&memDesc, __uuidof(ID3D12Heap), (void**)mem.GetAddressOf()))); }
-					else if constexpr (!resrcStack) { assert(SUCCEEDED(device->CreateDescriptorHeap(&memDesc, __uuidof(ID3D12DescriptorHeap), (void**)mem.GetAddressOf()))); }
+					constexpr bool resrcHeap = std::is_same<HeapType, ID3D12Heap>::value;
+					if constexpr (resrcHeap) { assert(SUCCEEDED(device->CreateHeap(&memDesc, __uuidof(ID3D12Heap), (void**)mem.GetAddressOf()))); }
+					else if constexpr (!resrcHeap) { assert(SUCCEEDED(device->CreateDescriptorHeap(&memDesc, __uuidof(ID3D12DescriptorHeap), (void**)mem.GetAddressOf()))); }
 
-					// Initialize data offset
-					if constexpr (resrcStack)
-					{ offs = 0; }
+					// Initialize the allocator
+					if constexpr (resrcHeap)
+					{
+						const u4Byte numPages = (u4Byte)(memDesc.SizeInBytes / D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+						alloc = new OffsetAllocator(numPages, std::min(numPages, AthruGPU::MAX_GPU_HEAP_ALLOCS));
+					}
 					else if constexpr (std::is_same<HeapType, ID3D12DescriptorHeap>::value)
-					{ offs = mem->GetCPUDescriptorHandleForHeapStart(); }
+					{ alloc = new OffsetAllocator(memDesc.NumDescriptors, memDesc.NumDescriptors); }
 				}
-				offsType offs; // [GPUMemory] uses a similar stack-based model to [StackAllocator]
-							   // Defined in bytes for [uploMem] and [resrcMem], multiples of cbv/uav/srv descriptor size for [shaderViewMem]
+				OffsetAllocator* alloc = nullptr; // Defined in 64KB pages for [uploMem], [resrcMem] and [rdbkMem], descriptors for [shaderViewMem]
 				Microsoft::WRL::ComPtr<HeapType> mem;
 			};
-			GPUStackedMem<ID3D12Heap> resrcMem; // Main buffer memory
-			GPUStackedMem<ID3D12Heap> uploMem; // CPU->GPU intermediate upload memory (used for planetary load-in + cbuffers)
+			// Resource heap matching the given heap type
+			GPUHeapMem<ID3D12Heap>* HeapFor(const AthruGPU::HEAP_TYPES heap);
+
+			GPUHeapMem<ID3D12Heap> resrcMem; // Main buffer memory
+			GPUHeapMem<ID3D12Heap> uploMem; // CPU->GPU intermediate upload memory (used for planetary load-in + cbuffers)
 											   // Animal memory could easily be too dense to be wholly GPU-resident, so stream that in through tiled resources instead
-            GPUStackedMem<ID3D12Heap> rdbkMem; // GPU->CPU intermediate readback memory (mainly used for tracking path counts between shading stages; Athru's path-tracing
+            GPUHeapMem<ID3D12Heap> rdbkMem; // GPU->CPU intermediate readback memory (mainly used for tracking path counts between shading stages; Athru's path-tracing
                                                // style guarantees stalls between stages (either from UAV barriers or from readback), so there's less reason to choose indirect
                                                // dispatch over a conceptually simpler readback->dispatch->update->readback loop)
-			GPUStackedMem<ID3D12DescriptorHeap> shaderViewMem; // Descriptor memory for shader-visible views (constant-buffer, shader-resource, unordered-access)
+			GPUHeapMem<ID3D12DescriptorHeap> shaderViewMem; // Descriptor memory for shader-visible views (constant-buffer, shader-resource, unordered-access)
 															   // Not necessary yet, but likely to have one descriptor heap for storage and smaller ones for per-context work
 															   // (descriptors across contexts would be stored in [shaderViewMem], then those needed for specific contexts
 															   //  would be copied across to [rnderViewMem], [physicsViewMem], and [ecoViewMem] each frame)
 															   // This simplifies descriptor management, and makes it natural to only include the context bindings you'll use
 															   // in each shader
 			D3D12_GPU_DESCRIPTOR_HANDLE rnderCtxStart; // GPU handle to the start of the rendering descriptor heap
+			D3D12_CPU_DESCRIPTOR_HANDLE viewHeapStart; // CPU handle to the start of [shaderViewMem]
+			u4Byte viewIncrement; // Distance between adjacent descriptors in [shaderViewMem]
+			OffsetAllocator::Allocation viewSlots[AthruGPU::EXPECTED_NUM_GPU_SHADER_VIEWS]; // Allocator ranges for each live view, indexed by
+																						   // descriptor (so [FreeView(...)] only needs a handle)
 			// -- No render-targets or depth-stencils used by Athru, compute-shading only -- //
 	};
 }
@@ -1,9 +1,16 @@
 #include "GPUServiceCentre.h"
 #include "GPUMessenger.h"
+#include "PNGEncoder.h"
+#include "FrameDump.h"
 #include "lodepng.h"
+#include <filesystem>
+#include <cstdio>
 
 GPUMessenger::GPUMessenger(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
-                           AthruGPU::GPUMemory& gpuMem) : gpuReadable(nullptr)
+                           AthruGPU::GPUMemory& gpuMem) : gpuReadable(nullptr), nextCaptureSlot(0), sequenceActive(false), sequenceFrame(0),
+																						   sequenceFormat(AthruGPU::CAPTURE_FORMATS::PNG), sequenceHeaderBytes(0),
+																						   streamGeneration(0), uploRingMem(nullptr), uploRing(AthruGPU::UPLOAD_RING_MEM),
+																						   uploFenceVal(0)
 {
 	// Initialize the GPU message buffer
 	msgBuf.InitMsgBuf(device, gpuMem, (address*)&gpuInput);
@@ -11,63 +18,250 @@ GPUMessenger::GPUMessenger(const Microsoft::WRL::ComPtr<ID3D12Device>& device,
 	// Initialize the readback buffer
 	rdbkBuf.InitReadbkBuf(device, gpuMem);
 
+	// Carve the readback buffer into capture slots; the HDR slot sits after every LDR slot
+	for (u4Byte i = 0; i <= HDR_CAPTURE_SLOT; i += 1)
+	{
+		CaptureSlot& slot = captureSlots[i];
+		slot.readback = rdbkBuf.resrc.Get();
+		slot.offset = i * AthruGPU::CAPTURE_SLOT_MEM;
+		slot.pixels = nullptr;
+		slot.width = 0;
+		slot.height = 0;
+		slot.format = (i == HDR_CAPTURE_SLOT) ? AthruGPU::CAPTURE_FORMATS::PFM : AthruGPU::CAPTURE_FORMATS::PNG;
+		slot.path[0] = '\0';
+		slot.fileOffset = 0;
+		new (&slot.busy) std::atomic<bool>(false);
+	}
+	sequenceStem[0] = '\0';
+
 	// Initialize the system buffer
 	sysBuf.InitBuf(device, gpuMem, SceneStuff::ALIGNED_PARAMETRIC_FIGURES_PER_SYSTEM, DXGI_FORMAT_UNKNOWN);
 
-	// Create messaging command list + allocator
-	device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_DIRECT,
-								   __uuidof(msgAlloc),
-								   (void**)&msgAlloc);
-	device->CreateCommandList(0x1,
-							  D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_DIRECT,
-							  msgAlloc.Get(),
-							  nullptr,
-							  __uuidof(msgCmds),
-							  (void**)&msgCmds);
-
-	// Record upload -> dedicated memory copy
-	// (used to transfer parametric figure memory onto the GPU in each new system)
-	D3D12_RESOURCE_BARRIER sysBufBarriers[2] = { AthruGPU::TransitionBarrier(D3D12_RESOURCE_STATE_COPY_DEST, sysBuf.resrc, sysBuf.resrcState),
-												 AthruGPU::TransitionBarrier(sysBuf.resrcState, sysBuf.resrc, D3D12_RESOURCE_STATE_COPY_DEST) };
-	msgCmds->ResourceBarrier(1, sysBufBarriers);
-	msgCmds->CopyBufferRegion(sysBuf.resrc.Get(), 0, msgBuf.resrc.Get(), 0, sysBytes); // Perform copy
-	msgCmds->ResourceBarrier(1, sysBufBarriers + 1);
-	HRESULT hr = msgCmds->Close();
+	// Initialize the upload ring's staging memory (placed straight after the message buffer in the upload heap)
+	uploRingBuf.InitUploBuf(device, gpuMem, AthruGPU::UPLOAD_RING_MEM, (address*)&uploRingMem);
+	for (u4Byte i = 0; i < AthruGPU::MAX_UPLOAD_STREAMS; i += 1)
+	{
+		streams[i].active = false;
+		streams[i].ticket = i;
+	}
+
+	// Create the upload fence + its completion event
+	HRESULT hr = device->CreateFence(0, D3D12_FENCE_FLAG_NONE, __uuidof(uploFence), (void**)&uploFence);
 	assert(SUCCEEDED(hr));
+	uploEvt = CreateEvent(NULL, FALSE, FALSE, L"AthruUploadEvent");
 
-	// Initialize file output thread with a null function
-	auto fn = []() {};
-	fileWriter = std::thread(fn);
+	// Create upload command allocators + the upload command list
+	for (u4Byte i = 0; i < AthruGPU::NUM_SWAPCHAIN_BUFFERS; i += 1)
+	{
+		hr = device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_DIRECT,
+											__uuidof(uploAllocs[i]),
+											(void**)&uploAllocs[i]);
+		assert(SUCCEEDED(hr));
+		uploAllocFences[i] = 0;
+	}
+	hr = device->CreateCommandList(0x1,
+								   D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_DIRECT,
+								   uploAllocs[0].Get(),
+								   nullptr,
+								   __uuidof(uploCmds),
+								   (void**)&uploCmds);
+	assert(SUCCEEDED(hr));
+	hr = uploCmds->Close(); // Lists are reset before every batch of copies
+	assert(SUCCEEDED(hr));
 }
 
 GPUMessenger::~GPUMessenger()
 {
-	// Wait for file output to finish
-	fileWriter.join();
+	// Wait for captures to finish encoding
+	for (u4Byte i = 0; i <= HDR_CAPTURE_SLOT; i += 1)
+	{
+		std::atomic<bool>& busy = captureSlots[i].busy;
+		AthruCore::Utility::AccessJobs()->WaitUntil([&busy]() { return !busy.load(std::memory_order_acquire); });
+	}
+
+	// Wait for in-flight uploads
+	WaitForUpload(uploFenceVal);
+	CloseHandle(uploEvt);
 
-	// Unmap message buffer, explicitly clear smart pointers
+	// Unmap message/upload buffers, explicitly clear smart pointers
 	D3D12_RANGE range;
 	range.Begin = 0;
-	range.End = sysBytes;
+	range.End = sizeof(GPUInput);
 	msgBuf.resrc->Unmap(0, &range);
+	range.End = AthruGPU::UPLOAD_RING_MEM;
+	uploRingBuf.resrc->Unmap(0, &range);
 	msgBuf.resrc = nullptr;
+	uploRingBuf.resrc = nullptr;
 	rdbkBuf.resrc = nullptr;
 	sysBuf.resrc = nullptr;
-	msgAlloc = nullptr;
-	msgCmds = nullptr;
+	for (u4Byte i = 0; i < AthruGPU::NUM_SWAPCHAIN_BUFFERS; i += 1)
+	{ uploAllocs[i] = nullptr; }
+	uploCmds = nullptr;
+	uploFence = nullptr;
 }
 
 void GPUMessenger::SysToGPU(SceneFigure::Figure* sceneFigures)
 {
-	// Copy the given system to the upload heap
-	memcpy(gpuInput, sceneFigures, sysBytes);
+	// Stream the given system into [sysBuf], then submit the copy straight away so it lands on the graphics queue
+	// ahead of the next frame's rendering work (no need to wait for it on the CPU)
+	// Figures live in the scene's figure array, which stays put while the upload is in flight
+	Stream(sceneFigures, sysBytes, sysBuf.resrc.Get(), 0, sysBuf.resrcState);
+	PumpUploads();
+}
+
+u4Byte GPUMessenger::Stream(const void* data, u8Byte bytes, ID3D12Resource* dst, u8Byte dstOffset, D3D12_RESOURCE_STATES dstState)
+{
+	assert(bytes > 0);
+
+	// Find an idle stream; if every stream is busy, keep pumping (+ waiting on the GPU) until one finishes
+	RetireUploads();
+	s4Byte streamNdx = -1;
+	while (streamNdx < 0)
+	{
+		for (u4Byte i = 0; i < AthruGPU::MAX_UPLOAD_STREAMS; i += 1)
+		{
+			if (!streams[i].active) { streamNdx = (s4Byte)i; break; }
+		}
+		if (streamNdx < 0)
+		{
+			PumpUploads();
+			WaitForUpload(uploFenceVal);
+			RetireUploads();
+		}
+	}
 
-	// Copy from the upload heap into [sysBuf]
-	// Scenes aren't configured for uploading complete systems yet, so ignore this for now
-	Direct3D* d3d = AthruGPU::GPU::AccessD3D();
-	const Microsoft::WRL::ComPtr<ID3D12CommandQueue>& rnderQueue = d3d->GetGraphicsQueue();
-	rnderQueue->ExecuteCommandLists(1, (ID3D12CommandList**)msgCmds.GetAddressOf());
-	d3d->WaitForQueue(rnderQueue);
+	// Queue the payload; its first slice is copied at the next [PumpUploads()]
+	UploadStream& stream = streams[streamNdx];
+	stream.src = (const uByte*)data;
+	stream.bytes = bytes;
+	stream.sent = 0;
+	stream.dst = dst;
+	stream.dstOffset = dstOffset;
+	stream.dstState = dstState;
+	stream.fence = 0;
+	stream.ticket = (streamGeneration * AthruGPU::MAX_UPLOAD_STREAMS) + streamNdx;
+	stream.active = true;
+	streamGeneration += 1;
+	return stream.ticket;
+}
+
+bool GPUMessenger::Streamed(u4Byte ticket)
+{
+	RetireUploads();
+	const UploadStream& stream = streams[ticket % AthruGPU::MAX_UPLOAD_STREAMS];
+	return stream.ticket != ticket || !stream.active; // Recycled streams finished long ago
+}
+
+void GPUMessenger::PumpUploads()
+{
+	RetireUploads();
+
+	// Stage one slice of each queued payload; slices shrink to fit whatever's left of the ring (+ the frame's budget),
+	// and payloads that can't get even a small slice wait for the next frame
+	struct PendingCopy
+	{
+		u4Byte stream;
+		u8Byte ringOffset;
+		u8Byte bytes;
+	};
+	PendingCopy copies[AthruGPU::MAX_UPLOAD_STREAMS];
+	D3D12_RESOURCE_BARRIER toCopyDest[AthruGPU::MAX_UPLOAD_STREAMS];
+	D3D12_RESOURCE_BARRIER fromCopyDest[AthruGPU::MAX_UPLOAD_STREAMS];
+	u4Byte numCopies = 0;
+	u4Byte numBarriers = 0;
+	u8Byte budget = AthruGPU::UPLOAD_FRAME_BUDGET;
+	constexpr u8Byte minSlice = AthruGPU::MINIMAL_D3D12_ALIGNED_BUFFER_MEM;
+	for (u4Byte i = 0; i < AthruGPU::MAX_UPLOAD_STREAMS && budget > 0; i += 1)
+	{
+		UploadStream& stream = streams[i];
+		if (!stream.active || stream.sent == stream.bytes) { continue; }
+
+		const u8Byte remaining = stream.bytes - stream.sent;
+		u8Byte slice = std::min(remaining, budget);
+		u8Byte ringOffset = UploadRing::NO_SPACE;
+		while (true)
+		{
+			ringOffset = uploRing.Allocate(slice, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT); // Texture-friendly alignment, so image payloads can share the ring
+			if (ringOffset != UploadRing::NO_SPACE || slice <= minSlice) { break; }
+			slice = std::max(slice / 2, minSlice);
+		}
+		if (ringOffset == UploadRing::NO_SPACE) { continue; }
+
+		memcpy(uploRingMem + ringOffset, stream.src + stream.sent, slice);
+		copies[numCopies] = { i, ringOffset, slice };
+		numCopies += 1;
+		budget -= slice;
+
+		// Transition each destination once, however many streams write into it
+		bool transitioned = false;
+		for (u4Byte j = 0; j < (numCopies - 1); j += 1)
+		{
+			const UploadStream& other = streams[copies[j].stream];
+			if (other.dst == stream.dst)
+			{
+				assert(other.dstState == stream.dstState);
+				transitioned = true;
+				break;
+			}
+		}
+		if (!transitioned && stream.dstState != D3D12_RESOURCE_STATE_COPY_DEST)
+		{
+			const Microsoft::WRL::ComPtr<ID3D12Resource> dst = stream.dst;
+			toCopyDest[numBarriers] = AthruGPU::TransitionBarrier(D3D12_RESOURCE_STATE_COPY_DEST, dst, stream.dstState);
+			fromCopyDest[numBarriers] = AthruGPU::TransitionBarrier(stream.dstState, dst, D3D12_RESOURCE_STATE_COPY_DEST);
+			numBarriers += 1;
+		}
+	}
+	if (numCopies == 0) { return; }
+
+	// Record copies; allocators are recycled once per [NUM_SWAPCHAIN_BUFFERS] batches, so this only waits if the GPU
+	// is that many batches behind
+	const u4Byte allocNdx = (u4Byte)(uploFenceVal % AthruGPU::NUM_SWAPCHAIN_BUFFERS);
+	WaitForUpload(uploAllocFences[allocNdx]);
+	HRESULT hr = uploAllocs[allocNdx]->Reset();
+	assert(SUCCEEDED(hr));
+	hr = uploCmds->Reset(uploAllocs[allocNdx].Get(), nullptr);
+	assert(SUCCEEDED(hr));
+	if (numBarriers > 0) { uploCmds->ResourceBarrier(numBarriers, toCopyDest); }
+	for (u4Byte i = 0; i < numCopies; i += 1)
+	{
+		UploadStream& stream = streams[copies[i].stream];
+		uploCmds->CopyBufferRegion(stream.dst, stream.dstOffset + stream.sent, uploRingBuf.resrc.Get(), copies[i].ringOffset, copies[i].bytes);
+		stream.sent += copies[i].bytes;
+	}
+	if (numBarriers > 0) { uploCmds->ResourceBarrier(numBarriers, fromCopyDest); }
+	hr = uploCmds->Close();
+	assert(SUCCEEDED(hr));
+
+	// Submit, then tag this batch's ring space + streams with the fence signalled after it
+	const Microsoft::WRL::ComPtr<ID3D12CommandQueue>& rnderQueue = AthruGPU::GPU::AccessD3D()->GetGraphicsQueue();
+	rnderQueue->ExecuteCommandLists(1, (ID3D12CommandList**)uploCmds.GetAddressOf());
+	uploFenceVal += 1;
+	hr = rnderQueue->Signal(uploFence.Get(), uploFenceVal);
+	assert(SUCCEEDED(hr));
+	uploRing.Close(uploFenceVal);
+	uploAllocFences[allocNdx] = uploFenceVal;
+	for (u4Byte i = 0; i < numCopies; i += 1)
+	{ streams[copies[i].stream].fence = uploFenceVal; }
+}
+
+void GPUMessenger::RetireUploads()
+{
+	const u8Byte completed = uploFence->GetCompletedValue();
+	uploRing.Retire(completed);
+	for (u4Byte i = 0; i < AthruGPU::MAX_UPLOAD_STREAMS; i += 1)
+	{
+		UploadStream& stream = streams[i];
+		if (stream.active && stream.sent == stream.bytes && stream.fence <= completed) { stream.active = false; }
+	}
+}
+
+void GPUMessenger::WaitForUpload(u8Byte fence)
+{
+	if (uploFence->GetCompletedValue() >= fence) { return; }
+	HRESULT hr = uploFence->SetEventOnCompletion(fence, uploEvt);
+	assert(SUCCEEDED(hr));
+	WaitForSingleObject(uploEvt, INFINITE);
 }
 
 void GPUMessenger::InputsToGPU(const DirectX::XMFLOAT4& sysOri,
@@ -110,28 +304,234 @@ void GPUMessenger::InputsToGPU(const DirectX::XMFLOAT4& sysOri,
     // Update physics & ecosystem inputs here...
 }
 
-// Convenience function for file output
-// Would prefer to define as a member of [GPUMessenger] than as a free-function,
-// but unsure if member functions can be dispatched from [std::thread]s when the
-// thread and the member function are controlled by the same class instance
-void fileWriterFn(const char* file, u4Byte width, u4Byte height, uByte* writeTo)
+// Release encoded captures once they've reached the disk
+void captureWrittenFn(IO_STATUS status, u8Byte bytesTransferred, void* png)
 {
-	// Save 8bpc/4-channel PNG with lodepng
-	lodepng_encode32_file(file, writeTo, width, height);
-	AthruCore::Utility::AccessLogger()->Log("took a screenshot :D", "screenshot message");
+	free(png);
+	if (status == IO_STATUS::DONE)
+	{
+		AthruCore::Utility::AccessLogger()->Log("took a screenshot :D", "screenshot message");
+	}
+	else
+	{
+		AthruCore::Utility::AccessLogger()->Log("failed to write a screenshot", "screenshot message");
+	}
 }
 
-void GPUMessenger::SaveTexture(const char* file, u4Byte width, u4Byte height)
+// Release video frames once they've reached the disk; frames arrive every render, so only
+// failures are logged
+void videoFrameWrittenFn(IO_STATUS status, u8Byte bytesTransferred, void* frame)
 {
-	// Load data from the readback buffer into intermediate CPU memory
-	DataFromGPU(0, width * height * 4, tmpFileStorage);
-	fileWriter.join(); // Wait for any previous work to end
-	fileWriter = std::thread(fileWriterFn, file, width, height, tmpFileStorage); // Begin outputting the given file
+	free(frame);
+	if (status != IO_STATUS::DONE)
+	{
+		AthruCore::Utility::AccessLogger()->Log("failed to write a video frame", "screenshot message");
+	}
+}
+
+void GPUMessenger::EncodeCapture(CaptureSlot* slot)
+{
+	// Encode the captured image (work is split into strips + spread over the job system
+	// for every format), then hand the encoded image to the I/O service; the image is
+	// released after the write completes
+	AsyncIO* io = AthruCore::Utility::AccessIO();
+	switch (slot->format)
+	{
+		case AthruGPU::CAPTURE_FORMATS::PNG:
+		{
+			// 8bpc/4-channel PNG
+			size_t pngSize = 0;
+			uByte* png = PNGEncoder::Encode(slot->pixels, slot->width, slot->height, AthruGPU::CAPTURE_PNG_SPEED, &pngSize);
+			if (png != nullptr)
+			{
+				io->Write(slot->path, png, pngSize, IO_WRITE_MODES::OVERWRITE, false, captureWrittenFn, png);
+			}
+			break;
+		}
+		case AthruGPU::CAPTURE_FORMATS::PFM:
+		{
+			// 32-bit float RGB, straight from the HDR display texture
+			size_t pfmSize = 0;
+			uByte* pfm = FrameDump::EncodePFM((const float*)slot->pixels, slot->width, slot->height, &pfmSize);
+			if (pfm != nullptr)
+			{
+				io->Write(slot->path, pfm, pfmSize, IO_WRITE_MODES::OVERWRITE, false, captureWrittenFn, pfm);
+			}
+			break;
+		}
+		case AthruGPU::CAPTURE_FORMATS::Y4M:
+		{
+			// Frames have fixed sizes + pre-assigned offsets, so they can be written in whatever
+			// order their encoders finish
+			const size_t frameBytes = FrameDump::Y4MFrameBytes(slot->width, slot->height);
+			uByte* frame = (uByte*)malloc(frameBytes);
+			if (frame != nullptr)
+			{
+				FrameDump::EncodeY4MFrame(slot->pixels, slot->width, slot->height, frame);
+				io->WriteAt(slot->path, frame, frameBytes, slot->fileOffset, false, videoFrameWrittenFn, frame);
+			}
+			break;
+		}
+	}
+
+	// Unmap the slot's region (nothing was written) + return it to the ring
+	D3D12_RANGE range;
+	range.Begin = 0;
+	range.End = 0;
+	slot->readback->Unmap(0, &range);
+	slot->pixels = nullptr;
+	slot->busy.store(false, std::memory_order_release);
+}
+
+s4Byte GPUMessenger::BeginCapture(bool screenshot)
+{
+	if (!screenshot && !sequenceActive) { return -1; }
+
+	// Look for a free slot, starting from the oldest capture
+	s4Byte slotNdx = -1;
+	for (u4Byte i = 0; i < AthruGPU::NUM_CAPTURE_SLOTS; i += 1)
+	{
+		const u4Byte ndx = (nextCaptureSlot + i) % AthruGPU::NUM_CAPTURE_SLOTS;
+		if (!captureSlots[ndx].busy.load(std::memory_order_acquire))
+		{
+			slotNdx = (s4Byte)ndx;
+			break;
+		}
+	}
+
+	// Every slot is busy; sequences wait on the oldest capture (helping out with encoding
+	// while they do), screenshots are dropped
+	if (slotNdx < 0)
+	{
+		if (!sequenceActive)
+		{
+			AthruCore::Utility::AccessLogger()->Log("dropped a screenshot, every capture slot is busy", "screenshot message");
+			return -1;
+		}
+		slotNdx = (s4Byte)nextCaptureSlot;
+		std::atomic<bool>& busy = captureSlots[slotNdx].busy;
+		AthruCore::Utility::AccessJobs()->WaitUntil([&busy]() { return !busy.load(std::memory_order_acquire); });
+	}
+
+	// Claim the slot + name its file
+	CaptureSlot& slot = captureSlots[slotNdx];
+	slot.busy.store(true, std::memory_order_relaxed);
+	slot.fileOffset = 0;
+	if (sequenceActive && sequenceFormat == AthruGPU::CAPTURE_FORMATS::Y4M)
+	{
+		slot.format = AthruGPU::CAPTURE_FORMATS::Y4M;
+		snprintf(slot.path, IOStuff::MAX_IO_PATH, "%s.y4m", sequenceStem);
+		slot.fileOffset = sequenceHeaderBytes + (sequenceFrame * (u8Byte)FrameDump::Y4MFrameBytes(GraphicsStuff::DISPLAY_WIDTH,
+																								   GraphicsStuff::DISPLAY_HEIGHT));
+		sequenceFrame += 1;
+	}
+	else if (sequenceActive)
+	{
+		slot.format = AthruGPU::CAPTURE_FORMATS::PNG;
+		snprintf(slot.path, IOStuff::MAX_IO_PATH, "%s%06u.png", sequenceStem, sequenceFrame);
+		sequenceFrame += 1;
+	}
+	else
+	{
+		slot.format = AthruGPU::CAPTURE_FORMATS::PNG;
+		snprintf(slot.path, IOStuff::MAX_IO_PATH, "screenshot.png");
+	}
+	nextCaptureSlot = (slotNdx + 1) % AthruGPU::NUM_CAPTURE_SLOTS;
+	return slotNdx;
+}
+
+s4Byte GPUMessenger::BeginHDRCapture()
+{
+	CaptureSlot& slot = captureSlots[HDR_CAPTURE_SLOT];
+	if (slot.busy.load(std::memory_order_acquire))
+	{
+		AthruCore::Utility::AccessLogger()->Log("dropped an HDR screenshot, the HDR capture slot is busy", "screenshot message");
+		return -1;
+	}
+
+	slot.busy.store(true, std::memory_order_relaxed);
+	slot.format = AthruGPU::CAPTURE_FORMATS::PFM;
+	slot.fileOffset = 0;
+	snprintf(slot.path, IOStuff::MAX_IO_PATH, "screenshot.pfm");
+	return (s4Byte)HDR_CAPTURE_SLOT;
+}
+
+void GPUMessenger::EndCapture(u4Byte slotNdx, u4Byte width, u4Byte height)
+{
+	CaptureSlot& slot = captureSlots[slotNdx];
+	assert(slot.busy.load(std::memory_order_relaxed));
+	const u4Byte bytesPerPixel = (slot.format == AthruGPU::CAPTURE_FORMATS::PFM) ? 16 : 4;
+	assert((width * height * bytesPerPixel) <= ((slotNdx == HDR_CAPTURE_SLOT) ? AthruGPU::HDR_CAPTURE_SLOT_MEM :
+																			   AthruGPU::CAPTURE_SLOT_MEM));
+
+	// Map the slot's region; encoders read straight out of readback memory, so captures
+	// never copy through intermediate storage
+	D3D12_RANGE range;
+	range.Begin = slot.offset;
+	range.End = slot.offset + (width * height * bytesPerPixel);
+	uByte* mapped = nullptr;
+	HRESULT hr = slot.readback->Map(0, &range, (void**)&mapped);
+	assert(SUCCEEDED(hr));
+	slot.pixels = mapped + slot.offset;
+	slot.width = width;
+	slot.height = height;
+
+	// Begin encoding the captured image; encoders run in the background, so they never land
+	// inside the frame loop's own waits, + report completion through [busy] instead of a
+	// job handle
+	CaptureSlot* slotPttr = &slot;
+	AthruCore::Utility::AccessJobs()->RunBackground([slotPttr]() { GPUMessenger::EncodeCapture(slotPttr); });
+}
+
+void GPUMessenger::BeginCaptureSequence(const char* fileStem, AthruGPU::CAPTURE_FORMATS format)
+{
+	assert(strlen(fileStem) < sizeof(sequenceStem));
+	assert(format != AthruGPU::CAPTURE_FORMATS::PFM); // HDR captures are single images
+	snprintf(sequenceStem, sizeof(sequenceStem), "%s", fileStem);
+	sequenceFrame = 0;
+	sequenceFormat = format;
+	sequenceHeaderBytes = 0;
+	if (format == AthruGPU::CAPTURE_FORMATS::Y4M)
+	{
+		// Replace any earlier video with a fresh stream header; frames are written in-place
+		// after it, so the header has to be the first write issued to the file
+		char header[FrameDump::MAX_Y4M_HEADER_BYTES];
+		char path[IOStuff::MAX_IO_PATH];
+		snprintf(path, IOStuff::MAX_IO_PATH, "%s.y4m", sequenceStem);
+		sequenceHeaderBytes = FrameDump::Y4MHeader(header, GraphicsStuff::DISPLAY_WIDTH, GraphicsStuff::DISPLAY_HEIGHT,
+												   AthruGPU::CAPTURE_VIDEO_FPS);
+		AthruCore::Utility::AccessIO()->Write(path, header, sequenceHeaderBytes, IO_WRITE_MODES::OVERWRITE, true);
+	}
+	sequenceActive = true;
+	AthruCore::Utility::AccessLogger()->Log("started a capture sequence", "screenshot message");
+}
+
+void GPUMessenger::EndCaptureSequence()
+{
+	sequenceActive = false;
+	AthruCore::Utility::AccessLogger()->Log(sequenceFrame, "captured frames in sequence");
+}
+
+bool GPUMessenger::CapturingSequence() const
+{
+	return sequenceActive;
 }
 
 void GPUMessenger::LoadTexture(const char* file, u4Byte width, u4Byte height, uByte** output)
 {
-	lodepng_decode32_file(output, &width, &height, file);
+	// Read the encoded image through the I/O service, then decode it with lodepng
+	std::error_code err;
+	const u8Byte fileSize = (u8Byte)std::filesystem::file_size(file, err);
+	if (err) { return; }
+
+	uByte* png = (uByte*)malloc(fileSize);
+	AsyncIO* io = AthruCore::Utility::AccessIO();
+	u8Byte numBytes = 0;
+	if (io->Wait(io->Read(file, png, fileSize), &numBytes) == IO_STATUS::DONE)
+	{
+		lodepng_decode32(output, &width, &height, png, numBytes);
+	}
+	free(png);
 }
 
 const Microsoft::WRL::ComPtr<ID3D12Resource>& GPUMessenger::AccessReadbackBuf()
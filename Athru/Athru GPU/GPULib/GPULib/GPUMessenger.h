@@ -2,10 +2,12 @@
 
 #include <d3d12.h>
 #include <functional>
-#include <thread>
+#include <atomic>
+#include "JobSystem.h"
 #include "SceneFigure.h"
 #include "AthruResrc.h"
 #include "ComputePass.h"
+#include "UploadRing.h"
 #include <wrl\client.h>
 
 class GPUMessenger
@@ -17,18 +19,34 @@ class GPUMessenger
 
 		// Upload per-system scene data to the GPU
         // Per-planet upload is unimplemented atm, but expected once I have planetary UVs ready
-		// All bulk uploads will probably occur here so I can supply a reasonable amount of data to
-		// the copy command-list
+		// System data streams through the upload ring like any other payload (see [Stream(...)]), so
+		// [system] should stay unchanged until the upload finishes
 		void SysToGPU(SceneFigure::Figure* system);
 
+		// Streamed uploads
+		// Queue [bytes] from [data] for copying into [dst] (starting at [dstOffset]); payloads are copied
+		// through a fence-tracked upload ring (see [UploadRing]) over as many frames as they need, so
+		// planets/critters/vegetation of any size can stream in without waiting for the GPU to go idle
+		// [data] should stay valid + unchanged until [Streamed(...)] reports the payload has arrived, and
+		// [dstState] is the state [dst] is kept in between copies
+		// Returns a ticket for [Streamed(...)]
+		u4Byte Stream(const void* data, u8Byte bytes, ID3D12Resource* dst, u8Byte dstOffset, D3D12_RESOURCE_STATES dstState);
+
+		// Whether the payload behind [ticket] has reached its destination
+		bool Streamed(u4Byte ticket);
+
+		// Copy the next slice of every queued payload into the upload ring + submit the copies to the
+		// graphics queue; call once per frame, before submitting any work that reads streamed data
+		// Slices are limited to [AthruGPU::UPLOAD_FRAME_BUDGET] bytes per frame, and payloads that don't
+		// fit in the ring's free space wait for later frames instead of stalling this one
+		void PumpUploads();
+
 		// Pass per-frame inputs along to the GPU
 		void InputsToGPU(const DirectX::XMFLOAT4& sysOri,
                          const Camera* camera);
 
 		// Expose interfaces to lodepng, the png encoding/decoding library used by Athru
-		// Saved textures are expected LDR/4-channel; copies into readback memory should have occurred before
-		// [SaveTexture(...)] is invoked (-> saves [GPUMessenger] having to maintain a separate command-list
-		// for every possible texture export)
+		// Captured frames are expected LDR/4-channel
 		// lodepng is distributed by Lode Vandevenne (thanks! :D) under the zlib license, which reads
 		// as follows:
 		//	Copyright(c) 2005 - 2018 Lode Vandevenne
@@ -51,8 +69,35 @@ class GPUMessenger
 		//
 		//	3. This notice may not be removed or altered from any source
 		//	distribution.
-		void SaveTexture(const char* file, u4Byte width, u4Byte height);
-		void LoadTexture(const char* file, u4Byte width, u4Byte height, uByte** output);
+		// Decoding doesn't touch any GPU state, so this is safe to call from any thread
+		static void LoadTexture(const char* file, u4Byte width, u4Byte height, uByte** output);
+
+		// Frame capture
+		// Captures cycle through [AthruGPU::NUM_CAPTURE_SLOTS] regions of readback memory, and each region
+		// stays claimed until its image has been encoded on the job system; that lets several captures
+		// encode at once without the frame loop waiting on them
+		// [BeginCapture(...)] decides whether the current frame should be captured (a screenshot was
+		// requested, or a capture sequence is running) and returns the readback slot to copy into (-1 for
+		// no capture); screenshots are dropped when every slot is busy, but sequences wait for a free slot
+		// so that no frames go missing
+		s4Byte BeginCapture(bool screenshot);
+
+		// Decide whether the current frame's HDR output should be saved (as a PFM); returns the readback
+		// slot to copy the HDR display texture into, or -1 if the HDR slot is still busy with an earlier
+		// capture (HDR captures are never queued, since each needs a full-size float image)
+		s4Byte BeginHDRCapture();
+
+		// Encode + save the image in the given slot (either kind); copies into readback memory should have finished
+		// before [EndCapture(...)] is invoked (-> saves [GPUMessenger] having to maintain a separate
+		// command-list for every possible texture export)
+		void EndCapture(u4Byte slot, u4Byte width, u4Byte height);
+
+		// Start/stop capturing every rendered frame; PNG sequences write numbered files ([fileStem]000000.png,
+		// [fileStem]000001.png, ...), Y4M sequences stream every frame into [fileStem].y4m
+		// Screenshots taken during a sequence land in the sequence
+		void BeginCaptureSequence(const char* fileStem, AthruGPU::CAPTURE_FORMATS format = AthruGPU::CAPTURE_FORMATS::PNG);
+		void EndCaptureSequence();
+		bool CapturingSequence() const;
 
 		// Access data copied into the read-back buffer at a given offset, in a given format
 		template<typename DataFmt>
@@ -102,7 +147,7 @@ class GPUMessenger
         AthruGPU::AthruResrc<SceneFigure::Figure,
                              AthruGPU::RResrc<AthruGPU::Buffer>> sysBuf;
 		// Length of the system buffer, in bytes
-		static constexpr u4Byte sysBytes = SceneStuff::ALIGNED_PARAMETRIC_FIGURES_PER_SYSTEM * sizeof(SceneFigure);
+		static constexpr u4Byte sysBytes = SceneStuff::ALIGNED_PARAMETRIC_FIGURES_PER_SYSTEM * sizeof(SceneFigure::Figure);
 
 		// CPU->GPU messaging buffer
         AthruGPU::AthruResrc<uByte,
@@ -114,16 +159,73 @@ class GPUMessenger
 		// + CPU-side mapping point
 		uByte* gpuReadable;
 
-		// Core messaging command-list + shared messaging allocator
-		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> msgCmds;
-		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> msgAlloc;
+		// Streamed upload state
+		struct UploadStream
+		{
+			const uByte* src;
+			u8Byte bytes;
+			u8Byte sent; // Bytes copied into the upload ring so far
+			ID3D12Resource* dst;
+			u8Byte dstOffset;
+			D3D12_RESOURCE_STATES dstState;
+			u8Byte fence; // Fence value signalled after the stream's latest copy
+			u4Byte ticket;
+			bool active;
+		};
+		UploadStream streams[AthruGPU::MAX_UPLOAD_STREAMS];
+		u4Byte streamGeneration; // Tickets are ([streamGeneration] * [MAX_UPLOAD_STREAMS]) + stream index, so recycled streams
+								 // never match stale tickets
+
+		// Staging memory for streamed uploads + the ring handing it out
+		AthruGPU::AthruResrc<uByte,
+							 AthruGPU::UploResrc<AthruGPU::RResrc<AthruGPU::Buffer>>> uploRingBuf;
+		uByte* uploRingMem;
+		UploadRing uploRing;
+
+		// Upload fence; signalled on the graphics queue after each batch of copies, with values increasing
+		// by one per batch
+		Microsoft::WRL::ComPtr<ID3D12Fence> uploFence;
+		u8Byte uploFenceVal;
+		HANDLE uploEvt;
+
+		// Upload command-list + one allocator per frame in flight (allocators can only be reset once the
+		// GPU has finished with their commands)
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> uploCmds;
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> uploAllocs[AthruGPU::NUM_SWAPCHAIN_BUFFERS];
+		u8Byte uploAllocFences[AthruGPU::NUM_SWAPCHAIN_BUFFERS];
+
+		// Recycle upload-ring space + streams the GPU has finished with
+		void RetireUploads();
+
+		// Block until the GPU passes [fence] on the upload timeline
+		void WaitForUpload(u8Byte fence);
+
+		// Frame capture state; slots are claimed on the main thread + released by their encoder jobs
+		struct CaptureSlot
+		{
+			ID3D12Resource* readback;
+			u4Byte offset; // Offset of this slot's region within the readback buffer
+			const uByte* pixels; // Mapped region; only valid while the slot is busy
+			u4Byte width;
+			u4Byte height;
+			AthruGPU::CAPTURE_FORMATS format;
+			char path[IOStuff::MAX_IO_PATH];
+			u8Byte fileOffset; // Where in [path] the encoded image should be written (only used by video frames)
+			std::atomic<bool> busy; // Set on the main thread, cleared by the slot's encoder once it's done
+		};
+		CaptureSlot captureSlots[AthruGPU::NUM_CAPTURE_SLOTS + 1]; // LDR slots, then the HDR slot
+		u4Byte nextCaptureSlot;
+		static constexpr u4Byte HDR_CAPTURE_SLOT = AthruGPU::NUM_CAPTURE_SLOTS;
 
-		// Specialty thread for file output (output wrapper declared as a free-function within
-		// [GPUMessenger.cpp])
-		std::thread fileWriter;
+		// Encode a captured image + pass it along to the I/O service, then release its slot
+		// Runs as a background job, so keep it independent of [GPUMessenger] state (apart from the
+		// slot it's handed)
+		static void EncodeCapture(CaptureSlot* slot);
 
-		// Intermediate CPU-side storage for file output
-		// Defined as an array instead of a pointer so that storage can be contiguous with class data
-		// within Athru's memory allocator
-		uByte tmpFileStorage[AthruGPU::EXPECTED_SHARED_GPU_RDBK_MEM];
+		// Capture sequence state
+		bool sequenceActive;
+		u4Byte sequenceFrame;
+		char sequenceStem[IOStuff::MAX_IO_PATH - 16]; // Leave room for frame numbers + extensions
+		AthruGPU::CAPTURE_FORMATS sequenceFormat;
+		u4Byte sequenceHeaderBytes; // Bytes ahead of the first frame in video sequences
 };
\ No newline at end of file
@@ -29,16 +29,27 @@ namespace AthruGPU
 				internalInit = false;
 			}
 
+			InitDevice();
+			InitRenderer();
+		}
+
+		// [Init()] in two steps, for callers starting Athru up in stages (see [HiLevelServiceCentre::StartUp()]);
+		// both steps have to run on the thread that created the window
+		static void InitDevice()
+		{
 			// Initialise the Direct3D handler class & the GPU messenger
 			d3DPttr = DEBUG_NEW Direct3D(AthruCore::Utility::AccessApp()->GetHWND());
 			GPUMemory& gpuMem = d3DPttr->GetGPUMem();
             const Microsoft::WRL::ComPtr<ID3D12Device>& device = d3DPttr->GetDevice();
 			gpuMessengerPttr = new GPUMessenger(device, gpuMem);
+		}
 
+		static void InitRenderer()
+		{
 			// Initialise the rendering system
 			HWND winHandle = AthruCore::Utility::AccessApp()->GetHWND();
-			rendererPttr = new Renderer(winHandle, gpuMem,
-										device, d3DPttr->GetGraphicsQueue());
+			rendererPttr = new Renderer(winHandle, d3DPttr->GetGPUMem(),
+										d3DPttr->GetDevice(), d3DPttr->GetGraphicsQueue());
 		}
 
 		static void DeInit()
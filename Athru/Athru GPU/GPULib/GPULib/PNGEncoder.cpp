@@ -0,0 +1,966 @@
+#include "UtilityServiceCentre.h"
+#include "PNGEncoder.h"
+#include "BenchUtils.h"
+#include "lodepng.h"
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+// Deflate tables (RFC 1951)
+static constexpr u2Byte LEN_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+										 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static constexpr uByte LEN_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+										 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static constexpr u2Byte DIST_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+										  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+										  8193, 12289, 16385, 24577 };
+static constexpr uByte DIST_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+										  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static constexpr uByte CODELEN_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// Deflate limits
+static constexpr u4Byte NUM_LIT_SYMS = 286;
+static constexpr u4Byte NUM_DIST_SYMS = 30;
+static constexpr u4Byte NUM_CODELEN_SYMS = 19;
+static constexpr u4Byte MAX_CODE_BITS = 15;
+static constexpr u4Byte MAX_CODELEN_BITS = 7;
+static constexpr u4Byte MIN_MATCH = 4; // Deflate allows three-byte matches, but four-byte hashes are much cheaper
+static constexpr u4Byte MAX_MATCH = 258;
+static constexpr u4Byte WINDOW_SIZE = 32768;
+static constexpr u4Byte WINDOW_MASK = WINDOW_SIZE - 1;
+static constexpr u4Byte HASH_BITS = 15;
+static constexpr u4Byte BLOCK_TOKENS = 65536; // LZ77 tokens per deflate block
+static constexpr u4Byte MAX_STORED_BYTES = 65535;
+
+// Lookup tables shared by every strip; built once on first use
+struct EncoderTables
+{
+	u4Byte crc[4][256]; // Slicing-by-four CRC32 tables
+	uByte lenCode[MAX_MATCH + 1]; // Match length -> length code (minus 257)
+	uByte distCode[512]; // Match distance -> distance code (see [DistCode(...)])
+	u2Byte fixedLitCodes[288];
+	uByte fixedLitLens[288];
+	u2Byte fixedDistCodes[NUM_DIST_SYMS];
+	uByte fixedDistLens[NUM_DIST_SYMS];
+};
+
+// Reverse the lowest [numBits] bits of [code]; deflate packs Huffman codes
+// most-significant-bit first into a least-significant-bit-first stream
+static u2Byte ReverseBits(u4Byte code, u4Byte numBits)
+{
+	u4Byte reversed = 0;
+	for (u4Byte i = 0; i < numBits; i += 1)
+	{
+		reversed = (reversed << 1) | ((code >> i) & 1);
+	}
+	return (u2Byte)reversed;
+}
+
+// Assign canonical Huffman codes for the given code lengths
+static void BuildCodes(const uByte* lens, u4Byte numSyms, u2Byte* codes)
+{
+	u4Byte lenCounts[MAX_CODE_BITS + 1] = {};
+	for (u4Byte i = 0; i < numSyms; i += 1)
+	{
+		lenCounts[lens[i]] += 1;
+	}
+	lenCounts[0] = 0;
+
+	u4Byte nextCode[MAX_CODE_BITS + 1] = {};
+	u4Byte code = 0;
+	for (u4Byte bits = 1; bits <= MAX_CODE_BITS; bits += 1)
+	{
+		code = (code + lenCounts[bits - 1]) << 1;
+		nextCode[bits] = code;
+	}
+
+	for (u4Byte i = 0; i < numSyms; i += 1)
+	{
+		codes[i] = (lens[i] > 0) ? ReverseBits(nextCode[lens[i]]++, lens[i]) : 0;
+	}
+}
+
+static EncoderTables BuildTables()
+{
+	EncoderTables tables;
+	for (u4Byte i = 0; i < 256; i += 1)
+	{
+		u4Byte crc = i;
+		for (u4Byte j = 0; j < 8; j += 1)
+		{
+			crc = (crc & 1) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1);
+		}
+		tables.crc[0][i] = crc;
+	}
+	for (u4Byte i = 0; i < 256; i += 1)
+	{
+		for (u4Byte j = 1; j < 4; j += 1)
+		{
+			const u4Byte prev = tables.crc[j - 1][i];
+			tables.crc[j][i] = (prev >> 8) ^ tables.crc[0][prev & 0xFF];
+		}
+	}
+
+	for (u4Byte code = 0; code < 29; code += 1)
+	{
+		const u4Byte end = (code < 28) ? LEN_BASE[code + 1] : (MAX_MATCH + 1);
+		for (u4Byte len = LEN_BASE[code]; len < end; len += 1)
+		{
+			tables.lenCode[len] = (uByte)code;
+		}
+	}
+	tables.lenCode[0] = tables.lenCode[1] = tables.lenCode[2] = 0;
+
+	// Distances up to 256 index the table directly; longer distances are looked up by
+	// their upper bits (every code past 16 spans a multiple of 128 distances)
+	for (u4Byte code = 0; code < NUM_DIST_SYMS; code += 1)
+	{
+		const u4Byte end = DIST_BASE[code] + (1u << DIST_EXTRA[code]);
+		for (u4Byte dist = DIST_BASE[code]; dist < end; dist += 1)
+		{
+			if (dist <= 256) { tables.distCode[dist - 1] = (uByte)code; }
+			else { tables.distCode[256 + ((dist - 1) >> 7)] = (uByte)code; }
+		}
+	}
+
+	for (u4Byte i = 0; i < 288; i += 1)
+	{
+		tables.fixedLitLens[i] = (i < 144) ? 8 : ((i < 256) ? 9 : ((i < 280) ? 7 : 8));
+	}
+	for (u4Byte i = 0; i < NUM_DIST_SYMS; i += 1)
+	{
+		tables.fixedDistLens[i] = 5;
+	}
+	BuildCodes(tables.fixedLitLens, 288, tables.fixedLitCodes);
+	BuildCodes(tables.fixedDistLens, NUM_DIST_SYMS, tables.fixedDistCodes);
+	return tables;
+}
+
+static const EncoderTables& Tables()
+{
+	static const EncoderTables tables = BuildTables();
+	return tables;
+}
+
+static u4Byte DistCode(const EncoderTables& tables, u4Byte dist)
+{
+	return (dist <= 256) ? tables.distCode[dist - 1] : tables.distCode[256 + ((dist - 1) >> 7)];
+}
+
+static u4Byte CRC32(const EncoderTables& tables, u4Byte crc, const uByte* data, size_t numBytes)
+{
+	crc = ~crc;
+	while (numBytes >= 4)
+	{
+		crc ^= (u4Byte)data[0] | ((u4Byte)data[1] << 8) | ((u4Byte)data[2] << 16) | ((u4Byte)data[3] << 24);
+		crc = tables.crc[3][crc & 0xFF] ^
+			  tables.crc[2][(crc >> 8) & 0xFF] ^
+			  tables.crc[1][(crc >> 16) & 0xFF] ^
+			  tables.crc[0][crc >> 24];
+		data += 4;
+		numBytes -= 4;
+	}
+	while (numBytes > 0)
+	{
+		crc = tables.crc[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+		data += 1;
+		numBytes -= 1;
+	}
+	return ~crc;
+}
+
+// Adler-32 (zlib's checksum); sums are reduced every 5552 bytes, the longest run that can't
+// overflow 32 bits
+static constexpr u4Byte ADLER_MOD = 65521;
+static u4Byte Adler32(u4Byte adler, const uByte* data, size_t numBytes)
+{
+	u4Byte a = adler & 0xFFFF;
+	u4Byte b = adler >> 16;
+	while (numBytes > 0)
+	{
+		const size_t runLen = std::min(numBytes, (size_t)5552);
+		for (size_t i = 0; i < runLen; i += 1)
+		{
+			a += data[i];
+			b += a;
+		}
+		a %= ADLER_MOD;
+		b %= ADLER_MOD;
+		data += runLen;
+		numBytes -= runLen;
+	}
+	return (b << 16) | a;
+}
+
+// Checksum of two concatenated runs, given each run's checksum + the length of the second run
+static u4Byte CombineAdler32(u4Byte adlerA, u4Byte adlerB, size_t lenB)
+{
+	const u4Byte rem = (u4Byte)(lenB % ADLER_MOD);
+	u4Byte a = adlerA & 0xFFFF;
+	u4Byte b = (u4Byte)(((u8Byte)rem * a) % ADLER_MOD);
+	a += (adlerB & 0xFFFF) + ADLER_MOD - 1;
+	b += (adlerA >> 16) + (adlerB >> 16) + ADLER_MOD - rem;
+	if (a >= ADLER_MOD) { a -= ADLER_MOD; }
+	if (a >= ADLER_MOD) { a -= ADLER_MOD; }
+	if (b >= (ADLER_MOD << 1)) { b -= (ADLER_MOD << 1); }
+	if (b >= ADLER_MOD) { b -= ADLER_MOD; }
+	return (b << 16) | a;
+}
+
+static void StoreBE32(uByte* dst, u4Byte val)
+{
+	dst[0] = (uByte)(val >> 24);
+	dst[1] = (uByte)(val >> 16);
+	dst[2] = (uByte)(val >> 8);
+	dst[3] = (uByte)val;
+}
+
+// Least-significant-bit-first writer for deflate streams; flushes four bytes at a time, so
+// output buffers need eight bytes of slack past the end of the stream
+struct BitWriter
+{
+	uByte* out;
+	size_t pos;
+	u8Byte bits;
+	u4Byte numBits;
+
+	void Put(u4Byte val, u4Byte count)
+	{
+		bits |= (u8Byte)val << numBits;
+		numBits += count;
+		if (numBits >= 32)
+		{
+			const u4Byte word = (u4Byte)bits;
+			memcpy(out + pos, &word, 4); // Little-endian targets only (x86/x64)
+			pos += 4;
+			bits >>= 32;
+			numBits -= 32;
+		}
+	}
+
+	// Pad out to the next byte boundary + flush everything written so far
+	void Align()
+	{
+		while (numBits > 0)
+		{
+			out[pos] = (uByte)bits;
+			pos += 1;
+			bits >>= 8;
+			numBits = (numBits > 8) ? (numBits - 8) : 0;
+		}
+		bits = 0;
+	}
+};
+
+// Build Huffman code lengths for [numSyms] symbols, limited to [maxBits] bits
+// Lengths are built from an ordinary Huffman tree, then over-long codes are folded back
+// under the limit + re-assigned by frequency
+static void BuildLengths(const u4Byte* freqs, u4Byte numSyms, u4Byte maxBits, uByte* lens)
+{
+	u2Byte syms[NUM_LIT_SYMS];
+	u4Byte numUsed = 0;
+	for (u4Byte i = 0; i < numSyms; i += 1)
+	{
+		lens[i] = 0;
+		if (freqs[i] > 0)
+		{
+			syms[numUsed] = (u2Byte)i;
+			numUsed += 1;
+		}
+	}
+
+	// Decoders reject incomplete codes, so always describe at least two symbols
+	if (numUsed == 0) { lens[0] = 1; lens[1] = 1; return; }
+	if (numUsed == 1) { lens[syms[0]] = 1; lens[(syms[0] == 0) ? 1 : 0] = 1; return; }
+
+	// Sort by frequency (ties by symbol, for determinism)
+	std::sort(syms, syms + numUsed, [freqs](u2Byte a, u2Byte b) { return (freqs[a] != freqs[b]) ? (freqs[a] < freqs[b]) : (a < b); });
+
+	// Two-queue Huffman construction; leaves are already sorted, and internal nodes are created
+	// in non-decreasing weight order, so the lightest two nodes are always at the queue fronts
+	u8Byte weights[NUM_LIT_SYMS * 2];
+	u2Byte parents[NUM_LIT_SYMS * 2];
+	for (u4Byte i = 0; i < numUsed; i += 1)
+	{
+		weights[i] = freqs[syms[i]];
+	}
+	u4Byte nextLeaf = 0;
+	u4Byte nextNode = numUsed;
+	const u4Byte numNodes = (numUsed * 2) - 1;
+	for (u4Byte node = numUsed; node < numNodes; node += 1)
+	{
+		u4Byte children[2];
+		for (u4Byte c = 0; c < 2; c += 1)
+		{
+			const bool takeLeaf = (nextLeaf < numUsed) && ((nextNode >= node) || (weights[nextLeaf] <= weights[nextNode]));
+			children[c] = takeLeaf ? nextLeaf++ : nextNode++;
+		}
+		weights[node] = weights[children[0]] + weights[children[1]];
+		parents[children[0]] = (u2Byte)node;
+		parents[children[1]] = (u2Byte)node;
+	}
+
+	// Parents always come after their children, so depths resolve in one backwards pass
+	uByte depths[NUM_LIT_SYMS * 2];
+	depths[numNodes - 1] = 0;
+	for (s4Byte node = (s4Byte)numNodes - 2; node >= 0; node -= 1)
+	{
+		depths[node] = depths[parents[node]] + 1;
+	}
+
+	// Count lengths, clamping over-long codes
+	u4Byte lenCounts[MAX_CODE_BITS + 1] = {};
+	for (u4Byte i = 0; i < numUsed; i += 1)
+	{
+		lenCounts[std::min((u4Byte)depths[i], maxBits)] += 1;
+	}
+
+	// Clamping over-subscribes the code (Kraft sum above one, in units of 2^-[maxBits]); lengthen
+	// the longest codes under the limit until it fits, then shorten codes again if that
+	// overshoots (decoders reject incomplete codes)
+	const u4Byte capacity = 1u << maxBits;
+	u4Byte kraft = 0;
+	for (u4Byte bits = 1; bits <= maxBits; bits += 1)
+	{
+		kraft += lenCounts[bits] << (maxBits - bits);
+	}
+	while (kraft > capacity)
+	{
+		u4Byte bits = maxBits - 1;
+		while (lenCounts[bits] == 0) { bits -= 1; }
+		lenCounts[bits] -= 1;
+		lenCounts[bits + 1] += 1;
+		kraft -= 1u << (maxBits - bits - 1);
+	}
+	while (kraft < capacity)
+	{
+		u4Byte bits = maxBits;
+		while (lenCounts[bits] == 0 || (kraft + (1u << (maxBits - bits))) > capacity) { bits -= 1; }
+		lenCounts[bits] -= 1;
+		lenCounts[bits - 1] += 1;
+		kraft += 1u << (maxBits - bits);
+	}
+
+	// Hand the longest codes to the least frequent symbols
+	u4Byte leaf = 0;
+	for (u4Byte bits = maxBits; bits > 0; bits -= 1)
+	{
+		for (u4Byte i = 0; i < lenCounts[bits]; i += 1)
+		{
+			lens[syms[leaf]] = (uByte)bits;
+			leaf += 1;
+		}
+	}
+}
+
+// LZ77 output; [dist] is zero for literals
+struct Token
+{
+	u2Byte litLen;
+	u2Byte dist;
+};
+
+// Per-strip compressor state
+struct StripDeflater
+{
+	const EncoderTables* tables;
+	BitWriter writer;
+	Token* tokens;
+	s4Byte* head; // Most recent position for each hash
+	s4Byte* prev; // Previous position with the same hash, for each position in the window
+	u4Byte chainDepth; // Candidates to check per match search; zero disables matching
+	bool storedOnly;
+
+	// Emit [numTokens] tokens as a single block, using whichever of stored/fixed/dynamic
+	// Huffman coding is smallest; [raw]/[rawLen] are the bytes the tokens describe
+	void FlushBlock(u4Byte numTokens, const uByte* raw, size_t rawLen, bool last)
+	{
+		const size_t numStoredChunks = std::max((size_t)1, (rawLen + MAX_STORED_BYTES - 1) / MAX_STORED_BYTES);
+		const u8Byte storedBits = (rawLen * 8) + (numStoredChunks * 42); // Header + worst-case padding + LEN/NLEN per chunk
+		if (storedOnly)
+		{
+			WriteStored(raw, rawLen, last);
+			return;
+		}
+
+		// Gather symbol frequencies
+		u4Byte litFreqs[NUM_LIT_SYMS] = {};
+		u4Byte distFreqs[NUM_DIST_SYMS] = {};
+		u8Byte extraBits = 0;
+		for (u4Byte i = 0; i < numTokens; i += 1)
+		{
+			const Token& token = tokens[i];
+			if (token.dist == 0)
+			{
+				litFreqs[token.litLen] += 1;
+			}
+			else
+			{
+				const u4Byte lenCode = tables->lenCode[token.litLen];
+				const u4Byte distCode = DistCode(*tables, token.dist);
+				litFreqs[257 + lenCode] += 1;
+				distFreqs[distCode] += 1;
+				extraBits += LEN_EXTRA[lenCode] + DIST_EXTRA[distCode];
+			}
+		}
+		litFreqs[256] = 1; // End-of-block
+
+		// Dynamic Huffman codes
+		uByte litLens[NUM_LIT_SYMS];
+		uByte distLens[NUM_DIST_SYMS];
+		BuildLengths(litFreqs, NUM_LIT_SYMS, MAX_CODE_BITS, litLens);
+		BuildLengths(distFreqs, NUM_DIST_SYMS, MAX_CODE_BITS, distLens);
+
+		u4Byte numLitLens = NUM_LIT_SYMS;
+		while (litLens[numLitLens - 1] == 0) { numLitLens -= 1; }
+		u4Byte numDistLens = NUM_DIST_SYMS;
+		while (distLens[numDistLens - 1] == 0) { numDistLens -= 1; }
+
+		// Run-length encode code lengths (symbol 16 repeats the previous length, 17/18 repeat zeroes)
+		uByte allLens[NUM_LIT_SYMS + NUM_DIST_SYMS];
+		memcpy(allLens, litLens, numLitLens);
+		memcpy(allLens + numLitLens, distLens, numDistLens);
+		const u4Byte numAllLens = numLitLens + numDistLens;
+		uByte rleSyms[NUM_LIT_SYMS + NUM_DIST_SYMS];
+		uByte rleExtras[NUM_LIT_SYMS + NUM_DIST_SYMS];
+		u4Byte numRLE = 0;
+		u4Byte codeLenFreqs[NUM_CODELEN_SYMS] = {};
+		for (u4Byte i = 0; i < numAllLens;)
+		{
+			const uByte len = allLens[i];
+			u4Byte runLen = 1;
+			while ((i + runLen) < numAllLens && allLens[i + runLen] == len) { runLen += 1; }
+			i += runLen;
+			if (len == 0)
+			{
+				while (runLen >= 11)
+				{
+					const u4Byte n = std::min(runLen, 138u);
+					rleSyms[numRLE] = 18; rleExtras[numRLE] = (uByte)(n - 11); numRLE += 1;
+					runLen -= n;
+				}
+				if (runLen >= 3)
+				{
+					rleSyms[numRLE] = 17; rleExtras[numRLE] = (uByte)(runLen - 3); numRLE += 1;
+					runLen = 0;
+				}
+			}
+			else
+			{
+				rleSyms[numRLE] = len; rleExtras[numRLE] = 0; numRLE += 1;
+				runLen -= 1;
+				while (runLen >= 3)
+				{
+					const u4Byte n = std::min(runLen, 6u);
+					rleSyms[numRLE] = 16; rleExtras[numRLE] = (uByte)(n - 3); numRLE += 1;
+					runLen -= n;
+				}
+			}
+			while (runLen > 0)
+			{
+				rleSyms[numRLE] = len; rleExtras[numRLE] = 0; numRLE += 1;
+				runLen -= 1;
+			}
+		}
+		for (u4Byte i = 0; i < numRLE; i += 1)
+		{
+			codeLenFreqs[rleSyms[i]] += 1;
+		}
+
+		uByte codeLenLens[NUM_CODELEN_SYMS];
+		BuildLengths(codeLenFreqs, NUM_CODELEN_SYMS, MAX_CODELEN_BITS, codeLenLens);
+		u4Byte numCodeLenLens = NUM_CODELEN_SYMS;
+		while (numCodeLenLens > 4 && codeLenLens[CODELEN_ORDER[numCodeLenLens - 1]] == 0) { numCodeLenLens -= 1; }
+
+		// Compare block sizes
+		u8Byte dynamicBits = 3 + 5 + 5 + 4 + (3 * numCodeLenLens) + extraBits;
+		u8Byte fixedBits = 3 + extraBits;
+		for (u4Byte i = 0; i < numRLE; i += 1)
+		{
+			const uByte sym = rleSyms[i];
+			dynamicBits += codeLenLens[sym] + ((sym == 16) ? 2 : ((sym == 17) ? 3 : ((sym == 18) ? 7 : 0)));
+		}
+		for (u4Byte i = 0; i < NUM_LIT_SYMS; i += 1)
+		{
+			dynamicBits += (u8Byte)litFreqs[i] * litLens[i];
+			fixedBits += (u8Byte)litFreqs[i] * tables->fixedLitLens[i];
+		}
+		for (u4Byte i = 0; i < NUM_DIST_SYMS; i += 1)
+		{
+			dynamicBits += (u8Byte)distFreqs[i] * distLens[i];
+			fixedBits += (u8Byte)distFreqs[i] * tables->fixedDistLens[i];
+		}
+
+		if (storedBits <= dynamicBits && storedBits <= fixedBits)
+		{
+			WriteStored(raw, rawLen, last);
+		}
+		else if (fixedBits <= dynamicBits)
+		{
+			writer.Put(last ? 1 : 0, 1);
+			writer.Put(1, 2);
+			WriteTokens(numTokens, tables->fixedLitCodes, tables->fixedLitLens, tables->fixedDistCodes, tables->fixedDistLens);
+		}
+		else
+		{
+			writer.Put(last ? 1 : 0, 1);
+			writer.Put(2, 2);
+			writer.Put(numLitLens - 257, 5);
+			writer.Put(numDistLens - 1, 5);
+			writer.Put(numCodeLenLens - 4, 4);
+			for (u4Byte i = 0; i < numCodeLenLens; i += 1)
+			{
+				writer.Put(codeLenLens[CODELEN_ORDER[i]], 3);
+			}
+
+			u2Byte codeLenCodes[NUM_CODELEN_SYMS];
+			BuildCodes(codeLenLens, NUM_CODELEN_SYMS, codeLenCodes);
+			for (u4Byte i = 0; i < numRLE; i += 1)
+			{
+				const uByte sym = rleSyms[i];
+				writer.Put(codeLenCodes[sym], codeLenLens[sym]);
+				if (sym == 16) { writer.Put(rleExtras[i], 2); }
+				else if (sym == 17) { writer.Put(rleExtras[i], 3); }
+				else if (sym == 18) { writer.Put(rleExtras[i], 7); }
+			}
+
+			u2Byte litCodes[NUM_LIT_SYMS];
+			u2Byte distCodes[NUM_DIST_SYMS];
+			BuildCodes(litLens, NUM_LIT_SYMS, litCodes);
+			BuildCodes(distLens, NUM_DIST_SYMS, distCodes);
+			WriteTokens(numTokens, litCodes, litLens, distCodes, distLens);
+		}
+	}
+
+	void WriteTokens(u4Byte numTokens, const u2Byte* litCodes, const uByte* litLens, const u2Byte* distCodes, const uByte* distLens)
+	{
+		for (u4Byte i = 0; i < numTokens; i += 1)
+		{
+			const Token& token = tokens[i];
+			if (token.dist == 0)
+			{
+				writer.Put(litCodes[token.litLen], litLens[token.litLen]);
+			}
+			else
+			{
+				const u4Byte lenCode = tables->lenCode[token.litLen];
+				const u4Byte distCode = DistCode(*tables, token.dist);
+				writer.Put(litCodes[257 + lenCode], litLens[257 + lenCode]);
+				writer.Put(token.litLen - LEN_BASE[lenCode], LEN_EXTRA[lenCode]);
+				writer.Put(distCodes[distCode], distLens[distCode]);
+				writer.Put(token.dist - DIST_BASE[distCode], DIST_EXTRA[distCode]);
+			}
+		}
+		writer.Put(litCodes[256], litLens[256]);
+	}
+
+	void WriteStored(const uByte* raw, size_t rawLen, bool last)
+	{
+		do
+		{
+			const u4Byte chunkLen = (u4Byte)std::min(rawLen, (size_t)MAX_STORED_BYTES);
+			rawLen -= chunkLen;
+			writer.Put((last && rawLen == 0) ? 1 : 0, 1);
+			writer.Put(0, 2);
+			writer.Align();
+			writer.out[writer.pos + 0] = (uByte)chunkLen;
+			writer.out[writer.pos + 1] = (uByte)(chunkLen >> 8);
+			writer.out[writer.pos + 2] = (uByte)~chunkLen;
+			writer.out[writer.pos + 3] = (uByte)(~chunkLen >> 8);
+			memcpy(writer.out + writer.pos + 4, raw, chunkLen);
+			writer.pos += 4 + chunkLen;
+			raw += chunkLen;
+		} while (rawLen > 0);
+	}
+
+	// Compress [data] as a sequence of blocks; the final block is only marked final if
+	// [last] is set, otherwise the stream is closed with an empty stored block so the
+	// next strip can start on a byte boundary
+	void Deflate(const uByte* data, size_t numBytes, bool last)
+	{
+		for (u4Byte i = 0; i < (1u << HASH_BITS); i += 1)
+		{
+			head[i] = -1;
+		}
+
+		u4Byte numTokens = 0;
+		size_t blockStart = 0;
+		size_t pos = 0;
+		while (pos < numBytes)
+		{
+			u4Byte bestLen = 0;
+			u4Byte bestDist = 0;
+			if (chainDepth > 0 && (pos + MIN_MATCH) <= numBytes)
+			{
+				const u4Byte maxLen = (u4Byte)std::min((size_t)MAX_MATCH, numBytes - pos);
+				s4Byte cand = head[Hash(data + pos)];
+				Insert(data, pos);
+				for (u4Byte depth = 0; depth < chainDepth && cand >= 0 && (pos - cand) <= WINDOW_SIZE; depth += 1)
+				{
+					if (data[cand + bestLen] == data[pos + bestLen])
+					{
+						const u4Byte len = MatchLength(data + cand, data + pos, maxLen);
+						if (len > bestLen)
+						{
+							bestLen = len;
+							bestDist = (u4Byte)(pos - cand);
+							if (len == maxLen) { break; }
+						}
+					}
+
+					// Stale window entries can point forwards; stop if they do
+					const s4Byte next = prev[cand & WINDOW_MASK];
+					if (next >= cand) { break; }
+					cand = next;
+				}
+			}
+
+			if (bestLen >= MIN_MATCH)
+			{
+				tokens[numTokens].litLen = (u2Byte)bestLen;
+				tokens[numTokens].dist = (u2Byte)bestDist;
+				for (u4Byte i = 1; i < bestLen && (pos + i + MIN_MATCH) <= numBytes; i += 1)
+				{
+					Insert(data, pos + i);
+				}
+				pos += bestLen;
+			}
+			else
+			{
+				tokens[numTokens].litLen = data[pos];
+				tokens[numTokens].dist = 0;
+				pos += 1;
+			}
+			numTokens += 1;
+
+			if (numTokens == BLOCK_TOKENS)
+			{
+				FlushBlock(numTokens, data + blockStart, pos - blockStart, last && (pos == numBytes));
+				numTokens = 0;
+				blockStart = pos;
+			}
+		}
+
+		// Flush remaining tokens (final streams always need at least one block, even when empty)
+		if (numTokens > 0 || (last && numBytes == 0))
+		{
+			FlushBlock(numTokens, data + blockStart, numBytes - blockStart, last);
+		}
+
+		if (!last)
+		{
+			writer.Put(0, 1);
+			writer.Put(0, 2);
+			writer.Align();
+			writer.out[writer.pos + 0] = 0x00;
+			writer.out[writer.pos + 1] = 0x00;
+			writer.out[writer.pos + 2] = 0xFF;
+			writer.out[writer.pos + 3] = 0xFF;
+			writer.pos += 4;
+		}
+		writer.Align();
+	}
+
+	static u4Byte Hash(const uByte* data)
+	{
+		u4Byte word;
+		memcpy(&word, data, 4);
+		return (word * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	void Insert(const uByte* data, size_t pos)
+	{
+		const u4Byte hash = Hash(data + pos);
+		prev[pos & WINDOW_MASK] = head[hash];
+		head[hash] = (s4Byte)pos;
+	}
+
+	static u4Byte MatchLength(const uByte* a, const uByte* b, u4Byte maxLen)
+	{
+		u4Byte len = 0;
+		while ((len + 8) <= maxLen)
+		{
+			u8Byte wordA;
+			u8Byte wordB;
+			memcpy(&wordA, a + len, 8);
+			memcpy(&wordB, b + len, 8);
+			const u8Byte diff = wordA ^ wordB;
+			if (diff != 0)
+			{
+				#ifdef _MSC_VER
+					unsigned long bit;
+					_BitScanForward64(&bit, diff);
+					return len + (bit >> 3);
+				#else
+					return len + (__builtin_ctzll(diff) >> 3);
+				#endif
+			}
+			len += 8;
+		}
+		while (len < maxLen && a[len] == b[len]) { len += 1; }
+		return len;
+	}
+};
+
+// PNG filters; captures only use [None] (filter zero, for stored images) + [Up] (filter two),
+// since per-row adaptive filtering costs five trial passes per row + rarely beats [Up] on
+// rendered frames (smooth vertical gradients, with noise that defeats [Sub]/[Paeth] prediction)
+static void FilterRow(uByte filter, const uByte* row, const uByte* prevRow, u4Byte rowBytes, uByte* out)
+{
+	out[0] = filter;
+	out += 1;
+	if (filter == 0)
+	{
+		memcpy(out, row, rowBytes);
+	}
+	else
+	{
+		for (u4Byte i = 0; i < rowBytes; i += 1)
+		{
+			out[i] = (uByte)(row[i] - prevRow[i]);
+		}
+	}
+}
+
+// Encoded IDAT chunk for one strip
+struct StripOutput
+{
+	uByte* chunk;
+	size_t chunkBytes;
+	u4Byte adler; // Checksum of the strip's filtered bytes
+	size_t filteredBytes;
+};
+
+uByte* PNGEncoder::Encode(const uByte* rgba, u4Byte width, u4Byte height, AthruGPU::PNG_SPEEDS speed,
+						  size_t* pngSize)
+{
+	*pngSize = 0;
+	if (width == 0 || height == 0) { return nullptr; }
+	const EncoderTables& tables = Tables();
+	const u4Byte rowBytes = width * 4;
+	const u4Byte numStrips = (height + AthruGPU::PNG_STRIP_ROWS - 1) / AthruGPU::PNG_STRIP_ROWS;
+	StripOutput* strips = (StripOutput*)malloc(sizeof(StripOutput) * numStrips);
+	if (strips == nullptr) { return nullptr; }
+
+	u4Byte chainDepth = 0;
+	switch (speed)
+	{
+		case AthruGPU::PNG_SPEEDS::STORED: chainDepth = 0; break;
+		case AthruGPU::PNG_SPEEDS::FASTEST: chainDepth = 1; break;
+		case AthruGPU::PNG_SPEEDS::FAST: chainDepth = 8; break;
+		case AthruGPU::PNG_SPEEDS::SMALLEST: chainDepth = 128; break;
+	}
+
+	// Filter + deflate strips in parallel
+	AthruCore::Utility::AccessJobs()->ParallelFor(0, numStrips, 1, [&](u4Byte begin, u4Byte end)
+	{
+		for (u4Byte s = begin; s < end; s += 1)
+		{
+			// Strips that can't get scratch memory are left empty, which fails the
+			// whole image below
+			StripOutput& strip = strips[s];
+			strip = { nullptr, 0, 1, 0 };
+			const u4Byte firstRow = s * AthruGPU::PNG_STRIP_ROWS;
+			const u4Byte numRows = std::min(AthruGPU::PNG_STRIP_ROWS, height - firstRow);
+			const size_t filteredBytes = (size_t)numRows * (rowBytes + 1);
+
+			// Filter rows; filters read the unfiltered row above, so strips don't depend on
+			// each other
+			uByte* filtered = (uByte*)malloc(filteredBytes);
+			uByte* zeroRow = (uByte*)calloc(rowBytes, 1);
+			if (filtered == nullptr || zeroRow == nullptr)
+			{
+				free(filtered);
+				free(zeroRow);
+				continue;
+			}
+
+			const uByte filter = (speed == AthruGPU::PNG_SPEEDS::STORED) ? 0 : 2;
+			for (u4Byte r = 0; r < numRows; r += 1)
+			{
+				const u4Byte y = firstRow + r;
+				const uByte* row = rgba + ((size_t)y * rowBytes);
+				const uByte* prevRow = (y > 0) ? (row - rowBytes) : zeroRow;
+				FilterRow(filter, row, prevRow, rowBytes, filtered + ((size_t)r * (rowBytes + 1)));
+			}
+			free(zeroRow);
+
+			// Deflate into an IDAT chunk; stored blocks bound the output size, since blocks never
+			// come out larger than storing them would
+			const size_t capacity = 8 + 2 + filteredBytes + (12 * ((filteredBytes / MAX_STORED_BYTES) + 2)) + 4 + 16;
+			StripDeflater deflater;
+			deflater.tables = &tables;
+			deflater.writer.out = (uByte*)malloc(capacity);
+			deflater.writer.pos = 8; // Leave room for the chunk length + type
+			deflater.writer.bits = 0;
+			deflater.writer.numBits = 0;
+			deflater.tokens = (Token*)malloc(sizeof(Token) * BLOCK_TOKENS);
+			deflater.head = (s4Byte*)malloc(sizeof(s4Byte) * (1u << HASH_BITS));
+			deflater.prev = (s4Byte*)malloc(sizeof(s4Byte) * WINDOW_SIZE);
+			if (deflater.writer.out == nullptr || deflater.tokens == nullptr ||
+				deflater.head == nullptr || deflater.prev == nullptr)
+			{
+				free(deflater.writer.out);
+				free(deflater.tokens);
+				free(deflater.head);
+				free(deflater.prev);
+				free(filtered);
+				continue;
+			}
+
+			deflater.chainDepth = chainDepth;
+			deflater.storedOnly = (speed == AthruGPU::PNG_SPEEDS::STORED);
+			if (s == 0)
+			{
+				// zlib header (deflate, 32K window, no preset dictionary)
+				deflater.writer.Put(0x78, 8);
+				deflater.writer.Put(0x01, 8);
+			}
+			deflater.Deflate(filtered, filteredBytes, s == (numStrips - 1));
+
+			uByte* chunk = deflater.writer.out;
+			const u4Byte dataBytes = (u4Byte)(deflater.writer.pos - 8);
+			StoreBE32(chunk, dataBytes);
+			memcpy(chunk + 4, "IDAT", 4);
+			StoreBE32(chunk + 8 + dataBytes, CRC32(tables, 0, chunk + 4, (size_t)dataBytes + 4));
+			strip.chunk = chunk;
+			strip.chunkBytes = (size_t)dataBytes + 12;
+			strip.adler = Adler32(1, filtered, filteredBytes);
+			strip.filteredBytes = filteredBytes;
+
+			free(deflater.tokens);
+			free(deflater.head);
+			free(deflater.prev);
+			free(filtered);
+		}
+	});
+
+	// Stitch strips together; the zlib checksum trails the final strip in its own chunk
+	size_t totalBytes = 8 + 25 + 16 + 12;
+	u4Byte adler = 1;
+	bool stripsEncoded = true;
+	for (u4Byte s = 0; s < numStrips; s += 1)
+	{
+		totalBytes += strips[s].chunkBytes;
+		adler = CombineAdler32(adler, strips[s].adler, strips[s].filteredBytes);
+		stripsEncoded = stripsEncoded && (strips[s].chunk != nullptr);
+	}
+
+	uByte* png = stripsEncoded ? (uByte*)malloc(totalBytes) : nullptr;
+	if (png != nullptr)
+	{
+		static constexpr uByte signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+		uByte* out = png;
+		memcpy(out, signature, 8);
+		out += 8;
+
+		StoreBE32(out, 13);
+		memcpy(out + 4, "IHDR", 4);
+		StoreBE32(out + 8, width);
+		StoreBE32(out + 12, height);
+		out[16] = 8; // Bit depth
+		out[17] = 6; // RGBA
+		out[18] = 0; // Deflate
+		out[19] = 0; // Adaptive filtering
+		out[20] = 0; // No interlacing
+		StoreBE32(out + 21, CRC32(tables, 0, out + 4, 17));
+		out += 25;
+
+		for (u4Byte s = 0; s < numStrips; s += 1)
+		{
+			memcpy(out, strips[s].chunk, strips[s].chunkBytes);
+			out += strips[s].chunkBytes;
+		}
+
+		StoreBE32(out, 4);
+		memcpy(out + 4, "IDAT", 4);
+		StoreBE32(out + 8, adler);
+		StoreBE32(out + 12, CRC32(tables, 0, out + 4, 8));
+		out += 16;
+
+		StoreBE32(out, 0);
+		memcpy(out + 4, "IEND", 4);
+		StoreBE32(out + 8, CRC32(tables, 0, out + 4, 4));
+		*pngSize = totalBytes;
+	}
+
+	for (u4Byte s = 0; s < numStrips; s += 1)
+	{
+		free(strips[s].chunk);
+	}
+	free(strips);
+	return png;
+}
+
+float PNGEncoder::Benchmark(u4Byte width, u4Byte height)
+{
+	// Smooth gradients + per-pixel noise, roughly like a partially-converged path-traced frame
+	const size_t numBytes = (size_t)width * height * 4;
+	uByte* image = (uByte*)malloc(numBytes);
+	BenchRand next;
+	for (u4Byte y = 0; y < height; y += 1)
+	{
+		for (u4Byte x = 0; x < width; x += 1)
+		{
+			const s4Byte noise = (s4Byte)(next() & 15) - 8;
+			uByte* px = image + (((size_t)y * width + x) * 4);
+			px[0] = (uByte)std::min(std::max(((s4Byte)((x * 255) / width)) + noise, 0), 255);
+			px[1] = (uByte)std::min(std::max(((s4Byte)((y * 255) / height)) + noise, 0), 255);
+			px[2] = (uByte)std::min(std::max(128 + (s4Byte)(((x ^ y) >> 4) & 63) + noise, 0), 255);
+			px[3] = 255;
+		}
+	}
+
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	auto decodesToSource = [image, numBytes, width, height](const uByte* png, size_t pngSize)
+	{
+		uByte* decoded = nullptr;
+		unsigned w = 0;
+		unsigned h = 0;
+		const bool matches = (lodepng_decode32(&decoded, &w, &h, png, pngSize) == 0) &&
+							 (w == width) && (h == height) && (memcmp(decoded, image, numBytes) == 0);
+		free(decoded);
+		return matches;
+	};
+
+	// Baseline (the previous capture path, minus file output)
+	auto t0 = std::chrono::steady_clock::now();
+	uByte* lodePNG = nullptr;
+	size_t lodeSize = 0;
+	lodepng_encode32(&lodePNG, &lodeSize, image, width, height);
+	const double lodeSecs = (std::chrono::steady_clock::now() - t0).count() * TimeStuff::nsToSecs;
+	logger->Log(lodeSecs * 1000.0, "PNG encode milliseconds (lodepng)");
+	logger->Log(lodeSize, "PNG bytes (lodepng)");
+	free(lodePNG);
+
+	float captureSpeedup = 0.0f;
+	bool allMatch = true;
+	const AthruGPU::PNG_SPEEDS speeds[4] = { AthruGPU::PNG_SPEEDS::STORED, AthruGPU::PNG_SPEEDS::FASTEST,
+											 AthruGPU::PNG_SPEEDS::FAST, AthruGPU::PNG_SPEEDS::SMALLEST };
+	for (u4Byte i = 0; i < 4; i += 1)
+	{
+		t0 = std::chrono::steady_clock::now();
+		size_t pngSize = 0;
+		uByte* png = Encode(image, width, height, speeds[i], &pngSize);
+		const double secs = (std::chrono::steady_clock::now() - t0).count() * TimeStuff::nsToSecs;
+		logger->Log((u4Byte)speeds[i], "PNG speed level");
+		logger->Log(secs * 1000.0, "PNG encode milliseconds (strips)");
+		logger->Log(pngSize, "PNG bytes (strips)");
+		const bool matches = (png != nullptr) && decodesToSource(png, pngSize);
+		logger->Log((u4Byte)matches, "PNG decodes to source image");
+		allMatch = allMatch && matches;
+		if (speeds[i] == AthruGPU::CAPTURE_PNG_SPEED)
+		{
+			captureSpeedup = (float)(lodeSecs / std::max(secs, 1e-9));
+		}
+		free(png);
+	}
+
+	free(image);
+	logger->Log(captureSpeedup, "PNG capture encode speedup over lodepng");
+	return BenchUtils::ReportChecks(allMatch, "PNG encoder benchmark", captureSpeedup);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "GPUGlobals.h"
+
+// Parallel PNG encoder for frame captures
+// Images are split into strips of [AthruGPU::PNG_STRIP_ROWS] rows; each strip is filtered + deflated
+// independently on the job system (strips end on byte-aligned empty stored blocks, so their deflate
+// streams can be concatenated directly), then written out as its own IDAT chunk
+// Strips don't share match history, which costs a little compression relative to lodepng's single
+// stream, but lets every strip encode at once
+class PNGEncoder
+{
+	public:
+		PNGEncoder() = delete;
+		~PNGEncoder() = delete;
+
+		// Encode an 8bpc RGBA image; returns a [malloc]'d PNG (release it with [free]) + writes its size
+		// into [pngSize], or returns [nullptr] if encoding fails
+		static uByte* Encode(const uByte* rgba, u4Byte width, u4Byte height, AthruGPU::PNG_SPEEDS speed,
+							 size_t* pngSize);
+
+		// Encode a synthetic (noisy, path-tracer-like) [width]x[height] image with lodepng's default
+		// settings, then with [Encode(...)] at every speed level; verifies each output decodes back to
+		// the source image + logs sizes/timings
+		// Returns the speedup of [AthruGPU::CAPTURE_PNG_SPEED] over lodepng, or a negative value if any
+		// output failed to decode back to the source image
+		static float Benchmark(u4Byte width, u4Byte height);
+};
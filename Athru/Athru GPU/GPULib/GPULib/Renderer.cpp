@@ -3,9 +3,56 @@
 #include "PixHistory.h"
 #include "Camera.h"
 #include "GPUMemory.h"
+#include "BufferPlanner.h"
+#include "BarrierPlanner.h"
 #include <array>
 #include <functional>
 
+DirectX::XMFLOAT2* Renderer::prefetchedDither = nullptr;
+
+// Records planned barriers into a D3D12 command list; planner resource indices map onto [resrcs]
+class D3DBarrierRecorder : public BarrierPlanner::Recorder
+{
+	public:
+		D3DBarrierRecorder(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* const* resrcs) :
+			cmdList(cmdList),
+			resrcs(resrcs) {}
+
+		void Barriers(const BarrierPlanner::Barrier* barriers, u4Byte numBarriers) override
+		{
+			D3D12_RESOURCE_BARRIER d3dBarriers[BarrierPlanner::MAX_RESOURCES * 2];
+			assert(numBarriers <= (BarrierPlanner::MAX_RESOURCES * 2)); // At most a split end + a split begin per resource
+			for (u4Byte i = 0; i < numBarriers; i += 1)
+			{
+				const BarrierPlanner::Barrier& barrier = barriers[i];
+				if (barrier.type == BarrierPlanner::BARRIER_TYPES::UAV) { d3dBarriers[i] = AthruGPU::UAVBarrier(resrcs[barrier.resrc]); }
+				else
+				{
+					d3dBarriers[i] = AthruGPU::TransitionBarrier(D3DState(barrier.after), resrcs[barrier.resrc], D3DState(barrier.before));
+					if (barrier.split == BarrierPlanner::BARRIER_SPLITS::BEGIN_ONLY) { d3dBarriers[i].Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY; }
+					else if (barrier.split == BarrierPlanner::BARRIER_SPLITS::END_ONLY) { d3dBarriers[i].Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY; }
+				}
+			}
+			cmdList->ResourceBarrier(numBarriers, d3dBarriers);
+		}
+
+	private:
+		static D3D12_RESOURCE_STATES D3DState(BarrierPlanner::RESRC_STATES state)
+		{
+			switch (state)
+			{
+				case BarrierPlanner::RESRC_STATES::UNORDERED_ACCESS: return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+				case BarrierPlanner::RESRC_STATES::COPY_SOURCE: return D3D12_RESOURCE_STATE_COPY_SOURCE;
+				case BarrierPlanner::RESRC_STATES::COPY_DEST: return D3D12_RESOURCE_STATE_COPY_DEST;
+				case BarrierPlanner::RESRC_STATES::INDIRECT_ARGUMENT: return D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+				default: return D3D12_RESOURCE_STATE_COMMON;
+			}
+		}
+
+		ID3D12GraphicsCommandList* cmdList;
+		ID3D12Resource* const* resrcs;
+};
+
 Renderer::Renderer(HWND windowHandle,
 				   AthruGPU::GPUMemory& gpuMem,
 				   const Microsoft::WRL::ComPtr<ID3D12Device>& device,
@@ -13,73 +60,90 @@ Renderer::Renderer(HWND windowHandle,
 			// Initialize shaders
             lensSampler(ComputePass(device,
 								    windowHandle,
-								    "LensSampler.cso",
+								    AthruGPU::RENDER_SHADER_PATHS[0],
 									1, 2, 21)),
 			tracer{ ComputePass(device,
 					 			windowHandle,
-					 			"RayMarch.cso",
+					 			AthruGPU::RENDER_SHADER_PATHS[1],
 								1, 2, 27) },
 			dispEditor { ComputePass(device,
 									 windowHandle,
-									 "RnderDispEditor.cso",
+									 AthruGPU::RENDER_SHADER_PATHS[2],
 									 1, 2, 27) },
 			surfSampler{ ComputePass(device,
 								     windowHandle,
-								     "SurfSampler.cso",
+								     AthruGPU::RENDER_SHADER_PATHS[3],
 								     1, 2, 27) },
 			post(device,
 				 windowHandle,
-				 "RasterPrep.cso",
+				 AthruGPU::RENDER_SHADER_PATHS[4],
 				 1, 2, 20),
 			// Cache a reference to the rendering command queue
 			rnderQueue(rndrCmdQueue),
 			rnderFrameCtr(0) // Rendering starts on the zeroth back-buffer
 {
-	// Upload blue-noise dither texture
+	// Upload blue-noise dither texture; packed textures are already converted, so upload straight
+	// out of the pack's mapping (texture initialization only reads from the given texels)
 	GPUMessenger* gpuMsg = AthruGPU::GPU::AccessGPUMessenger();
-	uByte* ditherMemRaw; // 128*128-wide image, loaded as four channels/texel
-	gpuMsg->LoadTexture("Third Party/Moments In Graphics/LDR_RG01_0.png", 128, 128, &ditherMemRaw);
-	DirectX::XMFLOAT2* ditherMem = new DirectX::XMFLOAT2[128 * 128];
-	for (u4Byte i = 0; i < 128 * 128 * 4; i += 4)
+	constexpr u4Byte ditherArea = AthruGPU::DITHER_TEX_WIDTH * AthruGPU::DITHER_TEX_WIDTH;
+	u8Byte ditherBytes = 0;
+	const uByte* ditherAsset = AthruCore::Utility::AccessAssets()->Find(AthruGPU::DITHER_TEX_PATH, ASSET_TYPES::TEXTURE, &ditherBytes);
+	if (ditherAsset != nullptr)
 	{
-		ditherMem[i / 4] = DirectX::XMFLOAT2(ditherMemRaw[i] / 256.0f, ditherMemRaw[i + 1] / 256.0f);
+		const AssetPack::TextureHeader* ditherInfo = (const AssetPack::TextureHeader*)ditherAsset;
+		assert(ditherInfo->width == AthruGPU::DITHER_TEX_WIDTH && ditherInfo->height == AthruGPU::DITHER_TEX_WIDTH);
+		assert(ditherInfo->format == DXGI_FORMAT_R32G32_FLOAT);
+		assert(ditherBytes == (sizeof(AssetPack::TextureHeader) + (ditherArea * sizeof(DirectX::XMFLOAT2))));
+		ditherTex.InitRTex(device, gpuMem, (DirectX::XMFLOAT2*)(ditherAsset + sizeof(AssetPack::TextureHeader)),
+						   AthruGPU::DITHER_TEX_WIDTH, AthruGPU::DITHER_TEX_WIDTH, 1u, DXGI_FORMAT_R32G32_FLOAT);
+	}
+	else
+	{
+		// Use texels decoded ahead of time where possible (see [PrefetchDitherTexels()])
+		DirectX::XMFLOAT2* ditherMem = (prefetchedDither != nullptr) ? prefetchedDither : DecodeDitherTexels();
+		prefetchedDither = nullptr;
+		ditherTex.InitRTex(device, gpuMem, ditherMem, AthruGPU::DITHER_TEX_WIDTH, AthruGPU::DITHER_TEX_WIDTH, 1u, DXGI_FORMAT_R32G32_FLOAT);
+		delete[] ditherMem;
+		ditherMem = nullptr;
 	}
-	free(ditherMemRaw);
-	ditherMemRaw = nullptr;
-	ditherTex.InitRTex(device, gpuMem, ditherMem, 128, 128, 1u, DXGI_FORMAT_R32G32_FLOAT);
-	delete[] ditherMem;
-	ditherMem = nullptr;
 
 	// Initialize rendering buffer
-	constexpr u4Byte sizes[18] = { (AthruGPU::NUM_RAND_PT_STREAMS * sizeof(PhiloStrm)),
-								   (GraphicsStuff::DISPLAY_AREA * sizeof(float2x3)),
-								   (GraphicsStuff::DISPLAY_AREA * sizeof(DirectX::XMFLOAT3)),
-								   (GraphicsStuff::DISPLAY_AREA * sizeof(DirectX::XMFLOAT3)),
-								   (GraphicsStuff::DISPLAY_AREA * sizeof(float)),
-								   (GraphicsStuff::DISPLAY_AREA * sizeof(u4Byte)),
-								   (GraphicsStuff::DISPLAY_AREA * sizeof(DirectX::XMFLOAT3)),
-								   (GraphicsStuff::DISPLAY_AREA * sizeof(DirectX::XMFLOAT3)),
-								   GraphicsStuff::DISPLAY_AREA * 4, // Four 8-bit channels/pixel
-								   (GraphicsStuff::DISPLAY_AREA * sizeof(PixHistory)),
-								   (8 * sizeof(u4Byte)),
-								   (GraphicsStuff::TILING_AREA * sizeof(u4Byte)),
-								   (GraphicsStuff::TILING_AREA * sizeof(u4Byte)),
-								   (GraphicsStuff::TILING_AREA * sizeof(u4Byte)),
-								   (GraphicsStuff::TILING_AREA * sizeof(u4Byte)),
-								   (GraphicsStuff::TILING_AREA * sizeof(u4Byte)),
-								   (GraphicsStuff::TILING_AREA * sizeof(u4Byte)),
-								   (GraphicsStuff::TILING_AREA * sizeof(u4Byte)) };
-	u4Byte rndrMem = 0;
-	for (u4Byte i = 0; i < 18; i += 1)
-	{ rndrMem += sizes[i]; }
+	// Sub-buffers are declared with the passes they're live in, then laid out by [BufferPlanner] so buffers that
+	// are never live at the same time can share memory
+	// Buffers carried between frames (RNG state, temporal AA history, dispatch axes reset during post-processing)
+	// stay live through every pass; offsets are aligned to each projection's element size
+	constexpr u4Byte lens = (u4Byte)AthruGPU::RNDR_PASSES::LENS_SAMPLING;
+	constexpr u4Byte trace = (u4Byte)AthruGPU::RNDR_PASSES::PATH_TRACING;
+	constexpr u4Byte postPass = (u4Byte)AthruGPU::RNDR_PASSES::POST_PROCESSING;
+	constexpr u4Byte capture = (u4Byte)AthruGPU::RNDR_PASSES::CAPTURE;
+	BufferPlanner layout;
+	layout.Declare("randState", AthruGPU::NUM_RAND_PT_STREAMS * sizeof(PhiloStrm), sizeof(PhiloStrm), lens, capture);
+	layout.Declare("rays", GraphicsStuff::DISPLAY_AREA * sizeof(float2x3), sizeof(float2x3), lens, trace);
+	layout.Declare("rayOris", GraphicsStuff::DISPLAY_AREA * sizeof(DirectX::XMFLOAT3), sizeof(DirectX::XMFLOAT3), trace, trace);
+	layout.Declare("outDirs", GraphicsStuff::DISPLAY_AREA * sizeof(DirectX::XMFLOAT3), sizeof(DirectX::XMFLOAT3), trace, trace);
+	layout.Declare("iors", GraphicsStuff::DISPLAY_AREA * sizeof(DirectX::XMFLOAT2), sizeof(DirectX::XMFLOAT2), trace, trace);
+	layout.Declare("figIDs", GraphicsStuff::DISPLAY_AREA * sizeof(u4Byte), sizeof(u4Byte), trace, trace);
+	layout.Declare("denoisePositions", GraphicsStuff::DISPLAY_AREA * sizeof(DirectX::XMFLOAT3), sizeof(DirectX::XMFLOAT3), lens, postPass);
+	layout.Declare("denoiseNormals", GraphicsStuff::DISPLAY_AREA * sizeof(DirectX::XMFLOAT3), sizeof(DirectX::XMFLOAT3), lens, postPass);
+	layout.Declare("displayTexExportable", GraphicsStuff::DISPLAY_AREA * 4, 4, postPass, capture); // Four 8-bit channels/pixel
+	layout.Declare("aaBuffer", GraphicsStuff::DISPLAY_AREA * sizeof(PixHistory), sizeof(PixHistory), lens, capture);
+	layout.Declare("dispAxesWrite", 8 * sizeof(u4Byte), sizeof(u4Byte), lens, capture);
+	layout.Declare("traceables", GraphicsStuff::TILING_AREA * sizeof(u4Byte), sizeof(u4Byte), lens, trace);
+	const char* isectionNames[6] = { "diffuIsections", "mirroIsections", "refraIsections", "snowwIsections", "ssurfIsections", "furryIsections" };
+	for (u4Byte i = 0; i < 6; i += 1)
+	{
+		layout.Declare(isectionNames[i], GraphicsStuff::TILING_AREA * sizeof(u4Byte), sizeof(u4Byte), trace, trace);
+	}
+	layout.Plan();
+	assert(layout.Valid());
+
+	u4Byte rndrMem = (u4Byte)layout.PeakBytes();
 	rndrMem += 65536 - (rndrMem % 65536); // Adjust rendering memory footprint toward 64KB alignment
 	rndrBuff.InitRawRWBuf(device, gpuMem, rndrMem);
-	u4Byte offsets[18];
-	offsets[0] = 0;
-	offsets[1] = sizes[0];
-	for (u4Byte i = 2; i < 18; i += 1)
-	{ offsets[i] = offsets[i - 1] + sizes[i - 1]; }
-	randState.InitRWBufProj(device, gpuMem, rndrBuff.resrc, AthruGPU::NUM_RAND_PT_STREAMS);
+	u4Byte offsets[18]; // Buffers were declared in the same order as the projections below
+	for (u4Byte i = 0; i < 18; i += 1)
+	{ offsets[i] = (u4Byte)layout.Offset(i); }
+	randState.InitRWBufProj(device, gpuMem, rndrBuff.resrc, AthruGPU::NUM_RAND_PT_STREAMS, offsets[0]);
 	rays.InitRWBufProj(device, gpuMem, rndrBuff.resrc, GraphicsStuff::DISPLAY_AREA, offsets[1]);
 	rayOris.InitRWBufProj(device, gpuMem, rndrBuff.resrc, GraphicsStuff::DISPLAY_AREA, offsets[2]);
 	outDirs.InitRWBufProj(device, gpuMem, rndrBuff.resrc, GraphicsStuff::DISPLAY_AREA, offsets[3]);
@@ -135,6 +199,9 @@ Renderer::Renderer(HWND windowHandle,
 	lensList->SetComputeRootDescriptorTable(0, baseRndrDescriptor);
 	lensList->SetPipelineState(lensSampler.shadingState.Get());
 	DirectX::XMUINT3 disp = AthruGPU::tiledDispatchAxes(16);
+	const D3D12_RESOURCE_BARRIER aliasBarrier = AthruGPU::UAVBarrier(rndrBuff.resrc); // Aliased sub-buffers change hands between passes, so finish
+																					 // writes from earlier passes before starting new ones
+	lensList->ResourceBarrier(1, &aliasBarrier);
 	lensList->Dispatch(disp.x, disp.y, disp.z);
 	lensList->Close(); // End lens-sampling submissions
 
@@ -159,25 +226,63 @@ Renderer::Renderer(HWND windowHandle,
 	cmdSigDesc.NodeMask = 0x1; // No support for multi-GPU atm
 	device->CreateCommandSignature(&cmdSigDesc, nullptr, __uuidof(ptCmdSignature), &ptCmdSignature);
 
-	// Prepare copy barriers for the read/write & indirect argument dispatch axes
-	D3D12_RESOURCE_BARRIER dispBarriers[4] = { AthruGPU::TransitionBarrier(D3D12_RESOURCE_STATE_COPY_SOURCE, rndrBuff.resrc.Get(), rndrBuff.resrcState),
-											   AthruGPU::TransitionBarrier(dispAxesArgs.resrcState, dispAxesArgs.resrc.Get(), D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT),
-											   AthruGPU::TransitionBarrier(rndrBuff.resrcState, rndrBuff.resrc.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE),
-											   AthruGPU::TransitionBarrier(D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, dispAxesArgs.resrc.Get(), dispAxesArgs.resrcState) };
-
-	// Prepare small UAV barriers to separate tracing/sampling from dispatch generation
-	// (since afaik there's no easy way to make indirect dispatch arguments scale with shader threads/group otherwise)
-	// All rendering shaders write to the Philox state buffer immediately before exiting
-	D3D12_RESOURCE_BARRIER dispEditBarriers[2] = { AthruGPU::UAVBarrier(randState.resrc),
-												   AthruGPU::UAVBarrier(randState.resrc) };
+	// Declare resource accesses for every path-tracing pass, then let [BarrierPlanner] derive (batched, split where
+	// possible) barriers between them; the lens-sampling list writes [rndrBuff] + [ctrBuff] just before this one, so
+	// their first unordered accesses wait on those writes
+	// All rendering shaders write to the Philox state buffer immediately before exiting, and dispatch editing needs
+	// the counters written by tracing/sampling, so every pass here writes [rndrBuff] + touches [ctrBuff]
+	typedef BarrierPlanner::RESRC_STATES BARRIER_STATES;
+	BarrierPlanner ptBarriers;
+	const u4Byte rndrResrc = ptBarriers.DeclareResrc("rndrBuff", BARRIER_STATES::UNORDERED_ACCESS, true);
+	const u4Byte ctrResrc = ptBarriers.DeclareResrc("ctrBuff", BARRIER_STATES::UNORDERED_ACCESS, true);
+	const u4Byte argsResrc = ptBarriers.DeclareResrc("dispAxesArgs", BARRIER_STATES::COPY_DEST, false); // Matches [dispAxesArgs.resrcState]
+	auto declareCopy = [&]()
+	{
+		ptBarriers.DeclarePass("dispatch axes copy");
+		ptBarriers.Reads(rndrResrc, BARRIER_STATES::COPY_SOURCE);
+		ptBarriers.Writes(argsResrc, BARRIER_STATES::COPY_DEST);
+	};
+	auto declareDispEdit = [&]()
+	{
+		ptBarriers.DeclarePass("dispatch editing");
+		ptBarriers.Writes(rndrResrc, BARRIER_STATES::UNORDERED_ACCESS);
+		ptBarriers.Reads(ctrResrc, BARRIER_STATES::UNORDERED_ACCESS);
+	};
+	for (int i = 0; i < GraphicsStuff::MAX_NUM_BOUNCES; i += 1)
+	{
+		ptBarriers.DeclarePass("tracing");
+		ptBarriers.Writes(rndrResrc, BARRIER_STATES::UNORDERED_ACCESS);
+		ptBarriers.Writes(ctrResrc, BARRIER_STATES::UNORDERED_ACCESS);
+		if (i > 0) { ptBarriers.Reads(argsResrc, BARRIER_STATES::INDIRECT_ARGUMENT); } // Tracing is a full-screen dispatch in the zeroth bounce
+		declareDispEdit();
+		declareCopy();
+		ptBarriers.DeclarePass("surface sampling");
+		ptBarriers.Writes(rndrResrc, BARRIER_STATES::UNORDERED_ACCESS);
+		ptBarriers.Writes(ctrResrc, BARRIER_STATES::UNORDERED_ACCESS);
+		ptBarriers.Reads(argsResrc, BARRIER_STATES::INDIRECT_ARGUMENT);
+		declareDispEdit();
+		declareCopy();
+	}
+	ptBarriers.Plan();
+	assert(ptBarriers.Valid());
+	ID3D12Resource* ptResrcs[3] = { rndrBuff.resrc.Get(), ctrBuff.resrc.Get(), dispAxesArgs.resrc.Get() };
+	D3DBarrierRecorder ptRecorder(ptCmdList.Get(), ptResrcs);
 
 	// Prepare path-tracing commands
+	// Passes are recorded in the order they were declared above
 	ptCmdList->SetDescriptorHeaps(1, viewHeap.GetAddressOf());
 	ptCmdList->SetComputeRootSignature(tracer.rootSig.Get()); // Tracing and sampling passes share the same descriptor layout
 	ptCmdList->SetComputeRootDescriptorTable(0, baseRndrDescriptor);
+	u4Byte ptPass = 0;
+	auto recordBarriers = [&]()
+	{
+		ptBarriers.Record(ptPass, ptRecorder);
+		ptPass += 1;
+	};
 	for (int i = 0; i < GraphicsStuff::MAX_NUM_BOUNCES; i += 1)
 	{
 		// Perform ray-tracing/marching
+		recordBarriers();
 		ptCmdList->SetPipelineState(tracer.shadingState.Get());
 		if (i > 0)
 		{
@@ -191,28 +296,27 @@ Renderer::Renderer(HWND windowHandle,
 		}
 
 		// Generate sampling dispatch axes
-		ptCmdList->ResourceBarrier(1, dispEditBarriers);
+		recordBarriers();
 		ptCmdList->SetPipelineState(dispEditor.shadingState.Get());
 		ptCmdList->Dispatch(1, 1, 1);
 
 		// Update sampler counters
-		if (i == 0) { ptCmdList->ResourceBarrier(1, dispBarriers); } // Consider issuing both elements and using split barriers here
-		else { ptCmdList->ResourceBarrier(2, dispBarriers); }
+		recordBarriers();
 		ptCmdList->CopyBufferRegion(dispAxesArgs.resrc.Get(), 0, rndrBuff.resrc.Get(), (u8Byte)(offsets[10]) + 12, 12);
-		ptCmdList->ResourceBarrier(2, dispBarriers + 2);
 
 		// Perform surface sampling & generate traceable dispatch axes
+		recordBarriers();
 		ptCmdList->SetPipelineState(surfSampler.shadingState.Get());
 		ptCmdList->ExecuteIndirect(ptCmdSignature.Get(), 1, dispAxesArgs.resrc.Get(), 0, nullptr, NULL);
-		ptCmdList->ResourceBarrier(1, dispEditBarriers + 1);
+		recordBarriers();
 		ptCmdList->SetPipelineState(dispEditor.shadingState.Get());
 		ptCmdList->Dispatch(1, 1, 1);
 
 		// Update ray-tracing/marching counters (tracing/marching occurs as a full-screen pass in the zeroth iteration)
-		ptCmdList->ResourceBarrier(2, dispBarriers); // Consider issuing both elements and using split barriers here
+		recordBarriers();
 		ptCmdList->CopyBufferRegion(dispAxesArgs.resrc.Get(), 0, rndrBuff.resrc.Get(), offsets[10], 12);
-		ptCmdList->ResourceBarrier(2, dispBarriers + 2);
 	}
+	ptBarriers.Record(ptPass, ptRecorder); // Return resources to their starting states
 	ptCmdList->Close();
 
 	// Prepare static data for presentation barriers
@@ -247,6 +351,7 @@ Renderer::Renderer(HWND windowHandle,
 		// -- No pixel resource barrier here, sampled colors are staged per-path and copied onto the display texture during post-processing --
 		postCmdLists[i]->SetComputeRootSignature(post.rootSig.Get());
 		postCmdLists[i]->SetComputeRootDescriptorTable(0, baseRndrDescriptor);
+		postCmdLists[i]->ResourceBarrier(1, &aliasBarrier);
 		postCmdLists[i]->Dispatch(disp.x, disp.y, disp.z);
 
 		// Prepare presentation commands
@@ -286,13 +391,8 @@ Renderer::Renderer(HWND windowHandle,
 		rnderCmdSets[i][2] = postCmdLists[i];
 	}
 
-	// Prepare separate screenshot command-list (context-dependant, can't easily batch with per-frame rendering work)
-	device->CreateCommandList(0x1,
-							  D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_DIRECT,
-							  rnderAlloc.Get(),
-							  nullptr,
-							  __uuidof(screenShotCmds),
-							  (void**)&screenShotCmds);
+	// Prepare separate screenshot command-lists (context-dependant, can't easily batch with per-frame rendering work)
+	// One list per capture slot, each copying into that slot's region of readback memory
 	D3D12_RESOURCE_BARRIER sshotOutputBarriers[2];
 	sshotOutputBarriers[0] = AthruGPU::TransitionBarrier(D3D12_RESOURCE_STATE_COPY_SOURCE,
 														 rndrBuff.resrc,
@@ -300,10 +400,53 @@ Renderer::Renderer(HWND windowHandle,
 	sshotOutputBarriers[1] = AthruGPU::TransitionBarrier(rndrBuff.resrcState,
 														 rndrBuff.resrc,
 														 D3D12_RESOURCE_STATE_COMMON);
-	screenShotCmds->ResourceBarrier(1, sshotOutputBarriers);
-	screenShotCmds->CopyBufferRegion(gpuMsg->AccessReadbackBuf().Get(), 0, rndrBuff.resrc.Get(), offsets[8], GraphicsStuff::DISPLAY_AREA * 4); // Four channels/pixel, one byte each
-	screenShotCmds->ResourceBarrier(1, sshotOutputBarriers + 1);
-	screenShotCmds->Close();
+	for (u4Byte i = 0; i < AthruGPU::NUM_CAPTURE_SLOTS; i += 1)
+	{
+		device->CreateCommandList(0x1,
+								  D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_DIRECT,
+								  rnderAlloc.Get(),
+								  nullptr,
+								  __uuidof(screenShotCmds[i]),
+								  (void**)&screenShotCmds[i]);
+		screenShotCmds[i]->ResourceBarrier(1, sshotOutputBarriers);
+		screenShotCmds[i]->CopyBufferRegion(gpuMsg->AccessReadbackBuf().Get(), i * AthruGPU::CAPTURE_SLOT_MEM,
+											rndrBuff.resrc.Get(), offsets[8], GraphicsStuff::DISPLAY_AREA * 4); // Four channels/pixel, one byte each
+		screenShotCmds[i]->ResourceBarrier(1, sshotOutputBarriers + 1);
+		screenShotCmds[i]->Close();
+	}
+
+	// Prepare the HDR screenshot command-list; the HDR display texture copies out into the readback region
+	// following every LDR capture slot
+	D3D12_RESOURCE_BARRIER hdrSshotBarriers[2];
+	hdrSshotBarriers[0] = AthruGPU::TransitionBarrier(D3D12_RESOURCE_STATE_COPY_SOURCE,
+													  displayTexHDR.resrc,
+													  displayTexHDR.resrcState);
+	hdrSshotBarriers[1] = AthruGPU::TransitionBarrier(displayTexHDR.resrcState,
+													  displayTexHDR.resrc,
+													  D3D12_RESOURCE_STATE_COPY_SOURCE);
+	D3D12_TEXTURE_COPY_LOCATION hdrSrc;
+	hdrSrc.pResource = displayTexHDR.resrc.Get();
+	hdrSrc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	hdrSrc.SubresourceIndex = 0; // No mip-maps on the display texture
+	D3D12_TEXTURE_COPY_LOCATION hdrDst;
+	hdrDst.pResource = gpuMsg->AccessReadbackBuf().Get();
+	hdrDst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	hdrDst.PlacedFootprint.Offset = AthruGPU::NUM_CAPTURE_SLOTS * AthruGPU::CAPTURE_SLOT_MEM;
+	hdrDst.PlacedFootprint.Footprint.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+	hdrDst.PlacedFootprint.Footprint.Width = GraphicsStuff::DISPLAY_WIDTH;
+	hdrDst.PlacedFootprint.Footprint.Height = GraphicsStuff::DISPLAY_HEIGHT;
+	hdrDst.PlacedFootprint.Footprint.Depth = 1;
+	hdrDst.PlacedFootprint.Footprint.RowPitch = GraphicsStuff::DISPLAY_WIDTH * 16; // Tightly packed, so captures can be read out directly
+	device->CreateCommandList(0x1,
+							  D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_DIRECT,
+							  rnderAlloc.Get(),
+							  nullptr,
+							  __uuidof(hdrScreenShotCmds),
+							  (void**)&hdrScreenShotCmds);
+	hdrScreenShotCmds->ResourceBarrier(1, hdrSshotBarriers);
+	hdrScreenShotCmds->CopyTextureRegion(&hdrDst, 0, 0, 0, &hdrSrc, nullptr);
+	hdrScreenShotCmds->ResourceBarrier(1, hdrSshotBarriers + 1);
+	hdrScreenShotCmds->Close();
 }
 
 Renderer::~Renderer()
@@ -323,16 +466,41 @@ void Renderer::Render(Direct3D* d3d)
 	// Execute prepared commands
 	rnderQueue->ExecuteCommandLists(3, (ID3D12CommandList**)rnderCmdSets[rnderFrameCtr % 3]);
 
-	// Optionally copy-out screenshot memory
-	if (AthruCore::Utility::AccessInput()->KeyTapped(GraphicsStuff::SCREENSHOT_KEY))
+	// Start/stop capture sequences
+	Input* input = AthruCore::Utility::AccessInput();
+	GPUMessenger* gpuMsg = AthruGPU::GPU::AccessGPUMessenger();
+	if (input->KeyTapped(GraphicsStuff::CAPTURE_SEQUENCE_KEY))
 	{
-		rnderQueue->ExecuteCommandLists(1, (ID3D12CommandList**)screenShotCmds.GetAddressOf());
-		d3d->WaitForQueue(rnderQueue); // Not waiting as expected, need to ask/debug
-									   // ...might need to reset completion event here...
-		AthruGPU::GPU::AccessGPUMessenger()->SaveTexture("screenshot.png", GraphicsStuff::DISPLAY_WIDTH, GraphicsStuff::DISPLAY_HEIGHT);
+		if (!gpuMsg->CapturingSequence()) { gpuMsg->BeginCaptureSequence("capture_"); }
+		else { gpuMsg->EndCaptureSequence(); }
+	}
+	if (input->KeyTapped(GraphicsStuff::VIDEO_CAPTURE_KEY))
+	{
+		if (!gpuMsg->CapturingSequence()) { gpuMsg->BeginCaptureSequence("capture", AthruGPU::CAPTURE_FORMATS::Y4M); }
+		else { gpuMsg->EndCaptureSequence(); }
+	}
+
+	// Optionally copy-out screenshot memory; encoding happens on the job system, so the frame only
+	// waits for the copy itself
+	const s4Byte captureSlot = gpuMsg->BeginCapture(input->KeyTapped(GraphicsStuff::SCREENSHOT_KEY));
+	if (captureSlot >= 0)
+	{
+		rnderQueue->ExecuteCommandLists(1, (ID3D12CommandList**)screenShotCmds[captureSlot].GetAddressOf());
+	}
+	const s4Byte hdrCaptureSlot = input->KeyTapped(GraphicsStuff::HDR_SCREENSHOT_KEY) ? gpuMsg->BeginHDRCapture() : -1;
+	if (hdrCaptureSlot >= 0)
+	{
+		rnderQueue->ExecuteCommandLists(1, (ID3D12CommandList**)hdrScreenShotCmds.GetAddressOf());
+	}
+	d3d->WaitForQueue(rnderQueue);
+	if (captureSlot >= 0)
+	{
+		gpuMsg->EndCapture(captureSlot, GraphicsStuff::DISPLAY_WIDTH, GraphicsStuff::DISPLAY_HEIGHT);
+	}
+	if (hdrCaptureSlot >= 0)
+	{
+		gpuMsg->EndCapture(hdrCaptureSlot, GraphicsStuff::DISPLAY_WIDTH, GraphicsStuff::DISPLAY_HEIGHT);
 	}
-	else
-	{ d3d->WaitForQueue(rnderQueue); }
 
 	// Publish traced results to the display
 	// No UAV barrier, because presentation includes a transition barrier that should cause a similar wait
@@ -340,6 +508,39 @@ void Renderer::Render(Direct3D* d3d)
 	rnderFrameCtr += 1;
 }
 
+void Renderer::ConvertDitherTexels(const uByte* rgba, DirectX::XMFLOAT2* texels, u4Byte numTexels)
+{
+	for (u4Byte i = 0; i < numTexels; i += 1)
+	{
+		texels[i] = DirectX::XMFLOAT2(rgba[i * 4] / 256.0f, rgba[(i * 4) + 1] / 256.0f);
+	}
+}
+
+void Renderer::PrefetchDitherTexels()
+{
+	u8Byte ditherBytes = 0;
+	const uByte* ditherAsset = AthruCore::Utility::AccessAssets()->Find(AthruGPU::DITHER_TEX_PATH, ASSET_TYPES::TEXTURE, &ditherBytes);
+	if (ditherAsset != nullptr)
+	{
+		AssetPack::Prefault(ditherAsset, ditherBytes);
+	}
+	else
+	{
+		prefetchedDither = DecodeDitherTexels();
+	}
+}
+
+DirectX::XMFLOAT2* Renderer::DecodeDitherTexels()
+{
+	constexpr u4Byte ditherArea = AthruGPU::DITHER_TEX_WIDTH * AthruGPU::DITHER_TEX_WIDTH;
+	uByte* ditherMemRaw; // 128*128-wide image, loaded as four channels/texel
+	GPUMessenger::LoadTexture(AthruGPU::DITHER_TEX_PATH, AthruGPU::DITHER_TEX_WIDTH, AthruGPU::DITHER_TEX_WIDTH, &ditherMemRaw);
+	DirectX::XMFLOAT2* ditherMem = new DirectX::XMFLOAT2[ditherArea];
+	ConvertDitherTexels(ditherMemRaw, ditherMem, ditherArea);
+	free(ditherMemRaw);
+	return ditherMem;
+}
+
 // Push constructions for this class through Athru's custom allocator
 void* Renderer::operator new(size_t size)
 {
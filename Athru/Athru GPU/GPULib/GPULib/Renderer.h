@@ -18,11 +18,25 @@ class Renderer
 		~Renderer();
 		void Render(Direct3D* d3d);
 
+		// Convert the two leading 8-bit channels of each RGBA dither texel to floats; shared with
+		// asset baking, so packed dither textures match ones loaded from loose images
+		static void ConvertDitherTexels(const uByte* rgba, DirectX::XMFLOAT2* texels, u4Byte numTexels);
+
+		// Page in (packed) or decode (loose) the dither texture ahead of time, e.g. on a worker
+		// during start-up; should finish before [this] is created
+		static void PrefetchDitherTexels();
+
 		// Overload the standard allocation/de-allocation operators
 		void* operator new(size_t size);
 		void operator delete(void* target);
 
 	private:
+		// Decode + convert the loose dither texture; returns a [new[]]'d array of texels
+		static DirectX::XMFLOAT2* DecodeDitherTexels();
+
+		// Texels decoded by [PrefetchDitherTexels()], if any (consumed by the constructor)
+		static DirectX::XMFLOAT2* prefetchedDither;
+
 		// Per-frame lens sampler
 		ComputePass lensSampler;
 
@@ -147,9 +161,12 @@ class Renderer
 		// (batched version of lensList/ptCmdList/postCmdList[0...2] for neater command submission)
 		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> rnderCmdSets[3][AthruGPU::NUM_SWAPCHAIN_BUFFERS];
 
-		// Screenshot command list
+		// Screenshot command lists, one for each capture slot
 		// (isolated from main rendering work since screenshot copy-out to readback memory may/may-not happen per-frame)
-		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> screenShotCmds;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> screenShotCmds[AthruGPU::NUM_CAPTURE_SLOTS];
+
+		// HDR screenshot command list; copies the floating-point display texture into the HDR capture slot
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> hdrScreenShotCmds;
 
 		// Not every frame is a rendering frame, so internally keep track of render frames here
 		u4Byte rnderFrameCtr;
@@ -3,6 +3,10 @@
     #include "Materials.hlsli"
 #endif
 
+// Throughput-based Russian roulette past each path's first surface; disable
+// here to trace every path for all of [MAX_NUM_BOUNCES]
+#define RUSSIAN_ROULETTE
+
 // Per-bounce indirect dispatch axes
 // (tracing axes in (0...2), sampling axes in (3...5), input traceable
 // count in [6], input sampling count in [7]
@@ -71,6 +75,18 @@ void SampleDiffu(uint ndx, float3x3 normSpace, float3 n, float3 wo,
 								 		  wo)) / ZERO_PDF_REMAP(iDir.w) *
 								 abs(dot(n, -wo));
 		float4 rho = displayTex[pix] * float4(rgb, 1.0f);
+#ifdef RUSSIAN_ROULETTE
+		// Paths past their first surface survive with probability equal to their
+		// brightest throughput channel (capped at one), + survivors are scaled up
+		// by the inverse of that probability, so dim paths end early without
+		// biasing the image; [DiffuseDir(...)] only takes [rand.xy], so [rand.z]
+		// is free for the survival test
+		if (any(rays[ndx][0] != gpuInfo.cameraPos.xyz))
+		{
+			float survP = min(max(rho.r, max(rho.g, rho.b)), 1.0f);
+			rho.rgb = (rand.z < survP) ? rho.rgb / survP : 0.0f.xxx;
+		}
+#endif
 		displayTex[pix] = rho;
 		if (dot(rho.rgb, 1.0f.xxx) > 0.0f) // Only propagate paths with nonzero brightnesss
 		{
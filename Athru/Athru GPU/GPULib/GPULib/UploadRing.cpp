@@ -0,0 +1,170 @@
+#include <assert.h>
+#include "UtilityServiceCentre.h"
+#include "UploadRing.h"
+#include "BenchUtils.h"
+#include <algorithm>
+
+UploadRing::UploadRing(u8Byte capacity) :
+	capacity(capacity),
+	head(0),
+	tail(0),
+	openBytes(0),
+	firstSubmission(0),
+	numSubmissions(0)
+{
+	assert(capacity > 0);
+}
+
+u8Byte UploadRing::Allocate(u8Byte bytes, u8Byte alignment)
+{
+	assert(alignment > 0 && bytes > 0);
+
+	// Pad up to [alignment]; ranges that would run past the end of the ring skip
+	// ahead to the start instead (the skipped bytes are recycled along with the range)
+	const u8Byte offset = head % capacity;
+	u8Byte start = ((offset + alignment - 1) / alignment) * alignment;
+	if ((start + bytes) > capacity) { start = capacity; }
+	if (start == capacity)
+	{
+		start = 0;
+		if (bytes > capacity) { return NO_SPACE; }
+	}
+	const u8Byte consumed = (start >= offset) ? (start - offset) + bytes : (capacity - offset) + start + bytes;
+	if ((head - tail + consumed) > capacity) { return NO_SPACE; }
+
+	head += consumed;
+	openBytes += consumed;
+	return start;
+}
+
+void UploadRing::Close(u8Byte fence)
+{
+	if (openBytes == 0) { return; } // Nothing to track
+
+	// Submissions land in fence order, so the FIFO stays sorted
+	assert(numSubmissions < AthruGPU::MAX_UPLOAD_SUBMISSIONS); // Retire more often (or raise [MAX_UPLOAD_SUBMISSIONS]) if this fails
+	assert(numSubmissions == 0 || fence > submissions[(firstSubmission + numSubmissions - 1) % AthruGPU::MAX_UPLOAD_SUBMISSIONS].fence);
+	submissions[(firstSubmission + numSubmissions) % AthruGPU::MAX_UPLOAD_SUBMISSIONS] = { head, fence };
+	numSubmissions += 1;
+	openBytes = 0;
+}
+
+void UploadRing::Retire(u8Byte completedFence)
+{
+	while (numSubmissions > 0 && submissions[firstSubmission].fence <= completedFence)
+	{
+		tail = submissions[firstSubmission].end;
+		firstSubmission = (firstSubmission + 1) % AthruGPU::MAX_UPLOAD_SUBMISSIONS;
+		numSubmissions -= 1;
+	}
+}
+
+u8Byte UploadRing::OldestFence() const
+{
+	return (numSubmissions > 0) ? submissions[firstSubmission].fence : 0;
+}
+
+u8Byte UploadRing::UsedBytes() const
+{
+	return head - tail;
+}
+
+u8Byte UploadRing::Capacity() const
+{
+	return capacity;
+}
+
+float UploadRing::Simulate(u4Byte numFrames)
+{
+	BenchRand next;
+
+	// Small ring (so wrapping + stalls happen constantly), shadowed by one fence value
+	// per byte; zero marks bytes nothing in flight is reading
+	constexpr u8Byte ringBytes = 1 << 16;
+	constexpr u8Byte chunkBytes = 1 << 13; // Largest range requested at once; payloads bigger than this stream in pieces
+	constexpr u4Byte maxLag = AthruGPU::NUM_SWAPCHAIN_BUFFERS;
+	StackAllocator* memory = AthruCore::Utility::AccessMemory();
+	u8Byte* shadow = (u8Byte*)memory->AlignedAlloc(sizeof(u8Byte) * ringBytes, (uByte)std::alignment_of<u8Byte>(), false);
+	for (u8Byte i = 0; i < ringBytes; i += 1) { shadow[i] = 0; }
+
+	UploadRing ring(ringBytes);
+	bool valid = true;
+	u8Byte completedFence = 0;
+	u8Byte frameFences[maxLag + 1] = {}; // Fences still pending on the simulated GPU, in submission order
+	u4Byte doneFrames[maxLag + 1] = {}; // Frame where each pending fence completes
+	u4Byte numPending = 0;
+	auto completeOldest = [&]()
+	{
+		completedFence = frameFences[0];
+		for (u4Byte i = 1; i < numPending; i += 1) { frameFences[i - 1] = frameFences[i]; doneFrames[i - 1] = doneFrames[i]; }
+		numPending -= 1;
+		ring.Retire(completedFence);
+		for (u8Byte i = 0; i < ringBytes; i += 1)
+		{
+			if (shadow[i] != 0 && shadow[i] <= completedFence) { shadow[i] = 0; }
+		}
+	};
+	u8Byte payloadLeft = 0; // Bytes left in the payload currently streaming in
+	u8Byte streamedBytes = 0;
+	u4Byte numStalls = 0;
+	u4Byte numPayloads = 0;
+	for (u4Byte frame = 1; frame <= numFrames && valid; frame += 1)
+	{
+		// Advance the simulated GPU; fences complete in order, each one to [maxLag] frames
+		// after submission
+		while (numPending > 0 && doneFrames[0] <= frame) { completeOldest(); }
+
+		// Frames can't run more than [maxLag] submissions ahead of the GPU, so wait on the
+		// oldest fence if we're that far ahead (the only time the CPU blocks)
+		if (numPending == maxLag) { completeOldest(); }
+
+		// Stream as much as fits this frame
+		const u8Byte fence = frame;
+		u8Byte frameBudget = (next() % (ringBytes / 2)) + 1;
+		while (frameBudget > 0)
+		{
+			if (payloadLeft == 0)
+			{
+				payloadLeft = (next() % (ringBytes * 4)) + 1; // Payloads up to four times the size of the ring
+				numPayloads += 1;
+			}
+			const u8Byte bytes = std::min(std::min(payloadLeft, chunkBytes), frameBudget);
+			const u8Byte alignment = (next() & 1) ? 256 : 4;
+			const u8Byte offset = ring.Allocate(bytes, alignment);
+			if (offset == NO_SPACE)
+			{
+				// Ranges never consume more than [bytes] plus alignment padding, plus whatever's
+				// skipped at the end of the ring when wrapping (less than [bytes + alignment]), so
+				// stalling is only fair once the ring is at least that full
+				valid = (ring.UsedBytes() + (2 * bytes) + alignment) > ringBytes;
+				numStalls += 1;
+				break;
+			}
+
+			// Every byte in the range has to be free of earlier in-flight data
+			valid = (offset % alignment) == 0 && (offset + bytes) <= ringBytes;
+			for (u8Byte i = offset; i < (offset + bytes) && valid; i += 1)
+			{
+				valid = shadow[i] == 0;
+				shadow[i] = fence;
+			}
+			payloadLeft -= bytes;
+			frameBudget -= bytes;
+			streamedBytes += bytes;
+		}
+
+		// Submit the frame; ranges are tagged with its fence
+		ring.Close(fence);
+		frameFences[numPending] = fence;
+		doneFrames[numPending] = std::max((numPending > 0) ? doneFrames[numPending - 1] : 0u, frame + (next() % maxLag) + 1);
+		numPending += 1;
+		valid = valid && ring.UsedBytes() <= ringBytes;
+	}
+
+	const float bytesPerFrame = (float)((double)streamedBytes / numFrames);
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	logger->Log(bytesPerFrame, "Upload ring simulation, mean bytes streamed per frame");
+	logger->Log((float)numStalls / numFrames, "Upload ring simulation, share of frames stalled on a full ring");
+	logger->Log(numPayloads, "Upload ring simulation, payloads started");
+	return BenchUtils::ReportChecks(valid, "Upload ring simulation", bytesPerFrame);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "GPUGlobals.h"
+
+// Fence-tracked ring allocator for streaming uploads
+// Ranges are handed out from a circular staging buffer in submission order;
+// [Close(...)] tags everything allocated since the previous submission with
+// the fence value signalled after it, and [Retire(...)] recycles every range
+// whose fence the GPU has passed
+// That lets uploads of any size stream through a fixed staging buffer over
+// several frames, without ever waiting for the whole queue to drain (callers
+// only wait on the oldest submission, and only when the ring is full)
+// Nothing here touches the graphics API; fence values are plain integers, so
+// ring behaviour can be checked against a simulated GPU timeline (see
+// [Simulate(...)])
+class UploadRing
+{
+	public:
+		// Returned when a range doesn't fit in the ring's free space
+		static constexpr u8Byte NO_SPACE = ~0ull;
+
+		UploadRing(u8Byte capacity);
+		~UploadRing() = default;
+
+		// Find [bytes] of contiguous space at a multiple of [alignment], wrapping
+		// back to the start of the ring if the range won't fit before the end;
+		// returns the range's offset, or [NO_SPACE] if the ring is too full
+		u8Byte Allocate(u8Byte bytes, u8Byte alignment);
+
+		// Tag every range allocated since the last call with [fence], the value
+		// the GPU will signal once it's done reading them
+		// Fence values should increase with every submission
+		void Close(u8Byte fence);
+
+		// Recycle ranges from every submission up to + including [completedFence]
+		void Retire(u8Byte completedFence);
+
+		// Fence for the oldest submission still holding ring space, or zero if
+		// nothing is in flight; waiting for this fence always frees space
+		u8Byte OldestFence() const;
+
+		// Bytes held by in-flight (or unsubmitted) ranges, including any padding
+		// skipped when ranges wrapped
+		u8Byte UsedBytes() const;
+		u8Byte Capacity() const;
+
+		// Stream random payloads through a small ring for [numFrames] simulated
+		// frames, with the simulated GPU finishing each frame's fence one to
+		// [AthruGPU::NUM_SWAPCHAIN_BUFFERS] frames later; checks that no range is
+		// handed out while an earlier range over the same bytes is still in
+		// flight, and that streams never stall while the ring has room
+		// Logs throughput + stall statistics; returns the mean number of bytes
+		// streamed per frame, or a negative value if any check failed
+		static float Simulate(u4Byte numFrames);
+
+	private:
+		struct Submission
+		{
+			u8Byte end; // Ring position (see [head]) after the submission's last range
+			u8Byte fence;
+		};
+
+		u8Byte capacity;
+		u8Byte head; // Total bytes ever allocated (including padding); offsets are [head % capacity]
+		u8Byte tail; // Total bytes ever recycled
+		u8Byte openBytes; // Bytes allocated since the last [Close(...)]
+		Submission submissions[AthruGPU::MAX_UPLOAD_SUBMISSIONS]; // FIFO of in-flight submissions
+		u4Byte firstSubmission;
+		u4Byte numSubmissions;
+};
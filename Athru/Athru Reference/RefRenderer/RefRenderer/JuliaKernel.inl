@@ -0,0 +1,154 @@
+#pragma once
+
+#include "RefGlobals.h"
+#include "JuliaPackets.h"
+
+// Instruction-set-agnostic body of the packet Julia estimator; included by each
+// JuliaPackets[SSE2|AVX2|AVX512].cpp after defining an [Ops] struct with
+// - [F]/[M]: packed floats + lane masks, [WIDTH] lanes each
+// - [Set1], [Load], [Store]
+// - [Add], [Sub], [Mul], [Div], [Sqrt]
+// - [Lt] (per-lane [<]), [And] (mask intersection), [Any] (any lane set),
+//   [Select(m, a, b)] ([m] ? [a] : [b] per lane)
+// - [Exponent]/[Mantissa], splitting positive normal floats into [e] + [m] with
+//   [x == m * 2^e] + [m] in [0.5, 1) (like [frexpf])
+// Arithmetic follows [RefShading::Julia(...)] operation-for-operation (except
+// where noted), so packets only diverge from the scalar estimator through
+// [log] + whatever contraction the compiler applies
+namespace JuliaKernel
+{
+	// Cephes-style natural logarithm (the approximation behind most SIMD math
+	// libraries); within a couple of ulps of [logf] for the positive, normal
+	// inputs [Julia(...)] produces
+	template<typename Ops>
+	inline typename Ops::F Log(typename Ops::F x)
+	{
+		using F = typename Ops::F;
+		F e = Ops::Exponent(x);
+		F m = Ops::Mantissa(x);
+
+		// Recentre the mantissa around one, so the polynomial only sees [sqrt(0.5) - 1, sqrt(2) - 1)
+		const F one = Ops::Set1(1.0f);
+		const auto small = Ops::Lt(m, Ops::Set1(0.707106781186547524f));
+		e = Ops::Select(small, Ops::Sub(e, one), e);
+		m = Ops::Sub(Ops::Select(small, Ops::Add(m, m), m), one);
+
+		const F m2 = Ops::Mul(m, m);
+		F y = Ops::Set1(7.0376836292e-2f);
+		y = Ops::Add(Ops::Mul(y, m), Ops::Set1(-1.1514610310e-1f));
+		y = Ops::Add(Ops::Mul(y, m), Ops::Set1(1.1676998740e-1f));
+		y = Ops::Add(Ops::Mul(y, m), Ops::Set1(-1.2420140846e-1f));
+		y = Ops::Add(Ops::Mul(y, m), Ops::Set1(1.4249322787e-1f));
+		y = Ops::Add(Ops::Mul(y, m), Ops::Set1(-1.6668057665e-1f));
+		y = Ops::Add(Ops::Mul(y, m), Ops::Set1(2.0000714765e-1f));
+		y = Ops::Add(Ops::Mul(y, m), Ops::Set1(-2.4999993993e-1f));
+		y = Ops::Add(Ops::Mul(y, m), Ops::Set1(3.3333331174e-1f));
+		y = Ops::Mul(Ops::Mul(y, m), m2);
+
+		// Split [ln(2)] into a short head (exact when scaled by [e]) + a tail
+		y = Ops::Add(y, Ops::Mul(e, Ops::Set1(-2.12194440e-4f)));
+		y = Ops::Sub(y, Ops::Mul(m2, Ops::Set1(0.5f)));
+		return Ops::Add(Ops::Add(m, y), Ops::Mul(e, Ops::Set1(0.693359375f)));
+	}
+
+	// [dot(q, q)]
+	template<typename Ops>
+	inline typename Ops::F SqrMag(typename Ops::F x, typename Ops::F y, typename Ops::F z, typename Ops::F w)
+	{
+		return Ops::Add(Ops::Add(Ops::Add(Ops::Mul(x, x), Ops::Mul(y, y)), Ops::Mul(z, z)), Ops::Mul(w, w));
+	}
+
+	// One packet of [Ops::WIDTH] points
+	template<typename Ops>
+	inline typename Ops::F Packet(typename Ops::F px, typename Ops::F py, typename Ops::F pz,
+								  const typename Ops::F c[4])
+	{
+		using F = typename Ops::F;
+		using M = typename Ops::M;
+		F zx = px;
+		F zy = py;
+		F zz = pz;
+		F zw = c[3];
+		F dx = Ops::Set1(1.0f);
+		F dy = Ops::Set1(0.0f);
+		F dz = Ops::Set1(0.0f);
+		F dw = Ops::Set1(0.0f);
+		const F two = Ops::Set1(2.0f);
+		const F bailout = Ops::Set1(RefStuff::BAILOUT_JULIA_DE);
+
+		// Lanes stay active until they've escaped; escaped lanes keep the [z]/[dz] they
+		// bailed out with, exactly like the scalar loop's early exit
+		M active = Ops::Lt(SqrMag<Ops>(zx, zy, zz, zw), bailout);
+#if defined(__GNUC__) && !defined(__clang__)
+		#pragma GCC unroll 8
+#endif
+		for (u4Byte i = 0; i < RefStuff::ITERATIONS_JULIA; i += 1)
+		{
+			if (!Ops::Any(active)) { break; }
+
+			// [dz = QtnProduct2(z, dz) * 2]
+			const F imDot = Ops::Add(Ops::Add(Ops::Mul(zy, dy), Ops::Mul(zz, dz)), Ops::Mul(zw, dw));
+			const F ndx = Ops::Mul(Ops::Sub(Ops::Mul(zx, dx), imDot), two);
+			const F ndy = Ops::Mul(Ops::Add(Ops::Add(Ops::Mul(zx, dy), Ops::Mul(dx, zy)), Ops::Sub(Ops::Mul(zz, dw), Ops::Mul(zw, dz))), two);
+			const F ndz = Ops::Mul(Ops::Add(Ops::Add(Ops::Mul(zx, dz), Ops::Mul(dx, zz)), Ops::Sub(Ops::Mul(zw, dy), Ops::Mul(zy, dw))), two);
+			const F ndw = Ops::Mul(Ops::Add(Ops::Add(Ops::Mul(zx, dw), Ops::Mul(dx, zw)), Ops::Sub(Ops::Mul(zy, dz), Ops::Mul(zz, dy))), two);
+
+			// [z = QtnProduct2(z, z) + juliaCoeffs]; squaring cancels the cross product + doubles
+			// the imaginary terms, which is exact, so the shortcut matches the general product
+			const F zImSqr = Ops::Add(Ops::Add(Ops::Mul(zy, zy), Ops::Mul(zz, zz)), Ops::Mul(zw, zw));
+			const F zx2 = Ops::Mul(zx, two);
+			const F nzx = Ops::Add(Ops::Sub(Ops::Mul(zx, zx), zImSqr), c[0]);
+			const F nzy = Ops::Add(Ops::Mul(zx2, zy), c[1]);
+			const F nzz = Ops::Add(Ops::Mul(zx2, zz), c[2]);
+			const F nzw = Ops::Add(Ops::Mul(zx2, zw), c[3]);
+
+			dx = Ops::Select(active, ndx, dx);
+			dy = Ops::Select(active, ndy, dy);
+			dz = Ops::Select(active, ndz, dz);
+			dw = Ops::Select(active, ndw, dw);
+			zx = Ops::Select(active, nzx, zx);
+			zy = Ops::Select(active, nzy, zy);
+			zz = Ops::Select(active, nzz, zz);
+			zw = Ops::Select(active, nzw, zw);
+			active = Ops::And(active, Ops::Lt(SqrMag<Ops>(zx, zy, zz, zw), bailout));
+		}
+
+		// [0.5 * log(r) * r / length(dz)]
+		const F r = Ops::Sqrt(SqrMag<Ops>(zx, zy, zz, zw));
+		const F dr = Ops::Sqrt(SqrMag<Ops>(dx, dy, dz, dw));
+		return Ops::Div(Ops::Mul(Ops::Mul(Ops::Set1(0.5f), Log<Ops>(r)), r), dr);
+	}
+
+	// Whole batches; trailing points are padded out to a full packet
+	template<typename Ops>
+	inline void Julia(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z,
+					  float* dists, u4Byte numPts)
+	{
+		using F = typename Ops::F;
+		const F c[4] = { Ops::Set1(juliaCoeffs.x), Ops::Set1(juliaCoeffs.y),
+						 Ops::Set1(juliaCoeffs.z), Ops::Set1(juliaCoeffs.w) };
+		u4Byte i = 0;
+		for (; (i + Ops::WIDTH) <= numPts; i += Ops::WIDTH)
+		{
+			Ops::Store(dists + i, Packet<Ops>(Ops::Load(x + i), Ops::Load(y + i), Ops::Load(z + i), c));
+		}
+
+		if (i < numPts)
+		{
+			// Pad with the last point, so spare lanes bail out alongside real ones
+			float tail[4][Ops::WIDTH];
+			for (u4Byte j = 0; j < Ops::WIDTH; j += 1)
+			{
+				const u4Byte src = ((i + j) < numPts) ? (i + j) : (numPts - 1);
+				tail[0][j] = x[src];
+				tail[1][j] = y[src];
+				tail[2][j] = z[src];
+			}
+			Ops::Store(tail[3], Packet<Ops>(Ops::Load(tail[0]), Ops::Load(tail[1]), Ops::Load(tail[2]), c));
+			for (u4Byte j = 0; (i + j) < numPts; j += 1)
+			{
+				dists[i + j] = tail[3][j];
+			}
+		}
+	}
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <assert.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "RefGlobals.h"
+#include "RefShading.h"
+#include "JuliaPackets.h"
+
+void JuliaPackets::Julia(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z,
+						 float* dists, u4Byte numPts, CPUFeatures::ISAS isa)
+{
+	assert(CPUFeatures::Supported(isa));
+	switch (isa)
+	{
+		case CPUFeatures::ISAS::SCALAR:
+			for (u4Byte i = 0; i < numPts; i += 1)
+			{
+				dists[i] = RefShading::Julia(juliaCoeffs, { x[i], y[i], z[i] });
+			}
+			break;
+		case CPUFeatures::ISAS::SSE2:
+			JuliaSSE2(juliaCoeffs, x, y, z, dists, numPts);
+			break;
+		case CPUFeatures::ISAS::AVX2:
+			JuliaAVX2(juliaCoeffs, x, y, z, dists, numPts);
+			break;
+		case CPUFeatures::ISAS::AVX512:
+			JuliaAVX512(juliaCoeffs, x, y, z, dists, numPts);
+			break;
+	}
+}
+
+void JuliaPackets::Julia(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z,
+						 float* dists, u4Byte numPts)
+{
+	Julia(juliaCoeffs, x, y, z, dists, numPts, CPUFeatures::Best());
+}
+
+// Shared test set for [Valid(...)] + [Benchmark(...)]: points scattered through the
+// cube around the default planet (in planet space, where the fractal fits
+// inside [-1.5...1.5] on every axis), so packets mix lanes that escape
+// immediately with lanes that run every iteration
+namespace
+{
+	struct TestPts
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		RefMaths::float4 coeffs;
+
+		TestPts(u4Byte numPts) : x(numPts), y(numPts), z(numPts)
+		{
+			coeffs = { RefStuff::PLANET_JULIA_COEFFS[0], RefStuff::PLANET_JULIA_COEFFS[1],
+					   RefStuff::PLANET_JULIA_COEFFS[2], RefStuff::PLANET_JULIA_COEFFS[3] };
+			u4Byte rng = 0x9E3779B9;
+			auto next = [&rng]()
+			{
+				rng ^= rng << 13;
+				rng ^= rng >> 17;
+				rng ^= rng << 5;
+				return ((rng >> 8) / 16777216.0f) * 3.0f - 1.5f;
+			};
+			for (u4Byte i = 0; i < numPts; i += 1)
+			{
+				x[i] = next();
+				y[i] = next();
+				z[i] = next();
+			}
+		}
+	};
+
+	// Difference relative to the scalar estimate; distances shrink towards zero near the
+	// surface, so small estimates are compared against one instead (matching how
+	// the marchers treat distances below their epsilons as equivalent)
+	float RelErr(float packet, float scalar)
+	{
+		return fabsf(packet - scalar) / RefMaths::hmax(fabsf(scalar), 1.0f);
+	}
+
+	float MaxRelErr(const std::vector<float>& packets, const std::vector<float>& scalars)
+	{
+		float maxErr = 0.0f;
+		for (size_t i = 0; i < scalars.size(); i += 1)
+		{
+			maxErr = RefMaths::hmax(maxErr, RelErr(packets[i], scalars[i]));
+		}
+		return maxErr;
+	}
+}
+
+bool JuliaPackets::Valid(u4Byte numPts)
+{
+	// Odd sizes exercise every kernel's tail handling
+	const TestPts pts(numPts);
+	std::vector<float> scalars(numPts);
+	std::vector<float> packets(numPts);
+	Julia(pts.coeffs, pts.x.data(), pts.y.data(), pts.z.data(), scalars.data(), numPts, CPUFeatures::ISAS::SCALAR);
+
+	bool valid = true;
+	const CPUFeatures::ISAS isas[] = { CPUFeatures::ISAS::SSE2, CPUFeatures::ISAS::AVX2, CPUFeatures::ISAS::AVX512 };
+	for (CPUFeatures::ISAS isa : isas)
+	{
+		if (!CPUFeatures::Supported(isa)) { continue; }
+		Julia(pts.coeffs, pts.x.data(), pts.y.data(), pts.z.data(), packets.data(), numPts, isa);
+		const float maxErr = MaxRelErr(packets, scalars);
+		if (!(maxErr <= MAX_REL_ERR))
+		{
+			printf("%s Julia packets differ from the scalar estimator by up to %g\n", CPUFeatures::Name(isa), maxErr);
+			valid = false;
+		}
+	}
+	return valid;
+}
+
+u4Byte JuliaPackets::Benchmark(u4Byte numPts, Timing* timings)
+{
+	const TestPts pts(numPts);
+	std::vector<float> scalars(numPts);
+	std::vector<float> packets(numPts);
+
+	// Best of a few passes, to keep one-off stalls (page faults on the first
+	// pass, scheduler noise) out of the rates
+	constexpr u4Byte NUM_PASSES = 3;
+	u4Byte numTimings = 0;
+	const CPUFeatures::ISAS isas[] = { CPUFeatures::ISAS::SCALAR, CPUFeatures::ISAS::SSE2,
+									   CPUFeatures::ISAS::AVX2, CPUFeatures::ISAS::AVX512 };
+	const u4Byte widths[] = { 1, 4, 8, 16 };
+	for (u4Byte i = 0; i < 4; i += 1)
+	{
+		if (!CPUFeatures::Supported(isas[i])) { continue; }
+		std::vector<float>& dists = (isas[i] == CPUFeatures::ISAS::SCALAR) ? scalars : packets;
+		double bestSecs = HUGE_VAL;
+		for (u4Byte j = 0; j < NUM_PASSES; j += 1)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			Julia(pts.coeffs, pts.x.data(), pts.y.data(), pts.z.data(), dists.data(), numPts, isas[i]);
+			const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			bestSecs = (secs < bestSecs) ? secs : bestSecs;
+		}
+
+		Timing& timing = timings[numTimings];
+		timing.isa = isas[i];
+		timing.width = widths[i];
+		timing.ptsPerSec = (bestSecs > 0.0) ? numPts / bestSecs : 0.0;
+		timing.maxRelErr = (isas[i] == CPUFeatures::ISAS::SCALAR) ? 0.0f : MaxRelErr(packets, scalars);
+		numTimings += 1;
+	}
+	return numTimings;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "RefMaths.h"
+#include "CPUFeatures.h"
+
+// Packet evaluator for the quaternion Julia distance estimator ([Julia(...)] in
+// [Fractals.hlsli], ported to [RefShading::Julia(...)])
+// Points are passed as structure-of-arrays + evaluated 4 (SSE2), 8 (AVX2) or
+// 16 (AVX-512) at a time, one point per SIMD lane; the iteration loop is
+// unrolled, and lanes that bail out are masked off (frozen) instead of
+// branching, so every lane reproduces the scalar estimator's early exit
+// Kernels for each instruction set live in their own translation units
+// (compiled with the matching target flags); [Julia(...)] picks the widest one
+// the running CPU supports (see [CPUFeatures])
+class JuliaPackets
+{
+	public:
+		// Per-instruction-set results from [Benchmark(...)]
+		struct Timing
+		{
+			CPUFeatures::ISAS isa;
+			u4Byte width; // Points per packet
+			double ptsPerSec;
+			float maxRelErr; // Largest relative difference from the scalar estimator
+		};
+
+		// Estimate distances for [numPts] planet-space points with [isa]'s kernel;
+		// [isa] must be supported by the running CPU
+		static void Julia(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z,
+						  float* dists, u4Byte numPts, CPUFeatures::ISAS isa);
+
+		// As above, with the widest available kernel
+		static void Julia(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z,
+						  float* dists, u4Byte numPts);
+
+		// Largest relative difference allowed between packet + scalar estimates; kernels
+		// share the scalar estimator's arithmetic, but use a polynomial [log] (see
+		// [JuliaKernel.inl])
+		static constexpr float MAX_REL_ERR = 1e-4f;
+
+		// Compare every available kernel against the scalar estimator over
+		// [numPts] random points around the default planet
+		static bool Valid(u4Byte numPts);
+
+		// Time the scalar estimator + every available kernel over [numPts] random
+		// points; writes one [Timing] per instruction set tested into [timings]
+		// (which should have room for four) + returns how many were written
+		static u4Byte Benchmark(u4Byte numPts, Timing* timings);
+
+	private:
+		// Kernels (see JuliaPackets[SSE2|AVX2|AVX512].cpp)
+		static void JuliaSSE2(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z, float* dists, u4Byte numPts);
+		static void JuliaAVX2(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z, float* dists, u4Byte numPts);
+		static void JuliaAVX512(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z, float* dists, u4Byte numPts);
+};
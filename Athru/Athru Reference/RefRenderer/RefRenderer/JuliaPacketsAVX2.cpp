@@ -0,0 +1,52 @@
+#include <immintrin.h>
+#include "RefGlobals.h"
+#include "JuliaPackets.h"
+
+// Compiled for AVX2 + FMA (per-file [EnableEnhancedInstructionSet] under MSVC); only
+// reached once [CPUFeatures] has confirmed the running CPU supports both
+// Shared headers are included above the target switch, so inline functions they
+// define (which the linker may merge with other files' copies) stay baseline-only
+#if defined(__GNUC__)
+	#pragma GCC target("avx2,fma")
+#endif
+
+#include "JuliaKernel.inl"
+
+// Eight-wide Julia packets
+namespace
+{
+	struct OpsAVX2
+	{
+		using F = __m256;
+		using M = __m256;
+		static constexpr u4Byte WIDTH = 8;
+
+		static F Set1(float f) { return _mm256_set1_ps(f); }
+		static F Load(const float* p) { return _mm256_loadu_ps(p); }
+		static void Store(float* p, F v) { _mm256_storeu_ps(p, v); }
+		static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+		static F Div(F a, F b) { return _mm256_div_ps(a, b); }
+		static F Sqrt(F a) { return _mm256_sqrt_ps(a); }
+		static M Lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static M And(M a, M b) { return _mm256_and_ps(a, b); }
+		static bool Any(M m) { return _mm256_movemask_ps(m) != 0; }
+		static F Select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+		static F Exponent(F x)
+		{
+			const __m256i e = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(x), 23), _mm256_set1_epi32(126));
+			return _mm256_cvtepi32_ps(e);
+		}
+		static F Mantissa(F x)
+		{
+			const __m256i m = _mm256_and_si256(_mm256_castps_si256(x), _mm256_set1_epi32(0x807FFFFF));
+			return _mm256_castsi256_ps(_mm256_or_si256(m, _mm256_set1_epi32(0x3F000000)));
+		}
+	};
+}
+
+void JuliaPackets::JuliaAVX2(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z, float* dists, u4Byte numPts)
+{
+	JuliaKernel::Julia<OpsAVX2>(juliaCoeffs, x, y, z, dists, numPts);
+}
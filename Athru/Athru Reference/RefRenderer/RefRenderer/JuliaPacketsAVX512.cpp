@@ -0,0 +1,57 @@
+#include <immintrin.h>
+#include "RefGlobals.h"
+#include "JuliaPackets.h"
+
+// Compiled for AVX-512F (per-file [EnableEnhancedInstructionSet] under MSVC); only
+// reached once [CPUFeatures] has confirmed the running CPU supports it
+// Shared headers are included above the target switch, so inline functions they
+// define (which the linker may merge with other files' copies) stay baseline-only
+#if defined(__GNUC__)
+	#pragma GCC target("avx512f")
+#endif
+
+#include "JuliaKernel.inl"
+
+// Sixteen-wide Julia packets; lane masks live in mask registers instead of
+// vectors, so blends + the early-out test are single instructions
+// Square roots, shifts + conversions use the zero-masking forms under a full mask,
+// since GCC's plain forms merge into an uninitialized register + trip
+// [-Wmaybe-uninitialized] (the generated instructions are the same)
+namespace
+{
+	struct OpsAVX512
+	{
+		using F = __m512;
+		using M = __mmask16;
+		static constexpr u4Byte WIDTH = 16;
+		static constexpr M ALL = 0xFFFF;
+
+		static F Set1(float f) { return _mm512_set1_ps(f); }
+		static F Load(const float* p) { return _mm512_loadu_ps(p); }
+		static void Store(float* p, F v) { _mm512_storeu_ps(p, v); }
+		static F Add(F a, F b) { return _mm512_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm512_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm512_mul_ps(a, b); }
+		static F Div(F a, F b) { return _mm512_div_ps(a, b); }
+		static F Sqrt(F a) { return _mm512_maskz_sqrt_ps(ALL, a); }
+		static M Lt(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+		static M And(M a, M b) { return (M)(a & b); }
+		static bool Any(M m) { return m != 0; }
+		static F Select(M m, F a, F b) { return _mm512_mask_blend_ps(m, b, a); }
+		static F Exponent(F x)
+		{
+			const __m512i e = _mm512_sub_epi32(_mm512_maskz_srli_epi32(ALL, _mm512_castps_si512(x), 23), _mm512_set1_epi32(126));
+			return _mm512_maskz_cvtepi32_ps(ALL, e);
+		}
+		static F Mantissa(F x)
+		{
+			const __m512i m = _mm512_and_si512(_mm512_castps_si512(x), _mm512_set1_epi32(0x807FFFFF));
+			return _mm512_castsi512_ps(_mm512_or_si512(m, _mm512_set1_epi32(0x3F000000)));
+		}
+	};
+}
+
+void JuliaPackets::JuliaAVX512(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z, float* dists, u4Byte numPts)
+{
+	JuliaKernel::Julia<OpsAVX512>(juliaCoeffs, x, y, z, dists, numPts);
+}
@@ -0,0 +1,42 @@
+#include <emmintrin.h>
+#include "JuliaKernel.inl"
+
+// Four-wide Julia packets; SSE2 is part of the x64 baseline, so this file needs no
+// special compiler flags
+namespace
+{
+	struct OpsSSE2
+	{
+		using F = __m128;
+		using M = __m128;
+		static constexpr u4Byte WIDTH = 4;
+
+		static F Set1(float f) { return _mm_set1_ps(f); }
+		static F Load(const float* p) { return _mm_loadu_ps(p); }
+		static void Store(float* p, F v) { _mm_storeu_ps(p, v); }
+		static F Add(F a, F b) { return _mm_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+		static F Div(F a, F b) { return _mm_div_ps(a, b); }
+		static F Sqrt(F a) { return _mm_sqrt_ps(a); }
+		static M Lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+		static M And(M a, M b) { return _mm_and_ps(a, b); }
+		static bool Any(M m) { return _mm_movemask_ps(m) != 0; }
+		static F Select(M m, F a, F b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+		static F Exponent(F x)
+		{
+			const __m128i e = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(126));
+			return _mm_cvtepi32_ps(e);
+		}
+		static F Mantissa(F x)
+		{
+			const __m128i m = _mm_and_si128(_mm_castps_si128(x), _mm_set1_epi32(0x807FFFFF));
+			return _mm_castsi128_ps(_mm_or_si128(m, _mm_set1_epi32(0x3F000000)));
+		}
+	};
+}
+
+void JuliaPackets::JuliaSSE2(RefMaths::float4 juliaCoeffs, const float* x, const float* y, const float* z, float* dists, u4Byte numPts)
+{
+	JuliaKernel::Julia<OpsSSE2>(juliaCoeffs, x, y, z, dists, numPts);
+}
@@ -0,0 +1,214 @@
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "RefGlobals.h"
+#include "MarchLab.h"
+#include "lodepng.h"
+
+using namespace RefMaths;
+using namespace RefMarching;
+
+// Map [x] (in [0...1]) onto a black -> purple -> orange -> yellow ramp
+static void HeatRGBA(float x, uByte rgba[4])
+{
+	constexpr u4Byte NUM_STOPS = 5;
+	const float stops[NUM_STOPS][3] = { { 0.0f, 0.0f, 0.02f }, { 0.34f, 0.06f, 0.43f }, { 0.73f, 0.21f, 0.33f },
+										{ 0.98f, 0.55f, 0.04f }, { 0.99f, 1.0f, 0.64f } };
+	const float pos = std::min(std::max(x, 0.0f), 1.0f) * (NUM_STOPS - 1);
+	const u4Byte stop = std::min((u4Byte)pos, NUM_STOPS - 2);
+	const float s = pos - stop;
+	for (u4Byte i = 0; i < 3; i += 1)
+	{
+		const float c = stops[stop][i] + (stops[stop + 1][i] - stops[stop][i]) * s;
+		rgba[i] = (uByte)(c * 255.0f + 0.5f);
+	}
+	rgba[3] = 255;
+}
+
+// Write [counts] as a heatmap scaled against [maxCount]
+static bool SaveHeatmap(const char* path, const std::vector<u4Byte>& counts, u4Byte maxCount, u4Byte width, u4Byte height)
+{
+	std::vector<uByte> rgba((size_t)width * height * 4);
+	for (size_t i = 0; i < counts.size(); i += 1)
+	{
+		HeatRGBA((maxCount > 0) ? (float)counts[i] / maxCount : 0.0f, &rgba[i * 4]);
+	}
+	return lodepng_encode32_file(path, rgba.data(), width, height) == 0;
+}
+
+bool MarchLab::Run(const Settings& settings, Stats stats[NUM_STRATEGIES], PrepassStats& prepass)
+{
+	const u4Byte width = settings.width;
+	const u4Byte height = settings.height;
+	const u4Byte area = width * height;
+	const u4Byte numThreads = (settings.numThreads != 0) ? settings.numThreads : std::max(std::thread::hardware_concurrency(), 1u);
+	const RefShading::SceneInfo scene = RefShading::DefaultScene();
+
+	// Same basis + projection as [RefRenderer], without sub-pixel jitter
+	const float3 zAxis = normalize(settings.cameraLook);
+	const float3 xAxis = normalize(cross(float3{ 0.0f, 1.0f, 0.0f }, zAxis));
+	const float3 viewBasis[3] = { xAxis, cross(zAxis, xAxis), zAxis };
+	auto viewDir = [&](float x, float y)
+	{
+		const float3 dir = normalize(float3{ x - (width / 2.0f), y - (height / 2.0f),
+											 height / tanf((0.5f * RefStuff::PI) / 2.0f) });
+		return mul(dir, viewBasis);
+	};
+
+	// Run [rowFn(row)] for every row in [0...numRows), claiming rows between workers;
+	// returns the wall-clock time taken
+	auto forRows = [numThreads](u4Byte numRows, auto rowFn)
+	{
+		std::atomic<u4Byte> nextRow = 0;
+		auto worker = [&]()
+		{
+			for (u4Byte row = nextRow.fetch_add(1); row < numRows; row = nextRow.fetch_add(1))
+			{
+				rowFn(row);
+			}
+		};
+
+		const auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> workers;
+		workers.reserve(numThreads - 1);
+		for (u4Byte i = 1; i < numThreads; i += 1)
+		{
+			workers.emplace_back(worker);
+		}
+		worker();
+		for (std::thread& t : workers)
+		{
+			t.join();
+		}
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	// Optional cone-marching prepass; one cone per tile, bounding the tile's
+	// pixel edges
+	const u4Byte coneTile = settings.coneTileWidth;
+	const u4Byte coneTilingWidth = (coneTile != 0) ? (width + coneTile - 1) / coneTile : 0;
+	const u4Byte coneTilingHeight = (coneTile != 0) ? (height + coneTile - 1) / coneTile : 0;
+	std::vector<ConeResult> cones((size_t)coneTilingWidth * coneTilingHeight);
+	const MarchParams coneParams = ShaderParams();
+	prepass.numCones = (u4Byte)cones.size();
+	prepass.secs = forRows(coneTilingHeight, [&](u4Byte row)
+	{
+		for (u4Byte i = 0; i < coneTilingWidth; i += 1)
+		{
+			const float x0 = (float)(i * coneTile);
+			const float y0 = (float)(row * coneTile);
+			const float x1 = (float)std::min((i + 1) * coneTile, width);
+			const float y1 = (float)std::min((row + 1) * coneTile, height);
+			const float3 corners[4] = { viewDir(x0, y0), viewDir(x1, y0), viewDir(x0, y1), viewDir(x1, y1) };
+			cones[i + (row * coneTilingWidth)] = ConeMarch(settings.cameraPos, corners, scene, coneParams);
+		}
+	});
+	u8Byte numConeEvals = 0;
+	double coneSkips = 0.0;
+	for (const ConeResult& cone : cones)
+	{
+		numConeEvals += cone.evals;
+		coneSkips += cone.tSafe;
+	}
+	prepass.meanEvals = (double)numConeEvals / area;
+	prepass.meanSkip = cones.empty() ? 0.0 : coneSkips / cones.size();
+	auto tStart = [&](u4Byte ndx)
+	{
+		if (coneTile == 0) { return 0.0f; }
+		return cones[((ndx % width) / coneTile) + (((ndx / width) / coneTile) * coneTilingWidth)].tSafe;
+	};
+
+	// March every strategy over every pixel, plus plain sphere tracing without
+	// the prepass for reference
+	std::vector<MarchResult> results[NUM_STRATEGIES];
+	std::vector<MarchResult> sphere(area);
+	forRows(height, [&](u4Byte row)
+	{
+		for (u4Byte i = row * width; i < (row + 1) * width; i += 1)
+		{
+			MarchParams params = ShaderParams();
+			params.strategy = STRATEGIES::SPHERE;
+			sphere[i] = March(settings.cameraPos, viewDir((i % width) + 0.5f, row + 0.5f), scene, params);
+		}
+	});
+	for (u4Byte s = 0; s < NUM_STRATEGIES; s += 1)
+	{
+		MarchParams params = ShaderParams();
+		params.strategy = (STRATEGIES)s;
+		params.omega = settings.omega;
+		params.epsGrowth = settings.epsGrowth;
+		results[s].resize(area);
+		stats[s].secs = forRows(height, [&](u4Byte row)
+		{
+			for (u4Byte i = row * width; i < (row + 1) * width; i += 1)
+			{
+				results[s][i] = March(settings.cameraPos, viewDir((i % width) + 0.5f, row + 0.5f), scene, params, tStart(i));
+			}
+		});
+	}
+
+	// Summarize each strategy against plain sphere tracing
+	u8Byte numBaselineEvals = 0;
+	for (const MarchResult& march : sphere) { numBaselineEvals += march.evals; }
+	prepass.baselineEvals = (double)numBaselineEvals / area;
+	u4Byte maxSteps = 0;
+	u4Byte maxEvals = 0;
+	for (u4Byte s = 0; s < NUM_STRATEGIES; s += 1)
+	{
+		Stats& stat = stats[s];
+		stat.strategy = (STRATEGIES)s;
+		stat.maxSteps = 0;
+		u8Byte numSteps = 0;
+		u8Byte numEvals = 0;
+		u4Byte numHits = 0;
+		u4Byte numExhausted = 0;
+		u4Byte numMismatches = 0;
+		u4Byte numCoHits = 0;
+		double hitDeltas = 0.0;
+		for (u4Byte i = 0; i < area; i += 1)
+		{
+			const MarchResult& march = results[s][i];
+			const bool hit = march.outcome == OUTCOMES::HIT;
+			const bool sphereHit = sphere[i].outcome == OUTCOMES::HIT;
+			numSteps += march.steps;
+			numEvals += march.evals;
+			stat.maxSteps = std::max(stat.maxSteps, march.steps);
+			maxEvals = std::max(maxEvals, march.evals);
+			numHits += hit ? 1 : 0;
+			numExhausted += (march.outcome == OUTCOMES::EXHAUSTED) ? 1 : 0;
+			numMismatches += (hit != sphereHit || (hit && march.field.figID != sphere[i].field.figID)) ? 1 : 0;
+			if (hit && sphereHit)
+			{
+				numCoHits += 1;
+				hitDeltas += fabsf(march.t - sphere[i].t);
+			}
+		}
+		maxSteps = std::max(maxSteps, stat.maxSteps);
+		stat.meanSteps = (double)numSteps / area;
+		stat.meanEvals = (double)numEvals / area;
+		stat.hitRate = (double)numHits / area;
+		stat.exhaustedRate = (double)numExhausted / area;
+		stat.mismatchRate = (double)numMismatches / area;
+		stat.meanHitDelta = (numCoHits > 0) ? hitDeltas / numCoHits : 0.0;
+	}
+
+	// Heatmaps
+	if (settings.outPrefix == nullptr) { return true; }
+	bool saved = true;
+	std::vector<u4Byte> counts(area);
+	for (u4Byte s = 0; s < NUM_STRATEGIES; s += 1)
+	{
+		char path[512];
+		for (u4Byte i = 0; i < area; i += 1) { counts[i] = results[s][i].steps; }
+		snprintf(path, sizeof(path), "%s-%s-steps.png", settings.outPrefix, Name((STRATEGIES)s));
+		saved = SaveHeatmap(path, counts, maxSteps, width, height) && saved;
+		for (u4Byte i = 0; i < area; i += 1) { counts[i] = results[s][i].evals; }
+		snprintf(path, sizeof(path), "%s-%s-evals.png", settings.outPrefix, Name((STRATEGIES)s));
+		saved = SaveHeatmap(path, counts, maxEvals, width, height) && saved;
+	}
+	return saved;
+}
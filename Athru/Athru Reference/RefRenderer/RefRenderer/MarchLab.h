@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "RefMaths.h"
+#include "RefMarching.h"
+
+// Compares [RefMarching]'s strategies on the default system; marches one
+// primary ray through every pixel centre with each strategy, measuring steps,
+// scene-field evaluations + how often the strategies disagree with plain
+// sphere tracing about what (+ where) each ray hits
+// Rays can optionally start from distances found by a cone-marching prepass
+// over screen tiles; the sphere-traced reference always marches without it
+// Heatmaps of per-pixel steps/evaluations share one scale across strategies,
+// so images from the same run can be compared directly
+class MarchLab
+{
+	public:
+		struct Settings
+		{
+			u4Byte width;
+			u4Byte height;
+			RefMaths::float3 cameraPos;
+			RefMaths::float3 cameraLook; // View direction (not the focal position)
+			u4Byte numThreads; // Zero for one worker per hardware thread
+			float omega; // Relaxation for [RELAXED] + the relaxation cap for [ENHANCED]
+			float epsGrowth; // Hit-epsilon scale per step
+			u4Byte coneTileWidth; // Pixels per side of each prepass tile; zero skips the prepass
+			const char* outPrefix; // Heatmaps go to [<outPrefix>-<strategy>-steps.png] + [...-evals.png]; null to skip them
+		};
+
+		struct Stats
+		{
+			RefMarching::STRATEGIES strategy;
+			double meanSteps;
+			u4Byte maxSteps;
+			double meanEvals;
+			double hitRate; // Rays ending on a surface
+			double exhaustedRate; // Rays running out of steps
+			double mismatchRate; // Rays hitting a different figure to [SPHERE] without the prepass (or hitting when it doesn't, or vice versa)
+			double meanHitDelta; // Mean distance between this strategy's hits + the reference's, for rays where both hit
+			double secs; // Wall-clock time across every worker
+		};
+
+		struct PrepassStats
+		{
+			u4Byte numCones;
+			double meanEvals; // Per pixel
+			double meanSkip; // Mean safe start distance
+			double secs;
+			double baselineEvals; // Mean evaluations per pixel for the reference (sphere tracing without the prepass)
+		};
+
+		// Run the prepass (if enabled) + every strategy, filling [stats] (one per
+		// strategy, in [STRATEGIES] order) + [prepass]; returns false if any heatmap
+		// couldn't be written
+		static bool Run(const Settings& settings, Stats stats[RefMarching::NUM_STRATEGIES], PrepassStats& prepass);
+};
@@ -0,0 +1,178 @@
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "PathQueues.h"
+
+PathQueues::PathQueues(u4Byte maxPaths, u4Byte numWorkers) :
+	locals(numWorkers)
+{
+	// Every path can land in a full chunk, and each worker can leave one padded
+	// chunk per queue at the end of a stage
+	capacity = ((maxPaths + CHUNK_SIZE - 1) / CHUNK_SIZE) + numWorkers;
+	for (u4Byte i = 0; i < NUM_QUEUES; i += 1)
+	{
+		tails[i].numChunks = 0;
+		shared[i].resize(capacity);
+	}
+
+	for (LocalQueues& local : locals)
+	{
+		memset(local.counts, 0, sizeof(local.counts));
+	}
+}
+
+void PathQueues::Publish(u4Byte worker, u4Byte q)
+{
+	LocalQueues& local = locals[worker];
+	const u4Byte chunk = tails[q].numChunks.fetch_add(1, std::memory_order_relaxed);
+	assert(chunk < capacity);
+	memcpy(shared[q][chunk].paths, local.paths[q], sizeof(Chunk));
+	local.counts[q] = 0;
+}
+
+void PathQueues::Flush(u4Byte worker)
+{
+	LocalQueues& local = locals[worker];
+	for (u4Byte i = 0; i < NUM_QUEUES; i += 1)
+	{
+		if (local.counts[i] == 0) { continue; }
+		for (u4Byte j = local.counts[i]; j < CHUNK_SIZE; j += 1)
+		{
+			local.paths[i][j] = NO_PATH;
+		}
+		Publish(worker, i);
+	}
+}
+
+const u4Byte* PathQueues::Compact(QUEUES queue, u4Byte& numPaths)
+{
+	// Compact in place; the write cursor never passes the read cursor
+	const u4Byte q = (u4Byte)queue;
+	u4Byte* paths = shared[q].data()->paths;
+	const u4Byte numSlots = tails[q].numChunks.load(std::memory_order_relaxed) * CHUNK_SIZE;
+	u4Byte numDense = 0;
+	for (u4Byte i = 0; i < numSlots; i += 1)
+	{
+		const u4Byte path = paths[i];
+		paths[numDense] = path;
+		numDense += (path != NO_PATH) ? 1 : 0;
+	}
+	tails[q].numChunks.store(0, std::memory_order_relaxed);
+	numPaths = numDense;
+	return paths;
+}
+
+bool PathQueues::Benchmark(u4Byte numPaths, u4Byte numWorkers, double nsPerPath[3])
+{
+	// Scatter paths between materials with a hash, so every queue sees
+	// interleaved pushes from every worker
+	auto material = [](u4Byte path)
+	{
+		u4Byte h = path * 0x9E3779B9;
+		h ^= h >> 16;
+		return 1 + (h % NUM_MATERIALS);
+	};
+
+	// Run [push(w, path)] over worker [w]'s share of the paths on every worker,
+	// then [finish(w)]
+	auto timed = [numPaths, numWorkers](auto push, auto finish)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		std::vector<std::thread> workers;
+		workers.reserve(numWorkers);
+		for (u4Byte w = 0; w < numWorkers; w += 1)
+		{
+			workers.emplace_back([=]()
+			{
+				const u4Byte first = (u4Byte)(((u8Byte)numPaths * w) / numWorkers);
+				const u4Byte last = (u4Byte)(((u8Byte)numPaths * (w + 1)) / numWorkers);
+				for (u4Byte path = first; path < last; path += 1)
+				{
+					push(w, path);
+				}
+				finish(w);
+			});
+		}
+		for (std::thread& t : workers) { t.join(); }
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	// Best of a few passes, to keep one-off stalls (page faults, thread start-up
+	// hiccups) out of the rates
+	constexpr u4Byte NUM_PASSES = 3;
+	double bestSecs[3] = { 1e30, 1e30, 1e30 };
+	std::vector<u4Byte> results[3][NUM_MATERIALS];
+	for (u4Byte pass = 0; pass < NUM_PASSES; pass += 1)
+	{
+		// Chunked per-worker queues (includes compaction)
+		{
+			PathQueues queues(numPaths, numWorkers);
+			const auto start = std::chrono::steady_clock::now();
+			timed([&](u4Byte w, u4Byte path) { queues.Push(w, (QUEUES)material(path), path); },
+				  [&](u4Byte w) { queues.Flush(w); });
+			const u4Byte* paths[NUM_MATERIALS];
+			u4Byte counts[NUM_MATERIALS];
+			for (u4Byte i = 0; i < NUM_MATERIALS; i += 1)
+			{
+				paths[i] = queues.Compact((QUEUES)(i + 1), counts[i]);
+			}
+			const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			bestSecs[0] = std::min(bestSecs[0], secs);
+			for (u4Byte i = 0; i < NUM_MATERIALS; i += 1) { results[0][i].assign(paths[i], paths[i] + counts[i]); }
+		}
+
+		// One mutex per queue, taken for every path
+		{
+			std::mutex locks[NUM_MATERIALS];
+			std::vector<u4Byte> queues[NUM_MATERIALS];
+			for (std::vector<u4Byte>& q : queues) { q.reserve(numPaths); }
+			const double secs = timed([&](u4Byte, u4Byte path)
+			{
+				const u4Byte q = material(path) - 1;
+				std::lock_guard<std::mutex> lock(locks[q]);
+				queues[q].push_back(path);
+			}, [](u4Byte) {});
+			bestSecs[1] = std::min(bestSecs[1], secs);
+			for (u4Byte i = 0; i < NUM_MATERIALS; i += 1) { results[1][i] = std::move(queues[i]); }
+		}
+
+		// One atomic increment per path, like [AppendStructuredBuffer]
+		{
+			std::atomic<u4Byte> tails[NUM_MATERIALS];
+			std::vector<u4Byte> queues[NUM_MATERIALS];
+			for (u4Byte i = 0; i < NUM_MATERIALS; i += 1)
+			{
+				tails[i] = 0;
+				queues[i].resize(numPaths);
+			}
+			const double secs = timed([&](u4Byte, u4Byte path)
+			{
+				const u4Byte q = material(path) - 1;
+				queues[q][tails[q].fetch_add(1, std::memory_order_relaxed)] = path;
+			}, [](u4Byte) {});
+			bestSecs[2] = std::min(bestSecs[2], secs);
+			for (u4Byte i = 0; i < NUM_MATERIALS; i += 1)
+			{
+				queues[i].resize(tails[i]);
+				results[2][i] = std::move(queues[i]);
+			}
+		}
+	}
+
+	// Every approach should collect exactly the same paths for each material
+	bool valid = true;
+	for (u4Byte i = 0; i < NUM_MATERIALS; i += 1)
+	{
+		for (u4Byte j = 0; j < 3; j += 1) { std::sort(results[j][i].begin(), results[j][i].end()); }
+		valid = valid && results[0][i] == results[1][i] && results[0][i] == results[2][i];
+	}
+
+	for (u4Byte i = 0; i < 3; i += 1)
+	{
+		nsPerPath[i] = (numPaths > 0) ? (bestSecs[i] * 1e9) / numPaths : 0.0;
+	}
+	return valid;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "Typedefs.h"
+
+// CPU stand-in for the path tracer's append/consume buffers ([traceables] +
+// the six per-material intersection buffers shared by [RayMarch.hlsl] and
+// [SurfSampler.hlsl])
+// Each worker appends into its own cache-line-sized chunk per queue, and only
+// touches shared state when a chunk fills up: one atomic claims a whole line
+// in the shared queue, so appends cost no atomics (+ workers never write to
+// the same cache line) however many paths they push
+// Chunks flushed before they fill are padded with [NO_PATH]; [Compact(...)]
+// squeezes those out between stages, leaving a dense list of paths for the
+// next stage to consume (the work [RnderDispEditor] + the append counters do
+// on the GPU)
+class PathQueues
+{
+	public:
+		// Queues, in the same order as the GPU's counters
+		enum class QUEUES
+		{
+			TRACEABLES,
+			DIFFU_ISECTIONS,
+			MIRRO_ISECTIONS,
+			REFRA_ISECTIONS,
+			SNOWW_ISECTIONS,
+			SSURF_ISECTIONS,
+			FURRY_ISECTIONS
+		};
+		static constexpr u4Byte NUM_QUEUES = 7;
+		static constexpr u4Byte NUM_MATERIALS = 6; // Every queue after [TRACEABLES]
+
+		// Paths per chunk; one 64-byte cache line of path IDs
+		static constexpr u4Byte CHUNK_SIZE = 16;
+
+		// Padding for partially-filled chunks
+		static constexpr u4Byte NO_PATH = 0xFFFFFFFF;
+
+		// Queues for up to [maxPaths] paths each, fed by [numWorkers] workers
+		PathQueues(u4Byte maxPaths, u4Byte numWorkers);
+		~PathQueues() = default;
+
+		// Append [path] to [queue] from [worker]; no other thread may push from
+		// the same worker ID at the same time
+		void Push(u4Byte worker, QUEUES queue, u4Byte path)
+		{
+			LocalQueues& local = locals[worker];
+			const u4Byte q = (u4Byte)queue;
+			local.paths[q][local.counts[q]] = path;
+			local.counts[q] += 1;
+			if (local.counts[q] == CHUNK_SIZE) { Publish(worker, q); }
+		}
+
+		// Publish [worker]'s partially-filled chunks; call once per worker at the
+		// end of every stage that pushes paths
+		void Flush(u4Byte worker);
+
+		// Squeeze padding out of [queue] + reset it for the next stage; returns
+		// the dense path list (valid until the next push to [queue]) + writes its
+		// length into [numPaths]
+		// Must not overlap pushes to [queue]; path order depends on how work was
+		// spread between workers
+		const u4Byte* Compact(QUEUES queue, u4Byte& numPaths);
+
+		// Push [numPaths] paths into the material queues with [numWorkers] threads
+		// through [PathQueues], a mutex-guarded baseline + a baseline with one
+		// atomic increment per path, checking that all three collect the same
+		// paths; writes nanoseconds per path for each into [nsPerPath] (chunked,
+		// mutex, atomic), or returns false if the results disagree
+		static bool Benchmark(u4Byte numPaths, u4Byte numWorkers, double nsPerPath[3]);
+
+	private:
+		// Copy [worker]'s chunk for queue [q] into the shared queue
+		void Publish(u4Byte worker, u4Byte q);
+
+		// Per-worker chunks; aligned so neighbouring workers never share lines
+		struct alignas(64) LocalQueues
+		{
+			u4Byte paths[NUM_QUEUES][CHUNK_SIZE];
+			u4Byte counts[NUM_QUEUES];
+		};
+
+		// Shared queue storage, in whole lines
+		struct alignas(64) Chunk
+		{
+			u4Byte paths[CHUNK_SIZE];
+		};
+
+		// Shared queue tails (in chunks), one line each
+		struct alignas(64) Tail
+		{
+			std::atomic<u4Byte> numChunks;
+		};
+
+		u4Byte capacity; // Chunks per shared queue
+		std::vector<LocalQueues> locals;
+		Tail tails[NUM_QUEUES];
+		std::vector<Chunk> shared[NUM_QUEUES];
+};
@@ -0,0 +1,120 @@
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "RefGlobals.h"
+#include "RefShading.h"
+#include "RefMarching.h"
+#include "PlanetGrads.h"
+
+using namespace RefMaths;
+using namespace RefShading;
+
+// Points where camera rays from the default view meet the default planet,
+// backed off by the tracing epsilon ([SurfSampler.hlsl]); rays are spread over
+// the view with a fixed xorshift sequence, so every run sees the same points
+static std::vector<float3> ShadingPoints(u4Byte numPts, const SceneInfo& scene)
+{
+	const float3 cameraPos = { RefStuff::DEFAULT_CAMERA_POS[0], RefStuff::DEFAULT_CAMERA_POS[1], RefStuff::DEFAULT_CAMERA_POS[2] };
+	const float3 zAxis = normalize(float3{ RefStuff::DEFAULT_CAMERA_LOOK[0], RefStuff::DEFAULT_CAMERA_LOOK[1], RefStuff::DEFAULT_CAMERA_LOOK[2] });
+	const float3 xAxis = normalize(cross(float3{ 0.0f, 1.0f, 0.0f }, zAxis));
+	const float3 viewBasis[3] = { xAxis, cross(zAxis, xAxis), zAxis };
+	const float width = (float)RefStuff::DEFAULT_DISPLAY_WIDTH;
+	const float height = (float)RefStuff::DEFAULT_DISPLAY_HEIGHT;
+	const RefMarching::MarchParams params = RefMarching::ShaderParams();
+
+	std::vector<float3> pts;
+	pts.reserve(numPts);
+	u4Byte rand = 0x9E3779B9;
+	auto rand01 = [&rand]()
+	{
+		rand ^= rand << 13;
+		rand ^= rand >> 17;
+		rand ^= rand << 5;
+		return (rand >> 8) / 16777216.0f;
+	};
+
+	// Most of the view is empty space, so give up after plenty of misses
+	const u8Byte maxRays = (u8Byte)numPts * 64;
+	for (u8Byte i = 0; i < maxRays && pts.size() < numPts; i += 1)
+	{
+		const float3 dir = mul(normalize(float3{ (rand01() - 0.5f) * width, (rand01() - 0.5f) * height,
+												 height / tanf((0.5f * RefStuff::PI) / 2.0f) }), viewBasis);
+		const RefMarching::MarchResult march = RefMarching::March(cameraPos, dir, scene, params);
+		if (march.outcome == RefMarching::OUTCOMES::HIT && march.field.figID != (float)RefStuff::STELLAR_FIG_ID)
+		{
+			pts.push_back(march.pos - dir * RefStuff::EPSILON_MAX);
+		}
+	}
+	return pts;
+}
+
+bool PlanetGrads::Valid(u4Byte numPts, Accuracy accuracy[NUM_METHODS])
+{
+	const SceneInfo scene = DefaultScene();
+	const std::vector<float3> pts = ShadingPoints(numPts, scene);
+	std::vector<float> errs[NUM_METHODS];
+	for (const float3& pt : pts)
+	{
+		// Reference; central differences of the unclamped estimator in planet space,
+		// unfolded with the same rotation as the dual gradients
+		constexpr float H = 0.0005f;
+		float foldAngle;
+		const float3 p = PtToPlanet(pt, scene.planetScale, &foldAngle);
+		const float3 axes[3] = { { H, 0.0f, 0.0f }, { 0.0f, H, 0.0f }, { 0.0f, 0.0f, H } };
+		float diffs[3];
+		for (u4Byte i = 0; i < 3; i += 1)
+		{
+			diffs[i] = Julia(scene.juliaCoeffs, p + axes[i]) - Julia(scene.juliaCoeffs, p - axes[i]);
+		}
+		const float3 ref = normalize(PlanetDirToWorld(float3{ diffs[0], diffs[1], diffs[2] }, foldAngle));
+
+		const float3 grads[NUM_METHODS] = { PlanetGrad(pt, scene, RefStuff::EPSILON_MAX), PlanetGradDual(pt, scene) };
+		for (u4Byte i = 0; i < NUM_METHODS; i += 1)
+		{
+			const float cosErr = std::min(std::max(dot(grads[i], ref), -1.0f), 1.0f);
+			errs[i].push_back(isfinite(cosErr) ? acosf(cosErr) * (180.0f / RefStuff::PI) : 180.0f);
+		}
+	}
+
+	for (u4Byte i = 0; i < NUM_METHODS; i += 1)
+	{
+		std::vector<float>& e = errs[i];
+		std::sort(e.begin(), e.end());
+		accuracy[i].medianDeg = e.empty() ? 0.0f : e[e.size() / 2];
+		accuracy[i].p99Deg = e.empty() ? 0.0f : e[(e.size() * 99) / 100];
+		accuracy[i].maxDeg = e.empty() ? 0.0f : e.back();
+	}
+	return !pts.empty() && accuracy[(u4Byte)METHODS::DUAL].medianDeg <= MAX_DUAL_MEDIAN_DEG;
+}
+
+void PlanetGrads::Benchmark(u4Byte numPts, double nsPerGrad[NUM_METHODS])
+{
+	// Best of a few passes, to keep one-off stalls out of the rates
+	constexpr u4Byte NUM_PASSES = 3;
+	const SceneInfo scene = DefaultScene();
+	const std::vector<float3> pts = ShadingPoints(numPts, scene);
+	for (u4Byte i = 0; i < NUM_METHODS; i += 1)
+	{
+		double bestSecs = 1e30;
+		float3 sink = { 0.0f, 0.0f, 0.0f }; // Keeps the gradients live
+		for (u4Byte j = 0; j < NUM_PASSES; j += 1)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (const float3& pt : pts)
+			{
+				sink += ((METHODS)i == METHODS::DUAL) ? PlanetGradDual(pt, scene) : PlanetGrad(pt, scene, RefStuff::EPSILON_MAX);
+			}
+			const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			bestSecs = std::min(bestSecs, secs);
+		}
+		volatile float sinkOut = sink.x + sink.y + sink.z;
+		(void)sinkOut;
+		nsPerGrad[i] = !pts.empty() ? (bestSecs * 1e9) / pts.size() : 0.0;
+	}
+}
+
+const char* PlanetGrads::Name(METHODS method)
+{
+	return (method == METHODS::DUAL) ? "dual" : "tetrahedral";
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Typedefs.h"
+
+// Compares the planet gradients behind surface normals: the shader's four-tap
+// tetrahedral differences ([RefShading::PlanetGrad(...)]) against forward-mode
+// dual-number differentiation of the Julia iteration
+// ([RefShading::PlanetGradDual(...)])
+// Both are measured at real shading points (camera rays from the default view,
+// marched onto the default planet + backed off by the tracing epsilon, like
+// [SurfSampler]), against central differences taken in planet space (where
+// coordinates are small enough for float differences to resolve)
+class PlanetGrads
+{
+	public:
+		enum class METHODS
+		{
+			TETRAHEDRAL,
+			DUAL
+		};
+		static constexpr u4Byte NUM_METHODS = 2;
+
+		// Angular error from the reference gradient, in degrees
+		struct Accuracy
+		{
+			float medianDeg;
+			float p99Deg;
+			float maxDeg;
+		};
+
+		// Largest median error allowed from the dual gradients; points sitting
+		// on the estimator's iteration-count seams have no well-defined gradient,
+		// so the tail is reported but not checked
+		static constexpr float MAX_DUAL_MEDIAN_DEG = 0.05f;
+
+		// Measure both methods over [numPts] shading points, writing one
+		// [Accuracy] per method into [accuracy]; returns false if the dual
+		// gradients miss [MAX_DUAL_MEDIAN_DEG] (or no shading points were found)
+		static bool Valid(u4Byte numPts, Accuracy accuracy[NUM_METHODS]);
+
+		// Time both methods over [numPts] shading points, writing nanoseconds per
+		// gradient into [nsPerGrad] (one per method)
+		static void Benchmark(u4Byte numPts, double nsPerGrad[NUM_METHODS]);
+
+		static const char* Name(METHODS method);
+};
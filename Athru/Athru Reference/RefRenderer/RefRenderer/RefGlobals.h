@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Typedefs.h"
+
+// Constants shared by the CPU reference renderer
+// [AppGlobals.h]/[GPUGlobals.h] pull in D3D12 + DirectXMath, so the values the
+// reference needs are mirrored here instead; keep them in sync with those
+// files (+ with the matching [#define]s in the shader headers, named in each
+// comment below)
+// Plain [constexpr] rather than [extern constexpr], since GCC/Clang treat the
+// latter as one external definition per translation unit
+namespace RefStuff
+{
+	// Rendering information (see [GraphicsStuff])
+	constexpr u4Byte DEFAULT_DISPLAY_WIDTH = 1920;
+	constexpr u4Byte DEFAULT_DISPLAY_HEIGHT = 1080;
+	constexpr u4Byte MAX_NUM_BOUNCES = 7;
+	constexpr u4Byte NUM_AA_SAMPLES = 4;
+	constexpr u4Byte TILE_WIDTH = 2;
+	constexpr u4Byte TILE_HEIGHT = 2;
+	constexpr float EPSILON_MAX = 0.0001f; // Tracing epsilon, passed to the GPU in [cameraPos.w]
+	constexpr float DENOISE_WIDTH = 3.0f;
+
+	// Dither texture (see [AthruGPU]); relative to the solution directory rather than the
+	// application's, + spelled with the on-disk case so it resolves on case-sensitive
+	// file systems
+	constexpr char DITHER_TEX_PATH[] = "Athru/Third Party/Moments in Graphics/LDR_RG01_0.png";
+	constexpr u4Byte DITHER_TEX_WIDTH = 128;
+
+	// Shader constants ([GenericUtility.hlsli])
+	constexpr float EPSILON_MIN = 0.00001f;
+	constexpr float PI = 3.14159265359f;
+	constexpr float HALF_PI = 1.57079632679f;
+	constexpr float TWO_PI = 6.28318530718f;
+	constexpr float FOUR_PI = 12.56637061436f;
+	constexpr u4Byte STELLAR_FIG_ID = 0;
+
+	// Marching limits ([Core3D.hlsli], [RayMarch.hlsl], [LightingUtility.hlsli])
+	constexpr float MAX_RAY_DIST = 16384.0f;
+	constexpr u4Byte MAX_VIS_MARCHER_STEPS = 512;
+	constexpr u4Byte MAX_OCC_MARCHER_STEPS = 256;
+
+	// System layout ([Core3D.hlsli])
+	constexpr float PLANETARY_RING_RADIUS = 800.0f;
+	constexpr float RADS_PER_PLANET = PI / 9.0f;
+
+	// Julia parameters ([Fractals.hlsli])
+	constexpr u4Byte ITERATIONS_JULIA = 8;
+	constexpr float BAILOUT_JULIA_DE = 256.0f;
+
+	// Stellar emission ([MaterialUtility.hlsli])
+	constexpr float STELLAR_BRIGHTNESS = 8000000.0f;
+
+	// Default scene, matching the first system generated by [System] + the
+	// default [Camera]
+	constexpr float STAR_RADIUS = 400.0f;
+	constexpr float PLANET_RADIUS = 100.0f;
+	constexpr float PLANET_JULIA_COEFFS[4] = { 0.0f, -0.6f, -0.6f, 0.0f };
+	constexpr float DEFAULT_CAMERA_POS[3] = { 700.0f, 0.0f, -10.0f };
+	constexpr float DEFAULT_CAMERA_LOOK[3] = { 0.0f, 0.0f, 1.0f };
+}
@@ -0,0 +1,186 @@
+#include "RefGlobals.h"
+#include "RefMarching.h"
+
+using namespace RefMaths;
+using namespace RefShading;
+
+namespace RefMarching
+{
+	MarchParams ShaderParams()
+	{
+		MarchParams params;
+		params.strategy = STRATEGIES::VARIANCE;
+		params.omega = 1.0f; // Unused by [VARIANCE]
+		params.epsGrowth = 1.175f;
+		params.maxSteps = RefStuff::MAX_VIS_MARCHER_STEPS;
+		params.maxDist = RefStuff::MAX_RAY_DIST;
+		return params;
+	}
+
+	const char* Name(STRATEGIES strategy)
+	{
+		switch (strategy)
+		{
+			case STRATEGIES::SPHERE:
+				return "sphere";
+			case STRATEGIES::RELAXED:
+				return "relaxed";
+			case STRATEGIES::VARIANCE:
+				return "variance";
+			case STRATEGIES::ENHANCED:
+				return "enhanced";
+		}
+		return "unknown";
+	}
+
+	// Every strategy shares the shader's start offset, epsilon schedule + exits;
+	// only the step sizes (+ how overshoots are caught) differ
+	MarchResult March(float3 ori, float3 dir, const SceneInfo& scene, const MarchParams& params, float tStart)
+	{
+		MarchResult result;
+		result.outcome = OUTCOMES::EXHAUSTED;
+		result.field = { 0.0f, 0.0f, 0.0f };
+		result.pos = ori;
+		result.t = 0.0f;
+		result.steps = 0;
+		result.evals = 0;
+		float eps = RefStuff::EPSILON_MAX;
+		float t = hmax(eps * 2.0f, tStart);
+		auto sample = [&](float3 rayVec, float3 rayOri)
+		{
+			result.evals += 1;
+			return SceneField(rayVec, rayOri, true, scene, eps);
+		};
+
+		// Per-strategy state; [prevF]/[prevDt] are the last distance + step taken
+		float prevF = 0.0f;
+		float prevDt = 0.0f;
+		float w = 1.0f;
+		bool relaxed = params.strategy != STRATEGIES::SPHERE;
+		float slope = -1.0f;
+		float fSamples[4] = { 0, 0, 0, 0 };
+		float fMean = 0.0f;
+		float fDeltas = 0.0f;
+		float fDeltaSet[4] = { 0, 0, 0, 0 };
+		for (u4Byte i = 0; i < params.maxSteps; i += 1)
+		{
+			result.steps = i + 1;
+			float3 rayVec = (dir * t) + ori;
+			FieldSample sceneField = sample(rayVec, ori);
+			const bool overshot = relaxed && (prevF + sceneField.dist < prevDt);
+			if (overshot)
+			{
+				switch (params.strategy)
+				{
+					case STRATEGIES::VARIANCE:
+						// Matches the shader, which reverts by [prevDt - w] instead of
+						// [prevDt - prevF] + passes the ray's direction as its origin here
+						relaxed = false;
+						t += prevDt * 1.0f - w;
+						rayVec = (dir * t) + ori;
+						sceneField = sample(rayVec, dir);
+						break;
+					case STRATEGIES::RELAXED:
+						relaxed = false;
+						t += prevF - prevDt;
+						rayVec = (dir * t) + ori;
+						sceneField = sample(rayVec, ori);
+						break;
+					case STRATEGIES::ENHANCED:
+						// Back up + take a plain step; relaxation resumes once the next
+						// step has measured a new slope
+						t += prevF - prevDt;
+						rayVec = (dir * t) + ori;
+						sceneField = sample(rayVec, ori);
+						break;
+					default:
+						break;
+				}
+			}
+			result.field = sceneField;
+			result.pos = rayVec;
+			result.t = t;
+
+			if (sceneField.dist < eps)
+			{
+				result.outcome = OUTCOMES::HIT;
+				break;
+			}
+			else if (t >= params.maxDist)
+			{
+				result.outcome = OUTCOMES::ESCAPED;
+				break;
+			}
+
+			// Choose the next step's relaxation
+			switch (params.strategy)
+			{
+				case STRATEGIES::SPHERE:
+					w = 1.0f;
+					break;
+				case STRATEGIES::RELAXED:
+					w = relaxed ? params.omega : 1.0f;
+					break;
+				case STRATEGIES::VARIANCE:
+				{
+					const float prevFSample = fSamples[i % 4];
+					fSamples[i % 4] = sceneField.dist / 4.0f;
+					fMean += fSamples[i % 4] - prevFSample;
+					const float d = sceneField.dist - fMean;
+					const float prevFDelta = fDeltaSet[i % 4];
+					fDeltaSet[i % 4] = d * d;
+					fDeltas += fDeltaSet[i % 4] - prevFDelta;
+					const float vari = hmin(fDeltas / 3.0f, 1.0f);
+					const float dw = 1.0f - vari;
+					w = 1.0f + (dw * vari);
+					break;
+				}
+				case STRATEGIES::ENHANCED:
+				{
+					// A plane whose distance changes by [slope] per unit along the ray is
+					// reached after [2 / (1 - slope)] times the current distance; slopes
+					// are unknown after the first step + after overshoots
+					slope = (i > 0 && !overshot) ? hmax(hmin((sceneField.dist - prevF) / prevDt, 1.0f), -1.0f) : -1.0f;
+					w = (slope < 1.0f) ? hmin(2.0f / (1.0f - slope), params.omega) : params.omega;
+					break;
+				}
+			}
+			prevF = sceneField.dist;
+			prevDt = prevF * w;
+			t += prevDt;
+			eps *= params.epsGrowth;
+		}
+		return result;
+	}
+
+	ConeResult ConeMarch(float3 ori, const float3 corners[4], const SceneInfo& scene, const MarchParams& params)
+	{
+		// Axis through the middle of the quad; the cone's half-angle reaches the
+		// furthest corner
+		const float3 axis = normalize(corners[0] + corners[1] + corners[2] + corners[3]);
+		float cosHalfAngle = 1.0f;
+		for (u4Byte i = 0; i < 4; i += 1)
+		{
+			cosHalfAngle = hmin(cosHalfAngle, dot(axis, corners[i]));
+		}
+		const float tanHalfAngle = sqrtf(hmax(1.0f - cosHalfAngle * cosHalfAngle, 0.0f)) / cosHalfAngle;
+
+		// An unbounding sphere of radius [d] at [t] covers every ray in the cone
+		// out to [t + h] if [h + (t + h) * tanHalfAngle <= d]; rays reach axial
+		// distance [t] no sooner than distance [t] along themselves, so covered
+		// axial distances are safe ray distances too
+		ConeResult result = { 0.0f, 0 };
+		float t = 0.0f;
+		const float eps = RefStuff::EPSILON_MAX;
+		for (u4Byte i = 0; i < params.maxSteps && t < params.maxDist; i += 1)
+		{
+			const float d = SceneField((axis * t) + ori, ori, false, scene, eps).dist;
+			result.evals += 1;
+			const float h = (d - t * tanHalfAngle) / (1.0f + tanHalfAngle);
+			if (h < hmax(t * tanHalfAngle, eps)) { break; }
+			t += h;
+		}
+		result.tSafe = hmin(t, params.maxDist);
+		return result;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "RefMaths.h"
+#include "RefShading.h"
+
+// Sphere tracers for visibility rays through the scene field; [VARIANCE] is
+// the marcher from [RayMarch.hlsl] (used by [RefRenderer]), the others are
+// alternatives for [MarchLab] to measure it against
+namespace RefMarching
+{
+	enum class STRATEGIES
+	{
+		SPHERE, // Plain sphere tracing; steps by the field distance
+		RELAXED, // Fixed over-relaxation (steps by [omega] x the distance); the first step that
+				 // overshoots (consecutive unbounding spheres stop overlapping) is reverted + the
+				 // march continues without relaxation [Keinert et al. 2014]
+		VARIANCE, // [RayMarch.hlsl]'s scheme; relaxation scales with the variance of the last four
+				  // distances, with the same one-shot fallback as [RELAXED]
+		ENHANCED // Relaxation estimated per step from the slope between the last two distances
+				 // (the step that would reach a plane with that slope), capped at [omega]; failed
+				 // steps fall back to plain sphere tracing for one step only [Balint + Valasek 2018]
+	};
+	constexpr u4Byte NUM_STRATEGIES = 4;
+
+	struct MarchParams
+	{
+		STRATEGIES strategy;
+		float omega; // Relaxation for [RELAXED] (+ the relaxation cap for [ENHANCED]); one or more
+		float epsGrowth; // Hit-epsilon scale per step; [RayMarch.hlsl] uses [1.175]
+		u4Byte maxSteps;
+		float maxDist;
+	};
+
+	// Parameters matching [RayMarch.hlsl]
+	MarchParams ShaderParams();
+
+	enum class OUTCOMES
+	{
+		HIT, // [field] + [pos] describe the intersection
+		ESCAPED, // Passed [maxDist]
+		EXHAUSTED // Ran out of steps first
+	};
+
+	struct MarchResult
+	{
+		OUTCOMES outcome;
+		RefShading::FieldSample field; // Field at the last sample
+		RefMaths::float3 pos;
+		float t; // Distance along the ray to [pos] (the last sample)
+		u4Byte steps; // Iterations of the marching loop
+		u4Byte evals; // Scene-field evaluations (strategies can sample more than once per step)
+	};
+
+	const char* Name(STRATEGIES strategy);
+
+	// March from [tStart] along the ray (or from the shader's offset of twice the
+	// starting epsilon, if that's further); epsilons still start from
+	// [EPSILON_MAX] + grow per step as usual
+	MarchResult March(RefMaths::float3 ori, RefMaths::float3 dir, const RefShading::SceneInfo& scene, const MarchParams& params,
+					  float tStart = 0.0f);
+
+	struct ConeResult
+	{
+		float tSafe; // No surface within this distance of [ori] for any ray in the cone
+		u4Byte evals;
+	};
+
+	// Cone marching; finds how far every ray from [ori] through the screen-space
+	// quad spanned by [corners] (unit directions) can skip before marching
+	// The cone encloses the corner rays, + steps along its axis by the part of
+	// each unbounding sphere that still covers the whole cone cross-section,
+	// stopping once that falls below the cone's radius (the cone has reached
+	// geometry) or the ray limits in [params] run out
+	// Samples the field without [SceneField(...)]'s per-ray figure bounds, which
+	// only hold along one ray
+	ConeResult ConeMarch(RefMaths::float3 ori, const RefMaths::float3 corners[4], const RefShading::SceneInfo& scene,
+						 const MarchParams& params);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <math.h>
+
+// Small HLSL-style vector library for the CPU reference renderer; just enough
+// of the shader language's vector types + intrinsics to port the rendering
+// shaders line-for-line
+// Intrinsics follow HLSL semantics where they differ from the C library
+// ([min]/[max] prefer non-NaN operands, [frac] is [x - floor(x)])
+namespace RefMaths
+{
+	struct float2
+	{
+		float x;
+		float y;
+	};
+
+	struct float3
+	{
+		float x;
+		float y;
+		float z;
+	};
+
+	struct float4
+	{
+		float x;
+		float y;
+		float z;
+		float w;
+	};
+
+	// Component-wise operators
+	inline float2 operator+(float2 a, float2 b) { return { a.x + b.x, a.y + b.y }; }
+	inline float2 operator-(float2 a, float2 b) { return { a.x - b.x, a.y - b.y }; }
+	inline float2 operator*(float2 a, float s) { return { a.x * s, a.y * s }; }
+
+	inline float3 operator+(float3 a, float3 b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	inline float3 operator-(float3 a, float3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline float3 operator*(float3 a, float3 b) { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+	inline float3 operator/(float3 a, float3 b) { return { a.x / b.x, a.y / b.y, a.z / b.z }; }
+	inline float3 operator*(float3 a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+	inline float3 operator*(float s, float3 a) { return { a.x * s, a.y * s, a.z * s }; }
+	inline float3 operator/(float3 a, float s) { return { a.x / s, a.y / s, a.z / s }; }
+	inline float3 operator+(float3 a, float s) { return { a.x + s, a.y + s, a.z + s }; }
+	inline float3 operator-(float3 a) { return { -a.x, -a.y, -a.z }; }
+	inline float3& operator+=(float3& a, float3 b) { a = a + b; return a; }
+	inline float3& operator-=(float3& a, float3 b) { a = a - b; return a; }
+
+	inline float4 operator+(float4 a, float4 b) { return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; }
+	inline float4 operator-(float4 a, float4 b) { return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; }
+	inline float4 operator*(float4 a, float4 b) { return { a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w }; }
+	inline float4 operator*(float4 a, float s) { return { a.x * s, a.y * s, a.z * s, a.w * s }; }
+	inline float4 operator/(float4 a, float s) { return { a.x / s, a.y / s, a.z / s, a.w / s }; }
+	inline float4& operator*=(float4& a, float4 b) { a = a * b; return a; }
+
+	inline float3 xyz(float4 v) { return { v.x, v.y, v.z }; }
+	inline float4 xyzw(float3 v, float w) { return { v.x, v.y, v.z, w }; }
+	inline float3 xxx(float s) { return { s, s, s }; }
+	inline bool operator==(float3 a, float3 b) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+
+	// HLSL [min]/[max] return the non-NaN operand when either is NaN
+	inline float hmin(float a, float b) { return fminf(a, b); }
+	inline float hmax(float a, float b) { return fmaxf(a, b); }
+	inline float3 hmax(float3 a, float s) { return { fmaxf(a.x, s), fmaxf(a.y, s), fmaxf(a.z, s) }; }
+	inline float3 habs(float3 a) { return { fabsf(a.x), fabsf(a.y), fabsf(a.z) }; }
+	inline float frac(float x) { return x - floorf(x); }
+	inline float sign(float x) { return (float)((x > 0.0f) - (x < 0.0f)); }
+
+	inline float dot(float3 a, float3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	inline float dot(float4 a, float4 b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+	inline float length(float3 a) { return sqrtf(dot(a, a)); }
+	inline float length(float4 a) { return sqrtf(dot(a, a)); }
+	inline float3 normalize(float3 a) { return a / length(a); }
+	inline float3 cross(float3 a, float3 b)
+	{
+		return { a.y * b.z - a.z * b.y,
+				 a.z * b.x - a.x * b.z,
+				 a.x * b.y - a.y * b.x };
+	}
+
+	// Row-vector/matrix product ([mul(v, m)] for [float3x3]s stored as rows)
+	inline float3 mul(float3 v, const float3 m[3]) { return (m[0] * v.x) + (m[1] * v.y) + (m[2] * v.z); }
+}
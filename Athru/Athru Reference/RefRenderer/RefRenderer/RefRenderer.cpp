@@ -0,0 +1,645 @@
+#include <assert.h>
+#include <string.h>
+#include "RefGlobals.h"
+#include "RefRenderer.h"
+#include "RefMarching.h"
+#include "lodepng.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace RefMaths;
+using namespace RefShading;
+
+// [reprojDists] entries where no hit landed (positive infinity's bits; hit
+// distances are positive, so their bits order the same way as the distances)
+static constexpr u4Byte NO_REPROJ_DIST = 0x7F800000;
+
+RefRenderer::RefRenderer(const Settings& settings) :
+	width(settings.width),
+	height(settings.height),
+	area(settings.width * settings.height),
+	tilingWidth(settings.width / RefStuff::TILE_WIDTH),
+	tilingHeight(settings.height / RefStuff::TILE_HEIGHT),
+	coneTileWidth(settings.coneTileWidth),
+	coneTilingWidth((coneTileWidth != 0) ? (settings.width + coneTileWidth - 1) / coneTileWidth : 0),
+	coneTilingHeight((coneTileWidth != 0) ? (settings.height + coneTileWidth - 1) / coneTileWidth : 0),
+	temporalHits(settings.temporalHits),
+	sampleBudget(settings.sampleBudget),
+	russianRoulette(settings.russianRoulette),
+	seed(settings.seed),
+	frameCtr(0),
+	numThreads((settings.numThreads != 0) ? settings.numThreads : std::max(std::thread::hardware_concurrency(), 1u)),
+	ditherRGBA(settings.ditherRGBA),
+	rays(area),
+	rayOris(area),
+	figIDs(area),
+	posBuffer(area),
+	nrmBuffer(area),
+	displayTex(area),
+	aaBuffer(area),
+	pixStats(area),
+	randBuf(area),
+	displayTexLDR(area),
+	coneStarts(coneTilingWidth * coneTilingHeight),
+	prevHits(temporalHits ? area : 0),
+	reprojDists(temporalHits ? area : 0),
+	workerCounts(numThreads),
+	pxPriorities((sampleBudget != 0) ? area : 0),
+	pxOrder((sampleBudget != 0) ? area : 0),
+	pathQueues(area, numThreads)
+{
+	assert((width % RefStuff::TILE_WIDTH) == 0 && (height % RefStuff::TILE_HEIGHT) == 0);
+	assert(ditherRGBA != nullptr);
+	assert(sampleBudget <= area);
+
+	MoveCamera(settings.cameraPos, settings.cameraLook);
+	scene = DefaultScene();
+
+	// GPU buffers start zeroed; LDR pixels nothing writes to stay opaque black
+	for (u4Byte i = 0; i < area; i += 1)
+	{
+		displayTex[i] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		aaBuffer[i] = { { 0.0f, 0.0f, 0.0f, 0.0f }, 0 };
+		pixStats[i] = { 0.0f, 0.0f, 0 };
+		displayTexLDR[i] = { { 0, 0, 0, 255 } };
+	}
+	for (u4Byte i = 0; i < prevHits.size(); i += 1)
+	{
+		prevHits[i] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	}
+	for (MarchCounts& counts : workerCounts)
+	{
+		counts = { 0, 0, 0, 0, 0, 0, 0 };
+	}
+}
+
+void RefRenderer::MoveCamera(float3 pos, float3 look)
+{
+	// Camera-to-world basis, as built by [XMMatrixLookAtLH(...)] with a y-up
+	// local up-vector
+	cameraPos = pos;
+	const float3 zAxis = normalize(look);
+	const float3 xAxis = normalize(cross(float3{ 0.0f, 1.0f, 0.0f }, zAxis));
+	viewBasis[0] = xAxis;
+	viewBasis[1] = cross(zAxis, xAxis);
+	viewBasis[2] = zAxis;
+}
+
+void RefRenderer::Frame()
+{
+	// Paths are handed out in runs of [PATHS_PER_CLAIM], so workers share the
+	// atomic claim counter once per run rather than once per path
+	constexpr u4Byte PATHS_PER_CLAIM = 64;
+
+	// Find where camera rays can start marching
+	ForItems(coneTilingHeight, 1, [this](u4Byte, u4Byte row)
+	{
+		for (u4Byte i = 0; i < coneTilingWidth; i += 1)
+		{
+			ConePrepass(i + (row * coneTilingWidth));
+		}
+	});
+
+	// Carry hit distances over from earlier frames
+	if (temporalHits)
+	{
+		ForItems(area, PATHS_PER_CLAIM, [this](u4Byte, u4Byte i)
+		{
+			reprojDists[i].store(NO_REPROJ_DIST, std::memory_order_relaxed);
+		});
+		ForItems(area, PATHS_PER_CLAIM, [this](u4Byte, u4Byte i)
+		{
+			ReprojPrepass(i);
+		});
+	}
+
+	// Generate camera rays for every tile (or every scheduled pixel)
+	if (sampleBudget != 0) { ScheduleFrame(); }
+	const u4Byte numFramePx = (sampleBudget != 0) ? sampleBudget : tilingWidth * tilingHeight;
+	ForItems(numFramePx, PATHS_PER_CLAIM, [this](u4Byte worker, u4Byte i)
+	{
+		LensSampler(i, worker);
+	});
+
+	// March every live path, then sample every intersected surface; [MatPrimAt(...)]
+	// only generates diffuse surfaces atm, so the other material queues stay empty
+	for (u4Byte i = 0; i < RefStuff::MAX_NUM_BOUNCES; i += 1)
+	{
+		u4Byte numTraceables = 0;
+		const u4Byte* traceables = pathQueues.Compact(PathQueues::QUEUES::TRACEABLES, numTraceables);
+		if (numTraceables == 0) { break; }
+		ForItems(numTraceables, PATHS_PER_CLAIM, [this, traceables](u4Byte worker, u4Byte j)
+		{
+			RayMarch(traceables[j], worker);
+		});
+
+		u4Byte numDiffuIsections = 0;
+		const u4Byte* diffuIsections = pathQueues.Compact(PathQueues::QUEUES::DIFFU_ISECTIONS, numDiffuIsections);
+		ForItems(numDiffuIsections, PATHS_PER_CLAIM, [this, diffuIsections](u4Byte worker, u4Byte j)
+		{
+			SurfSampler(diffuIsections[j], worker);
+		});
+	}
+
+	// Paths still bouncing after the last bounce are dropped, like the GPU's
+	u4Byte numDropped = 0;
+	pathQueues.Compact(PathQueues::QUEUES::TRACEABLES, numDropped);
+
+	// Post-process once every path has finished
+	ForItems(numFramePx, PATHS_PER_CLAIM, [this](u4Byte, u4Byte i)
+	{
+		RasterPrep(i);
+	});
+	frameCtr += 1;
+}
+
+bool RefRenderer::SavePNG(const char* path) const
+{
+	return lodepng_encode32_file(path, (const unsigned char*)displayTexLDR.data(), width, height) == 0;
+}
+
+u4Byte RefRenderer::NumThreads() const
+{
+	return numThreads;
+}
+
+RefRenderer::MarchCounts RefRenderer::PrimaryCounts() const
+{
+	MarchCounts sum = { 0, 0, 0, 0, 0, 0, 0 };
+	for (const MarchCounts& counts : workerCounts)
+	{
+		sum.rays += counts.rays;
+		sum.steps += counts.steps;
+		sum.evals += counts.evals;
+		sum.guesses += counts.guesses;
+		sum.reuses += counts.reuses;
+		sum.bounceRays += counts.bounceRays;
+		sum.bounceEvals += counts.bounceEvals;
+	}
+	return sum;
+}
+
+void RefRenderer::LumaMeans(std::vector<float>& means) const
+{
+	means.resize(area);
+	for (u4Byte i = 0; i < area; i += 1)
+	{
+		means[i] = pixStats[i].mean;
+	}
+}
+
+void RefRenderer::ImageLuma(double& mean, double& stdErr) const
+{
+	double sum = 0.0;
+	double meanVariance = 0.0;
+	u4Byte numPx = 0;
+	for (const PixStats& stats : pixStats)
+	{
+		if (stats.n < 2) { continue; }
+		sum += stats.mean;
+		meanVariance += (stats.m2 / (stats.n - 1)) / stats.n;
+		numPx += 1;
+	}
+	mean = (numPx > 0) ? sum / numPx : 0.0;
+	stdErr = (numPx > 0) ? sqrt(meanVariance) / numPx : 0.0;
+}
+
+u4Byte RefRenderer::TilePx(u4Byte linTileID) const
+{
+	if (sampleBudget != 0) { return framePx[linTileID]; }
+	const u4Byte x = (frameCtr % 2) + ((linTileID % tilingWidth) * RefStuff::TILE_WIDTH);
+	const u4Byte y = ((frameCtr % 4) / 2) + ((linTileID / tilingWidth) * RefStuff::TILE_HEIGHT);
+	return x + (y * width);
+}
+
+void RefRenderer::ScheduleFrame()
+{
+	// Relative squared standard error of each pixel's mean, as estimated from
+	// its samples; floors keep near-black pixels from dominating + give pixels
+	// whose samples happen to agree (e.g. every path escaping) a small share, so
+	// rare paths onto the star can still be found
+	constexpr u4Byte MIN_SAMPLES = 4;
+	constexpr float LUMA_FLOOR = 0.01f;
+	constexpr float VARIANCE_FLOOR = 0.0001f;
+	constexpr u4Byte PX_PER_CLAIM = 256;
+	ForItems(area, PX_PER_CLAIM, [this](u4Byte, u4Byte i)
+	{
+		const PixStats& stats = pixStats[i];
+		float priority;
+		if (stats.n < MIN_SAMPLES)
+		{
+			priority = 1e30f * (MIN_SAMPLES - stats.n);
+		}
+		else
+		{
+			const float variance = stats.m2 / (stats.n - 1);
+			priority = (variance + VARIANCE_FLOOR) / (stats.n * ((stats.mean * stats.mean) + LUMA_FLOOR));
+		}
+
+		// Break ties with blue noise, so pixels with equal priorities (e.g. every
+		// unsampled pixel) are picked evenly across the image
+		const u4Byte ditherTexel = ((i % width) % RefStuff::DITHER_TEX_WIDTH) + (((i / width) % RefStuff::DITHER_TEX_WIDTH) * RefStuff::DITHER_TEX_WIDTH);
+		pxPriorities[i] = priority * (1.0f + ditherRGBA[(ditherTexel * 4) + 2] / 256000.0f);
+		pxOrder[i] = i;
+	});
+
+	// Take the highest priorities, then sort them back into scanline order for
+	// locality in the later stages
+	std::nth_element(pxOrder.begin(), pxOrder.begin() + sampleBudget, pxOrder.end(),
+					 [this](u4Byte a, u4Byte b) { return pxPriorities[a] > pxPriorities[b]; });
+	framePx.assign(pxOrder.begin(), pxOrder.begin() + sampleBudget);
+	std::sort(framePx.begin(), framePx.end());
+}
+
+template<typename Stage>
+void RefRenderer::ForItems(u4Byte numItems, u4Byte itemsPerClaim, const Stage& stage)
+{
+	// Items are claimed in runs, so workers finishing early steal the runs slower
+	// workers haven't reached (cost varies a lot between paths crossing planets
+	// + paths escaping into empty space)
+	std::atomic<u4Byte> nextItem = 0;
+	auto worker = [&](u4Byte workerID)
+	{
+		for (u4Byte first = nextItem.fetch_add(itemsPerClaim); first < numItems; first = nextItem.fetch_add(itemsPerClaim))
+		{
+			const u4Byte last = std::min(first + itemsPerClaim, numItems);
+			for (u4Byte i = first; i < last; i += 1)
+			{
+				stage(workerID, i);
+			}
+		}
+		pathQueues.Flush(workerID);
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(numThreads - 1);
+	for (u4Byte i = 1; i < numThreads; i += 1)
+	{
+		workers.emplace_back(worker, i);
+	}
+	worker(0);
+	for (std::thread& t : workers)
+	{
+		t.join();
+	}
+}
+
+void RefRenderer::ConePrepass(u4Byte linConeTileID)
+{
+	// Bound the supersampled positions [LensSampler(...)] can generate for the
+	// tile's pixels; jitter reaches up to one sample width past either side of
+	// each pixel's base position, + positions are truncated before projection
+	const u4Byte pixWidth = (u4Byte)sqrtf((float)RefStuff::NUM_AA_SAMPLES);
+	const float baseSSPixOffs = (float)pixWidth * 0.5f;
+	const u4Byte x0 = (linConeTileID % coneTilingWidth) * coneTileWidth;
+	const u4Byte y0 = (linConeTileID / coneTilingWidth) * coneTileWidth;
+	const u4Byte x1 = std::min(x0 + coneTileWidth, width) - 1;
+	const u4Byte y1 = std::min(y0 + coneTileWidth, height) - 1;
+	const float ssMinX = std::max((x0 * pixWidth) + baseSSPixOffs - pixWidth - 1.0f, 0.0f);
+	const float ssMinY = std::max((y0 * pixWidth) + baseSSPixOffs - pixWidth - 1.0f, 0.0f);
+	const float ssMaxX = (x1 * pixWidth) + baseSSPixOffs + pixWidth;
+	const float ssMaxY = (y1 * pixWidth) + baseSSPixOffs + pixWidth;
+
+	// Camera rays through the corners ([PRayDir(...)])
+	const float2 viewSizes = { (float)(width * pixWidth), (float)(height * pixWidth) };
+	auto cornerDir = [&](float ssX, float ssY)
+	{
+		const float3 dir = normalize(float3{ ssX - (viewSizes.x / 2.0f), ssY - (viewSizes.y / 2.0f),
+											 viewSizes.y / tanf((0.5f * RefStuff::PI) / 2.0f) });
+		return mul(dir, viewBasis);
+	};
+	const float3 corners[4] = { cornerDir(ssMinX, ssMinY), cornerDir(ssMaxX, ssMinY),
+								cornerDir(ssMinX, ssMaxY), cornerDir(ssMaxX, ssMaxY) };
+	coneStarts[linConeTileID] = RefMarching::ConeMarch(cameraPos, corners, scene, RefMarching::ShaderParams()).tSafe;
+}
+
+void RefRenderer::ReprojPrepass(u4Byte ndx)
+{
+	const float4 hit = prevHits[ndx];
+	if (hit.w == 0.0f) { return; }
+
+	// Into camera space ([viewBasis] is orthonormal, so its transpose inverts it)
+	const float3 toHit = xyz(hit) - cameraPos;
+	const float3 viewPt = { dot(toHit, viewBasis[0]), dot(toHit, viewBasis[1]), dot(toHit, viewBasis[2]) };
+	if (viewPt.z <= 0.0f) { return; }
+
+	// Back through [PRayDir(...)] onto supersampled positions, then onto the
+	// pixel whose base position ([LensSampler(...)]) is closest
+	const u4Byte pixWidth = (u4Byte)sqrtf((float)RefStuff::NUM_AA_SAMPLES);
+	const float baseSSPixOffs = (float)pixWidth * 0.5f;
+	const float2 viewSizes = { (float)(width * pixWidth), (float)(height * pixWidth) };
+	const float focalDist = viewSizes.y / tanf((0.5f * RefStuff::PI) / 2.0f);
+	const float ssPixX = ((viewPt.x / viewPt.z) * focalDist) + (viewSizes.x / 2.0f);
+	const float ssPixY = ((viewPt.y / viewPt.z) * focalDist) + (viewSizes.y / 2.0f);
+	const float pxX = floorf(((ssPixX - baseSSPixOffs) / pixWidth) + 0.5f);
+	const float pxY = floorf(((ssPixY - baseSSPixOffs) / pixWidth) + 0.5f);
+	if (!(pxX >= 0.0f && pxX < width && pxY >= 0.0f && pxY < height)) { return; }
+
+	// Keep the nearest distance landing in the pixel
+	const float dist = length(toHit);
+	u4Byte distBits;
+	memcpy(&distBits, &dist, sizeof(float));
+	std::atomic<u4Byte>& reprojDist = reprojDists[(u4Byte)pxX + ((u4Byte)pxY * width)];
+	u4Byte prevBits = reprojDist.load(std::memory_order_relaxed);
+	while (distBits < prevBits && !reprojDist.compare_exchange_weak(prevBits, distBits, std::memory_order_relaxed)) {}
+}
+
+void RefRenderer::LensSampler(u4Byte linTileID, u4Byte worker)
+{
+	const u4Byte ndx = TilePx(linTileID);
+	const u4Byte pxX = ndx % width;
+	const u4Byte pxY = ndx / width;
+
+	// Jittered sub-pixel sample ([PixToRay(...)]); samples step through the R2
+	// sequence, offset by blue-noise dither
+	const u4Byte pixSampleNdx = (aaBuffer[ndx].sampleCount + 1) % RefStuff::NUM_AA_SAMPLES;
+	const float pixWidth = sqrtf((float)RefStuff::NUM_AA_SAMPLES);
+	const float g = 1.6180339887498948482f;
+	const float a1 = 1.0f / g;
+	const float a2 = 1.0f / (g * g);
+	float2 sampleXY = { fmodf(0.5f + a1 * pixSampleNdx, 1.0f),
+						fmodf(0.5f + a2 * pixSampleNdx, 1.0f) };
+	sampleXY = (sampleXY - float2{ 0.5f, 0.5f }) * pixWidth;
+	const u4Byte ditherTexel = (pxX % RefStuff::DITHER_TEX_WIDTH) + ((pxY % RefStuff::DITHER_TEX_WIDTH) * RefStuff::DITHER_TEX_WIDTH);
+	const float2 uv01 = { ditherRGBA[ditherTexel * 4] / 256.0f, ditherRGBA[(ditherTexel * 4) + 1] / 256.0f }; // See [Renderer::ConvertDitherTexels(...)]
+	sampleXY = sampleXY + (uv01 * pixWidth) - float2{ pixWidth * 0.5f, pixWidth * 0.5f };
+	sampleXY = { fmodf(sampleXY.x, pixWidth), fmodf(sampleXY.y, pixWidth) };
+
+	// Camera ray through the sample ([PRayDir(...)]); the shader passes sample positions
+	// as [uint2]s, so they're truncated (+ clamped at zero) before projection
+	const float baseSSPixOffs = (float)((u4Byte)pixWidth) * 0.5f;
+	const float ssPixX = std::max((pxX * pixWidth) + baseSSPixOffs + sampleXY.x, 0.0f);
+	const float ssPixY = std::max((pxY * pixWidth) + baseSSPixOffs + sampleXY.y, 0.0f);
+	const float2 viewSizes = { (float)(width * (u4Byte)pixWidth), (float)(height * (u4Byte)pixWidth) };
+	const float3 dir = normalize(float3{ (float)((u4Byte)ssPixX) - (viewSizes.x / 2.0f),
+										 (float)((u4Byte)ssPixY) - (viewSizes.y / 2.0f),
+										 viewSizes.y / tanf((0.5f * RefStuff::PI) / 2.0f) });
+
+	rays[ndx] = { cameraPos, mul(dir, viewBasis) };
+	pathQueues.Push(worker, PathQueues::QUEUES::TRACEABLES, ndx);
+	displayTex[ndx] = { 1.0f, 1.0f, 1.0f, BlackmanHarris(sampleXY, RefStuff::NUM_AA_SAMPLES) };
+	posBuffer[ndx] = xxx(16384.0f); // Default points in the position/normal-buffers to infinity
+	nrmBuffer[ndx] = xxx(16384.0f);
+	if (aaBuffer[ndx].sampleCount == 0) // First sample; [frameCtr < 4] in the shader, since its fixed pattern traces every pixel once in four frames
+	{
+		strmBuilder(ndx + (seed * area), randBuf[ndx]);
+	}
+}
+
+void RefRenderer::RayMarch(u4Byte ndx, u4Byte worker)
+{
+	// Relaxed sphere tracing with the shader's variance-driven scheme (see [RefMarching])
+	PhiloStrm randStrm = randBuf[ndx];
+	philoxPermu01(randStrm); // Material selection sample; only diffuse surfaces are generated atm ([MatPrimAt(...)])
+	float4 rgba = { 1.0f, 1.0f, 1.0f, 1.0f };
+	const Ray ray = rays[ndx];
+	const bool primary = ray.ori == cameraPos;
+	MarchCounts& counts = workerCounts[worker];
+	float tStart = 0.0f;
+	u4Byte numVerifyEvals = 0;
+	if (coneTileWidth != 0 && primary)
+	{
+		const u4Byte coneTileX = (ndx % width) / coneTileWidth;
+		const u4Byte coneTileY = (ndx / width) / coneTileWidth;
+		tStart = coneStarts[coneTileX + (coneTileY * coneTilingWidth)];
+	}
+	if (temporalHits && primary)
+	{
+		// Guess from the nearest distance reprojected around the pixel (reprojected
+		// hits only land near the rays that would meet them), backed off in
+		// proportion; one sample there has to be outside every figure, + close
+		// enough to one for the surface the guess came from to still be just
+		// ahead, or the ray keeps its earlier start
+		// Hit epsilons grow per step ([RefMarching::March(...)]), so rays grazing a
+		// figure can still end differently to a full march (as they can from
+		// [coneStarts])
+		constexpr float BACKOFF = 0.02f;
+		const u4Byte pxX = ndx % width;
+		const u4Byte pxY = ndx / width;
+		u4Byte guessBits = NO_REPROJ_DIST;
+		for (u4Byte y = (pxY > 0) ? pxY - 1 : 0; y <= std::min(pxY + 1, height - 1); y += 1)
+		{
+			for (u4Byte x = (pxX > 0) ? pxX - 1 : 0; x <= std::min(pxX + 1, width - 1); x += 1)
+			{
+				guessBits = std::min(guessBits, reprojDists[x + (y * width)].load(std::memory_order_relaxed));
+			}
+		}
+		float guess;
+		memcpy(&guess, &guessBits, sizeof(float));
+		const float backoff = hmax(guess * BACKOFF, RefStuff::EPSILON_MAX * 4.0f);
+		const float tGuess = guess - backoff;
+		if (guessBits != NO_REPROJ_DIST && tGuess > tStart)
+		{
+			const float d = SceneField((ray.dir * tGuess) + ray.ori, ray.ori, true, scene, RefStuff::EPSILON_MAX).dist;
+			numVerifyEvals = 1;
+			counts.guesses += 1;
+			if (d >= RefStuff::EPSILON_MAX && d <= backoff * 2.0f)
+			{
+				tStart = tGuess;
+				counts.reuses += 1;
+			}
+		}
+	}
+	const RefMarching::MarchResult march = RefMarching::March(ray.ori, ray.dir, scene, RefMarching::ShaderParams(), tStart);
+	if (primary)
+	{
+		counts.rays += 1;
+		counts.steps += march.steps;
+		counts.evals += march.evals + numVerifyEvals;
+		if (temporalHits)
+		{
+			prevHits[ndx] = xyzw(march.pos, (march.outcome == RefMarching::OUTCOMES::HIT) ? 1.0f : 0.0f);
+		}
+	}
+	else
+	{
+		counts.bounceRays += 1;
+		counts.bounceEvals += march.evals;
+	}
+	if (march.outcome == RefMarching::OUTCOMES::HIT)
+	{
+		if (march.field.figID == (float)RefStuff::STELLAR_FIG_ID)
+		{
+			rgba = xyzw(Emission(RefStuff::STELLAR_BRIGHTNESS, march.t), 1.0f);
+		}
+		else
+		{
+			rayOris[ndx] = march.pos;
+			figIDs[ndx] = (u4Byte)march.field.figID;
+			pathQueues.Push(worker, PathQueues::QUEUES::DIFFU_ISECTIONS, ndx);
+		}
+	}
+	else if (march.outcome == RefMarching::OUTCOMES::ESCAPED)
+	{
+		rgba = { 0.0f, 0.0f, 0.0f, 1.0f };
+	}
+	displayTex[ndx] *= rgba;
+	randBuf[ndx] = randStrm;
+}
+
+void RefRenderer::SurfSampler(u4Byte ndx, u4Byte worker)
+{
+	PhiloStrm randStrm = randBuf[ndx];
+	philoxPermu01(randStrm);
+	const float eps = RefStuff::EPSILON_MAX;
+	const Ray ray = { rayOris[ndx], rays[ndx].dir };
+	const float3 pt = ray.ori - ray.dir * eps;
+	const float3 n = PlanetGradDual(pt, scene); // [PlanetGrad(...)] without [APPROX_PLANET_GRAD]
+	float3 normSpace[3];
+	NormalSpace(n, normSpace);
+	if (rays[ndx].ori == cameraPos)
+	{
+		posBuffer[ndx] = pt;
+		nrmBuffer[ndx] = n;
+	}
+
+	// Diffuse sampling ([SampleDiffu(...)]); next-event estimation shades paths
+	// that can see the star, everything else bounces
+	const float3 wo = ray.dir;
+	const float4 surf = xyzw(SurfRGB(wo, n), 1.0f); // [SurfAlpha(...)] is one for diffuse surfaces
+	const float diffuP = 1.0f; // [DiffuChance(...)]
+	float4 rand = philoxPermu01(randStrm);
+	const float4 nee = DiffuLiGather(surf, diffuP, n, wo, pt, normSpace, scene, eps, rand);
+	if (nee.w != 0.0f)
+	{
+		rand = philoxPermu01(randStrm);
+		float4 iDir = DiffuseDir(wo, n, { rand.x, rand.y });
+		iDir = xyzw(mul(xyz(iDir), normSpace), iDir.w / diffuP);
+		const float3 brdfDirs[3] = { xyz(iDir), n, wo };
+		const float3 rgb = DiffuseBRDF(surf, brdfDirs) / ZERO_PDF_REMAP(iDir.w) * fabsf(dot(n, -wo));
+		float4 rho = displayTex[ndx] * xyzw(rgb, 1.0f);
+		if (russianRoulette && !(rays[ndx].ori == cameraPos))
+		{
+			// Russian roulette ([RUSSIAN_ROULETTE]); survivors are reweighted by their
+			// survival chance, + [rand.z] is free since [DiffuseDir(...)] only takes [rand.xy]
+			const float survP = hmin(hmax(rho.x, hmax(rho.y, rho.z)), 1.0f);
+			const float3 survRGB = (rand.z < survP) ? xyz(rho) / survP : xxx(0.0f);
+			rho = xyzw(survRGB, rho.w);
+		}
+		displayTex[ndx] = rho;
+		if ((rho.x + rho.y + rho.z) > 0.0f) // Only propagate paths with nonzero brightness
+		{
+			rays[ndx] = { pt, xyz(iDir) };
+			rayOris[ndx] = pt;
+			pathQueues.Push(worker, PathQueues::QUEUES::TRACEABLES, ndx);
+		}
+	}
+	else
+	{
+		displayTex[ndx] *= xyzw(xyz(nee), 1.0f);
+	}
+	randBuf[ndx] = randStrm;
+}
+
+void RefRenderer::RasterPrep(u4Byte linTileID)
+{
+	// Constant denoising filter kernel + offsets
+	static constexpr float h[25] =
+	{
+		1 / 256.0f,  1 / 64.0f,  3 / 128.0f,  1 / 64.0f,  1 / 256.0f,
+		1 / 64.0f,  1 / 16.0f,  3 / 32.0f,  1 / 16.0f,  1 / 64.0f,
+		3 / 128.0f,  3 / 32.0f,  9 / 64.0f,  3 / 32.0f,  3 / 128.0f,
+		1 / 64.0f,  1 / 16.0f,  3 / 32.0f,  1 / 16.0f,  1 / 64.0f,
+		1 / 256.0f,  1 / 64.0f,  3 / 128.0f,  1 / 64.0f,  1 / 256.0f
+	};
+	static constexpr s4Byte krnOffs[25][2] =
+	{
+		{ -2,-2 }, { -1,-2 }, { 0,-2 }, { 1,-2 }, { 2,-2 },
+		{ -2,-1 }, { -1,-1 }, { 0,-1 }, { 1,-1 }, { 2,-1 },
+		{ -2,0 }, { -1,0 }, { 0,0 }, { 1,0 }, { 2,0 },
+		{ -2,1 }, { -1,1 }, { 0,1 }, { 1,1 }, { 2,1 },
+		{ -2,2 }, { -1,2 }, { 0,2 }, { 1,2 }, { 2,2 }
+	};
+
+	const u4Byte ndx = TilePx(linTileID);
+	const u4Byte pxX = ndx % width;
+	const u4Byte pxY = ndx / width;
+	const float4 tx = displayTex[ndx];
+
+	// Kernel taps as the shader resolves them: offsets are [uint2]s, so negative taps
+	// wrap far past the image and clamp onto its far edge; taps at the edge read zero
+	// from the display texture, + wrap onto the next row (or read zero past the end)
+	// in the linear position/normal buffers
+	struct Tap { float3 rgb; float3 nrm; float3 pos; };
+	auto tapAt = [&](u4Byte l)
+	{
+		const float stepWidth = RefStuff::DENOISE_WIDTH;
+		const u4Byte x = (krnOffs[l][0] < 0) ? width : std::min(pxX + (u4Byte)(krnOffs[l][0] * stepWidth), width);
+		const u4Byte y = (krnOffs[l][1] < 0) ? height : std::min(pxY + (u4Byte)(krnOffs[l][1] * stepWidth), height);
+		const u4Byte linEltID = x + (y * width);
+		const float3 zero = xxx(0.0f);
+		return Tap { (x < width && y < height) ? xyz(displayTex[x + (y * width)]) : zero,
+					 (linEltID < area) ? nrmBuffer[linEltID] : zero,
+					 (linEltID < area) ? posBuffer[linEltID] : zero };
+	};
+
+	// Edge-avoiding a-trous wavelet denoising, one 5x5 pass
+	const float3 n = nrmBuffer[ndx];
+	const float3 x = posBuffer[ndx];
+	float3 m[3] = { xxx(0.0f), xxx(0.0f), xxx(0.0f) };
+	for (u4Byte l = 0; l < 25; l += 1)
+	{
+		const Tap tap = tapAt(l);
+		m[0] += tap.rgb;
+		m[1] += tap.nrm;
+		m[2] += tap.pos;
+	}
+	m[0] = m[0] / 25.0f;
+	m[1] = m[1] / 25.0f;
+	m[2] = m[2] / 25.0f;
+
+	// Matches the shader, which compares mean normals against positions (+ vice-versa)
+	const float3 vsigmas[3] = { habs(m[0] - xyz(tx)),
+								habs(m[1] - posBuffer[ndx]),
+								habs(m[2] - nrmBuffer[ndx]) };
+	const float3 sigmas = { dot(vsigmas[0], vsigmas[0]),
+							dot(vsigmas[1], vsigmas[1]),
+							dot(vsigmas[2], vsigmas[2]) };
+
+	float3 c = xyz(tx);
+	float k = 0.0f;
+	float3 d = xxx(0.0f);
+	for (u4Byte j = 0; j < 25; j += 1)
+	{
+		const Tap tap = tapAt(j);
+		const float3 dRGB = c - tap.rgb;
+		const float3 dNrm = n - tap.nrm;
+		const float3 dPos = x - tap.pos;
+		const float wrt = hmin(expf(dot(dRGB, dRGB) / sigmas.x), 1.0f);
+		const float wn = hmin(expf(-hmax(dot(dNrm, dNrm), 0.0f) / sigmas.y), 1.0f);
+		const float wx = hmin(expf(-dot(dPos, dPos) / sigmas.z), 1.0f);
+		const float currK = h[j] * wrt * wn * wx;
+		k += currK;
+		d += tap.rgb * currK;
+	}
+	c = d / ((k == 0.0f) ? 1.0f : k);
+
+	// Luminance statistics for [ScheduleFrame()]
+	PixStats& stats = pixStats[ndx];
+	const float luma = dot(xyz(tx), float3{ 0.2126f, 0.7152f, 0.0722f });
+	stats.n += 1;
+	const float delta = luma - stats.mean;
+	stats.mean += delta / stats.n;
+	stats.m2 += delta * (luma - stats.mean);
+
+	// Temporal AA ([FrameSmoothing(...)])
+	const PixHistory pixHistory = aaBuffer[ndx];
+	const u4Byte sampleCount = pixHistory.sampleCount + 1;
+	float4 currAccum = xyzw(xyz(pixHistory.currSampleAccum) + (c * tx.w),
+							pixHistory.currSampleAccum.w + tx.w);
+	if (sampleCount / RefStuff::NUM_AA_SAMPLES >= 1)
+	{ currAccum = currAccum - (pixHistory.currSampleAccum / (float)RefStuff::NUM_AA_SAMPLES); }
+	aaBuffer[ndx] = { currAccum, sampleCount };
+	c = hmax(xyz(currAccum) / currAccum.w, 0.0f);
+
+	// Tonemap, then flip into window space; the shader's flip maps row zero one past
+	// the last row, so that write is dropped (as it is on the GPU)
+	const float3 imgOut = HDR(c, 1.0f);
+	const u4Byte outY = height - pxY;
+	if (outY < height)
+	{
+		auto unorm = [](float v) { return (uByte)((fminf(fmaxf(v, 0.0f), 1.0f) * 255.0f) + 0.5f); };
+		displayTexLDR[pxX + (outY * width)] = { { unorm(imgOut.x), unorm(imgOut.y), unorm(imgOut.z), 255 } };
+	}
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "Typedefs.h"
+#include "RefShading.h"
+#include "PathQueues.h"
+
+// CPU reference implementation of the path-tracing pipeline in [Renderer]
+// ([LensSampler] -> ([RayMarch] -> [RnderDispEditor] -> [SurfSampler]) x bounces
+// -> [RasterPrep]), for machines without a D3D12 device
+// Each shader becomes a per-path member function reading + writing the same
+// per-pixel buffers as its GPU counterpart, run as a wavefront: every stage
+// processes all of the frame's live paths across the worker threads before
+// the next stage starts, like the GPU's dispatches
+// Append/consume buffers become [PathQueues] (per-worker chunks flushed into
+// shared queues, one per material + one for [traceables]), and the indirect
+// dispatches sized by [RnderDispEditor] become loops over the compacted
+// queues
+// Seed zero reproduces the GPU's random streams; other seeds offset every
+// stream so independent renders can be averaged
+class RefRenderer
+{
+	public:
+		struct Settings
+		{
+			u4Byte width; // Should be multiples of the tile width/height
+			u4Byte height;
+			u4Byte seed;
+			RefMaths::float3 cameraPos;
+			RefMaths::float3 cameraLook; // View direction (not the focal position)
+			u4Byte numThreads; // Zero for one worker per hardware thread
+			u4Byte coneTileWidth; // Pixels per side of each cone-marching prepass tile; zero disables the prepass
+			bool temporalHits; // Start camera rays from the previous frames' hit distances, reprojected into the current view
+			u4Byte sampleBudget; // Camera rays per frame, spent on the pixels with the least certain means; zero traces [TilePx(...)]'s fixed pattern instead
+			bool russianRoulette; // End dim paths early past their first surface ([RUSSIAN_ROULETTE] in [SurfSampler.hlsl])
+			const uByte* ditherRGBA; // [DITHER_TEX_WIDTH]x[DITHER_TEX_WIDTH] 8bpc RGBA texels
+		};
+
+		// Marching costs, summed over every frame so far
+		struct MarchCounts
+		{
+			u8Byte rays; // Camera rays
+			u8Byte steps;
+			u8Byte evals; // Includes the samples verifying reprojected start distances
+			u8Byte guesses; // Rays with a reprojected start distance to verify
+			u8Byte reuses; // Guesses that passed verification
+			u8Byte bounceRays; // Rays marched from surfaces (so mean path length is [(rays + bounceRays) / rays])
+			u8Byte bounceEvals;
+		};
+
+		RefRenderer(const Settings& settings);
+		~RefRenderer() = default;
+
+		// Move the camera before the next frame (e.g. for scripted camera paths);
+		// [look] is a view direction, like [Settings::cameraLook]
+		void MoveCamera(RefMaths::float3 pos, RefMaths::float3 look);
+
+		// Render one frame (one sample for a quarter of the image, or for
+		// [sampleBudget] pixels, then post-processing for the same pixels), then
+		// advance the frame counter
+		void Frame();
+
+		// Write the tonemapped image to [path]; returns false if encoding/writing
+		// fails
+		bool SavePNG(const char* path) const;
+
+		u4Byte NumThreads() const;
+		MarchCounts PrimaryCounts() const;
+
+		// Mean luminance of every pixel's samples so far (see [pixStats]), for
+		// measuring convergence
+		void LumaMeans(std::vector<float>& means) const;
+
+		// Mean of the per-pixel luminance means, + its standard error (from each
+		// pixel's sample variance); pixels with fewer than two samples are skipped
+		void ImageLuma(double& mean, double& stdErr) const;
+
+	private:
+		// Temporal AA history for each pixel (see [PixHistory])
+		struct PixHistory
+		{
+			RefMaths::float4 currSampleAccum;
+			u4Byte sampleCount;
+		};
+
+		// Running luminance statistics for each pixel's samples (Welford's
+		// method), driving the adaptive scheduler
+		struct PixStats
+		{
+			float mean;
+			float m2; // Sum of squared differences from the mean
+			u4Byte n;
+		};
+
+		// Rays stored as origin + direction ([float2x3] on the GPU)
+		struct Ray
+		{
+			RefMaths::float3 ori;
+			RefMaths::float3 dir;
+		};
+
+		// Shader stages; tile stages take linear tile IDs, path stages take
+		// linear pixel IDs; stages appending paths push them into [pathQueues]
+		// from [worker]
+		// [ConePrepass] marches one cone per [coneTileWidth]-sized tile, bounding
+		// every camera ray [LensSampler] can generate inside it; primary rays start
+		// marching from the distance it finds
+		// [ReprojPrepass] projects the last surface hit by each pixel's camera ray
+		// into the current view, keeping the nearest hit distance landing in each
+		// pixel; camera rays try starting just short of the nearest distance around
+		// their pixel
+		void ConePrepass(u4Byte linConeTileID);
+		void ReprojPrepass(u4Byte ndx);
+		void LensSampler(u4Byte linTileID, u4Byte worker);
+		void RayMarch(u4Byte ndx, u4Byte worker);
+		void SurfSampler(u4Byte ndx, u4Byte worker);
+		void RasterPrep(u4Byte linTileID);
+
+		// Pixel traced for [linTileID] this frame, as a linear index ([TilePx(...)]);
+		// with a [sampleBudget], [linTileID] indexes [framePx] instead
+		u4Byte TilePx(u4Byte linTileID) const;
+
+		// Fill [framePx] with the [sampleBudget] pixels whose mean luminance has
+		// the largest relative error, estimated from [pixStats]; pixels with too
+		// few samples to estimate from come first
+		void ScheduleFrame();
+
+		// Run [stage(worker, item)] for items [0...numItems), spread across the
+		// worker threads [itemsPerClaim] at a time; flushes each worker's
+		// [pathQueues] chunks once it runs out of items
+		template<typename Stage>
+		void ForItems(u4Byte numItems, u4Byte itemsPerClaim, const Stage& stage);
+
+		u4Byte width;
+		u4Byte height;
+		u4Byte area;
+		u4Byte tilingWidth;
+		u4Byte tilingHeight;
+		u4Byte coneTileWidth;
+		u4Byte coneTilingWidth;
+		u4Byte coneTilingHeight;
+		bool temporalHits;
+		u4Byte sampleBudget;
+		bool russianRoulette;
+		u4Byte seed;
+		u4Byte frameCtr;
+		u4Byte numThreads;
+		RefMaths::float3 cameraPos;
+		RefMaths::float3 viewBasis[3]; // Camera-to-world rotation (rows of [XMMatrixLookAtLH(...)]'s basis)
+		RefShading::SceneInfo scene;
+		const uByte* ditherRGBA;
+
+		// Per-pixel buffers (see [Renderer]'s rendering buffer); the display
+		// texture holds path throughput/radiance in [rgb] + the lens filter weight
+		// in [a]
+		std::vector<Ray> rays;
+		std::vector<RefMaths::float3> rayOris;
+		std::vector<u4Byte> figIDs;
+		std::vector<RefMaths::float3> posBuffer;
+		std::vector<RefMaths::float3> nrmBuffer;
+		std::vector<RefMaths::float4> displayTex;
+		std::vector<PixHistory> aaBuffer;
+		std::vector<PixStats> pixStats;
+		std::vector<RefShading::PhiloStrm> randBuf;
+		std::vector<uByte4> displayTexLDR;
+		std::vector<float> coneStarts; // Safe start distances per prepass tile
+		std::vector<RefMaths::float4> prevHits; // World-space position of each pixel's last camera-ray hit in [xyz], [w] is zero for misses
+		std::vector<std::atomic<u4Byte>> reprojDists; // Nearest reprojected hit distance per pixel, as float bits (infinity where nothing landed)
+		std::vector<MarchCounts> workerCounts; // One per worker, summed by [PrimaryCounts()]
+		std::vector<float> pxPriorities; // Scheduling priority per pixel, rebuilt every frame
+		std::vector<u4Byte> pxOrder; // Pixel indices, partially ordered by priority
+		std::vector<u4Byte> framePx; // Pixels traced this frame, in index order
+
+		// Paths waiting for each stage
+		PathQueues pathQueues;
+};
@@ -0,0 +1,380 @@
+#include "RefGlobals.h"
+#include "RefShading.h"
+
+using namespace RefMaths;
+
+namespace RefShading
+{
+	SceneInfo DefaultScene()
+	{
+		SceneInfo scene;
+		scene.systemOri = { 0.0f, 0.0f, 0.0f };
+		scene.starScale = RefStuff::STAR_RADIUS;
+		scene.planetScale = RefStuff::PLANET_RADIUS;
+		scene.juliaCoeffs = { RefStuff::PLANET_JULIA_COEFFS[0], RefStuff::PLANET_JULIA_COEFFS[1],
+							  RefStuff::PLANET_JULIA_COEFFS[2], RefStuff::PLANET_JULIA_COEFFS[3] };
+		return scene;
+	}
+
+	// Streams come from [Philox], which matches the shader's seeding + iteration
+	// bit-for-bit
+	void strmBuilder(u4Byte ndx, PhiloStrm& strm)
+	{
+		Philox::Seed(ndx, strm);
+	}
+
+	float4 philoxPermu01(PhiloStrm& strm)
+	{
+		Philox::Permu(strm);
+		return { Philox::ToFloat01(strm.ctr[0]), Philox::ToFloat01(strm.ctr[1]),
+				 Philox::ToFloat01(strm.ctr[2]), Philox::ToFloat01(strm.ctr[3]) };
+	}
+
+	float3 BoundingSphereTrace(float3 pt, float3 ro, float4 sphGeo)
+	{
+		const float3 rd = normalize((pt - ro) + RefStuff::EPSILON_MIN);
+		ro -= xyz(sphGeo);
+		const float b = 2.0f * dot(rd, ro);
+		const float c = dot(ro, ro) - (sphGeo.w * sphGeo.w);
+		const float dsc = (b * b) - (4.0f * c);
+		float2 tt = { -b / 2.0f, -b / 2.0f };
+		if (dsc > 0.0f)
+		{
+			const float q = -0.5f * (b + sign(b) * sqrtf(dsc));
+			tt = { q, c / q };
+		}
+		tt = { hmin(tt.x, tt.y), hmax(tt.x, tt.y) };
+		return { tt.x, tt.y, (tt.x >= 0.0f && dsc >= 0.0f) ? 1.0f : 0.0f };
+	}
+
+	// Quaternion product with the real part in [x]
+	static float4 QtnProduct2(float4 qtnA, float4 qtnB)
+	{
+		const float3 aIm = { qtnA.y, qtnA.z, qtnA.w };
+		const float3 bIm = { qtnB.y, qtnB.z, qtnB.w };
+		const float x = qtnA.x * qtnB.x - dot(aIm, bIm);
+		const float3 yzw = (qtnA.x * bIm) + (qtnB.x * aIm) + cross(aIm, bIm);
+		return { x, yzw.x, yzw.y, yzw.z };
+	}
+
+	float Julia(float4 juliaCoeffs, float3 coord)
+	{
+		float4 z = { coord.x, coord.y, coord.z, juliaCoeffs.w };
+		float4 dz = { 1.0f, 0.0f, 0.0f, 0.0f };
+		u4Byte i = 0;
+		while (i < RefStuff::ITERATIONS_JULIA &&
+			   dot(z, z) < RefStuff::BAILOUT_JULIA_DE)
+		{
+			dz = QtnProduct2(z, dz) * 2.0f;
+			z = QtnProduct2(z, z) + juliaCoeffs;
+			i += 1;
+		}
+		const float r = length(z);
+		return (0.5f * logf(r) * r / length(dz));
+	}
+
+	// Forward-mode dual quaternions; [d[i]] carries the derivative of [v] along
+	// planet-space axis [i]
+	namespace
+	{
+		struct DualQtn
+		{
+			float4 v;
+			float4 d[3];
+		};
+
+		DualQtn DualProduct(const DualQtn& a, const DualQtn& b)
+		{
+			DualQtn p;
+			p.v = QtnProduct2(a.v, b.v);
+			for (u4Byte i = 0; i < 3; i += 1)
+			{
+				p.d[i] = QtnProduct2(a.d[i], b.v) + QtnProduct2(a.v, b.d[i]);
+			}
+			return p;
+		}
+
+		// The cross products in [a'a + aa'] cancel, so squares are cheaper than
+		// general products
+		DualQtn DualSquare(const DualQtn& a)
+		{
+			DualQtn p;
+			p.v = QtnProduct2(a.v, a.v);
+			const float3 aIm = { a.v.y, a.v.z, a.v.w };
+			for (u4Byte i = 0; i < 3; i += 1)
+			{
+				const float4 da = a.d[i];
+				const float3 daIm = { da.y, da.z, da.w };
+				const float3 yzw = (a.v.x * daIm) + (da.x * aIm);
+				p.d[i] = float4{ a.v.x * da.x - dot(aIm, daIm), yzw.x, yzw.y, yzw.z } * 2.0f;
+			}
+			return p;
+		}
+	}
+
+	float4 JuliaDual(float4 juliaCoeffs, float3 coord)
+	{
+		// Same iteration as [Julia(...)], with [z] + [dz] differentiated alongside
+		// ([w] is the fixed slice, so it never varies with [coord])
+		DualQtn z = { { coord.x, coord.y, coord.z, juliaCoeffs.w },
+					  { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f } } };
+		DualQtn dz = { { 1.0f, 0.0f, 0.0f, 0.0f }, {} };
+		u4Byte i = 0;
+		while (i < RefStuff::ITERATIONS_JULIA &&
+			   dot(z.v, z.v) < RefStuff::BAILOUT_JULIA_DE)
+		{
+			dz = DualProduct(z, dz);
+			dz.v = dz.v * 2.0f;
+			for (u4Byte j = 0; j < 3; j += 1) { dz.d[j] = dz.d[j] * 2.0f; }
+			z = DualSquare(z);
+			z.v = z.v + juliaCoeffs;
+			i += 1;
+		}
+
+		// [0.5 * log(r) * r / |dz|], differentiated by the product/quotient rules
+		const float r = length(z.v);
+		const float dzLen = length(dz.v);
+		const float logR = logf(r);
+		float3 grad;
+		float* gradAxes[3] = { &grad.x, &grad.y, &grad.z };
+		for (u4Byte j = 0; j < 3; j += 1)
+		{
+			const float dr = dot(z.v, z.d[j]) / r;
+			const float dDzLen = dot(dz.v, dz.d[j]) / dzLen;
+			*gradAxes[j] = 0.5f * ((dr * (1.0f + logR)) - (logR * r * dDzLen / dzLen)) / dzLen;
+		}
+		return xyzw(grad, 0.5f * logR * r / dzLen);
+	}
+
+	float3 PtToPlanet(float3 pt, float planetScale, float* foldAngle)
+	{
+		const float2 ray2D = { pt.x, pt.z };
+		const float theta = atan2f(ray2D.y, ray2D.x + RefStuff::EPSILON_MIN);
+		const float thetaOffs = fmodf(theta, RefStuff::RADS_PER_PLANET * 2.0f) - RefStuff::RADS_PER_PLANET;
+		if (foldAngle != nullptr) { *foldAngle = theta - thetaOffs; }
+		const float len = sqrtf(ray2D.x * ray2D.x + ray2D.y * ray2D.y);
+		pt = { cosf(thetaOffs) * len, pt.y, sinf(thetaOffs) * len };
+		pt -= float3{ RefStuff::PLANETARY_RING_RADIUS, 0.0f, 0.0f };
+		return pt / planetScale;
+	}
+
+	static float PlanetDF(float3 pt, const SceneInfo& scene, float eps)
+	{
+		const float jDist = Julia(scene.juliaCoeffs, PtToPlanet(pt, scene.planetScale));
+		return hmax(jDist * scene.planetScale, eps * 0.9f);
+	}
+
+	static float StarDF(float3 pt, float3 rayOri, bool useFigBounds, const SceneInfo& scene)
+	{
+		const float4 linTransf = xyzw(scene.systemOri, scene.starScale);
+		const float sphereDF = length(pt - scene.systemOri) - scene.starScale;
+		if (!useFigBounds) { return sphereDF; }
+		const float3 isect = BoundingSphereTrace(pt, rayOri, linTransf);
+		return sphereDF + ((isect.z == 0.0f) ? RefStuff::MAX_RAY_DIST : 0.0f);
+	}
+
+	FieldSample SceneField(float3 pt, float3 rayOri, bool useFigBounds, const SceneInfo& scene, float eps)
+	{
+		// Planets are type/ID (1, 1), the star is (0, 0) ([trackedFigUnion(...)])
+		const float planetDist = PlanetDF(pt, scene, eps);
+		const float starDist = StarDF(pt, rayOri, useFigBounds, scene);
+		if (planetDist > starDist) { return { starDist, 0.0f, 0.0f }; }
+		return { planetDist, 1.0f, 1.0f };
+	}
+
+	float3 PlanetGrad(float3 samplePoint, const SceneInfo& scene, float eps)
+	{
+		// Tetrahedral gradient ([tetGrad(...)])
+		const float3 e0 = { eps, -eps, -eps };
+		const float3 e1 = { -eps, -eps, eps };
+		const float3 e2 = { -eps, eps, -eps };
+		const float3 e3 = { eps, eps, eps };
+		const float t1 = PlanetDF(samplePoint + e0, scene, eps);
+		const float t2 = PlanetDF(samplePoint + e1, scene, eps);
+		const float t3 = PlanetDF(samplePoint + e2, scene, eps);
+		const float t4 = PlanetDF(samplePoint + e3, scene, eps);
+		const float3 gradVec = t1 * e0 + t2 * e1 + t3 * e2 + t4 * e3;
+		return gradVec / length(gradVec);
+	}
+
+	float3 PlanetDirToWorld(float3 dir, float foldAngle)
+	{
+		// Folding rotates by [-foldAngle] about y, so unfolding rotates by [foldAngle]
+		const float c = cosf(foldAngle);
+		const float sn = sinf(foldAngle);
+		return { c * dir.x - sn * dir.z, dir.y, sn * dir.x + c * dir.z };
+	}
+
+	float3 PlanetGradDual(float3 samplePoint, const SceneInfo& scene)
+	{
+		// Scaling the planet scales distances back, so planet-space gradients
+		// only need unfolding
+		float foldAngle;
+		const float3 grad = xyz(JuliaDual(scene.juliaCoeffs, PtToPlanet(samplePoint, scene.planetScale, &foldAngle)));
+		return normalize(PlanetDirToWorld(grad, foldAngle));
+	}
+
+	void NormalSpace(float3 normal, float3 space[3])
+	{
+		const float3 absNormal = habs(normal);
+		const float3 basisX = (absNormal.x > absNormal.y) ? float3{ normal.z, 0.0f, -normal.x } :
+															 float3{ 0.0f, normal.z, -normal.y };
+		space[0] = normalize(basisX);
+		space[1] = normal;
+		space[2] = normalize(cross(normal, basisX));
+	}
+
+	// [wo] + [norml] only keep the signature in step with [Materials.hlsli]; diffuse
+	// directions are generated in normal space + don't depend on either
+	float4 DiffuseDir(float3 /*wo*/, float3 /*norml*/, float2 uv01)
+	{
+		// Concentric disk mapping, projected onto the hemisphere
+		float2 uv = (uv01 * 2.0f) - float2{ 1.0f, 1.0f };
+		if (!(uv.x == 0.0f && uv.y == 0.0f))
+		{
+			const float uvArr[2] = { uv.x, uv.y };
+			const float2 absUV = { fabsf(uv.x), fabsf(uv.y) };
+			const float r = hmax(absUV.x, absUV.y) * sign(uvArr[absUV.x < absUV.y]);
+			const float uvRatio = uvArr[absUV.x > absUV.y] / uvArr[absUV.y > absUV.x];
+			const bool rIsV = (r == uv.y);
+			const float coeffs[2] = { -1.0f, 1.0f };
+			const float theta = (((RefStuff::PI / 2.0f) * (rIsV ? 1.0f : 0.0f)) - ((RefStuff::PI / 4.0f) * uvRatio)) * coeffs[rIsV];
+			uv = float2{ cosf(theta), sinf(theta) } * r;
+		}
+		const float3 wi = normalize(float3{ uv.x, sqrtf(1.0f - (uv.x * uv.x + uv.y * uv.y)), uv.y });
+		return xyzw(wi, wi.y / RefStuff::PI); // [DiffusePDF(wi, UNIT_Y)]
+	}
+
+	float3 DiffuseBRDF(float4 surf, const float3 surfDirs[3])
+	{
+		// Oren-Nayar
+		const float3 lambert = xyz(surf) / RefStuff::PI;
+		surf.w *= RefStuff::HALF_PI;
+		const float variSqr = surf.w * surf.w;
+		const float a = 1.0f - (variSqr / (2.0f * (variSqr + 0.33f)));
+		const float b = (0.45f * variSqr) / (variSqr + 0.09f);
+		const float2 cThetaIO = { dot(surfDirs[1], surfDirs[0]),
+								  dot(surfDirs[1], surfDirs[2]) };
+		const float2 sThetaIO = { sqrtf(hmax(1.0f - (cThetaIO.x * cThetaIO.x), 0.0f)),
+								  sqrtf(hmax(1.0f - (cThetaIO.y * cThetaIO.y), 0.0f)) };
+		const float cosPhiSection = dot(surfDirs[2] - surfDirs[1] * cThetaIO.y,
+										surfDirs[1] - surfDirs[1] * cThetaIO.x);
+		const float orenNayar = a + (b * hmax(0.0f, cosPhiSection)) *
+									(sThetaIO.x * sThetaIO.y) /
+									hmax(cThetaIO.x, cThetaIO.y);
+		return lambert * orenNayar;
+	}
+
+	float3 SurfRGB(float3 wo, float3 norml)
+	{
+		return { fabsf(cross(wo, norml).x), 0.5f, 0.5f };
+	}
+
+	float3 Emission(float srcBrightness, float distance)
+	{
+		return xxx(srcBrightness / (RefStuff::FOUR_PI * hmax(distance * distance, 1.0f)));
+	}
+
+	float ZERO_PDF_REMAP(float x)
+	{
+		return (x == 0.0f) ? (1.0f / RefStuff::EPSILON_MIN) : x;
+	}
+
+	static float3 StellarSurfPos(float4 starInfo, float2 uv01, float3 targFigPos)
+	{
+		const float3 targVec = xyz(starInfo) - targFigPos;
+		const float2 randUV = ((uv01 * 2.0f) - float2{ 1.0f, 1.0f }) * starInfo.w;
+		const float3 yJitter = { 0.0f, randUV.y, 0.0f };
+		const float3 localXJitter = cross(normalize(targVec), float3{ 0.0f, 1.0f, 0.0f }) * randUV.x;
+		return (normalize(targVec + yJitter + localXJitter) * starInfo.w) + xyz(starInfo);
+	}
+
+	static float MISWeight(float samplesDistroA, float distroAPDF,
+						   float samplesDistroB, float distroBPDF)
+	{
+		const float distroA = samplesDistroA * distroAPDF;
+		const float distroB = samplesDistroB * distroBPDF;
+		const float distroASqr = distroA * distroA;
+		const float distroBSqr = distroB * distroB;
+		return distroASqr / (distroASqr + distroBSqr);
+	}
+
+	static OccData OccTest(float3 rayOri, float3 rayDir, float targID, const SceneInfo& scene, float eps)
+	{
+		OccData occData = { rayDir, eps, rayOri, true, 0x11 };
+		for (u4Byte i = 0; i < RefStuff::MAX_OCC_MARCHER_STEPS; i += 1)
+		{
+			const float3 rayVec = rayOri + (rayDir * occData.dist);
+			const FieldSample sceneField = SceneField(rayVec, rayOri, false, scene, eps);
+			if (sceneField.dist < eps)
+			{
+				occData.occ = (sceneField.figID != targID);
+				occData.endPos = rayVec;
+				occData.nearID = (u4Byte)sceneField.figID;
+				break;
+			}
+			occData.dist += sceneField.dist;
+			eps *= 1.05f;
+		}
+		return occData;
+	}
+
+	float4 DiffuLiGather(float4 surf, float diffuP, float3 n, float3 wo,
+						 float3 pt, const float3 nSpace[3], const SceneInfo& scene,
+						 float eps, float4 rand01)
+	{
+		// Choose between light + surface sampling with MIS weights
+		float4 gatherDir = DiffuseDir(wo, n, { rand01.x, rand01.y });
+		const float srcPDF = 1.0f / RefStuff::TWO_PI; // [StellarPosPDF()]
+		const float mis = MISWeight(1, srcPDF,
+									1, gatherDir.w / diffuP);
+		const float4 starInfo = xyzw(scene.systemOri, scene.starScale);
+		if (rand01.z > mis)
+		{
+			const float3 stellarSurfPos = StellarSurfPos(starInfo, { rand01.w, rand01.z }, pt);
+			gatherDir = xyzw(normalize(stellarSurfPos - pt), srcPDF);
+		}
+		else
+		{
+			gatherDir = xyzw(mul(xyz(gatherDir), nSpace), gatherDir.w);
+			if (BoundingSphereTrace(pt, pt - xyz(gatherDir) * eps, starInfo).z == 0.0f)
+			{ return { 0.0f, 0.0f, 0.0f, 1.0f }; } // Filter out diffuse rays that never intersect the system star
+		}
+
+		// Shade visible light samples
+		// The shader evaluates the BRDF with [occData[0].yzw] (the sample direction's [yz], then
+		// its distance) as the incident direction; kept as-is here so results match
+		const OccData occData = OccTest(pt, xyz(gatherDir), (float)RefStuff::STELLAR_FIG_ID, scene, eps);
+		const float3 neeRGB = Emission(RefStuff::STELLAR_BRIGHTNESS, occData.dist) *
+							  fabsf(dot(n, occData.dir));
+		const float3 brdfDirs[3] = { { occData.dir.y, occData.dir.z, occData.dist }, n, wo };
+		const float3 brdf = DiffuseBRDF(surf, brdfDirs) / gatherDir.w;
+		return xyzw(neeRGB * brdf, occData.occ ? 1.0f : 0.0f);
+	}
+
+	static float BlackmanHarrisPerAxis(float filtVal, u4Byte numAASamples)
+	{
+		const float alph0 = 0.35875f;
+		const float alph1 = 0.48829f;
+		const float alph2 = 0.14128f;
+		const float alph3 = 0.01168f;
+		const float constFract = (RefStuff::PI * filtVal) / (numAASamples - 1);
+		return alph0 - (alph1 * cosf(2.0f * constFract)) +
+					   (alph2 * cosf(4.0f * constFract)) -
+					   (alph3 * cosf(6.0f * constFract));
+	}
+
+	float BlackmanHarris(float2 sampleXY, u4Byte numAASamples)
+	{
+		return BlackmanHarrisPerAxis(fabsf(sampleXY.x), numAASamples) *
+			   BlackmanHarrisPerAxis(fabsf(sampleXY.y), numAASamples);
+	}
+
+	float3 HDR(float3 traceColor, float exposure)
+	{
+		// Hejl & Burgess-Dawson
+		traceColor = traceColor * exposure;
+		const float3 hdr = hmax(traceColor - xxx(0.004f), 0.0f);
+		return (hdr * (hdr * 6.2f + 0.5f)) / (hdr * (hdr * 6.2f + 1.7f) + 0.06f);
+	}
+}
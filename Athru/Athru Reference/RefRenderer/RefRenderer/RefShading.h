@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "RefMaths.h"
+#include "Philox.h"
+
+// CPU ports of the shading utilities shared by the rendering shaders
+// ([GenericUtility.hlsli], [PhiloInit.hlsli], [Core3D.hlsli], [Fractals.hlsli],
+// [Materials.hlsli], [LightingUtility.hlsli], [AA.hlsli], [HDR.hlsli]); each
+// function keeps the name + argument order of its shader counterpart, and
+// follows it line-for-line (quirks included) so reference images stay
+// comparable with GPU captures
+// Only the paths reachable from the current pipeline are ported (diffuse
+// surfaces, stellar light, approximate planet gradients)
+namespace RefShading
+{
+	// Per-path Philox state ([PhiloStrm] in [GenericUtility.hlsli])
+	using PhiloStrm = Philox::Strm;
+
+	// Scene description normally carried by the figure buffer + [gpuInfo]
+	struct SceneInfo
+	{
+		RefMaths::float3 systemOri;
+		float starScale;
+		float planetScale;
+		RefMaths::float4 juliaCoeffs; // Julia parameters in [xyz], w-slice in [w]
+	};
+
+	// Figures from the default system
+	SceneInfo DefaultScene();
+
+	// Nearest-figure info returned by [SceneField(...)] ([float2x3]'s zeroth row)
+	struct FieldSample
+	{
+		float dist;
+		float dfType;
+		float figID;
+	};
+
+	// Occlusion-test results ([OccTest(...)]'s [float3x4] output)
+	struct OccData
+	{
+		RefMaths::float3 dir;
+		float dist;
+		RefMaths::float3 endPos;
+		bool occ;
+		u4Byte nearID;
+	};
+
+	// Random streams
+	void strmBuilder(u4Byte ndx, PhiloStrm& strm);
+	RefMaths::float4 philoxPermu01(PhiloStrm& strm); // [iToFloatV(philoxPermu(strm))]
+
+	// Scene distance fields
+	float Julia(RefMaths::float4 juliaCoeffs, RefMaths::float3 coord); // Planet-space distance estimate (see [JuliaPackets] for batches)
+	RefMaths::float3 BoundingSphereTrace(RefMaths::float3 pt, RefMaths::float3 ro, RefMaths::float4 sphGeo);
+	FieldSample SceneField(RefMaths::float3 pt, RefMaths::float3 rayOri, bool useFigBounds, const SceneInfo& scene, float eps);
+	RefMaths::float3 PlanetGrad(RefMaths::float3 samplePoint, const SceneInfo& scene, float eps); // Four-tap ([tetGrad(...)])
+
+	// Planet-space distance estimate in [w], with its gradient in [xyz] from the
+	// same pass (differentiating the iteration with dual quaternions) ([JuliaDual(...)])
+	RefMaths::float4 JuliaDual(RefMaths::float4 juliaCoeffs, RefMaths::float3 coord);
+
+	// Normalized planet gradient from [JuliaDual(...)]; far more accurate than
+	// [PlanetGrad(...)] at about the same cost. Ignores [PlanetDF]'s near-surface clamp, which would
+	// zero the gradient wherever it applies
+	RefMaths::float3 PlanetGradDual(RefMaths::float3 samplePoint, const SceneInfo& scene);
+
+	// Fold points into the symmetric planet's frame ([SysSymmet(...)] + [PtToPlanet(...)]);
+	// writes the fold's rotation about the y-axis into [foldAngle] if given
+	RefMaths::float3 PtToPlanet(RefMaths::float3 pt, float planetScale, float* foldAngle = nullptr);
+
+	// Rotate planet-space directions (e.g. gradients) back out of [PtToPlanet(...)]'s fold
+	RefMaths::float3 PlanetDirToWorld(RefMaths::float3 dir, float foldAngle);
+	void NormalSpace(RefMaths::float3 normal, RefMaths::float3 space[3]);
+
+	// Diffuse materials + lighting
+	RefMaths::float4 DiffuseDir(RefMaths::float3 wo, RefMaths::float3 norml, RefMaths::float2 uv01);
+	RefMaths::float3 DiffuseBRDF(RefMaths::float4 surf, const RefMaths::float3 surfDirs[3]);
+	RefMaths::float3 SurfRGB(RefMaths::float3 wo, RefMaths::float3 norml);
+	RefMaths::float3 Emission(float srcBrightness, float distance);
+	RefMaths::float4 DiffuLiGather(RefMaths::float4 surf, float diffuP, RefMaths::float3 n, RefMaths::float3 wo,
+								   RefMaths::float3 pt, const RefMaths::float3 nSpace[3], const SceneInfo& scene,
+								   float eps, RefMaths::float4 rand01);
+	float ZERO_PDF_REMAP(float x);
+
+	// Post-processing
+	float BlackmanHarris(RefMaths::float2 sampleXY, u4Byte numAASamples);
+	RefMaths::float3 HDR(RefMaths::float3 traceColor, float exposure);
+}
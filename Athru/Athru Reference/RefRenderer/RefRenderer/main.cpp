@@ -0,0 +1,498 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "RefGlobals.h"
+#include "RefRenderer.h"
+#include "JuliaPackets.h"
+#include "Philox.h"
+#include "PathQueues.h"
+#include "MarchLab.h"
+#include "PlanetGrads.h"
+#include <thread>
+#include "lodepng.h"
+
+// Command-line front-end for [RefRenderer]; renders the default system from
+// the given camera + writes the tonemapped result to a PNG
+// Only depends on the C++ standard library, lodepng + a few self-contained
+// UtilityLib files, so it also builds away from Visual Studio, e.g. (from the
+// solution directory)
+// U="Athru Utilities/UtilityLib/UtilityLib"
+// g++ -std=c++17 -O2 -pthread -I"$U" -I"Third Party/Lode Vandevenne/lodepng-master"
+//     "Athru Reference/RefRenderer/RefRenderer/"*.cpp "$U/CPUFeatures.cpp" "$U/"Philox*.cpp
+//     "Third Party/Lode Vandevenne/lodepng-master/lodepng.cpp" -o RefRenderer
+// The dither texture is loaded from a path relative to the working directory
+// (like the main application), so run from the solution directory or pass
+// [--dither]
+
+static void PrintUsage()
+{
+	fprintf(stderr,
+			"usage: RefRenderer [options]\n"
+			"  --out <file.png>     output image (default reference.png)\n"
+			"  --seed <n>           random seed; 0 reproduces the GPU's streams (default 0)\n"
+			"  --camera <x y z>     camera position (default 700 0 -10)\n"
+			"  --look <x y z>       view direction (default 0 0 1)\n"
+			"  --frames <n>         frames to accumulate; every four frames trace each pixel once (default 16)\n"
+			"  --size <w h>         image size, in multiples of two (default 1920 1080)\n"
+			"  --threads <n>        worker threads; 0 uses every hardware thread (default 0)\n"
+			"  --cone-tile <n>      pixels per side of each cone-marching prepass tile; 0 disables the prepass (default 8)\n"
+			"  --temporal-hits <n>  1 starts camera rays from reprojected hit distances of earlier frames, 0 doesn't (default 1)\n"
+			"  --sample-budget <n>  camera rays per frame, spent on the noisiest pixels; 0 traces a fixed quarter of\n"
+			"                       the image per frame instead (default 0)\n"
+			"  --roulette <n>       1 ends dim paths early with Russian roulette, 0 traces every bounce (default 1)\n"
+			"  --dither <file.png>  blue-noise dither texture (default %s)\n"
+			"  --march-lab <prefix> compare ray-marching strategies from the camera instead of rendering;\n"
+			"                       writes step/evaluation heatmaps to <prefix>-<strategy>-{steps,evals}.png\n"
+			"  --omega <w>          relaxation for --march-lab's relaxed + enhanced strategies (default 1.6)\n"
+			"  --eps-growth <g>     --march-lab's hit-epsilon growth per step (default 1.175, as in the shader)\n"
+			"  --bench-julia <n>    check the Julia packet kernels against the scalar estimator on <n> points, then\n"
+			"                       print each one's throughput instead of rendering\n"
+			"  --bench-philox <n>   check the Philox kernels against the shader's arithmetic on <n> streams, then\n"
+			"                       print each one's throughput instead of rendering\n"
+			"  --bench-queues <n>   check [PathQueues] against shared queues over <n> paths, then print what each\n"
+			"                       costs per path (uses --threads) instead of rendering\n"
+			"  --bench-grads <n>    check dual-number planet gradients against finite differences at <n> points,\n"
+			"                       then print what each gradient method costs instead of rendering\n"
+			"  --bench-temporal <n> render <n> frames along scripted camera paths with + without reprojected start\n"
+			"                       distances, then print what camera rays cost on each path instead of rendering\n"
+			"  --bench-adaptive <n> render <n> frames with the fixed sampling pattern + the adaptive scheduler, then\n"
+			"                       print how fast each one converges on a reference instead of rendering\n"
+			"  --bench-roulette <n> render <n> frames with + without Russian roulette, check their mean luminance\n"
+			"                       agrees + print how much cheaper paths get instead of rendering\n",
+			RefStuff::DITHER_TEX_PATH);
+}
+
+// Check every Julia packet kernel the CPU supports against the scalar
+// estimator, then print how many points per second each one evaluates
+static int BenchJulia(u4Byte numPts)
+{
+	const bool valid = JuliaPackets::Valid(numPts);
+	JuliaPackets::Timing timings[4];
+	const u4Byte numTimings = JuliaPackets::Benchmark(numPts, timings);
+	const double scalarRate = timings[0].ptsPerSec;
+	printf("Julia estimator over %u points\n", numPts);
+	printf("  %-8s %6s %14s %9s %12s\n", "isa", "width", "points/s", "speedup", "max rel err");
+	for (u4Byte i = 0; i < numTimings; i += 1)
+	{
+		printf("  %-8s %6u %14.4g %8.2fx %12.3g\n", CPUFeatures::Name(timings[i].isa), timings[i].width,
+			   timings[i].ptsPerSec, (scalarRate > 0.0) ? timings[i].ptsPerSec / scalarRate : 0.0, timings[i].maxRelErr);
+	}
+	printf("packets %s the scalar estimator (tolerance %g)\n", valid ? "match" : "DON'T match", JuliaPackets::MAX_REL_ERR);
+	return valid ? 0 : 1;
+}
+
+// Check every Philox kernel the CPU supports against the shader's arithmetic,
+// then print how much random output each one generates per second
+static int BenchPhilox(u4Byte numStrms)
+{
+	constexpr u4Byte NUM_PERMUS = 64;
+	const bool valid = Philox::Valid(numStrms, 4);
+	Philox::Timing timings[4];
+	const u4Byte numTimings = Philox::Benchmark(numStrms, NUM_PERMUS, timings);
+	const double scalarRate = timings[0].gbPerSec;
+	printf("Philox4x32-8 over %u streams, %u permutations each\n", numStrms, NUM_PERMUS);
+	printf("  %-8s %6s %10s %9s\n", "isa", "width", "GB/s", "speedup");
+	for (u4Byte i = 0; i < numTimings; i += 1)
+	{
+		printf("  %-8s %6u %10.3f %8.2fx\n", CPUFeatures::Name(timings[i].isa), timings[i].width,
+			   timings[i].gbPerSec, (scalarRate > 0.0) ? timings[i].gbPerSec / scalarRate : 0.0);
+	}
+	printf("streams %s the shader's bit-for-bit\n", valid ? "match" : "DON'T match");
+	return valid ? 0 : 1;
+}
+
+// March every pixel with each of [RefMarching]'s strategies + print what
+// each one costs (+ how often it disagrees with plain sphere tracing)
+static int RunMarchLab(const MarchLab::Settings& settings)
+{
+	MarchLab::Stats stats[RefMarching::NUM_STRATEGIES];
+	MarchLab::PrepassStats prepass;
+	const bool saved = MarchLab::Run(settings, stats, prepass);
+	printf("ray marching at %ux%u (omega %g, eps growth %g)\n", settings.width, settings.height, settings.omega, settings.epsGrowth);
+	if (settings.coneTileWidth != 0)
+	{
+		printf("cone prepass over %u %ux%u tiles: %.3f evals/pixel, mean safe start %.1f, %.3fs\n",
+			   prepass.numCones, settings.coneTileWidth, settings.coneTileWidth, prepass.meanEvals, prepass.meanSkip, prepass.secs);
+	}
+
+	// Totals include the prepass, + are compared against sphere tracing without it
+	printf("  %-9s %10s %9s %10s %11s %9s %8s %9s %9s %12s %8s\n",
+		   "strategy", "mean steps", "max steps", "mean evals", "total evals", "vs sphere", "hits", "exhausted", "mismatch", "mean hit dt", "secs");
+	for (u4Byte i = 0; i < RefMarching::NUM_STRATEGIES; i += 1)
+	{
+		const MarchLab::Stats& stat = stats[i];
+		const double totalEvals = stat.meanEvals + prepass.meanEvals;
+		printf("  %-9s %10.2f %9u %10.2f %11.2f %8.2fx %7.2f%% %8.2f%% %8.3f%% %12.4g %8.3f\n",
+			   RefMarching::Name(stat.strategy), stat.meanSteps, stat.maxSteps, stat.meanEvals, totalEvals,
+			   (totalEvals > 0.0) ? prepass.baselineEvals / totalEvals : 0.0, stat.hitRate * 100.0,
+			   stat.exhaustedRate * 100.0, stat.mismatchRate * 100.0, stat.meanHitDelta, stat.secs);
+	}
+	if (settings.outPrefix != nullptr)
+	{
+		printf("%s heatmaps to %s-*.png\n", saved ? "wrote" : "COULDN'T write", settings.outPrefix);
+	}
+	return saved ? 0 : 1;
+}
+
+// Check dual-number planet gradients against finite differences (alongside
+// the shader's four-tap gradients), then print what each one costs
+static int BenchGrads(u4Byte numPts)
+{
+	PlanetGrads::Accuracy accuracy[PlanetGrads::NUM_METHODS];
+	const bool valid = PlanetGrads::Valid(numPts, accuracy);
+	double nsPerGrad[PlanetGrads::NUM_METHODS];
+	PlanetGrads::Benchmark(numPts, nsPerGrad);
+	const double tetRate = nsPerGrad[(u4Byte)PlanetGrads::METHODS::TETRAHEDRAL];
+	printf("planet gradients at %u shading points\n", numPts);
+	printf("  %-12s %10s %9s %11s %9s %9s\n", "method", "ns/grad", "speedup", "median err", "p99 err", "max err");
+	for (u4Byte i = 0; i < PlanetGrads::NUM_METHODS; i += 1)
+	{
+		printf("  %-12s %10.1f %8.2fx %10.4fd %8.3fd %8.2fd\n", PlanetGrads::Name((PlanetGrads::METHODS)i), nsPerGrad[i],
+			   (nsPerGrad[i] > 0.0) ? tetRate / nsPerGrad[i] : 0.0, accuracy[i].medianDeg, accuracy[i].p99Deg, accuracy[i].maxDeg);
+	}
+	printf("dual gradients %s finite differences (median tolerance %gd)\n", valid ? "match" : "DON'T match", PlanetGrads::MAX_DUAL_MEDIAN_DEG);
+	return valid ? 0 : 1;
+}
+
+// Render [numFrames] frames along a few scripted camera paths starting from
+// [settings]' camera, with + without reprojected start distances, then print
+// what camera rays cost to march on each path
+// Counts skip the first four frames, which trace every pixel for the first
+// time (+ so have nothing to reproject)
+static int BenchTemporal(RefRenderer::Settings settings, u4Byte numFrames)
+{
+	using namespace RefMaths;
+	struct CameraPath
+	{
+		const char* name;
+		float3 stepPos; // Camera-space motion per frame
+		float yawStep; // Radians per frame
+	};
+	const CameraPath paths[4] = { { "still", { 0.0f, 0.0f, 0.0f }, 0.0f },
+								  { "dolly", { 0.0f, 0.0f, 0.25f }, 0.0f },
+								  { "truck", { 0.25f, 0.0f, 0.0f }, 0.0f },
+								  { "pan", { 0.0f, 0.0f, 0.0f }, 0.001f } };
+	constexpr u4Byte NUM_WARMUP_FRAMES = 4;
+	const float3 zAxis = normalize(settings.cameraLook);
+	const float3 xAxis = normalize(cross(float3{ 0.0f, 1.0f, 0.0f }, zAxis));
+	const float3 viewBasis[3] = { xAxis, cross(zAxis, xAxis), zAxis };
+
+	printf("camera-ray marching over %u frames at %ux%u (cone tiles %u)\n", numFrames, settings.width, settings.height, settings.coneTileWidth);
+	printf("  %-6s %6s %10s %10s %9s %9s %9s %11s\n", "path", "reuse", "mean steps", "mean evals", "vs off", "verified", "accepted", "ms/frame");
+	for (const CameraPath& path : paths)
+	{
+		double offEvals = 0.0;
+		for (u4Byte reuse = 0; reuse < 2; reuse += 1)
+		{
+			settings.temporalHits = reuse != 0;
+			RefRenderer renderer(settings);
+			RefRenderer::MarchCounts warmup = { 0, 0, 0, 0, 0, 0, 0 };
+			const auto start = std::chrono::steady_clock::now();
+			auto warmStart = start;
+			for (u4Byte i = 0; i < numFrames; i += 1)
+			{
+				const float yaw = path.yawStep * i;
+				const float3 look = (viewBasis[2] * cosf(yaw)) + (viewBasis[0] * sinf(yaw));
+				renderer.MoveCamera(settings.cameraPos + (mul(path.stepPos, viewBasis) * (float)i), look);
+				if (i == NUM_WARMUP_FRAMES)
+				{
+					warmup = renderer.PrimaryCounts();
+					warmStart = std::chrono::steady_clock::now();
+				}
+				renderer.Frame();
+			}
+			const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - warmStart).count();
+			const RefRenderer::MarchCounts total = renderer.PrimaryCounts();
+			const double rays = (double)(total.rays - warmup.rays);
+			const double meanSteps = (rays > 0.0) ? (total.steps - warmup.steps) / rays : 0.0;
+			const double meanEvals = (rays > 0.0) ? (total.evals - warmup.evals) / rays : 0.0;
+			const u8Byte guesses = total.guesses - warmup.guesses;
+			const u8Byte reuses = total.reuses - warmup.reuses;
+			if (reuse == 0) { offEvals = meanEvals; }
+			const u4Byte numTimedFrames = (numFrames > NUM_WARMUP_FRAMES) ? numFrames - NUM_WARMUP_FRAMES : 0;
+			printf("  %-6s %6s %10.2f %10.2f %8.2fx %8.2f%% %8.2f%% %11.1f\n", path.name, (reuse != 0) ? "on" : "off", meanSteps, meanEvals,
+				   (meanEvals > 0.0) ? offEvals / meanEvals : 0.0, (rays > 0.0) ? (guesses * 100.0) / rays : 0.0,
+				   (guesses > 0) ? (reuses * 100.0) / guesses : 0.0, (numTimedFrames > 0) ? (secs * 1000.0) / numTimedFrames : 0.0);
+		}
+	}
+	return 0;
+}
+
+// Render [numFrames] frames with [RefRenderer]'s fixed sampling pattern + with
+// the adaptive scheduler at the same ray budget (a quarter of the image per
+// frame), printing how far each one's pixel means are from a reference as
+// camera rays accumulate
+// The reference is the fixed pattern over eight times as many frames, with
+// independent random streams; errors are relative ([(mean - ref)^2 / (ref^2 + 0.01)]),
+// so bright pixels (e.g. the star) don't swamp everything else
+static int BenchAdaptive(RefRenderer::Settings settings, u4Byte numFrames)
+{
+	constexpr u4Byte REF_FRAMES_SCALE = 8;
+	constexpr u4Byte FRAMES_PER_ROW = 4;
+	const u4Byte area = settings.width * settings.height;
+	const u4Byte seed = settings.seed;
+
+	std::vector<float> refMeans;
+	settings.sampleBudget = 0;
+	settings.seed = seed + 1;
+	{
+		RefRenderer refRenderer(settings);
+		for (u4Byte i = 0; i < numFrames * REF_FRAMES_SCALE; i += 1)
+		{
+			refRenderer.Frame();
+		}
+		refRenderer.LumaMeans(refMeans);
+	}
+
+	// Error + camera rays per pixel after every few frames, for each scheme
+	const u4Byte numRows = numFrames / FRAMES_PER_ROW;
+	std::vector<double> errs[2];
+	std::vector<double> raysPerPx[2];
+	double secs[2];
+	settings.seed = seed;
+	for (u4Byte adaptive = 0; adaptive < 2; adaptive += 1)
+	{
+		settings.sampleBudget = (adaptive != 0) ? area / 4 : 0;
+		RefRenderer renderer(settings);
+		std::vector<float> means;
+		secs[adaptive] = 0.0;
+		for (u4Byte i = 0; i < numRows * FRAMES_PER_ROW; i += 1)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			renderer.Frame();
+			secs[adaptive] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (((i + 1) % FRAMES_PER_ROW) != 0) { continue; }
+			renderer.LumaMeans(means);
+			double err = 0.0;
+			for (u4Byte j = 0; j < area; j += 1)
+			{
+				const double d = means[j] - refMeans[j];
+				err += (d * d) / ((refMeans[j] * refMeans[j]) + 0.01);
+			}
+			errs[adaptive].push_back(err / area);
+			raysPerPx[adaptive].push_back((double)renderer.PrimaryCounts().rays / area);
+		}
+	}
+
+	printf("relative error vs camera rays at %ux%u (reference: %u frames)\n", settings.width, settings.height, numFrames * REF_FRAMES_SCALE);
+	printf("  %6s %11s %12s %12s %9s\n", "frames", "rays/pixel", "fixed", "adaptive", "vs fixed");
+	for (u4Byte i = 0; i < numRows; i += 1)
+	{
+		printf("  %6u %11.2f %12.4g %12.4g %8.2fx\n", (i + 1) * FRAMES_PER_ROW, raysPerPx[1][i], errs[0][i], errs[1][i],
+			   (errs[1][i] > 0.0) ? errs[0][i] / errs[1][i] : 0.0);
+	}
+	printf("fixed %.1fms/frame, adaptive %.1fms/frame\n", (numRows > 0) ? (secs[0] * 1000.0) / (numRows * FRAMES_PER_ROW) : 0.0,
+		   (numRows > 0) ? (secs[1] * 1000.0) / (numRows * FRAMES_PER_ROW) : 0.0);
+	return 0;
+}
+
+// Render [numFrames] frames with + without Russian roulette (on independent
+// random streams), then check the image's mean luminance agrees within its
+// standard errors, + print how much shorter (+ cheaper) paths get
+static int BenchRoulette(RefRenderer::Settings settings, u4Byte numFrames)
+{
+	constexpr double MAX_SIGMAS = 3.0; // Mean luminance difference allowed, in combined standard errors
+	const u4Byte seed = settings.seed;
+	double means[2];
+	double stdErrs[2];
+	printf("Russian roulette over %u frames at %ux%u\n", numFrames, settings.width, settings.height);
+	printf("  %-8s %11s %10s %12s %13s %9s\n", "roulette", "mean luma", "std err", "path length", "evals/path", "ms/frame");
+	for (u4Byte roulette = 0; roulette < 2; roulette += 1)
+	{
+		settings.russianRoulette = roulette != 0;
+		settings.seed = seed + roulette;
+		RefRenderer renderer(settings);
+		const auto start = std::chrono::steady_clock::now();
+		for (u4Byte i = 0; i < numFrames; i += 1)
+		{
+			renderer.Frame();
+		}
+		const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		renderer.ImageLuma(means[roulette], stdErrs[roulette]);
+		const RefRenderer::MarchCounts counts = renderer.PrimaryCounts();
+		const double rays = (double)counts.rays;
+		printf("  %-8s %11.5g %10.3g %12.3f %13.2f %9.1f\n", (roulette != 0) ? "on" : "off", means[roulette], stdErrs[roulette],
+			   (rays > 0.0) ? (counts.rays + counts.bounceRays) / rays : 0.0, (rays > 0.0) ? (counts.evals + counts.bounceEvals) / rays : 0.0,
+			   (numFrames > 0) ? (secs * 1000.0) / numFrames : 0.0);
+	}
+	const double combinedErr = sqrt((stdErrs[0] * stdErrs[0]) + (stdErrs[1] * stdErrs[1]));
+	const double sigmas = (combinedErr > 0.0) ? fabs(means[1] - means[0]) / combinedErr : 0.0;
+	const bool valid = sigmas <= MAX_SIGMAS;
+	printf("mean luminance %s (%.2f standard errors apart, tolerance %g)\n", valid ? "agrees" : "DOESN'T agree", sigmas, MAX_SIGMAS);
+	return valid ? 0 : 1;
+}
+
+// Check that [PathQueues] collects the same paths as simpler shared queues,
+// then print what each approach costs per path
+static int BenchQueues(u4Byte numPaths, u4Byte numThreads)
+{
+	if (numThreads == 0) { numThreads = std::max(std::thread::hardware_concurrency(), 1u); }
+	double nsPerPath[3];
+	const bool valid = PathQueues::Benchmark(numPaths, numThreads, nsPerPath);
+	const char* names[3] = { "chunked", "mutex", "atomic" };
+	printf("path queueing over %u paths on %u threads\n", numPaths, numThreads);
+	printf("  %-8s %10s %9s\n", "queues", "ns/path", "speedup");
+	for (u4Byte i = 0; i < 3; i += 1)
+	{
+		printf("  %-8s %10.2f %8.2fx\n", names[i], nsPerPath[i], (nsPerPath[i] > 0.0) ? nsPerPath[1] / nsPerPath[i] : 0.0);
+	}
+	printf("queues %s\n", valid ? "agree" : "DON'T agree");
+	return valid ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+	const char* outPath = "reference.png";
+	const char* ditherPath = RefStuff::DITHER_TEX_PATH;
+	u4Byte numFrames = 16;
+	RefRenderer::Settings settings;
+	settings.width = RefStuff::DEFAULT_DISPLAY_WIDTH;
+	settings.height = RefStuff::DEFAULT_DISPLAY_HEIGHT;
+	settings.seed = 0;
+	settings.cameraPos = { RefStuff::DEFAULT_CAMERA_POS[0], RefStuff::DEFAULT_CAMERA_POS[1], RefStuff::DEFAULT_CAMERA_POS[2] };
+	settings.cameraLook = { RefStuff::DEFAULT_CAMERA_LOOK[0], RefStuff::DEFAULT_CAMERA_LOOK[1], RefStuff::DEFAULT_CAMERA_LOOK[2] };
+	settings.numThreads = 0;
+	settings.coneTileWidth = 8;
+	settings.temporalHits = true;
+	settings.sampleBudget = 0;
+	settings.russianRoulette = true;
+	settings.ditherRGBA = nullptr;
+	u4Byte benchJulia = 0;
+	u4Byte benchPhilox = 0;
+	u4Byte benchQueues = 0;
+	u4Byte benchGrads = 0;
+	u4Byte benchTemporal = 0;
+	u4Byte benchAdaptive = 0;
+	u4Byte benchRoulette = 0;
+	const char* marchLabPrefix = nullptr;
+	float omega = 1.6f;
+	float epsGrowth = 1.175f;
+
+	// Parse options; every option takes a fixed number of values
+	for (int i = 1; i < argc; i += 1)
+	{
+		auto hasValues = [&](int numValues) { return (i + numValues) < argc; };
+		if (strcmp(argv[i], "--out") == 0 && hasValues(1)) { outPath = argv[++i]; }
+		else if (strcmp(argv[i], "--dither") == 0 && hasValues(1)) { ditherPath = argv[++i]; }
+		else if (strcmp(argv[i], "--seed") == 0 && hasValues(1)) { settings.seed = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--frames") == 0 && hasValues(1)) { numFrames = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--threads") == 0 && hasValues(1)) { settings.numThreads = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--bench-julia") == 0 && hasValues(1)) { benchJulia = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--bench-philox") == 0 && hasValues(1)) { benchPhilox = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--bench-queues") == 0 && hasValues(1)) { benchQueues = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--bench-grads") == 0 && hasValues(1)) { benchGrads = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--march-lab") == 0 && hasValues(1)) { marchLabPrefix = argv[++i]; }
+		else if (strcmp(argv[i], "--omega") == 0 && hasValues(1)) { omega = strtof(argv[++i], nullptr); }
+		else if (strcmp(argv[i], "--cone-tile") == 0 && hasValues(1)) { settings.coneTileWidth = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--temporal-hits") == 0 && hasValues(1)) { settings.temporalHits = strtoul(argv[++i], nullptr, 10) != 0; }
+		else if (strcmp(argv[i], "--bench-temporal") == 0 && hasValues(1)) { benchTemporal = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--sample-budget") == 0 && hasValues(1)) { settings.sampleBudget = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--bench-adaptive") == 0 && hasValues(1)) { benchAdaptive = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--roulette") == 0 && hasValues(1)) { settings.russianRoulette = strtoul(argv[++i], nullptr, 10) != 0; }
+		else if (strcmp(argv[i], "--bench-roulette") == 0 && hasValues(1)) { benchRoulette = (u4Byte)strtoul(argv[++i], nullptr, 10); }
+		else if (strcmp(argv[i], "--eps-growth") == 0 && hasValues(1)) { epsGrowth = strtof(argv[++i], nullptr); }
+		else if (strcmp(argv[i], "--size") == 0 && hasValues(2))
+		{
+			settings.width = (u4Byte)strtoul(argv[++i], nullptr, 10);
+			settings.height = (u4Byte)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--camera") == 0 && hasValues(3))
+		{
+			settings.cameraPos.x = strtof(argv[++i], nullptr);
+			settings.cameraPos.y = strtof(argv[++i], nullptr);
+			settings.cameraPos.z = strtof(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--look") == 0 && hasValues(3))
+		{
+			settings.cameraLook.x = strtof(argv[++i], nullptr);
+			settings.cameraLook.y = strtof(argv[++i], nullptr);
+			settings.cameraLook.z = strtof(argv[++i], nullptr);
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	// Benchmarks replace rendering; they run after parsing so they can see
+	// options given after them (e.g. [--threads])
+	if (benchJulia != 0) { return BenchJulia(benchJulia); }
+	if (benchPhilox != 0) { return BenchPhilox(benchPhilox); }
+	if (benchQueues != 0) { return BenchQueues(benchQueues, settings.numThreads); }
+	if (benchGrads != 0) { return BenchGrads(benchGrads); }
+
+	// Views straight up/down have no defined basis with a y-up camera
+	const bool validLook = settings.cameraLook.x != 0.0f || settings.cameraLook.z != 0.0f;
+	if (settings.width == 0 || settings.height == 0 ||
+		(settings.width % RefStuff::TILE_WIDTH) != 0 || (settings.height % RefStuff::TILE_HEIGHT) != 0 || !validLook ||
+		settings.sampleBudget > (settings.width * settings.height))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// The marching lab doesn't need a dither texture (rays go through pixel centres)
+	if (marchLabPrefix != nullptr)
+	{
+		MarchLab::Settings labSettings;
+		labSettings.width = settings.width;
+		labSettings.height = settings.height;
+		labSettings.cameraPos = settings.cameraPos;
+		labSettings.cameraLook = settings.cameraLook;
+		labSettings.numThreads = settings.numThreads;
+		labSettings.omega = std::max(omega, 1.0f);
+		labSettings.epsGrowth = epsGrowth;
+		labSettings.coneTileWidth = settings.coneTileWidth;
+		labSettings.outPrefix = marchLabPrefix;
+		return RunMarchLab(labSettings);
+	}
+
+	// Load the dither texture
+	uByte* dither = nullptr;
+	unsigned ditherWidth = 0;
+	unsigned ditherHeight = 0;
+	if (lodepng_decode32_file(&dither, &ditherWidth, &ditherHeight, ditherPath) != 0 ||
+		ditherWidth != RefStuff::DITHER_TEX_WIDTH || ditherHeight != RefStuff::DITHER_TEX_WIDTH)
+	{
+		fprintf(stderr, "couldn't load a %ux%u dither texture from %s\n", RefStuff::DITHER_TEX_WIDTH, RefStuff::DITHER_TEX_WIDTH, ditherPath);
+		free(dither);
+		return 1;
+	}
+	settings.ditherRGBA = dither;
+
+	// Scripted camera paths + sampling comparisons replace the render
+	if (benchTemporal != 0 || benchAdaptive != 0 || benchRoulette != 0)
+	{
+		const int result = (benchTemporal != 0) ? BenchTemporal(settings, benchTemporal) :
+						   (benchAdaptive != 0) ? BenchAdaptive(settings, benchAdaptive) :
+												  BenchRoulette(settings, benchRoulette);
+		free(dither);
+		return result;
+	}
+
+	// Render
+	RefRenderer renderer(settings);
+	const auto start = std::chrono::steady_clock::now();
+	for (u4Byte i = 0; i < numFrames; i += 1)
+	{
+		renderer.Frame();
+	}
+	const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("rendered %u frames at %ux%u on %u threads in %.2fs (%.1fms/frame)\n",
+		   numFrames, settings.width, settings.height, renderer.NumThreads(), secs, (numFrames > 0) ? (secs * 1000.0) / numFrames : 0.0);
+
+	const bool saved = renderer.SavePNG(outPath);
+	free(dither);
+	if (!saved)
+	{
+		fprintf(stderr, "couldn't write %s\n", outPath);
+		return 1;
+	}
+	printf("wrote %s\n", outPath);
+	return 0;
+}
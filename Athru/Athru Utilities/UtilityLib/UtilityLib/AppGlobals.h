@@ -150,6 +150,14 @@ namespace GraphicsStuff
 												  (float)GraphicsStuff::DISPLAY_HEIGHT;
 	// ASCII key ID for the screenshot button (F)
 	extern constexpr u4Byte SCREENSHOT_KEY = 0x46;
+	// ASCII key ID for starting/stopping capture sequences (V); sequences
+	// write every rendered frame to numbered files
+	extern constexpr u4Byte CAPTURE_SEQUENCE_KEY = 0x56;
+	// ASCII key ID for raw HDR screenshots (H)
+	extern constexpr u4Byte HDR_SCREENSHOT_KEY = 0x48;
+	// ASCII key ID for starting/stopping video capture (R); videos stream
+	// every rendered frame into one uncompressed file
+	extern constexpr u4Byte VIDEO_CAPTURE_KEY = 0x52;
 }
 
 namespace SceneStuff
@@ -157,10 +165,86 @@ namespace SceneStuff
 	extern constexpr u4Byte SYSTEM_COUNT = 100;
 	extern constexpr u4Byte BODIES_PER_SYSTEM = 10;
 	extern constexpr u4Byte PLANTS_PER_PLANET = 100;
+	extern constexpr u4Byte PLANT_SPECIES_PER_PLANET = 4; // Plants on each planet are instanced from a handful of seeded species
 	extern constexpr u4Byte ALIGNED_PARAMETRIC_FIGURES_PER_SYSTEM = 1024; // Total number of parameteric figures/system (number of plants * number
 																		  // of bodies, animal forms are defined explicitly with volumes in Athru)
 																		  // Aligned to the nearest power of two for simpler buffer management
 																		  // (+ at 64 bytes/figure 1024 figures should match exactly to the 65536-byte
 																		  // resource alignment requirement in d3d12)
 	extern constexpr u4Byte ANIMALS_PER_PLANET = 100;
+	extern constexpr u4Byte FLUID_PACKETS_PER_PLANET = 8192; // Ocean/atmosphere packets simulated around the planet nearest the player
+																// (each fluid gets its own set)
+}
+
+namespace JobStuff
+{
+	// Upper bound on worker threads (including the main thread); the pool
+	// takes every hardware thread up to this limit
+	extern constexpr u4Byte MAX_WORKERS = 16;
+
+	// Job slots per worker; slots are recycled in a ring, so this bounds the
+	// number of unfinished jobs any single worker can create at once
+	// Power of two so ring indices can wrap with a bitmask
+	extern constexpr u4Byte JOBS_PER_WORKER = 4096;
+
+	// Maximum number of jobs waiting on any one job (see [JobSystem::Depend(...)])
+	extern constexpr u4Byte MAX_JOB_CONTINUATIONS = 8;
+
+	// Capacity of the shared queue for background jobs (see [JobSystem::RunBackground(...)])
+	extern constexpr u4Byte MAX_BACKGROUND_JOBS = 64;
+}
+
+namespace StartupStuff
+{
+	// Maximum number of stages in a start-up graph (see [StartupGraph])
+	extern constexpr u4Byte MAX_STARTUP_STAGES = 24;
+
+	// Maximum number of prerequisites for any one start-up stage
+	extern constexpr u4Byte MAX_STARTUP_DEPS = 12;
+}
+
+namespace IOStuff
+{
+	// Maximum number of in-flight file requests; submitting more than this
+	// waits for the oldest requests to finish
+	extern constexpr u4Byte MAX_IO_REQUESTS = 256;
+
+	// Staging space for writes that [AsyncIO] copies instead of borrowing from
+	// the caller (four megabytes)
+	extern constexpr u8Byte IO_STAGING_BYTES = 4 * 1024 * 1024;
+
+	// Worker threads used when native asynchronous I/O isn't available
+	extern constexpr u4Byte IO_FALLBACK_THREADS = 2;
+
+	// Longest supported file path (matches Windows' [MAX_PATH])
+	extern constexpr u4Byte MAX_IO_PATH = 260;
+
+	// Number of files that can be appended to at once (see [AsyncIO::Write(...)])
+	extern constexpr u4Byte MAX_APPEND_STREAMS = 8;
+
+	// Packed assets (see [AssetPack]); built by launching Athru with [-bake],
+	// then memory-mapped on every later launch
+	extern constexpr char ASSET_PACK_PATH[] = "Athru.athpak";
+
+	// Payload alignment within asset packs; large enough for any CPU-side
+	// vector load, and matches D3D12's constant/texture-row alignment
+	extern constexpr u8Byte ASSET_PACK_ALIGN = 256;
+}
+
+namespace AudioStuff
+{
+	// Output sample rate for critter audio (samples/second, mono)
+	extern constexpr u4Byte SAMPLE_RATE = 48000;
+
+	// Maximum number of critters voiced at once; the mixer keeps whichever
+	// critters are loudest from the camera's perspective
+	// Multiple of four so the oscillator bank maps cleanly onto SSE lanes
+	extern constexpr u4Byte MAX_VOICES = 256;
+
+	// Samples synthesized/submitted to the audio device per block
+	extern constexpr u4Byte BLOCK_SAMPLES = 512;
+
+	// Capacity of the ring between the game thread and the audio device
+	// (8192 samples is ~170ms at 48KHz, enough to ride out a few slow frames)
+	extern constexpr u4Byte RING_SAMPLES = 8192;
 }
@@ -0,0 +1,325 @@
+#include <algorithm>
+#include <filesystem>
+#include <stdlib.h>
+#include <string.h>
+#include "UtilityServiceCentre.h"
+#include "AssetPack.h"
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+// Pack identification ("ATHP" in file order), bumped whenever the layout changes
+static constexpr u4Byte PACK_MAGIC = 0x50485441;
+static constexpr u4Byte PACK_VERSION = 1;
+
+AssetPack::AssetPack(const char* packPath) :
+	mapping(nullptr),
+	mappingBytes(0),
+	entries(nullptr),
+	numEntries(0),
+	file(nullptr),
+	fileMapping(nullptr)
+{
+	// Map the whole pack read-only; pages are only read in once assets are touched
+	#ifdef _WIN32
+		HANDLE packFile = CreateFileA(packPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+									  FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (packFile == INVALID_HANDLE_VALUE) { return; }
+		file = packFile;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(packFile, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(PackHeader)) { return; }
+		HANDLE packMapping = CreateFileMappingA(packFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (packMapping == nullptr) { return; }
+		fileMapping = packMapping;
+
+		mapping = (const uByte*)MapViewOfFile(packMapping, FILE_MAP_READ, 0, 0, 0);
+		if (mapping == nullptr) { return; }
+		mappingBytes = (u8Byte)fileSize.QuadPart;
+	#else
+		const int packFile = open(packPath, O_RDONLY);
+		if (packFile < 0) { return; }
+
+		struct stat fileInfo;
+		if (fstat(packFile, &fileInfo) != 0 || fileInfo.st_size < (off_t)sizeof(PackHeader))
+		{
+			close(packFile);
+			return;
+		}
+		void* view = mmap(nullptr, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, packFile, 0);
+		close(packFile); // Mappings outlive their file descriptors
+		if (view == MAP_FAILED) { return; }
+		mapping = (const uByte*)view;
+		mappingBytes = (u8Byte)fileInfo.st_size;
+	#endif
+
+	// Reject packs from other versions of Athru, or packs that were cut short
+	const PackHeader* header = (const PackHeader*)mapping;
+	const u8Byte indexEnd = sizeof(PackHeader) + ((u8Byte)header->numEntries * sizeof(PackEntry));
+	if (header->magic != PACK_MAGIC || header->version != PACK_VERSION ||
+		header->numBytes != mappingBytes || indexEnd > mappingBytes)
+	{
+		AthruCore::Utility::AccessLogger()->Log("ignoring invalid asset pack", "asset message");
+		return;
+	}
+	entries = (const PackEntry*)(mapping + sizeof(PackHeader));
+	numEntries = header->numEntries;
+}
+
+AssetPack::~AssetPack()
+{
+	#ifdef _WIN32
+		if (mapping != nullptr) { UnmapViewOfFile(mapping); }
+		if (fileMapping != nullptr) { CloseHandle((HANDLE)fileMapping); }
+		if (file != nullptr) { CloseHandle((HANDLE)file); }
+	#else
+		if (mapping != nullptr) { munmap((void*)mapping, (size_t)mappingBytes); }
+	#endif
+	mapping = nullptr;
+	entries = nullptr;
+	numEntries = 0;
+}
+
+const uByte* AssetPack::Find(const char* name, ASSET_TYPES type, u8Byte* numBytes) const
+{
+	*numBytes = 0;
+	if (numEntries == 0) { return nullptr; }
+
+	// Binary search over the index
+	const u8Byte nameHash = Hash(name, strlen(name));
+	const PackEntry* entry = std::lower_bound(entries, entries + numEntries, nameHash,
+											  [](const PackEntry& e, u8Byte hash) { return e.nameHash < hash; });
+	if (entry == (entries + numEntries) || entry->nameHash != nameHash || entry->type != (u4Byte)type)
+	{
+		return nullptr;
+	}
+
+	// Don't hand out views past the end of the mapping
+	if (entry->offset > mappingBytes || entry->numBytes > (mappingBytes - entry->offset))
+	{
+		return nullptr;
+	}
+	*numBytes = entry->numBytes;
+	return mapping + entry->offset;
+}
+
+bool AssetPack::Loaded() const
+{
+	return numEntries > 0;
+}
+
+void AssetPack::Prefault(const uByte* view, u8Byte numBytes)
+{
+	// One read per (smallest common) page is enough to map it; accumulate into a [volatile]
+	// so the reads aren't optimized away
+	constexpr u8Byte pageBytes = 4096;
+	uByte touched = 0;
+	for (u8Byte i = 0; i < numBytes; i += pageBytes)
+	{
+		touched ^= view[i];
+	}
+	if (numBytes > 0) { touched ^= view[numBytes - 1]; }
+	volatile uByte sink = touched;
+	(void)sink;
+}
+
+bool AssetPack::Build(const char* packPath, const Source* sources, u4Byte numSources)
+{
+	// Hash names + payloads, and find each payload's first occurrence
+	PackEntry* packEntries = (PackEntry*)malloc(sizeof(PackEntry) * std::max(numSources, 1u));
+	u4Byte* firstSource = (u4Byte*)malloc(sizeof(u4Byte) * std::max(numSources, 1u));
+	u8Byte numBytes = sizeof(PackHeader) + ((u8Byte)numSources * sizeof(PackEntry));
+	u4Byte numUnique = 0;
+	for (u4Byte i = 0; i < numSources; i += 1)
+	{
+		PackEntry& entry = packEntries[i];
+		entry.nameHash = Hash(sources[i].name, strlen(sources[i].name));
+		entry.contentHash = Hash(sources[i].data, sources[i].numBytes);
+		entry.numBytes = sources[i].numBytes;
+		entry.type = (u4Byte)sources[i].type;
+		entry.padding = 0;
+
+		firstSource[i] = i;
+		for (u4Byte j = 0; j < i; j += 1)
+		{
+			if (packEntries[j].contentHash == entry.contentHash && sources[j].numBytes == sources[i].numBytes &&
+				memcmp(sources[j].data, sources[i].data, sources[i].numBytes) == 0)
+			{
+				firstSource[i] = firstSource[j];
+				break;
+			}
+		}
+
+		// Place unique payloads as they're found
+		if (firstSource[i] == i)
+		{
+			numBytes += (IOStuff::ASSET_PACK_ALIGN - (numBytes % IOStuff::ASSET_PACK_ALIGN)) % IOStuff::ASSET_PACK_ALIGN;
+			entry.offset = numBytes;
+			numBytes += sources[i].numBytes;
+			numUnique += 1;
+		}
+		else
+		{
+			entry.offset = packEntries[firstSource[i]].offset;
+		}
+	}
+	free(firstSource);
+
+	// Assemble the pack in memory; alignment gaps stay zeroed
+	uByte* pack = (uByte*)calloc((size_t)numBytes, 1);
+	PackHeader* header = (PackHeader*)pack;
+	header->magic = PACK_MAGIC;
+	header->version = PACK_VERSION;
+	header->numEntries = numSources;
+	header->padding = 0;
+	header->numBytes = numBytes;
+	for (u4Byte i = 0; i < numSources; i += 1)
+	{
+		memcpy(pack + packEntries[i].offset, sources[i].data, (size_t)sources[i].numBytes);
+	}
+
+	// Sort the index for lookups; names have to be unique
+	std::sort(packEntries, packEntries + numSources,
+			  [](const PackEntry& a, const PackEntry& b) { return a.nameHash < b.nameHash; });
+	for (u4Byte i = 1; i < numSources; i += 1)
+	{
+		assert(packEntries[i].nameHash != packEntries[i - 1].nameHash);
+	}
+	memcpy(pack + sizeof(PackHeader), packEntries, sizeof(PackEntry) * numSources);
+	free(packEntries);
+
+	AsyncIO* io = AthruCore::Utility::AccessIO();
+	u8Byte bytesWritten = 0;
+	const IO_STATUS status = io->Wait(io->Write(packPath, pack, numBytes, IO_WRITE_MODES::OVERWRITE, false), &bytesWritten);
+	free(pack);
+
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	logger->Log(numSources, "assets packed");
+	logger->Log(numUnique, "unique asset payloads");
+	logger->Log(numBytes, "asset pack bytes");
+	return (status == IO_STATUS::DONE) && (bytesWritten == numBytes);
+}
+
+uByte* AssetPack::CompileDNA(const char* dnaPath, u8Byte* numBytes)
+{
+	*numBytes = 0;
+	std::error_code err;
+	const u8Byte textBytes = (u8Byte)std::filesystem::file_size(dnaPath, err);
+	if (err) { return nullptr; }
+
+	// Read the source text through Athru's I/O service
+	char* text = (char*)malloc((size_t)textBytes + 1);
+	AsyncIO* io = AthruCore::Utility::AccessIO();
+	u8Byte bytesRead = 0;
+	if (io->Wait(io->Read(dnaPath, text, textBytes), &bytesRead) != IO_STATUS::DONE)
+	{
+		free(text);
+		return nullptr;
+	}
+	text[bytesRead] = '\0';
+
+	// Every line carries at most one field, so line counts bound field counts
+	u4Byte maxFields = 1;
+	for (u8Byte i = 0; i < bytesRead; i += 1)
+	{
+		if (text[i] == '\n') { maxFields += 1; }
+	}
+	uByte* dna = (uByte*)malloc(sizeof(u8Byte) + (sizeof(DNAField) * maxFields));
+	DNAField* fields = (DNAField*)(dna + sizeof(u8Byte));
+	u4Byte numFields = 0;
+
+	// Parse values up to each line's first tag marker, then hash the tag itself
+	char* line = text;
+	while (*line != '\0')
+	{
+		char* lineEnd = strchr(line, '\n');
+		if (lineEnd != nullptr) { *lineEnd = '\0'; }
+
+		char* tagStart = strstr(line, "--");
+		char* tagEnd = (tagStart != nullptr) ? strstr(tagStart + 2, "--") : nullptr;
+		if (tagEnd != nullptr)
+		{
+			DNAField& field = fields[numFields];
+			field.numValues = 0;
+			field.padding = 0;
+			const char* cursor = line;
+			while (cursor < tagStart && field.numValues < 4)
+			{
+				char* parsed = nullptr;
+				const float value = strtof(cursor, &parsed);
+				if (parsed == cursor || parsed > tagStart) { break; }
+				field.values[field.numValues] = value;
+				field.numValues += 1;
+				cursor = parsed;
+				while (cursor < tagStart && (*cursor == ',' || *cursor == ' ' || *cursor == '\t')) { cursor += 1; }
+			}
+
+			// Skip section markers + non-numeric values
+			if (field.numValues > 0)
+			{
+				const char* tag = tagStart + 2;
+				const char* tagLast = tagEnd;
+				while (tag < tagLast && *tag == ' ') { tag += 1; }
+				while (tagLast > tag && *(tagLast - 1) == ' ') { tagLast -= 1; }
+				field.tagHash = Hash(tag, (u8Byte)(tagLast - tag));
+				for (u4Byte i = field.numValues; i < 4; i += 1) { field.values[i] = 0.0f; }
+				numFields += 1;
+			}
+		}
+
+		if (lineEnd == nullptr) { break; }
+		line = lineEnd + 1;
+	}
+	free(text);
+
+	*(u8Byte*)dna = numFields;
+	*numBytes = sizeof(u8Byte) + (sizeof(DNAField) * numFields);
+	return dna;
+}
+
+u4Byte AssetPack::DNAValues(const uByte* dna, u8Byte numBytes, const char* tag, float* values, u4Byte maxValues)
+{
+	if (numBytes < sizeof(u8Byte)) { return 0; }
+	const u8Byte numFields = std::min(*(const u8Byte*)dna, (numBytes - sizeof(u8Byte)) / sizeof(DNAField));
+	const DNAField* fields = (const DNAField*)(dna + sizeof(u8Byte));
+	const u8Byte tagHash = Hash(tag, strlen(tag));
+	for (u8Byte i = 0; i < numFields; i += 1)
+	{
+		if (fields[i].tagHash == tagHash)
+		{
+			const u4Byte numValues = std::min(fields[i].numValues, maxValues);
+			memcpy(values, fields[i].values, sizeof(float) * numValues);
+			return numValues;
+		}
+	}
+	return 0;
+}
+
+u8Byte AssetPack::Hash(const void* data, u8Byte numBytes)
+{
+	const uByte* bytes = (const uByte*)data;
+	u8Byte hash = 0xCBF29CE484222325ull;
+	for (u8Byte i = 0; i < numBytes; i += 1)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+// Push constructions for this class through Athru's custom allocator
+void* AssetPack::operator new(size_t size)
+{
+	StackAllocator* allocator = AthruCore::Utility::AccessMemory();
+	return allocator->AlignedAlloc(size, (uByte)std::alignment_of<AssetPack>(), false);
+}
+
+// We aren't expecting to use [delete], so overload it to do nothing
+void AssetPack::operator delete(void* target)
+{
+	return;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "AppGlobals.h"
+
+// Kinds of packed asset; lookups check types as well as names, so a stray name
+// collision can't hand (e.g.) shader bytecode to the texture loader
+enum class ASSET_TYPES
+{
+	SHADER, // Compiled shader bytecode (.cso), stored as-is
+	TEXTURE, // [AssetPack::TextureHeader], then texels ready for upload
+	DNA // Compiled organism data (see [AssetPack::CompileDNA(...)])
+};
+
+// Read-only asset pack
+// Packs are built offline (see [Build(...)]) + memory-mapped at startup, so
+// assets load as views straight into the mapping instead of copies
+// Packs are content-addressed; the index maps hashed asset names onto hashed
+// payloads, and payloads shared between several names are only stored once
+// Missing or invalid packs leave [this] empty, in which case every lookup
+// fails + callers fall back to loading loose files
+class AssetPack
+{
+	public:
+		// Map the pack at [packPath]
+		AssetPack(const char* packPath);
+		~AssetPack(); // Unmaps the pack; views handed out by [Find(...)] are invalid afterwards
+
+		// Look up an asset by the name it was packed with (normally the relative path
+		// of its source file); returns a view of its payload + writes the payload's
+		// size into [numBytes], or returns [nullptr] if the asset isn't packed
+		const uByte* Find(const char* name, ASSET_TYPES type, u8Byte* numBytes) const;
+
+		// Whether a valid pack was mapped
+		bool Loaded() const;
+
+		// Touch every page of a view returned by [Find(...)], so the pack is read in
+		// ahead of time (e.g. on a worker during start-up) instead of faulting page-by-page
+		// on whichever thread first uses the asset
+		static void Prefault(const uByte* view, u8Byte numBytes);
+
+		// Layout at the start of each [ASSET_TYPES::TEXTURE] payload
+		struct TextureHeader
+		{
+			u4Byte width;
+			u4Byte height;
+			u4Byte format; // Graphics-API format ID (a [DXGI_FORMAT] for Athru's D3D12 renderer)
+			u4Byte texelBytes;
+		};
+
+		// One asset to pack
+		struct Source
+		{
+			const char* name;
+			ASSET_TYPES type;
+			const void* data;
+			u8Byte numBytes;
+		};
+
+		// Write a pack containing [sources] to [packPath]; returns [false] if the
+		// pack couldn't be written
+		static bool Build(const char* packPath, const Source* sources, u4Byte numSources);
+
+		// Compile a text DNA file into the packed organism format; returns a [malloc]'d
+		// payload (release it with [free]) + writes its size into [numBytes], or
+		// returns [nullptr] if the file can't be read
+		// DNA files tag values with trailing descriptors, like
+		// 0.1 -- FREQUENCY --
+		// 0, 7, 5, 1 -- TORSO_POSITION_CHUNK_SUB_CHUNK_BOXECULE_HOMOG_Z --
+		// and compiled DNA keeps one record (up to four values) per tagged line
+		static uByte* CompileDNA(const char* dnaPath, u8Byte* numBytes);
+
+		// Read the values tagged with [tag] out of compiled DNA; returns the number of
+		// values copied into [values] (zero if the tag is missing)
+		static u4Byte DNAValues(const uByte* dna, u8Byte numBytes, const char* tag, float* values, u4Byte maxValues);
+
+		// Overload the standard allocation/de-allocation operators
+		void* operator new(size_t size);
+		void operator delete(void* target);
+
+	private:
+		// On-disk layout; the header leads into the index (sorted by name hash), then
+		// payloads follow at [IOStuff::ASSET_PACK_ALIGN]-byte boundaries
+		struct PackHeader
+		{
+			u4Byte magic;
+			u4Byte version;
+			u4Byte numEntries;
+			u4Byte padding;
+			u8Byte numBytes; // Total pack size; packs truncated after building are rejected
+		};
+
+		struct PackEntry
+		{
+			u8Byte nameHash;
+			u8Byte contentHash;
+			u8Byte offset;
+			u8Byte numBytes;
+			u4Byte type; // [ASSET_TYPES], stored as an integer
+			u4Byte padding;
+		};
+
+		// Compiled DNA record
+		struct DNAField
+		{
+			u8Byte tagHash;
+			float values[4];
+			u4Byte numValues;
+			u4Byte padding;
+		};
+
+		// 64-bit FNV-1a; used for asset names, DNA tags + payloads
+		static u8Byte Hash(const void* data, u8Byte numBytes);
+
+		const uByte* mapping;
+		u8Byte mappingBytes;
+		const PackEntry* entries;
+		u4Byte numEntries;
+
+		// Platform handles for the mapping
+		void* file;
+		void* fileMapping;
+};
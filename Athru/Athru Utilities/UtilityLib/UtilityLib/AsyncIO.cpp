@@ -0,0 +1,604 @@
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+#include "UtilityServiceCentre.h"
+#include "AsyncIO.h"
+
+#ifdef _WIN32
+// Completion keys; the doorbell wakes the service thread for new submissions,
+// everything else is a finished file operation
+constexpr ULONG_PTR IO_DOORBELL_KEY = 1;
+constexpr ULONG_PTR IO_FILE_KEY = 2;
+
+// Per-request state for overlapped I/O
+struct NativeRequest
+{
+	OVERLAPPED overlapped; // Completions hand back a pointer to this, so keep it first
+	HANDLE file;
+	u4Byte slot;
+};
+#endif
+
+// Map tickets onto request slots
+static u4Byte RequestSlot(IOTicket ticket)
+{
+	return ticket % IOStuff::MAX_IO_REQUESTS;
+}
+
+// Small wrappers over platform-specific stdio calls (used by the thread-pool fallback)
+static FILE* OpenFile(const char* path, const char* mode)
+{
+	#ifdef _WIN32
+		FILE* file = nullptr;
+		return (fopen_s(&file, path, mode) == 0) ? file : nullptr;
+	#else
+		return fopen(path, mode);
+	#endif
+}
+
+static bool SeekFile(FILE* file, u8Byte offset)
+{
+	#ifdef _WIN32
+		return _fseeki64(file, (s8Byte)offset, SEEK_SET) == 0;
+	#else
+		return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+	#endif
+}
+
+AsyncIO::AsyncIO() :
+	nextTicket(1),
+	issuedTicket(1),
+	retiredTicket(1),
+	stagingHead(0),
+	stagingTail(0),
+	numAppendCursors(0),
+	nextAppendCursor(0),
+	exiting(false),
+	completionPort(nullptr),
+	nativeState(nullptr),
+	numIOThreads(0)
+{
+	requests = MemoryStuff::ArrayAlloc<Request>(IOStuff::MAX_IO_REQUESTS, false);
+	for (u4Byte i = 0; i < IOStuff::MAX_IO_REQUESTS; i += 1)
+	{
+		new (&requests[i]) Request();
+		requests[i].ticket = 0;
+		requests[i].status.store((u4Byte)IO_STATUS::DONE, std::memory_order_relaxed);
+	}
+	staging = MemoryStuff::ArrayAlloc<uByte>(IOStuff::IO_STAGING_BYTES, false);
+
+	// Prefer overlapped I/O through a completion port; one thread is enough to
+	// issue requests + reap completions, since the OS does the actual transfers
+	#ifdef _WIN32
+		completionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+		if (completionPort != nullptr)
+		{
+			NativeRequest* native = MemoryStuff::ArrayAlloc<NativeRequest>(IOStuff::MAX_IO_REQUESTS, false);
+			for (u4Byte i = 0; i < IOStuff::MAX_IO_REQUESTS; i += 1)
+			{
+				memset(&native[i].overlapped, 0, sizeof(OVERLAPPED));
+				native[i].file = INVALID_HANDLE_VALUE;
+				native[i].slot = i;
+			}
+			nativeState = native;
+			ioThreads[0] = std::thread(&AsyncIO::NativeLoop, this);
+			numIOThreads = 1;
+			return;
+		}
+	#endif
+
+	// Otherwise fall back to blocking I/O on a few dedicated threads
+	for (u4Byte i = 0; i < IOStuff::IO_FALLBACK_THREADS; i += 1)
+	{
+		ioThreads[i] = std::thread(&AsyncIO::FallbackLoop, this);
+	}
+	numIOThreads = IOStuff::IO_FALLBACK_THREADS;
+}
+
+AsyncIO::~AsyncIO()
+{
+	WaitAll();
+	{
+		std::lock_guard<std::mutex> held(lock);
+		exiting = true;
+	}
+	progress.notify_all();
+
+	#ifdef _WIN32
+		if (completionPort != nullptr)
+		{
+			PostQueuedCompletionStatus((HANDLE)completionPort, 0, IO_DOORBELL_KEY, nullptr);
+		}
+	#endif
+
+	for (u4Byte i = 0; i < numIOThreads; i += 1)
+	{
+		ioThreads[i].join();
+	}
+
+	#ifdef _WIN32
+		if (completionPort != nullptr)
+		{
+			CloseHandle((HANDLE)completionPort);
+			completionPort = nullptr;
+		}
+	#endif
+}
+
+IOTicket AsyncIO::Read(const char* path, void* dst, u8Byte capacity, u8Byte offset,
+					   IOCallback onComplete, void* userData)
+{
+	const size_t pathLen = strlen(path);
+	assert(pathLen < IOStuff::MAX_IO_PATH);
+
+	std::unique_lock<std::mutex> held(lock);
+	Request& req = Claim(held, 0, nullptr);
+	req.op = IO_OPS::READ;
+	req.mode = IO_WRITE_MODES::OVERWRITE; // Unused for reads
+	memcpy(req.path, path, pathLen + 1);
+	req.data = (uByte*)dst;
+	req.numBytes = capacity;
+	req.offset = offset;
+	req.onComplete = onComplete;
+	req.userData = userData;
+	return Submit(req);
+}
+
+IOTicket AsyncIO::Write(const char* path, const void* src, u8Byte numBytes,
+						IO_WRITE_MODES mode, bool stageCopy,
+						IOCallback onComplete, void* userData)
+{
+	assert(mode != IO_WRITE_MODES::IN_PLACE); // In-place writes need an offset, use [WriteAt(...)]
+	return QueueWrite(path, src, numBytes, mode, 0, stageCopy, onComplete, userData);
+}
+
+IOTicket AsyncIO::WriteAt(const char* path, const void* src, u8Byte numBytes, u8Byte offset,
+						  bool stageCopy, IOCallback onComplete, void* userData)
+{
+	return QueueWrite(path, src, numBytes, IO_WRITE_MODES::IN_PLACE, offset, stageCopy, onComplete, userData);
+}
+
+IOTicket AsyncIO::QueueWrite(const char* path, const void* src, u8Byte numBytes,
+							 IO_WRITE_MODES mode, u8Byte offset, bool stageCopy,
+							 IOCallback onComplete, void* userData)
+{
+	const size_t pathLen = strlen(path);
+	assert(pathLen < IOStuff::MAX_IO_PATH);
+	assert(!stageCopy || (numBytes <= IOStuff::IO_STAGING_BYTES));
+
+	std::unique_lock<std::mutex> held(lock);
+	uByte* staged = nullptr;
+	Request& req = Claim(held, stageCopy ? numBytes : 0, &staged);
+	if (stageCopy)
+	{
+		memcpy(staged, src, numBytes);
+		req.data = staged;
+	}
+	else
+	{
+		req.data = (uByte*)src;
+	}
+
+	req.op = IO_OPS::WRITE;
+	req.mode = mode;
+	memcpy(req.path, path, pathLen + 1);
+	req.numBytes = numBytes;
+	req.offset = offset; // Resolved when the write is issued (except for in-place writes)
+	req.onComplete = onComplete;
+	req.userData = userData;
+	return Submit(req);
+}
+
+IO_STATUS AsyncIO::Status(IOTicket ticket, u8Byte* bytesTransferred)
+{
+	std::lock_guard<std::mutex> held(lock);
+	const Request& req = requests[RequestSlot(ticket)];
+	if (req.ticket != ticket)
+	{
+		// Slot recycled; the request must have finished a while ago
+		if (bytesTransferred != nullptr) { *bytesTransferred = 0; }
+		return IO_STATUS::DONE;
+	}
+
+	const IO_STATUS status = (IO_STATUS)req.status.load(std::memory_order_acquire);
+	if (bytesTransferred != nullptr) { *bytesTransferred = req.bytesTransferred; }
+	return status;
+}
+
+IO_STATUS AsyncIO::Wait(IOTicket ticket, u8Byte* bytesTransferred)
+{
+	std::unique_lock<std::mutex> held(lock);
+	while (true)
+	{
+		const Request& req = requests[RequestSlot(ticket)];
+		if (req.ticket != ticket)
+		{
+			if (bytesTransferred != nullptr) { *bytesTransferred = 0; }
+			return IO_STATUS::DONE;
+		}
+
+		const IO_STATUS status = (IO_STATUS)req.status.load(std::memory_order_acquire);
+		if (status != IO_STATUS::PENDING)
+		{
+			if (bytesTransferred != nullptr) { *bytesTransferred = req.bytesTransferred; }
+			return status;
+		}
+		progress.wait(held);
+	}
+}
+
+void AsyncIO::WaitAll()
+{
+	std::unique_lock<std::mutex> held(lock);
+	Retire();
+	while (retiredTicket != nextTicket)
+	{
+		progress.wait(held);
+		Retire();
+	}
+}
+
+bool AsyncIO::NativeBackend() const
+{
+	return completionPort != nullptr;
+}
+
+AsyncIO::Request& AsyncIO::Claim(std::unique_lock<std::mutex>& held, u8Byte stagingBytes, uByte** staged)
+{
+	while (true)
+	{
+		Retire();
+		const bool slotFree = (nextTicket - retiredTicket) < IOStuff::MAX_IO_REQUESTS;
+
+		// Staged copies are contiguous, so skip to the start of the staging ring when
+		// a copy won't fit before the end
+		bool stagingFree = true;
+		u8Byte stagingStart = stagingHead;
+		if (stagingBytes > 0)
+		{
+			const u8Byte ringPos = stagingHead % IOStuff::IO_STAGING_BYTES;
+			if ((ringPos + stagingBytes) > IOStuff::IO_STAGING_BYTES)
+			{
+				stagingStart += IOStuff::IO_STAGING_BYTES - ringPos;
+			}
+
+			// Nothing staged right now, so the skipped space is free as well
+			if (stagingTail == stagingHead)
+			{
+				stagingTail = stagingStart;
+				stagingHead = stagingStart;
+			}
+			stagingFree = ((stagingStart + stagingBytes) - stagingTail) <= IOStuff::IO_STAGING_BYTES;
+		}
+
+		if (slotFree && stagingFree)
+		{
+			Request& req = requests[RequestSlot(nextTicket)];
+			req.stagingEnd = 0;
+			if (stagingBytes > 0)
+			{
+				*staged = staging + (stagingStart % IOStuff::IO_STAGING_BYTES);
+				stagingHead = stagingStart + stagingBytes;
+				req.stagingEnd = stagingHead;
+			}
+			return req;
+		}
+
+		// Wait for the oldest requests to finish
+		progress.wait(held);
+	}
+}
+
+void AsyncIO::Retire()
+{
+	while (retiredTicket != nextTicket)
+	{
+		const Request& req = requests[RequestSlot(retiredTicket)];
+		if ((IO_STATUS)req.status.load(std::memory_order_acquire) == IO_STATUS::PENDING) { break; }
+		if (req.stagingEnd != 0) { stagingTail = req.stagingEnd; }
+		retiredTicket += 1;
+	}
+}
+
+IOTicket AsyncIO::Submit(Request& req)
+{
+	req.ticket = nextTicket;
+	req.bytesTransferred = 0;
+	req.status.store((u4Byte)IO_STATUS::PENDING, std::memory_order_relaxed);
+	nextTicket += 1;
+
+	// Wake whichever thread issues requests
+	progress.notify_all();
+	#ifdef _WIN32
+		if (completionPort != nullptr)
+		{
+			PostQueuedCompletionStatus((HANDLE)completionPort, 0, IO_DOORBELL_KEY, nullptr);
+		}
+	#endif
+	return req.ticket;
+}
+
+AsyncIO::AppendCursor* AsyncIO::FindCursor(const char* path)
+{
+	for (u4Byte i = 0; i < numAppendCursors; i += 1)
+	{
+		if (strcmp(appendCursors[i].path, path) == 0)
+		{
+			return &appendCursors[i];
+		}
+	}
+	return nullptr;
+}
+
+AsyncIO::AppendCursor* AsyncIO::IdleCursor()
+{
+	if (numAppendCursors < IOStuff::MAX_APPEND_STREAMS)
+	{
+		numAppendCursors += 1;
+		return &appendCursors[numAppendCursors - 1];
+	}
+
+	// Round-robin over cursors without writes in flight; recycling a busy cursor
+	// would resume its file from a size that doesn't include those writes yet
+	for (u4Byte i = 0; i < IOStuff::MAX_APPEND_STREAMS; i += 1)
+	{
+		AppendCursor* cursor = &appendCursors[(nextAppendCursor + i) % IOStuff::MAX_APPEND_STREAMS];
+		if (cursor->numInFlight == 0 && !cursor->sizing)
+		{
+			nextAppendCursor = (nextAppendCursor + i + 1) % IOStuff::MAX_APPEND_STREAMS;
+			return cursor;
+		}
+	}
+	return nullptr;
+}
+
+bool AsyncIO::Issuable(const Request& req)
+{
+	if (req.op == IO_OPS::READ) { return true; }
+
+	// New files need a free or idle cursor
+	const AppendCursor* cursor = FindCursor(req.path);
+	if (cursor == nullptr)
+	{
+		if (numAppendCursors < IOStuff::MAX_APPEND_STREAMS) { return true; }
+		for (u4Byte i = 0; i < IOStuff::MAX_APPEND_STREAMS; i += 1)
+		{
+			if (appendCursors[i].numInFlight == 0 && !appendCursors[i].sizing) { return true; }
+		}
+		return false;
+	}
+
+	// Writes to each file are serialized around overwrites (which truncate it);
+	// appends + in-place writes get disjoint ranges, so those can overlap
+	if (cursor->sizing || cursor->overwriting) { return false; }
+	return (req.mode != IO_WRITE_MODES::OVERWRITE) || (cursor->numInFlight == 0);
+}
+
+u8Byte AsyncIO::WriteOffset(std::unique_lock<std::mutex>& held, const Request& req)
+{
+	// Track new files; overwrites always get a cursor, so later writes can wait for
+	// them to finish
+	AppendCursor* cursor = FindCursor(req.path);
+	if (cursor == nullptr)
+	{
+		cursor = IdleCursor();
+		assert(cursor != nullptr); // Guaranteed by [Issuable(...)]
+		memcpy(cursor->path, req.path, strlen(req.path) + 1);
+		cursor->offset = 0;
+		cursor->numInFlight = 0;
+		cursor->overwriting = false;
+		cursor->sizing = false;
+
+		// Other writes start from the end of the file; nothing else is writing to it
+		// through this service, so its size on disk is current
+		// Query that outside the lock so submitters never wait on the file system;
+		// later writes to the same file wait on [sizing] instead
+		if (req.mode != IO_WRITE_MODES::OVERWRITE)
+		{
+			cursor->sizing = true;
+			held.unlock();
+			std::error_code err;
+			const u8Byte fileSize = (u8Byte)std::filesystem::file_size(req.path, err);
+			held.lock();
+			cursor->offset = err ? 0 : fileSize;
+			cursor->sizing = false;
+			progress.notify_all();
+		}
+	}
+
+	cursor->numInFlight += 1;
+	if (req.mode == IO_WRITE_MODES::OVERWRITE)
+	{
+		cursor->overwriting = true;
+		cursor->offset = req.numBytes;
+		return 0;
+	}
+	else if (req.mode == IO_WRITE_MODES::IN_PLACE)
+	{
+		// In-place writes can extend the file, so appends issued afterwards should land past them
+		const u8Byte writeEnd = req.offset + req.numBytes;
+		if (writeEnd > cursor->offset) { cursor->offset = writeEnd; }
+		return req.offset;
+	}
+
+	const u8Byte offset = cursor->offset;
+	cursor->offset += req.numBytes;
+	return offset;
+}
+
+void AsyncIO::Complete(Request& req, IO_STATUS status, u8Byte bytesTransferred)
+{
+	// Release the file's cursor while the request still owns its slot (the slot
+	// can be recycled as soon as its status is published)
+	if (req.op == IO_OPS::WRITE)
+	{
+		std::lock_guard<std::mutex> held(lock);
+		AppendCursor* cursor = FindCursor(req.path);
+		assert(cursor != nullptr && cursor->numInFlight > 0);
+		cursor->numInFlight -= 1;
+		if (req.mode == IO_WRITE_MODES::OVERWRITE) { cursor->overwriting = false; }
+	}
+
+	// Run callbacks before publishing results, so anything waiting on the request
+	// also sees everything its callback did
+	req.bytesTransferred = bytesTransferred;
+	if (req.onComplete != nullptr)
+	{
+		req.onComplete(status, bytesTransferred, req.userData);
+	}
+	req.status.store((u4Byte)status, std::memory_order_release);
+
+	// Taking the lock orders this wake-up after any waiter's last status check
+	{
+		std::lock_guard<std::mutex> held(lock);
+	}
+	progress.notify_all();
+}
+
+void AsyncIO::NativeLoop()
+{
+	#ifdef _WIN32
+		NativeRequest* native = (NativeRequest*)nativeState;
+		while (true)
+		{
+			DWORD numBytes = 0;
+			ULONG_PTR key = 0;
+			OVERLAPPED* overlapped = nullptr;
+			const BOOL succeeded = GetQueuedCompletionStatus((HANDLE)completionPort, &numBytes, &key, &overlapped, INFINITE);
+			if (key != IO_DOORBELL_KEY && overlapped != nullptr)
+			{
+				// Finished transfer
+				NativeRequest& nativeReq = *(NativeRequest*)overlapped;
+				CloseHandle(nativeReq.file);
+				nativeReq.file = INVALID_HANDLE_VALUE;
+				const bool reachedEOF = !succeeded && (GetLastError() == ERROR_HANDLE_EOF);
+				Complete(requests[nativeReq.slot], (succeeded || reachedEOF) ? IO_STATUS::DONE : IO_STATUS::FAILED, numBytes);
+			}
+
+			// Issue everything submitted since the last doorbell, up to the first
+			// request waiting on writes in flight (completions can unblock it, so
+			// this runs after those as well); write offsets are resolved in
+			// submission order, but files are opened + transfers started outside
+			// the lock so submitters never wait on the file system
+			while (true)
+			{
+				std::unique_lock<std::mutex> held(lock);
+				if (issuedTicket == nextTicket)
+				{
+					if (exiting) { return; }
+					break;
+				}
+
+				Request& req = requests[RequestSlot(issuedTicket)];
+				NativeRequest& nativeReq = native[RequestSlot(issuedTicket)];
+				if (!Issuable(req)) { break; }
+				issuedTicket += 1;
+				const bool reading = (req.op == IO_OPS::READ);
+				const u8Byte offset = reading ? req.offset : WriteOffset(held, req);
+				held.unlock();
+
+				const DWORD disposition = reading ? OPEN_EXISTING : ((req.mode == IO_WRITE_MODES::OVERWRITE) ? CREATE_ALWAYS : OPEN_ALWAYS);
+				HANDLE file = CreateFileA(req.path, reading ? GENERIC_READ : GENERIC_WRITE,
+										  FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, disposition,
+										  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, nullptr);
+				if (file == INVALID_HANDLE_VALUE)
+				{
+					Complete(req, IO_STATUS::FAILED, 0);
+					continue;
+				}
+				if (CreateIoCompletionPort(file, (HANDLE)completionPort, IO_FILE_KEY, 0) == nullptr)
+				{
+					CloseHandle(file);
+					Complete(req, IO_STATUS::FAILED, 0);
+					continue;
+				}
+
+				// Overlapped transfers are limited to 32-bit lengths
+				assert(req.numBytes <= 0xFFFFFFFF);
+				memset(&nativeReq.overlapped, 0, sizeof(OVERLAPPED));
+				nativeReq.overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+				nativeReq.overlapped.OffsetHigh = (DWORD)(offset >> 32);
+				nativeReq.file = file;
+				const BOOL issued = reading ? ReadFile(file, req.data, (DWORD)req.numBytes, nullptr, &nativeReq.overlapped) :
+											  WriteFile(file, req.data, (DWORD)req.numBytes, nullptr, &nativeReq.overlapped);
+				const DWORD err = issued ? ERROR_SUCCESS : GetLastError();
+				if (!issued && err != ERROR_IO_PENDING)
+				{
+					// Failed before anything was queued, so no completion is coming
+					// (reads starting past the end of a file land here, + count as
+					// empty reads rather than failures)
+					CloseHandle(file);
+					nativeReq.file = INVALID_HANDLE_VALUE;
+					Complete(req, (err == ERROR_HANDLE_EOF) ? IO_STATUS::DONE : IO_STATUS::FAILED, 0);
+				}
+			}
+		}
+	#endif
+}
+
+void AsyncIO::FallbackLoop()
+{
+	while (true)
+	{
+		// Pull the next request once it won't race writes already in flight (see
+		// [Issuable(...)]); files are opened under the lock, so truncating overwrites
+		// always happen before later requests touch the same file
+		std::unique_lock<std::mutex> held(lock);
+		progress.wait(held, [this]()
+		{
+			return exiting || ((issuedTicket != nextTicket) && Issuable(requests[RequestSlot(issuedTicket)]));
+		});
+		if (issuedTicket == nextTicket) { return; } // Exiting with nothing left to do
+
+		Request& req = requests[RequestSlot(issuedTicket)];
+		issuedTicket += 1;
+		const bool reading = (req.op == IO_OPS::READ);
+		u8Byte offset = req.offset;
+		FILE* file = nullptr;
+		if (reading)
+		{
+			file = OpenFile(req.path, "rb");
+		}
+		else
+		{
+			offset = WriteOffset(held, req);
+			file = OpenFile(req.path, (req.mode == IO_WRITE_MODES::OVERWRITE) ? "wb" : "r+b");
+			if (file == nullptr && req.mode != IO_WRITE_MODES::OVERWRITE)
+			{
+				// Appending to (or writing into) a file that doesn't exist yet
+				file = OpenFile(req.path, "wb");
+			}
+		}
+		held.unlock();
+
+		if (file == nullptr)
+		{
+			Complete(req, IO_STATUS::FAILED, 0);
+			continue;
+		}
+
+		u8Byte numBytes = 0;
+		bool succeeded = SeekFile(file, offset);
+		if (succeeded)
+		{
+			numBytes = reading ? fread(req.data, 1, req.numBytes, file) :
+								 fwrite(req.data, 1, req.numBytes, file);
+			succeeded = reading ? (ferror(file) == 0) : (numBytes == req.numBytes);
+		}
+		succeeded = (fclose(file) == 0) && succeeded;
+		Complete(req, succeeded ? IO_STATUS::DONE : IO_STATUS::FAILED, numBytes);
+	}
+}
+
+// Push constructions for this class through Athru's custom allocator
+void* AsyncIO::operator new(size_t size)
+{
+	StackAllocator* allocator = AthruCore::Utility::AccessMemory();
+	return allocator->AlignedAlloc(size, (uByte)std::alignment_of<AsyncIO>(), false);
+}
+
+// We aren't expecting to use [delete], so overload it to do nothing
+void AsyncIO::operator delete(void* target)
+{
+	return;
+}
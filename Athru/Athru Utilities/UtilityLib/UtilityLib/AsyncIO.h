@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "Typedefs.h"
+#include "AppGlobals.h"
+
+// Request states
+enum class IO_STATUS
+{
+	PENDING,
+	DONE,
+	FAILED
+};
+
+// Ways to write into files; [OVERWRITE] replaces the file, [APPEND] adds to the
+// end of it (appends to the same file always land in submission order), [IN_PLACE]
+// writes at a fixed offset without truncating (see [AsyncIO::WriteAt(...)])
+enum class IO_WRITE_MODES
+{
+	OVERWRITE,
+	APPEND,
+	IN_PLACE
+};
+
+// Handle for a submitted request; tickets count up from one, so zero is never
+// a valid ticket
+typedef u4Byte IOTicket;
+
+// Completion callback; runs on an I/O thread, so it should be short + must not
+// block on other I/O
+typedef void (*IOCallback)(IO_STATUS status, u8Byte bytesTransferred, void* userData);
+
+// Asynchronous file I/O service
+// Requests go into a submission ring + complete out-of-order; callers either poll
+// [Status(...)], block in [Wait(...)], or hand over a callback
+// Windows builds run requests as overlapped I/O through a completion port (one
+// service thread issues requests + reaps completions); other platforms (or
+// Windows machines where the port can't be created) fall back to a small pool
+// of threads doing blocking reads/writes
+class AsyncIO
+{
+	public:
+		AsyncIO();
+		~AsyncIO(); // Finishes every outstanding request before returning
+
+		// Read up to [capacity] bytes from [path] into [dst], starting [offset] bytes
+		// into the file; [dst] has to stay alive until the request completes
+		IOTicket Read(const char* path, void* dst, u8Byte capacity, u8Byte offset = 0,
+					  IOCallback onComplete = nullptr, void* userData = nullptr);
+
+		// Write [numBytes] bytes from [src] into [path]
+		// With [stageCopy] set, [src] is copied into internal staging space before
+		// this returns (so callers can immediately reuse it); otherwise [src] has to
+		// stay alive until the request completes
+		// Staged writes are limited to [IOStuff::IO_STAGING_BYTES]
+		IOTicket Write(const char* path, const void* src, u8Byte numBytes,
+					   IO_WRITE_MODES mode, bool stageCopy,
+					   IOCallback onComplete = nullptr, void* userData = nullptr);
+
+		// Write [numBytes] bytes from [src] into [path], starting [offset] bytes into the file
+		// The file is created if it doesn't exist, but never truncated; useful for fixed-size
+		// records (e.g. video frames) that can finish out-of-order
+		IOTicket WriteAt(const char* path, const void* src, u8Byte numBytes, u8Byte offset,
+						 bool stageCopy, IOCallback onComplete = nullptr, void* userData = nullptr);
+
+		// Check on a request; [bytesTransferred] (if given) receives the number of
+		// bytes read/written so far
+		// Results are only kept for the most recent [IOStuff::MAX_IO_REQUESTS]
+		// requests; older requests report [IO_STATUS::DONE] with zero bytes
+		IO_STATUS Status(IOTicket ticket, u8Byte* bytesTransferred = nullptr);
+
+		// Block until the given request completes, then return its status
+		IO_STATUS Wait(IOTicket ticket, u8Byte* bytesTransferred = nullptr);
+
+		// Block until every submitted request has completed
+		void WaitAll();
+
+		// Whether requests are running on the platform's native asynchronous I/O
+		// (as opposed to the thread-pool fallback)
+		bool NativeBackend() const;
+
+		// Overload the standard allocation/de-allocation operators
+		void* operator new(size_t size);
+		void operator delete(void* target);
+
+	private:
+		enum class IO_OPS
+		{
+			READ,
+			WRITE
+		};
+
+		struct Request
+		{
+			IOTicket ticket;
+			IO_OPS op;
+			IO_WRITE_MODES mode;
+			char path[IOStuff::MAX_IO_PATH];
+			uByte* data;
+			u8Byte numBytes;
+			u8Byte offset;
+			u8Byte stagingEnd; // End of this request's staging space (zero if unstaged)
+			IOCallback onComplete;
+			void* userData;
+			std::atomic<u4Byte> status; // [IO_STATUS], stored as an integer
+			u8Byte bytesTransferred;
+		};
+
+		// Write position for each file being appended to; assigned as requests are
+		// issued, so appends keep their order even when several are in flight at once
+		// Cursors also track the writes in flight for their file, so overwrites never
+		// race other writes to the same path + cursors are only recycled once idle
+		struct AppendCursor
+		{
+			char path[IOStuff::MAX_IO_PATH];
+			u8Byte offset;
+			u4Byte numInFlight; // Issued writes that haven't completed yet
+			bool overwriting; // Whether one of those writes is an overwrite
+			bool sizing; // Whether [offset] is still being read from the file system
+		};
+
+		// Claim a request slot (+ staging space, if [stagingBytes] is non-zero);
+		// blocks while the ring/staging space is full
+		// Called with [lock] held
+		Request& Claim(std::unique_lock<std::mutex>& held, u8Byte stagingBytes, uByte** staged);
+
+		// Shared body for [Write(...)] + [WriteAt(...)]
+		IOTicket QueueWrite(const char* path, const void* src, u8Byte numBytes,
+							IO_WRITE_MODES mode, u8Byte offset, bool stageCopy,
+							IOCallback onComplete, void* userData);
+
+		// Release slots (+ staging space) held by completed requests, oldest first
+		// Called with [lock] held
+		void Retire();
+
+		// Publish a claimed request to the I/O threads
+		// Called with [lock] held
+		IOTicket Submit(Request& req);
+
+		// Find the cursor tracking [path], or an idle cursor to recycle; either
+		// returns [nullptr] if there isn't one
+		// Called with [lock] held
+		AppendCursor* FindCursor(const char* path);
+		AppendCursor* IdleCursor();
+
+		// Whether [req] can be issued without racing writes already in flight; requests
+		// are issued in submission order, so later requests wait behind this one
+		// Called with [lock] held
+		bool Issuable(const Request& req);
+
+		// Resolve where a write lands + update the file's append cursor; new cursors
+		// read the file's size with [lock] released
+		// Called with [lock] held, in submission order, once [Issuable(...)] passes
+		u8Byte WriteOffset(std::unique_lock<std::mutex>& held, const Request& req);
+
+		// Record a request's result, run its callback + wake waiters
+		void Complete(Request& req, IO_STATUS status, u8Byte bytesTransferred);
+
+		// I/O thread loops
+		void NativeLoop();
+		void FallbackLoop();
+
+		Request* requests;
+		IOTicket nextTicket; // Next ticket to hand out
+		IOTicket issuedTicket; // Next ticket to hand to an I/O thread
+		IOTicket retiredTicket; // Every ticket below this has completed + released its slot
+
+		uByte* staging;
+		u8Byte stagingHead;
+		u8Byte stagingTail;
+
+		AppendCursor appendCursors[IOStuff::MAX_APPEND_STREAMS];
+		u4Byte numAppendCursors;
+		u4Byte nextAppendCursor; // First cursor to consider recycling when every cursor is in use
+
+		std::mutex lock;
+		std::condition_variable progress; // Signalled on every submission + completion
+		bool exiting;
+
+		// Native (completion port) state; [nativeState] carries per-request
+		// overlapped records + file handles, parallel to [requests]
+		void* completionPort;
+		void* nativeState;
+
+		std::thread ioThreads[IOStuff::IO_FALLBACK_THREADS];
+		u4Byte numIOThreads;
+};
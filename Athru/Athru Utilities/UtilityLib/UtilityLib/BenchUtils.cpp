@@ -0,0 +1,10 @@
+#include <string>
+#include "UtilityServiceCentre.h"
+#include "BenchUtils.h"
+
+float BenchUtils::ReportChecks(bool valid, const char* benchName, float result)
+{
+	const std::string label = std::string(benchName) + ", all checks passed";
+	AthruCore::Utility::AccessLogger()->Log(valid, label.c_str());
+	return valid ? result : -1.0f;
+}
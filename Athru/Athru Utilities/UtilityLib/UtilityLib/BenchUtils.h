@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Typedefs.h"
+
+// Shared scaffolding for the headless benchmarks/simulations (the [-bench-*] +
+// [-selftest] flags)
+
+// Deterministic xorshift32 stream; every run draws the same values, so results
+// are comparable between runs + builds
+// Call like a function ([next()]) for the next value
+class BenchRand
+{
+	public:
+		BenchRand() : state(0x9E3779B9) {}
+
+		u4Byte operator()()
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+
+	private:
+		u4Byte state;
+};
+
+namespace BenchUtils
+{
+	// Log whether every check made by the benchmark named [benchName] passed, then
+	// return [result] if they did or -1 if they didn't (benchmarks report failure
+	// with negative results)
+	float ReportChecks(bool valid, const char* benchName, float result);
+}
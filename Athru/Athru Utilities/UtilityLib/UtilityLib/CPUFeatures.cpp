@@ -0,0 +1,83 @@
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+#include "CPUFeatures.h"
+
+namespace CPUFeatures
+{
+	// Feature bits are read once + cached
+	struct Features
+	{
+		bool avx2;
+		bool avx512;
+	};
+
+	static Features Detect()
+	{
+		Features features;
+#if defined(_MSC_VER)
+		int regs[4];
+		__cpuid(regs, 0);
+		const int maxLeaf = regs[0];
+		__cpuid(regs, 1);
+		const bool osxsave = (regs[2] & (1 << 27)) != 0;
+		const bool fma = (regs[2] & (1 << 12)) != 0;
+		const u8Byte xcr0 = osxsave ? _xgetbv(0) : 0;
+		bool avx2 = false;
+		bool avx512 = false;
+		if (maxLeaf >= 7)
+		{
+			__cpuidex(regs, 7, 0);
+			avx2 = (regs[1] & (1 << 5)) != 0;
+			avx512 = (regs[1] & (1 << 16)) != 0;
+		}
+
+		// The OS has to save the wider registers as well ([XCR0] bits 1-2 for the YMM
+		// state, 5-7 for the opmask + ZMM state)
+		features.avx2 = avx2 && fma && (xcr0 & 0x6) == 0x6;
+		features.avx512 = avx512 && (xcr0 & 0xE6) == 0xE6;
+#else
+		features.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		features.avx512 = __builtin_cpu_supports("avx512f");
+#endif
+		return features;
+	}
+
+	bool Supported(ISAS isa)
+	{
+		static const Features features = Detect();
+		switch (isa)
+		{
+			case ISAS::SCALAR:
+			case ISAS::SSE2:
+				return true;
+			case ISAS::AVX2:
+				return features.avx2;
+			case ISAS::AVX512:
+				return features.avx512;
+		}
+		return false;
+	}
+
+	ISAS Best()
+	{
+		return Supported(ISAS::AVX512) ? ISAS::AVX512 :
+			   Supported(ISAS::AVX2) ? ISAS::AVX2 : ISAS::SSE2;
+	}
+
+	const char* Name(ISAS isa)
+	{
+		switch (isa)
+		{
+			case ISAS::SCALAR:
+				return "scalar";
+			case ISAS::SSE2:
+				return "SSE2";
+			case ISAS::AVX2:
+				return "AVX2";
+			case ISAS::AVX512:
+				return "AVX-512";
+		}
+		return "unknown";
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Typedefs.h"
+
+// Runtime instruction-set detection for code with per-ISA kernels (compiled
+// into their own translation units with the matching target flags); nothing
+// may call into a kernel before [Supported(...)] has passed for its
+// instruction set
+namespace CPUFeatures
+{
+	enum class ISAS
+	{
+		SCALAR,
+		SSE2, // Part of the x64 baseline, so always available
+		AVX2, // AVX2 + FMA
+		AVX512 // AVX-512F
+	};
+
+	// Whether the running CPU (+ OS, for the wider register files) supports [isa]
+	bool Supported(ISAS isa);
+
+	// Widest supported instruction set
+	ISAS Best();
+
+	const char* Name(ISAS isa);
+}
@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include "UtilityServiceCentre.h"
+#include "JobSystem.h"
+
+// Sentinel worker index for threads outside the pool
+constexpr u4Byte NOT_A_WORKER = 0xFFFFFFFF;
+
+// Index of the worker running on each thread
+static thread_local u4Byte currWorkerNdx = NOT_A_WORKER;
+
+// Idle workers spin (yielding between attempts) this many times before they
+// go to sleep; short gaps between jobs are common + waking threads is slow
+constexpr u4Byte IDLE_SPINS = 64;
+
+void JobSystem::WorkDeque::Init(std::atomic<Job*>* storage, u4Byte capacity)
+{
+	assert((capacity & (capacity - 1)) == 0);
+	top.store(0, std::memory_order_relaxed);
+	bottom.store(0, std::memory_order_relaxed);
+	buffer = storage;
+	mask = capacity - 1;
+}
+
+// Memory ordering follows Le et al., "Correct and Efficient Work-Stealing for
+// Weak Memory Models" (2013)
+void JobSystem::WorkDeque::Push(Job* job)
+{
+	const s8Byte b = bottom.load(std::memory_order_relaxed);
+	const s8Byte t = top.load(std::memory_order_acquire);
+	assert((b - t) <= (s8Byte)mask); // Deques don't grow; more than [JobStuff::JOBS_PER_WORKER] queued jobs is a bug
+	buffer[b & mask].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release); // Publishes [job] (+ its payload) to thieves
+}
+
+JobSystem::Job* JobSystem::WorkDeque::Pop()
+{
+	const s8Byte b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	s8Byte t = top.load(std::memory_order_relaxed);
+	if (t > b)
+	{
+		// Empty deque
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = buffer[b & mask].load(std::memory_order_relaxed);
+	if (t == b)
+	{
+		// Last job in the deque; race any thieves for it
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+JobSystem::Job* JobSystem::WorkDeque::Steal()
+{
+	s8Byte t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const s8Byte b = bottom.load(std::memory_order_acquire);
+	if (t >= b) { return nullptr; }
+
+	Job* job = buffer[t & mask].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		// Lost the race to the owner/another thief
+		return nullptr;
+	}
+	return job;
+}
+
+JobSystem::JobSystem() :
+	bgHead(0),
+	bgTail(0),
+	numBackground(0),
+	numQueued(0),
+	numSleeping(0),
+	exiting(false)
+{
+	// One worker per hardware thread; the creating thread is worker zero
+	const u4Byte hwThreads = std::thread::hardware_concurrency();
+	numWorkers = (hwThreads == 0) ? 1 : ((hwThreads > JobStuff::MAX_WORKERS) ? JobStuff::MAX_WORKERS : hwThreads);
+	workers = MemoryStuff::ArrayAlloc<Worker>(numWorkers, false);
+	for (u4Byte i = 0; i < numWorkers; i += 1)
+	{
+		new (&workers[i]) Worker();
+		workers[i].jobs = MemoryStuff::ArrayAlloc<Job>(JobStuff::JOBS_PER_WORKER, false);
+		for (u4Byte j = 0; j < JobStuff::JOBS_PER_WORKER; j += 1)
+		{
+			new (&workers[i].jobs[j]) Job();
+			workers[i].jobs[j].unfinished.store(0, std::memory_order_relaxed);
+		}
+
+		std::atomic<Job*>* dequeStorage = MemoryStuff::ArrayAlloc<std::atomic<Job*>>(JobStuff::JOBS_PER_WORKER, false);
+		for (u4Byte j = 0; j < JobStuff::JOBS_PER_WORKER; j += 1)
+		{
+			new (&dequeStorage[j]) std::atomic<Job*>(nullptr);
+		}
+		workers[i].deque.Init(dequeStorage, JobStuff::JOBS_PER_WORKER);
+		workers[i].nextJob = 0;
+		workers[i].rng = (i + 1) * 0x9E3779B9u;
+	}
+	bgJobs = MemoryStuff::ArrayAlloc<Job*>(JobStuff::MAX_BACKGROUND_JOBS, false);
+
+	currWorkerNdx = 0;
+	for (u4Byte i = 1; i < numWorkers; i += 1)
+	{
+		threads[i - 1] = std::thread(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	// Wake everyone up + wait for them to leave
+	// Outstanding jobs are abandoned, so callers should wait on anything
+	// important before shutdown
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		exiting.store(true);
+	}
+	wakeSignal.notify_all();
+	for (u4Byte i = 1; i < numWorkers; i += 1)
+	{
+		threads[i - 1].join();
+	}
+	currWorkerNdx = NOT_A_WORKER;
+}
+
+void JobSystem::Depend(Job* job, Job* prereq)
+{
+	assert(!prereq->submitted);
+	assert(prereq->numContinuations < JobStuff::MAX_JOB_CONTINUATIONS);
+	job->pendingDeps.fetch_add(1, std::memory_order_relaxed);
+	prereq->continuations[prereq->numContinuations] = job;
+	prereq->numContinuations += 1;
+}
+
+void JobSystem::Run(Job* job)
+{
+	job->submitted = true;
+	Release(job);
+}
+
+bool JobSystem::Finished(const Job* job) const
+{
+	return job->unfinished.load(std::memory_order_acquire) == 0;
+}
+
+void JobSystem::Wait(const Job* job)
+{
+	const u4Byte workerNdx = CurrWorker();
+	while (!Finished(job))
+	{
+		Help(workerNdx);
+	}
+}
+
+u4Byte JobSystem::NumWorkers() const
+{
+	return numWorkers;
+}
+
+float JobSystem::Benchmark(u4Byte numItems)
+{
+	// Per-item work is a short dependent chain of transcendentals, heavy enough
+	// that scheduling overhead only shows up at very fine grains
+	float* results = MemoryStuff::ArrayAlloc<float>(numItems, false);
+	auto work = [results](u4Byte begin, u4Byte end)
+	{
+		for (u4Byte i = begin; i < end; i += 1)
+		{
+			float x = (float)i;
+			for (u4Byte j = 0; j < 64; j += 1)
+			{
+				x = sinf(x) * 0.5f + sqrtf(fabsf(x) + 1.0f);
+			}
+			results[i] = x;
+		}
+	};
+	auto elapsedMs = [](std::chrono::steady_clock::time_point t0)
+	{
+		return (float)((std::chrono::steady_clock::now() - t0).count() * TimeStuff::nsToSecs * 1000.0);
+	};
+
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	work(0, numItems);
+	const float serialMs = elapsedMs(t0);
+	logger->Log(serialMs, "Job system benchmark, serial time (milliseconds)");
+
+	// Splitting into [n] sub-ranges caps parallelism at [n] workers, so this gives
+	// scaling at 1, 2, 4... threads without resizing the pool
+	char label[128];
+	float speedup = 1.0f;
+	for (u4Byte numRanges = 1; numRanges < (numWorkers * 2); numRanges *= 2)
+	{
+		const u4Byte clampedRanges = (numRanges < numWorkers) ? numRanges : numWorkers;
+		t0 = std::chrono::steady_clock::now();
+		ParallelFor(0, numItems, (numItems + clampedRanges - 1) / clampedRanges, work);
+		const float parallelMs = elapsedMs(t0);
+		speedup = serialMs / ((parallelMs > 0.0f) ? parallelMs : 1e-6f);
+		snprintf(label, sizeof(label), "Job system benchmark, speedup over serial (%u workers)", clampedRanges);
+		logger->Log(speedup, label);
+		if (clampedRanges == numWorkers) { break; }
+	}
+
+	// Finer grains let idle workers balance load, at the cost of more jobs
+	t0 = std::chrono::steady_clock::now();
+	ParallelFor(0, numItems, (numItems / (numWorkers * 16)) + 1, work);
+	logger->Log(serialMs / std::max(elapsedMs(t0), 1e-6f), "Job system benchmark, speedup over serial (all workers, fine-grained)");
+
+	// Raw scheduling overhead; one empty job per item
+	constexpr u4Byte numEmptyJobs = JobStuff::JOBS_PER_WORKER / 2;
+	t0 = std::chrono::steady_clock::now();
+	ParallelFor(0, numEmptyJobs, 1, [](u4Byte begin, u4Byte end) {});
+	logger->Log((float)numEmptyJobs / std::max(elapsedMs(t0) * 0.001f, 1e-9f), "Job system benchmark, empty jobs/second");
+	return speedup;
+}
+
+JobSystem::Job* JobSystem::Allocate(void (*fn)(JobSystem&, Job*, const void*), Job* parent)
+{
+	// The ring can wrap onto slots that are still live (parents held open
+	// while they spawn children, jobs parked behind slow prerequisites...);
+	// reusing those would corrupt their counters, so skip ahead to the next
+	// free slot, + help out with queued work if every slot is taken
+	// Jobs run here can allocate too, so re-read the ring position after each one
+	const u4Byte workerNdx = CurrWorker();
+	Worker& worker = workers[workerNdx];
+	Job* job = nullptr;
+	while (job == nullptr)
+	{
+		for (u4Byte i = 0; i < JobStuff::JOBS_PER_WORKER; i += 1)
+		{
+			Job* slot = &worker.jobs[worker.nextJob & (JobStuff::JOBS_PER_WORKER - 1)];
+			worker.nextJob += 1;
+			if (Finished(slot))
+			{
+				job = slot;
+				break;
+			}
+		}
+
+		if (job == nullptr)
+		{
+			Help(workerNdx);
+		}
+	}
+
+	job->fn = fn;
+	job->parent = parent;
+	job->unfinished.store(1, std::memory_order_relaxed);
+	job->pendingDeps.store(1, std::memory_order_relaxed);
+	job->numContinuations = 0;
+	job->submitted = false;
+	if (parent != nullptr)
+	{
+		parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void JobSystem::Release(Job* job)
+{
+	if (job->pendingDeps.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		Push(job);
+	}
+}
+
+void JobSystem::Push(Job* job)
+{
+	workers[CurrWorker()].deque.Push(job);
+	numQueued.fetch_add(1, std::memory_order_seq_cst);
+	Wake();
+}
+
+void JobSystem::PushBackground(Job* job)
+{
+	{
+		std::lock_guard<std::mutex> lock(bgMutex);
+		if ((bgTail - bgHead) < JobStuff::MAX_BACKGROUND_JOBS)
+		{
+			bgJobs[bgTail % JobStuff::MAX_BACKGROUND_JOBS] = job;
+			bgTail += 1;
+			job = nullptr;
+		}
+	}
+
+	// Nowhere to queue [job]; running it here stalls the caller, but that beats
+	// dropping it
+	if (job != nullptr)
+	{
+		Execute(job);
+		return;
+	}
+	numBackground.fetch_add(1, std::memory_order_seq_cst);
+	numQueued.fetch_add(1, std::memory_order_seq_cst);
+	Wake();
+}
+
+void JobSystem::Wake()
+{
+	if (numSleeping.load(std::memory_order_seq_cst) > 0)
+	{
+		// Taking the lock orders this wake-up after any sleeper's last check for work
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		wakeSignal.notify_one();
+	}
+}
+
+JobSystem::Job* JobSystem::Take(u4Byte workerNdx)
+{
+	Worker& worker = workers[workerNdx];
+	Job* job = worker.deque.Pop();
+	for (u4Byte i = 0; (job == nullptr) && (i < numWorkers); i += 1)
+	{
+		// Xorshift32 victim selection
+		worker.rng ^= worker.rng << 13;
+		worker.rng ^= worker.rng >> 17;
+		worker.rng ^= worker.rng << 5;
+		const u4Byte victim = worker.rng % numWorkers;
+		if (victim != workerNdx)
+		{
+			job = workers[victim].deque.Steal();
+		}
+	}
+
+	// Background jobs are only picked up once there's nothing else to do, +
+	// never by the main thread while other workers are around to take them
+	const bool takesBackground = (workerNdx != 0) || (numWorkers == 1);
+	if ((job == nullptr) && takesBackground && (numBackground.load(std::memory_order_acquire) > 0))
+	{
+		std::lock_guard<std::mutex> lock(bgMutex);
+		if (bgHead != bgTail)
+		{
+			job = bgJobs[bgHead % JobStuff::MAX_BACKGROUND_JOBS];
+			bgHead += 1;
+			numBackground.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (job != nullptr)
+	{
+		numQueued.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void JobSystem::Help(u4Byte workerNdx)
+{
+	Job* job = Take(workerNdx);
+	if (job != nullptr)
+	{
+		Execute(job);
+	}
+	else
+	{
+		std::this_thread::yield();
+	}
+}
+
+void JobSystem::Execute(Job* job)
+{
+	job->fn(*this, job, job->payload);
+	Finish(job);
+}
+
+void JobSystem::Finish(Job* job)
+{
+	// Copy out everything we need before releasing [job]; its slot can be recycled
+	// as soon as [unfinished] reaches zero
+	Job* parent = job->parent;
+	const u4Byte numContinuations = job->numContinuations;
+	Job* continuations[JobStuff::MAX_JOB_CONTINUATIONS];
+	for (u4Byte i = 0; i < numContinuations; i += 1)
+	{
+		continuations[i] = job->continuations[i];
+	}
+
+	if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) { return; }
+	for (u4Byte i = 0; i < numContinuations; i += 1)
+	{
+		Release(continuations[i]);
+	}
+
+	if (parent != nullptr)
+	{
+		Finish(parent);
+	}
+}
+
+u4Byte JobSystem::CurrWorker() const
+{
+	// Jobs can only be used from pool workers; foreign threads have no ring or
+	// deque to use, so stop here instead of indexing past [workers]
+	if (currWorkerNdx == NOT_A_WORKER)
+	{
+		AthruCore::Utility::AccessLogger()->Log("job system called from a thread outside the pool", "job system message");
+		std::abort();
+	}
+	return currWorkerNdx;
+}
+
+void JobSystem::WorkerLoop(u4Byte workerNdx)
+{
+	currWorkerNdx = workerNdx;
+	u4Byte idleSpins = 0;
+	while (!exiting.load(std::memory_order_acquire))
+	{
+		Job* job = Take(workerNdx);
+		if (job != nullptr)
+		{
+			Execute(job);
+			idleSpins = 0;
+		}
+		else if (idleSpins < IDLE_SPINS)
+		{
+			std::this_thread::yield();
+			idleSpins += 1;
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			numSleeping.fetch_add(1, std::memory_order_seq_cst);
+			wakeSignal.wait(lock, [this]() { return (numQueued.load(std::memory_order_seq_cst) > 0) || exiting.load(); });
+			numSleeping.fetch_sub(1, std::memory_order_relaxed);
+			idleSpins = 0;
+		}
+	}
+}
+
+// Push constructions for this class through Athru's custom allocator
+void* JobSystem::operator new(size_t size)
+{
+	StackAllocator* allocator = AthruCore::Utility::AccessMemory();
+	return allocator->AlignedAlloc(size, (uByte)std::alignment_of<JobSystem>(), false);
+}
+
+// We aren't expecting to use [delete], so overload it to do nothing
+void JobSystem::operator delete(void* target)
+{
+	return;
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <new>
+#include <type_traits>
+#include "Typedefs.h"
+#include "AppGlobals.h"
+
+// Fixed-size work-stealing job pool
+// Every worker (the thread that created the pool counts as worker zero) owns a
+// Chase-Lev deque; workers push + pop their own jobs from the bottom of their
+// deque (LIFO, so recently-spawned work stays in cache) and steal from the top
+// of other workers' deques when they run dry
+// Jobs live in per-worker rings instead of the heap (Athru's allocator can't
+// free anything), so creating/finishing jobs never allocates
+// Jobs can only be created/run/waited on from pool workers (the main thread +
+// any running job); other threads (e.g. the audio device thread) should keep
+// their own synchronization (the pool logs + aborts if they try)
+class JobSystem
+{
+	public:
+		// Unit of work; fields are internal to [JobSystem], callers should only ever
+		// hold [Job] pointers
+		struct alignas(64) Job
+		{
+			void (*fn)(JobSystem& jobs, Job* job, const void* payload);
+			Job* parent;
+			std::atomic<s4Byte> unfinished; // One for [this] + one for each unfinished child
+			std::atomic<s4Byte> pendingDeps; // One for [Run(...)] + one for each unfinished prerequisite
+			u4Byte numContinuations;
+			bool submitted;
+			Job* continuations[JobStuff::MAX_JOB_CONTINUATIONS];
+			alignas(16) uByte payload[64];
+		};
+		static constexpr u4Byte PAYLOAD_BYTES = sizeof(Job::payload);
+
+		JobSystem();
+		~JobSystem();
+
+		// Create a job calling [fn()]; jobs don't run until they're passed to
+		// [Run(...)]
+		// Jobs created with a [parent] hold it open, so waiting on the parent also
+		// waits on them
+		// [fn] is copied into the job, so it needs to be small + trivially
+		// copyable/destructible (lambdas capturing a few pointers/references/values
+		// are fine)
+		template<typename fnType>
+		Job* Create(const fnType& fn, Job* parent = nullptr)
+		{
+			static_assert(sizeof(fnType) <= PAYLOAD_BYTES, "Job functions must fit inside [JobSystem::PAYLOAD_BYTES]");
+			static_assert(std::is_trivially_copyable<fnType>::value && std::is_trivially_destructible<fnType>::value,
+						  "Job functions are copied bytewise + never destroyed");
+			Job* job = Allocate(&CallFn<fnType>, parent);
+			new (job->payload) fnType(fn);
+			return job;
+		}
+
+		// Stop [job] from starting until [prereq] (+ all its children) have finished
+		// Dependencies have to be declared before [prereq] is passed to [Run(...)],
+		// and each job supports up to [JobStuff::MAX_JOB_CONTINUATIONS] dependants
+		void Depend(Job* job, Job* prereq);
+
+		// Submit [job]; it starts as soon as its prerequisites are finished
+		void Run(Job* job);
+
+		// Check whether [job] (+ all its children) have finished
+		bool Finished(const Job* job) const;
+
+		// Block until [job] (+ all its children) have finished, running other jobs
+		// in the meantime
+		// Job slots are recycled, so [job] should be waited on reasonably soon after
+		// it's created (before its worker creates another [JobStuff::JOBS_PER_WORKER] jobs)
+		void Wait(const Job* job);
+
+		// Submit [fn] as a background job; background jobs go through a shared
+		// queue that only pool threads take from (never worker zero, unless it's
+		// the only worker), so long-running work submitted from the main thread
+		// can't end up running inside one of its [Wait(...)]s
+		// Background jobs can't be waited on directly (their slots may be
+		// recycled long before anyone checks on them); track completion inside
+		// [fn] + wait on that with [WaitUntil(...)] instead
+		template<typename fnType>
+		void RunBackground(const fnType& fn)
+		{
+			Job* job = Create(fn);
+			job->submitted = true;
+			PushBackground(job);
+		}
+
+		// Block until [done()] returns true, running other jobs in the meantime
+		template<typename fnType>
+		void WaitUntil(const fnType& done)
+		{
+			const u4Byte workerNdx = CurrWorker();
+			while (!done())
+			{
+				Help(workerNdx);
+			}
+		}
+
+		// Call [fn(rangeBegin, rangeEnd)] over [begin, end) in sub-ranges of at most
+		// [grain] elements, then wait for every sub-range to finish
+		// Ranges are split recursively, so idle workers steal big halves first
+		template<typename fnType>
+		void ParallelFor(u4Byte begin, u4Byte end, u4Byte grain, const fnType& fn)
+		{
+			if (begin >= end) { return; }
+			Job* root = Allocate(&RunRange<fnType>, nullptr);
+			new (root->payload) RangeJob<fnType>{ begin, end, (grain > 0) ? grain : 1, &fn };
+			Run(root);
+			Wait(root);
+		}
+
+		// Number of workers in the pool (including the main thread)
+		u4Byte NumWorkers() const;
+
+		// Scaling test; runs a fixed compute-heavy loop over [numItems] items serially,
+		// then with [ParallelFor(...)] split across 1, 2, 4...[NumWorkers()] sub-ranges,
+		// + measures the overhead of empty jobs
+		// Logs each timing + returns the speedup of the full pool over serial execution
+		float Benchmark(u4Byte numItems);
+
+		// Overload the standard allocation/de-allocation operators
+		void* operator new(size_t size);
+		void operator delete(void* target);
+
+	private:
+		// Chase-Lev work-stealing deque (fixed capacity); [Push(...)]/[Pop()] are
+		// owner-only, [Steal()] is safe from any thread
+		class WorkDeque
+		{
+			public:
+				void Init(std::atomic<Job*>* storage, u4Byte capacity);
+				void Push(Job* job);
+				Job* Pop();
+				Job* Steal();
+
+			private:
+				alignas(64) std::atomic<s8Byte> top;
+				alignas(64) std::atomic<s8Byte> bottom;
+				std::atomic<Job*>* buffer;
+				u4Byte mask;
+		};
+
+		// Per-worker state; padded out to whole cache lines so workers don't
+		// false-share
+		struct alignas(64) Worker
+		{
+			WorkDeque deque;
+			Job* jobs; // Ring of [JobStuff::JOBS_PER_WORKER] job slots
+			u4Byte nextJob;
+			u4Byte rng; // Victim selection while stealing
+		};
+
+		// [ParallelFor(...)] sub-range
+		template<typename fnType>
+		struct RangeJob
+		{
+			u4Byte begin;
+			u4Byte end;
+			u4Byte grain;
+			const fnType* fn;
+		};
+
+		template<typename fnType>
+		static void CallFn(JobSystem& jobs, Job* job, const void* payload)
+		{
+			(*(const fnType*)payload)();
+		}
+
+		// Split off the upper half of the range as a child job until the remainder
+		// fits in a single grain, then process the remainder here
+		template<typename fnType>
+		static void RunRange(JobSystem& jobs, Job* job, const void* payload)
+		{
+			RangeJob<fnType> range = *(const RangeJob<fnType>*)payload;
+			while ((range.end - range.begin) > range.grain)
+			{
+				const u4Byte mid = range.begin + ((range.end - range.begin) / 2);
+				Job* half = jobs.Allocate(&RunRange<fnType>, job);
+				new (half->payload) RangeJob<fnType>{ mid, range.end, range.grain, range.fn };
+				jobs.Run(half);
+				range.end = mid;
+			}
+			(*range.fn)(range.begin, range.end);
+		}
+
+		// Claim the next free job slot from the calling worker's ring, running
+		// queued jobs until one frees up if every slot is live
+		Job* Allocate(void (*fn)(JobSystem&, Job*, const void*), Job* parent);
+
+		// Drop one prerequisite (or the submission) from [job]; queues the job
+		// once nothing else is holding it back
+		void Release(Job* job);
+
+		// Queue [job] on the calling worker + wake a sleeping worker to help out
+		void Push(Job* job);
+
+		// Queue [job] on the shared background queue + wake a sleeping worker to
+		// run it; runs [job] immediately if the queue is full
+		void PushBackground(Job* job);
+
+		// Wake a sleeping worker, if there are any
+		void Wake();
+
+		// Fetch work for the given worker (own deque first, then other workers',
+		// then the background queue)
+		Job* Take(u4Byte workerNdx);
+
+		// Run one job for the given worker, or yield if there's nothing to do
+		void Help(u4Byte workerNdx);
+
+		// Run [job], then mark it finished
+		void Execute(Job* job);
+
+		// Drop one unfinished item from [job]; when that empties it, release
+		// dependants + forward completion to the job's parent
+		void Finish(Job* job);
+
+		// Index of the calling worker
+		u4Byte CurrWorker() const;
+
+		// Main loop for pool threads
+		void WorkerLoop(u4Byte workerNdx);
+
+		Worker* workers;
+		u4Byte numWorkers;
+
+		// Background queue (see [RunBackground(...)]); a locked ring, since
+		// background jobs are rare + long-running
+		// [numBackground] lets idle workers skip the lock while it's empty
+		Job** bgJobs;
+		u4Byte bgHead;
+		u4Byte bgTail;
+		std::atomic<u4Byte> numBackground;
+		std::mutex bgMutex;
+		std::thread threads[JobStuff::MAX_WORKERS - 1];
+
+		// Sleep/wake state; workers sleep after spinning for a while without
+		// finding any work, and [Push(...)] wakes them while jobs are waiting
+		std::atomic<s4Byte> numQueued;
+		std::atomic<s4Byte> numSleeping;
+		std::atomic<bool> exiting;
+		std::mutex sleepMutex;
+		std::condition_variable wakeSignal;
+};
@@ -5,6 +5,44 @@
 // define it here
 char Logger::ConsolePrinter::outputString[8191];
 
+void Logger::LogMem(const address& stackStart)
+{
+	AsyncIO* io = AthruCore::Utility::AccessIO();
+	if (io != nullptr)
+	{
+		io->Write("athru.mem", stackStart, MemoryStuff::STARTING_HEAP_ALLOC, IO_WRITE_MODES::OVERWRITE, false);
+	}
+	else
+	{
+		std::ofstream ostrm("athru.mem", std::ios::out | std::ios_base::binary);
+		ostrm.write((const char*)stackStart, MemoryStuff::STARTING_HEAP_ALLOC);
+		ostrm.close();
+	}
+}
+
+void Logger::FlushFileText(std::unique_lock<std::mutex>& held, bool overwrite)
+{
+	const std::string text = logFileStreamPttr->str();
+	logFileStreamPttr->str("");
+	held.unlock();
+
+	// Text is copied into the service's staging space, so [text] can go out
+	// of scope straight away; very large messages are written directly
+	AsyncIO* io = AthruCore::Utility::AccessIO();
+	if (io != nullptr && text.size() <= IOStuff::IO_STAGING_BYTES)
+	{
+		io->Write(logFilePath, text.data(), text.size(),
+				  overwrite ? IO_WRITE_MODES::OVERWRITE : IO_WRITE_MODES::APPEND, true);
+	}
+	else
+	{
+		std::fstream file;
+		file.open(logFilePath, overwrite ? std::fstream::out : (std::fstream::out | std::fstream::app));
+		file << text;
+		file.close();
+	}
+}
+
 // Push constructions for this class through Athru's custom allocator
 void* Logger::operator new(size_t size)
 {
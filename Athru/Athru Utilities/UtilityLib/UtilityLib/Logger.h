@@ -3,6 +3,7 @@
 #include <sstream>
 #include <fstream>
 #include <tuple>
+#include <mutex>
 #include "Typedefs.h"
 #include "leakChecker.h"
 #include "AppGlobals.h"
@@ -17,8 +18,9 @@ class Logger
 
 			// Streams ONLY work if they're allocated on an external heap;
 			// ask SO what the fruit is going on there
-			logFileStreamPttr = new std::fstream();
-			logFileStreamPttr->open(logFilePath, std::ios::out);
+			// File output is buffered here + handed to the I/O service
+			// after each message, so logging never blocks on the disk
+			logFileStreamPttr = new std::stringstream();
 			*logFileStreamPttr << "Note:" << '\n';
 			*logFileStreamPttr << "Unions + structs/classes are too complicated to easily log members," << '\n';
 			*logFileStreamPttr << "and it's impossible to easily log the names of enum values without" << '\n';
@@ -30,7 +32,8 @@ class Logger
 			*logFileStreamPttr << "- Athru will only ever log the address, type-ID, and numeric value of enumerations;" << '\n';
 			*logFileStreamPttr << "  enum names must be stringified before being passed to the logger" << '\n' << '\n';
 			*logFileStreamPttr << "Thank you for reading :)" << '\n' << '\n';
-			logFileStreamPttr->close();
+			std::unique_lock<std::mutex> held(streamLock);
+			FlushFileText(held, true);
 
 			printStreamPttr = new std::ostringstream();
 			*printStreamPttr << "Note:" << '\n';
@@ -117,10 +120,10 @@ class Logger
 									!memFuncPttrData &&
 									 enumData;
 
+			std::unique_lock<std::mutex> held(streamLock);
 			auto streams = std::make_tuple(printStreamPttr, logFileStreamPttr);
 			auto stream = std::get<(int)dest>(streams);
 			constexpr bool loggingToFile = std::is_same<decltype(stream), decltype(logFileStreamPttr)>::value;
-			if constexpr (loggingToFile) { logFileStreamPttr->open(logFilePath, std::fstream::out | std::fstream::app); }
 			if constexpr(isArith)
 			{ *stream << "logging " << typeid(loggableType).name() << " with value " << dataLogging << '\n'; }
 			else if constexpr (isUnion)
@@ -157,7 +160,7 @@ class Logger
 			{ *stream << "Sorry! Athru is only able to log objects with arithmetic, union, struct/class, function-pointer, or enum type" << '\n'; }
 			*stream << "labelled as: " << label << '\n' << '\n';
 			if constexpr (!loggingToFile) { ConsolePrinter::OutputText(stream); }
-			else if constexpr (loggingToFile) { logFileStreamPttr->close(); }
+			else if constexpr (loggingToFile) { FlushFileText(held, false); }
 		}
 
 		// Logging for references-to-types (i.e. any case where [dataLogging] *is* a
@@ -165,10 +168,10 @@ class Logger
 		template<DESTINATIONS dest = DESTINATIONS::CONSOLE, typename loggableType>
 		void Log(loggableType* dataLogging, const char* label = "(unlabelled)")
 		{
+			std::unique_lock<std::mutex> held(streamLock);
 			auto streams = std::make_tuple(printStreamPttr, logFileStreamPttr);
 			auto stream = std::get<(int)dest>(streams);
 			constexpr bool loggingToFile = std::is_same<decltype(stream), decltype(logFileStreamPttr)>::value;
-			if (loggingToFile) { logFileStreamPttr->open(logFilePath, std::fstream::out | std::fstream::app); }
 			if (dataLogging != nullptr)
 			{
 				constexpr bool isCString = (std::is_same<loggableType, const char>{});
@@ -243,7 +246,7 @@ class Logger
 			{ *stream << "Unknown data stored at the null address (0x0000000000000000 in 64-bit, 0x00000000 in 32-bit)" << '\n'; }
 			*stream << "labelled as: " << label << '\n' << '\n';
 			if constexpr (!loggingToFile) { ConsolePrinter::OutputText(stream); }
-			else if constexpr (loggingToFile) { logFileStreamPttr->close(); }
+			else if constexpr (loggingToFile) { FlushFileText(held, false); }
 		}
 
 		// Logging non-pointer arrays
@@ -270,12 +273,9 @@ class Logger
 
 		// Log a memory dump; can be useful for occupancy debugging (essentially, how densely packed is our memory? Can we trim
 		// sub-allocations to support the same amount of data with less memory overhead?)
-		void LogMem(const address& stackStart)
-		{
-			std::ofstream ostrm("athru.mem", std::ios::out | std::ios_base::binary);
-			ostrm.write((const char*)stackStart, MemoryStuff::STARTING_HEAP_ALLOC); // Might be able to replace this with a [memcpy]
-			ostrm.close();
-		}
+		// Dumps are written straight out of the heap without a copy, so
+		// they capture memory as it is when the write lands
+		void LogMem(const address& stackStart);
 
 		// Overload the standard allocation/de-allocation operators
 		void* operator new(size_t size);
@@ -296,7 +296,19 @@ class Logger
 				static char outputString[8191];
 		};
 
+		// Hand buffered file output to the I/O service (or write it
+		// directly if the service isn't available yet), then clear the
+		// buffer
+		// Called with [streamLock] held; releases it before writing, since I/O
+		// callbacks can log too
+		void FlushFileText(std::unique_lock<std::mutex>& held, bool overwrite);
+
 		char* logFilePath;
-		std::fstream* logFileStreamPttr;
+		std::stringstream* logFileStreamPttr;
 		std::ostringstream* printStreamPttr;
+
+		// Messages can arrive from any thread (e.g. job workers + I/O completion
+		// callbacks), so the streams + [ConsolePrinter]'s shared buffer are only
+		// touched with this held
+		std::mutex streamLock;
 };
\ No newline at end of file
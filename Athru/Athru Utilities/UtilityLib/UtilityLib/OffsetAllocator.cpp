@@ -0,0 +1,406 @@
+#include <assert.h>
+#include <string.h>
+#include "UtilityServiceCentre.h"
+#include "OffsetAllocator.h"
+#include "BenchUtils.h"
+#include <chrono>
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+OffsetAllocator::OffsetAllocator(u4Byte size, u4Byte maxAllocs) :
+	size(size),
+	maxAllocs(maxAllocs),
+	numAllocs(0),
+	freeStorage(0),
+	numFreeRegions(0),
+	usedBinsTop(0)
+{
+	assert(size > 0 && size != NO_SPACE);
+	assert(maxAllocs > 0);
+	for (u4Byte i = 0; i < NUM_TOP_BINS; i += 1) { usedBins[i] = 0; }
+	for (u4Byte i = 0; i < NUM_LEAF_BINS; i += 1) { binIndices[i] = UNUSED; }
+
+	// Free regions never sit next to each other (they merge), so there's at most one
+	// more free region than there are allocations
+	const u4Byte maxNodes = (maxAllocs * 2) + 1;
+	StackAllocator* allocator = AthruCore::Utility::AccessMemory();
+	nodes = (Node*)allocator->AlignedAlloc(sizeof(Node) * maxNodes, (uByte)std::alignment_of<Node>(), false);
+	freeNodes = (u4Byte*)allocator->AlignedAlloc(sizeof(u4Byte) * maxNodes, (uByte)std::alignment_of<u4Byte>(), false);
+
+	// Stack node slots so the lowest ones are popped first
+	for (u4Byte i = 0; i < maxNodes; i += 1) { freeNodes[i] = maxNodes - i - 1; }
+	freeOffset = maxNodes;
+
+	// Start with one region covering the whole address space
+	InsertNodeIntoBin(size, 0);
+}
+
+OffsetAllocator::Allocation OffsetAllocator::Allocate(u4Byte size)
+{
+	assert(size > 0);
+	Allocation alloc;
+	if (numAllocs == maxAllocs) { return alloc; }
+
+	// Find the smallest bin guaranteed to fit [size]; look through the leaf bins
+	// sharing its top-level bin first, then fall back to the next non-empty top-level bin
+	const u4Byte minBin = BinRoundUp(size);
+	const u4Byte minTopBin = minBin >> TOP_BINS_INDEX_SHIFT;
+	const u4Byte minLeafBin = minBin & LEAF_BINS_INDEX_MASK;
+	u4Byte topBin = minTopBin;
+	u4Byte leafBin = UNUSED;
+	if (usedBinsTop & (1u << topBin)) { leafBin = LowestBitFrom(usedBins[topBin], minLeafBin); }
+	if (leafBin == UNUSED && (minTopBin + 1) < NUM_TOP_BINS)
+	{
+		topBin = LowestBitFrom(usedBinsTop, minTopBin + 1);
+		if (topBin != UNUSED) { leafBin = LowestBit(usedBins[topBin]); } // Any leaf bin in a larger top-level bin fits
+	}
+
+	u4Byte nodeIndex = UNUSED;
+	if (leafBin != UNUSED)
+	{
+		nodeIndex = binIndices[(topBin << TOP_BINS_INDEX_SHIFT) | leafBin];
+	}
+	else
+	{
+		// Nothing's guaranteed to fit, but regions in the bin [size] rounds down into
+		// might still be large enough; walk that bin before giving up (keeps requests
+		// that fill a whole heap, or whatever's left of it, from failing)
+		u4Byte candidate = binIndices[BinRoundDown(size)];
+		while (candidate != UNUSED && nodes[candidate].dataSize < size) { candidate = nodes[candidate].binListNext; }
+		if (candidate == UNUSED) { return alloc; }
+		nodeIndex = candidate;
+	}
+
+	// Take the region over for the allocation
+	Node& node = nodes[nodeIndex];
+	const u4Byte nodeTotalSize = node.dataSize;
+	RemoveNodeFromBin(nodeIndex);
+	node.dataSize = size;
+	node.used = true;
+
+	// Return whatever the allocation didn't need to the allocator, as a new region
+	// directly after the allocation
+	const u4Byte remainder = nodeTotalSize - size;
+	if (remainder > 0)
+	{
+		const u4Byte newNodeIndex = InsertNodeIntoBin(remainder, node.dataOffset + size);
+		if (node.neighbourNext != UNUSED) { nodes[node.neighbourNext].neighbourPrev = newNodeIndex; }
+		nodes[newNodeIndex].neighbourPrev = nodeIndex;
+		nodes[newNodeIndex].neighbourNext = node.neighbourNext;
+		node.neighbourNext = newNodeIndex;
+	}
+
+	numAllocs += 1;
+	alloc.offset = node.dataOffset;
+	alloc.node = nodeIndex;
+	return alloc;
+}
+
+void OffsetAllocator::Free(Allocation alloc)
+{
+	assert(alloc.node != NO_SPACE);
+	const u4Byte nodeIndex = alloc.node;
+	Node& node = nodes[nodeIndex];
+	assert(node.used); // Double-free otherwise
+
+	// Merge with free neighbours
+	u4Byte offset = node.dataOffset;
+	u4Byte size = node.dataSize;
+	if (node.neighbourPrev != UNUSED && !nodes[node.neighbourPrev].used)
+	{
+		const Node& prevNode = nodes[node.neighbourPrev];
+		offset = prevNode.dataOffset;
+		size += prevNode.dataSize;
+		assert(prevNode.neighbourNext == nodeIndex);
+		const u4Byte prevIndex = node.neighbourPrev;
+		node.neighbourPrev = prevNode.neighbourPrev;
+		RemoveNodeFromBin(prevIndex);
+		freeNodes[freeOffset] = prevIndex;
+		freeOffset += 1;
+	}
+	if (node.neighbourNext != UNUSED && !nodes[node.neighbourNext].used)
+	{
+		const Node& nextNode = nodes[node.neighbourNext];
+		size += nextNode.dataSize;
+		assert(nextNode.neighbourPrev == nodeIndex);
+		const u4Byte nextIndex = node.neighbourNext;
+		node.neighbourNext = nextNode.neighbourNext;
+		RemoveNodeFromBin(nextIndex);
+		freeNodes[freeOffset] = nextIndex;
+		freeOffset += 1;
+	}
+	const u4Byte neighbourPrev = node.neighbourPrev;
+	const u4Byte neighbourNext = node.neighbourNext;
+
+	// Recycle the allocation's node, then file the merged region
+	freeNodes[freeOffset] = nodeIndex;
+	freeOffset += 1;
+	numAllocs -= 1;
+	const u4Byte mergedIndex = InsertNodeIntoBin(size, offset);
+	nodes[mergedIndex].neighbourPrev = neighbourPrev;
+	nodes[mergedIndex].neighbourNext = neighbourNext;
+	if (neighbourPrev != UNUSED) { nodes[neighbourPrev].neighbourNext = mergedIndex; }
+	if (neighbourNext != UNUSED) { nodes[neighbourNext].neighbourPrev = mergedIndex; }
+}
+
+u4Byte OffsetAllocator::AllocationSize(Allocation alloc) const
+{
+	if (alloc.node == NO_SPACE) { return 0; }
+	return nodes[alloc.node].dataSize;
+}
+
+OffsetAllocator::StorageReport OffsetAllocator::Stats() const
+{
+	StorageReport report;
+	report.totalFree = freeStorage;
+	report.numFreeRegions = numFreeRegions;
+	report.numAllocs = numAllocs;
+	report.largestFree = 0;
+	if (usedBinsTop != 0)
+	{
+		// Regions round down into bins, so the largest region lives in the largest
+		// non-empty bin, but might not be the first one there
+		const u4Byte topBin = HighestBit(usedBinsTop);
+		const u4Byte leafBin = HighestBit(usedBins[topBin]);
+		u4Byte nodeIndex = binIndices[(topBin << TOP_BINS_INDEX_SHIFT) | leafBin];
+		while (nodeIndex != UNUSED)
+		{
+			if (nodes[nodeIndex].dataSize > report.largestFree) { report.largestFree = nodes[nodeIndex].dataSize; }
+			nodeIndex = nodes[nodeIndex].binListNext;
+		}
+	}
+	report.fragmentation = (freeStorage > 0) ? 1.0f - ((float)report.largestFree / (float)freeStorage) : 0.0f;
+	return report;
+}
+
+float OffsetAllocator::Benchmark(u4Byte numOps)
+{
+	constexpr u4Byte spaceSize = 1 << 18;
+	constexpr u4Byte maxLive = 4096;
+
+	// Sizes skew small (like descriptors + small buffers) with the occasional
+	// large request, and allocations outnumber frees two-to-one so the space
+	// fills up + the allocator has to work through fragmented free lists
+	BenchRand next;
+	auto nextSize = [&next]()
+	{
+		const u4Byte scale = next() % 12;
+		return (next() & ((1u << scale) - 1)) + 1;
+	};
+
+	StackAllocator* memory = AthruCore::Utility::AccessMemory();
+	Allocation* live = (Allocation*)memory->AlignedAlloc(sizeof(Allocation) * maxLive, (uByte)std::alignment_of<Allocation>(), false);
+	uByte* owners = (uByte*)memory->AlignedAlloc(spaceSize, 1, false); // Shadow model; one byte per unit, set while allocated
+
+	// Timed pass; random allocations/frees with no checking, so only the allocator is measured
+	OffsetAllocator timedAlloc(spaceSize, maxLive);
+	u4Byte numLive = 0;
+	const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	for (u4Byte i = 0; i < numOps; i += 1)
+	{
+		if (numLive > 0 && ((next() % 3) == 0 || numLive == maxLive))
+		{
+			const u4Byte victim = next() % numLive;
+			timedAlloc.Free(live[victim]);
+			numLive -= 1;
+			live[victim] = live[numLive];
+		}
+		else
+		{
+			const Allocation alloc = timedAlloc.Allocate(nextSize());
+			if (alloc.offset != NO_SPACE) { live[numLive] = alloc; numLive += 1; }
+		}
+	}
+	const std::chrono::steady_clock::duration opTime = std::chrono::steady_clock::now() - t0;
+
+	// Checked pass; same pattern of requests, verified against the shadow model
+	OffsetAllocator checkedAlloc(spaceSize, maxLive);
+	memset(owners, 0, spaceSize);
+	next = BenchRand();
+	numLive = 0;
+	bool valid = true;
+	float fragmentationSum = 0.0f;
+	float fragmentationMax = 0.0f;
+	u4Byte numFailed = 0;
+	for (u4Byte i = 0; i < numOps && valid; i += 1)
+	{
+		if (numLive > 0 && ((next() % 3) == 0 || numLive == maxLive))
+		{
+			const u4Byte victim = next() % numLive;
+			const u4Byte offset = live[victim].offset;
+			const u4Byte allocSize = checkedAlloc.AllocationSize(live[victim]);
+			for (u4Byte j = 0; j < allocSize; j += 1) { owners[offset + j] = 0; }
+			checkedAlloc.Free(live[victim]);
+			numLive -= 1;
+			live[victim] = live[numLive];
+		}
+		else
+		{
+			const u4Byte allocSize = nextSize();
+			const Allocation alloc = checkedAlloc.Allocate(allocSize);
+			if (alloc.offset == NO_SPACE)
+			{
+				// Failing is only allowed when no free region is large enough for the bin
+				// [allocSize] rounds up into
+				numFailed += 1;
+				valid = checkedAlloc.Stats().largestFree < BinSize(BinRoundUp(allocSize)) || numLive == maxLive;
+				continue;
+			}
+			valid = (alloc.offset + allocSize) <= spaceSize && checkedAlloc.AllocationSize(alloc) == allocSize;
+			for (u4Byte j = 0; j < allocSize && valid; j += 1)
+			{
+				valid = owners[alloc.offset + j] == 0;
+				owners[alloc.offset + j] = 1;
+			}
+			live[numLive] = alloc;
+			numLive += 1;
+		}
+
+		const StorageReport report = checkedAlloc.Stats();
+		valid = valid && report.numAllocs == numLive && report.largestFree <= report.totalFree;
+		fragmentationSum += report.fragmentation;
+		if (report.fragmentation > fragmentationMax) { fragmentationMax = report.fragmentation; }
+	}
+
+	// Everything should merge back into one region once all allocations are freed
+	for (u4Byte i = 0; i < numLive; i += 1) { checkedAlloc.Free(live[i]); }
+	const StorageReport emptyReport = checkedAlloc.Stats();
+	valid = valid && emptyReport.totalFree == spaceSize && emptyReport.numFreeRegions == 1 && emptyReport.largestFree == spaceSize;
+
+	const float nsPerOp = (float)((double)opTime.count() * TimeStuff::nsToSecs * 1e9 / numOps);
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	logger->Log(nsPerOp, "Offset allocator benchmark, time per allocation/free (nanoseconds)");
+	logger->Log(fragmentationSum / numOps, "Offset allocator benchmark, mean fragmentation");
+	logger->Log(fragmentationMax, "Offset allocator benchmark, worst fragmentation");
+	logger->Log(numFailed, "Offset allocator benchmark, failed allocations");
+	return BenchUtils::ReportChecks(valid, "Offset allocator benchmark", nsPerOp);
+}
+
+u4Byte OffsetAllocator::BinRoundUp(u4Byte size)
+{
+	// Sizes below [BINS_PER_LEAF] are denormals with exact bins
+	if (size < BINS_PER_LEAF) { return size; }
+
+	// Normalized sizes keep three bits below the highest set bit as the mantissa,
+	// rounding up if any lower bits are set (a carry bumps the exponent, which is
+	// what we want)
+	const u4Byte highestBit = HighestBit(size);
+	const u4Byte mantissaStartBit = highestBit - TOP_BINS_INDEX_SHIFT;
+	const u4Byte exponent = mantissaStartBit + 1;
+	u4Byte mantissa = (size >> mantissaStartBit) & LEAF_BINS_INDEX_MASK;
+	const u4Byte lowBitsMask = (1u << mantissaStartBit) - 1;
+	if ((size & lowBitsMask) != 0) { mantissa += 1; }
+	return (exponent << TOP_BINS_INDEX_SHIFT) + mantissa;
+}
+
+u4Byte OffsetAllocator::BinRoundDown(u4Byte size)
+{
+	if (size < BINS_PER_LEAF) { return size; }
+	const u4Byte highestBit = HighestBit(size);
+	const u4Byte mantissaStartBit = highestBit - TOP_BINS_INDEX_SHIFT;
+	const u4Byte exponent = mantissaStartBit + 1;
+	const u4Byte mantissa = (size >> mantissaStartBit) & LEAF_BINS_INDEX_MASK;
+	return (exponent << TOP_BINS_INDEX_SHIFT) | mantissa;
+}
+
+u4Byte OffsetAllocator::BinSize(u4Byte bin)
+{
+	const u4Byte exponent = bin >> TOP_BINS_INDEX_SHIFT;
+	const u4Byte mantissa = bin & LEAF_BINS_INDEX_MASK;
+	if (exponent == 0) { return mantissa; }
+	return (mantissa | BINS_PER_LEAF) << (exponent - 1);
+}
+
+u4Byte OffsetAllocator::LowestBit(u4Byte mask)
+{
+	#ifdef _MSC_VER
+		unsigned long bit;
+		_BitScanForward(&bit, mask);
+		return bit;
+	#else
+		return (u4Byte)__builtin_ctz(mask);
+	#endif
+}
+
+u4Byte OffsetAllocator::HighestBit(u4Byte mask)
+{
+	#ifdef _MSC_VER
+		unsigned long bit;
+		_BitScanReverse(&bit, mask);
+		return bit;
+	#else
+		return 31 - (u4Byte)__builtin_clz(mask);
+	#endif
+}
+
+u4Byte OffsetAllocator::LowestBitFrom(u4Byte mask, u4Byte startBit)
+{
+	const u4Byte maskAfter = mask & ~((1u << startBit) - 1);
+	return (maskAfter != 0) ? LowestBit(maskAfter) : UNUSED;
+}
+
+u4Byte OffsetAllocator::InsertNodeIntoBin(u4Byte size, u4Byte dataOffset)
+{
+	// Mark the bin as non-empty
+	const u4Byte bin = BinRoundDown(size);
+	const u4Byte topBin = bin >> TOP_BINS_INDEX_SHIFT;
+	const u4Byte leafBin = bin & LEAF_BINS_INDEX_MASK;
+	if (binIndices[bin] == UNUSED)
+	{
+		usedBins[topBin] |= (uByte)(1u << leafBin);
+		usedBinsTop |= 1u << topBin;
+	}
+
+	// Push a fresh node onto the front of the bin
+	assert(freeOffset > 0);
+	freeOffset -= 1;
+	const u4Byte nodeIndex = freeNodes[freeOffset];
+	const u4Byte headIndex = binIndices[bin];
+	nodes[nodeIndex] = { dataOffset, size, UNUSED, headIndex, UNUSED, UNUSED, false };
+	if (headIndex != UNUSED) { nodes[headIndex].binListPrev = nodeIndex; }
+	binIndices[bin] = nodeIndex;
+	freeStorage += size;
+	numFreeRegions += 1;
+	return nodeIndex;
+}
+
+void OffsetAllocator::RemoveNodeFromBin(u4Byte nodeIndex)
+{
+	const Node& node = nodes[nodeIndex];
+	if (node.binListPrev != UNUSED)
+	{
+		// Easy case; unlink from the middle/end of the bin
+		nodes[node.binListPrev].binListNext = node.binListNext;
+		if (node.binListNext != UNUSED) { nodes[node.binListNext].binListPrev = node.binListPrev; }
+	}
+	else
+	{
+		// Front of the bin; update the bin's head, + clear its bits if it's now empty
+		const u4Byte bin = BinRoundDown(node.dataSize);
+		const u4Byte topBin = bin >> TOP_BINS_INDEX_SHIFT;
+		const u4Byte leafBin = bin & LEAF_BINS_INDEX_MASK;
+		binIndices[bin] = node.binListNext;
+		if (node.binListNext != UNUSED) { nodes[node.binListNext].binListPrev = UNUSED; }
+		if (binIndices[bin] == UNUSED)
+		{
+			usedBins[topBin] &= ~(1u << leafBin);
+			if (usedBins[topBin] == 0) { usedBinsTop &= ~(1u << topBin); }
+		}
+	}
+	freeStorage -= node.dataSize;
+	numFreeRegions -= 1;
+}
+
+// Push constructions for this class through Athru's custom allocator
+void* OffsetAllocator::operator new(size_t size)
+{
+	StackAllocator* allocator = AthruCore::Utility::AccessMemory();
+	return allocator->AlignedAlloc(size, (uByte)std::alignment_of<OffsetAllocator>(), false);
+}
+
+// We aren't expecting to use [delete], so overload it to do nothing
+void OffsetAllocator::operator delete(void* target)
+{
+	return;
+}
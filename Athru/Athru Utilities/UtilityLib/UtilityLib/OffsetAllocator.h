@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Typedefs.h"
+
+// General-purpose offset allocator
+// Hands out ranges of an abstract address space (bytes, 64KB heap pages,
+// descriptor slots...) + never touches the memory itself, so the same core
+// can manage GPU heaps, descriptor heaps, or anything else addressed by
+// offset, and can be fuzzed/benchmarked entirely on the CPU
+// Free ranges are filed into 256 size-class bins (a two-level segregated fit,
+// like TLSF); bin sizes follow a tiny floating-point format (five exponent
+// bits, three mantissa bits), so every bin is within 12.5% of the sizes it
+// holds
+// Allocation + freeing are O(1): two bitmask scans find the smallest
+// non-empty bin that's guaranteed to fit, and freed ranges merge with free
+// neighbours immediately (requests with no guaranteed fit also check the bin
+// just below before failing, which is the only non-constant-time path)
+// Offsets come out of a fresh allocator in order (each allocation starts
+// where the last one ended) until something is freed
+class OffsetAllocator
+{
+	public:
+		// Returned for allocations that couldn't be satisfied
+		static constexpr u4Byte NO_SPACE = 0xFFFFFFFF;
+
+		struct Allocation
+		{
+			u4Byte offset = NO_SPACE;
+			u4Byte node = NO_SPACE; // Internal; needed to free the allocation later
+		};
+
+		// Snapshot of free space within the allocator
+		struct StorageReport
+		{
+			u4Byte totalFree;
+			u4Byte largestFree;
+			u4Byte numFreeRegions;
+			u4Byte numAllocs;
+			float fragmentation; // One minus the share of free space held by the largest free region; zero while
+								 // free space is contiguous, near one when it's scattered into many small regions
+		};
+
+		// Manage [size] units of space, with at most [maxAllocs] live allocations
+		// at once
+		OffsetAllocator(u4Byte size, u4Byte maxAllocs);
+		~OffsetAllocator() = default;
+
+		// Allocate [size] units; returns an allocation with offset [NO_SPACE] if
+		// there isn't a large enough free region (or [maxAllocs] allocations are
+		// already live)
+		Allocation Allocate(u4Byte size);
+
+		// Return [alloc]'s range to the allocator
+		void Free(Allocation alloc);
+
+		// Size requested for [alloc]
+		u4Byte AllocationSize(Allocation alloc) const;
+
+		// Summarize free space; O(1) apart from [largestFree], which walks the
+		// largest non-empty bin
+		StorageReport Stats() const;
+
+		// Run [numOps] random allocations/frees against a shadow model of the
+		// address space, checking that live ranges never overlap + that freed
+		// space always merges back together; logs time per operation and the
+		// fragmentation seen along the way
+		// Returns mean nanoseconds per operation, or a negative value if any
+		// check failed
+		static float Benchmark(u4Byte numOps);
+
+		// Overload the standard allocation/de-allocation operators
+		void* operator new(size_t size);
+		void operator delete(void* target);
+
+	private:
+		static constexpr u4Byte NUM_TOP_BINS = 32;
+		static constexpr u4Byte BINS_PER_LEAF = 8;
+		static constexpr u4Byte TOP_BINS_INDEX_SHIFT = 3;
+		static constexpr u4Byte LEAF_BINS_INDEX_MASK = 0x7;
+		static constexpr u4Byte NUM_LEAF_BINS = NUM_TOP_BINS * BINS_PER_LEAF;
+		static constexpr u4Byte UNUSED = 0xFFFFFFFF;
+
+		// Free/allocated regions; free regions are doubly-linked into their
+		// bin, and every region is doubly-linked to its neighbours in the
+		// address space
+		struct Node
+		{
+			u4Byte dataOffset;
+			u4Byte dataSize;
+			u4Byte binListPrev;
+			u4Byte binListNext;
+			u4Byte neighbourPrev;
+			u4Byte neighbourNext;
+			bool used;
+		};
+
+		// Size-class conversions; allocations round up so any region in the
+		// chosen bin fits, free regions round down so their bin never
+		// over-promises
+		static u4Byte BinRoundUp(u4Byte size);
+		static u4Byte BinRoundDown(u4Byte size);
+		static u4Byte BinSize(u4Byte bin);
+
+		// Bit scans (index of the lowest/highest set bit; [mask] must be
+		// non-zero)
+		static u4Byte LowestBit(u4Byte mask);
+		static u4Byte HighestBit(u4Byte mask);
+
+		// Lowest set bit in [mask] at or above [startBit], or [UNUSED]
+		static u4Byte LowestBitFrom(u4Byte mask, u4Byte startBit);
+
+		// File a free region into its bin; returns the region's node
+		u4Byte InsertNodeIntoBin(u4Byte size, u4Byte dataOffset);
+
+		// Unlink a free region from its bin; the caller either reuses the node or
+		// pushes it back onto [freeNodes]
+		void RemoveNodeFromBin(u4Byte nodeIndex);
+
+		u4Byte size;
+		u4Byte maxAllocs;
+		u4Byte numAllocs;
+		u4Byte freeStorage;
+		u4Byte numFreeRegions;
+
+		u4Byte usedBinsTop; // One bit per top-level bin with any free regions
+		uByte usedBins[NUM_TOP_BINS]; // One bit per leaf bin with any free regions
+		u4Byte binIndices[NUM_LEAF_BINS]; // First free region in each bin
+
+		Node* nodes;
+		u4Byte* freeNodes; // Stack of unused node slots
+		u4Byte freeOffset; // Number of slots in [freeNodes]
+};
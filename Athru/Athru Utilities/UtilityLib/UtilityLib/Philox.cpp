@@ -0,0 +1,253 @@
+#include <assert.h>
+#include <chrono>
+#include <vector>
+#include "Philox.h"
+
+// Hashes behind [strmBuilder(...)] ([PhiloInit.hlsli])
+static void xxminstd32(u4Byte i, u4Byte out[4])
+{
+	const u4Byte PRIME32_2 = 2246822519U, PRIME32_3 = 3266489917U;
+	const u4Byte PRIME32_4 = 668265263U, PRIME32_5 = 374761393U;
+	u4Byte h32 = i + PRIME32_5;
+	h32 = PRIME32_4 * ((h32 << 17) | (h32 >> (32 - 17)));
+	h32 = PRIME32_2 * (h32 ^ (h32 >> 15));
+	h32 = PRIME32_3 * (h32 ^ (h32 >> 13));
+	h32 ^= (h32 >> 16);
+	out[0] = h32;
+	out[1] = h32 * 16807U;
+	out[2] = h32 * 48271U;
+	out[3] = h32 * 69621U;
+}
+
+static u4Byte tmhash(u4Byte x)
+{
+	x = ((x >> 16) ^ x) * 0x45d9f3b;
+	x = ((x >> 16) ^ x) * 0x45d9f3b;
+	return (x >> 16) ^ x;
+}
+
+static u4Byte ihashIII(u4Byte i)
+{
+	i = 1103515245U * ((i >> 1U) ^ i);
+	i = 1103515245U * (i ^ (i >> 3U));
+	return i ^ (i >> 16);
+}
+
+void Philox::Seed(u4Byte ndx, Strm& strm)
+{
+	xxminstd32(ndx, strm.ctr);
+	strm.key[0] = ihashIII(ndx);
+	strm.key[1] = tmhash(ndx);
+}
+
+// The eight rounds of [philoxPermu(...)], with products from whichever [mulhilo]
+// the caller supplies
+template<typename Mulhilo>
+static void PermuRounds(Philox::Strm& strm, Mulhilo mulhilo)
+{
+	const u4Byte m0 = 0xCD9E8D57; // Multiplier from the Random123 paper, page 7
+	const u4Byte m1 = 0xD2511F53; // Multiplier from the Random123 paper, page 7
+	u4Byte* ctr = strm.ctr;
+	u4Byte* key = strm.key;
+	for (u4Byte i = 0; i < 8; i += 1)
+	{
+		u4Byte lo0, hi0, lo1, hi1;
+		mulhilo(m0, ctr[0], lo0, hi0);
+		mulhilo(m1, ctr[2], lo1, hi1);
+		const u4Byte next[4] = { hi1 ^ ctr[1] ^ key[0], lo1,
+								 hi0 ^ ctr[2] ^ key[1], lo0 };
+		ctr[0] = next[0];
+		ctr[1] = next[1];
+		ctr[2] = next[2];
+		ctr[3] = next[3];
+		key[0] += 0x9E3779B9;
+		key[1] += 0xBB67AE85;
+	}
+}
+
+void Philox::Permu(Strm& strm)
+{
+	PermuRounds(strm, [](u4Byte a, u4Byte b, u4Byte& lo, u4Byte& hi)
+	{
+		const u8Byte product = (u8Byte)a * b;
+		lo = (u4Byte)product;
+		hi = (u4Byte)(product >> 32);
+	});
+}
+
+void Philox::Seed(u4Byte firstNdx, Strms strms, u4Byte numStrms, CPUFeatures::ISAS isa)
+{
+	assert(CPUFeatures::Supported(isa));
+	switch (isa)
+	{
+		case CPUFeatures::ISAS::SCALAR:
+			for (u4Byte i = 0; i < numStrms; i += 1)
+			{
+				Strm strm;
+				Seed(firstNdx + i, strm);
+				for (u4Byte j = 0; j < 4; j += 1) { strms.ctr[j][i] = strm.ctr[j]; }
+				strms.key[0][i] = strm.key[0];
+				strms.key[1][i] = strm.key[1];
+			}
+			break;
+		case CPUFeatures::ISAS::SSE2:
+			SeedSSE2(firstNdx, strms, numStrms);
+			break;
+		case CPUFeatures::ISAS::AVX2:
+			SeedAVX2(firstNdx, strms, numStrms);
+			break;
+		case CPUFeatures::ISAS::AVX512:
+			SeedAVX512(firstNdx, strms, numStrms);
+			break;
+	}
+}
+
+void Philox::Seed(u4Byte firstNdx, Strms strms, u4Byte numStrms)
+{
+	Seed(firstNdx, strms, numStrms, CPUFeatures::Best());
+}
+
+void Philox::Permu(Strms strms, u4Byte numStrms, u4Byte numPermus, CPUFeatures::ISAS isa)
+{
+	assert(CPUFeatures::Supported(isa));
+	switch (isa)
+	{
+		case CPUFeatures::ISAS::SCALAR:
+			for (u4Byte i = 0; i < numStrms; i += 1)
+			{
+				Strm strm;
+				for (u4Byte j = 0; j < 4; j += 1) { strm.ctr[j] = strms.ctr[j][i]; }
+				strm.key[0] = strms.key[0][i];
+				strm.key[1] = strms.key[1][i];
+				for (u4Byte j = 0; j < numPermus; j += 1) { Permu(strm); }
+				for (u4Byte j = 0; j < 4; j += 1) { strms.ctr[j][i] = strm.ctr[j]; }
+				strms.key[0][i] = strm.key[0];
+				strms.key[1][i] = strm.key[1];
+			}
+			break;
+		case CPUFeatures::ISAS::SSE2:
+			PermuSSE2(strms, numStrms, numPermus);
+			break;
+		case CPUFeatures::ISAS::AVX2:
+			PermuAVX2(strms, numStrms, numPermus);
+			break;
+		case CPUFeatures::ISAS::AVX512:
+			PermuAVX512(strms, numStrms, numPermus);
+			break;
+	}
+}
+
+void Philox::Permu(Strms strms, u4Byte numStrms, u4Byte numPermus)
+{
+	Permu(strms, numStrms, numPermus, CPUFeatures::Best());
+}
+
+// Structure-of-arrays storage for [Valid(...)] + [Benchmark(...)]
+namespace
+{
+	struct StrmStorage
+	{
+		std::vector<u4Byte> data;
+		Philox::Strms strms;
+
+		StrmStorage(u4Byte numStrms) : data((size_t)numStrms * 6)
+		{
+			for (u4Byte i = 0; i < 4; i += 1) { strms.ctr[i] = data.data() + (size_t)numStrms * i; }
+			strms.key[0] = data.data() + (size_t)numStrms * 4;
+			strms.key[1] = data.data() + (size_t)numStrms * 5;
+		}
+	};
+}
+
+bool Philox::Valid(u4Byte numStrms, u4Byte numPermus)
+{
+	// Reference streams, from the shader's 16-bit [mulhilo(...)]
+	std::vector<Strm> refs(numStrms);
+	for (u4Byte i = 0; i < numStrms; i += 1)
+	{
+		Seed(i, refs[i]);
+		for (u4Byte j = 0; j < numPermus; j += 1)
+		{
+			PermuRounds(refs[i], [](u4Byte a, u4Byte b, u4Byte& lo, u4Byte& hi)
+			{
+				lo = a * b;
+				const u4Byte WHALF = 16u;
+				const u4Byte LOMASK = 0xFFFF;
+				const u4Byte ahi = a >> WHALF;
+				const u4Byte alo = a & LOMASK;
+				const u4Byte bhi = b >> WHALF;
+				const u4Byte blo = b & LOMASK;
+				const u4Byte ahbl = ahi * blo;
+				const u4Byte albh = alo * bhi;
+				const u4Byte ahbl_albh = ((ahbl & LOMASK) + (albh & LOMASK));
+				hi = ahi * bhi + (ahbl >> WHALF) + (albh >> WHALF);
+				hi += ahbl_albh >> WHALF;
+				hi += ((lo >> WHALF) < (ahbl_albh & LOMASK)) ? 1u : 0u;
+			});
+		}
+	}
+
+	// Every available kernel (odd stream counts exercise the scalar tails), after
+	// seeding + after iterating
+	StrmStorage storage(numStrms);
+	const CPUFeatures::ISAS isas[] = { CPUFeatures::ISAS::SCALAR, CPUFeatures::ISAS::SSE2,
+									   CPUFeatures::ISAS::AVX2, CPUFeatures::ISAS::AVX512 };
+	for (CPUFeatures::ISAS isa : isas)
+	{
+		if (!CPUFeatures::Supported(isa)) { continue; }
+		Seed(0, storage.strms, numStrms, isa);
+		for (u4Byte i = 0; i < numStrms; i += 1)
+		{
+			Strm strm;
+			Seed(i, strm);
+			for (u4Byte j = 0; j < 4; j += 1)
+			{
+				if (storage.strms.ctr[j][i] != strm.ctr[j]) { return false; }
+			}
+			if (storage.strms.key[0][i] != strm.key[0] || storage.strms.key[1][i] != strm.key[1]) { return false; }
+		}
+
+		Permu(storage.strms, numStrms, numPermus, isa);
+		for (u4Byte i = 0; i < numStrms; i += 1)
+		{
+			for (u4Byte j = 0; j < 4; j += 1)
+			{
+				if (storage.strms.ctr[j][i] != refs[i].ctr[j]) { return false; }
+			}
+			if (storage.strms.key[0][i] != refs[i].key[0] || storage.strms.key[1][i] != refs[i].key[1]) { return false; }
+		}
+	}
+	return true;
+}
+
+u4Byte Philox::Benchmark(u4Byte numStrms, u4Byte numPermus, Timing* timings)
+{
+	// Best of a few passes, to keep one-off stalls (page faults on the first
+	// pass, scheduler noise) out of the rates
+	constexpr u4Byte NUM_PASSES = 3;
+	StrmStorage storage(numStrms);
+	u4Byte numTimings = 0;
+	const CPUFeatures::ISAS isas[] = { CPUFeatures::ISAS::SCALAR, CPUFeatures::ISAS::SSE2,
+									   CPUFeatures::ISAS::AVX2, CPUFeatures::ISAS::AVX512 };
+	const u4Byte widths[] = { 1, 4, 8, 16 };
+	for (u4Byte i = 0; i < 4; i += 1)
+	{
+		if (!CPUFeatures::Supported(isas[i])) { continue; }
+		Seed(0, storage.strms, numStrms, isas[i]);
+		double bestSecs = 1e30;
+		for (u4Byte j = 0; j < NUM_PASSES; j += 1)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			Permu(storage.strms, numStrms, numPermus, isas[i]);
+			const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			bestSecs = (secs < bestSecs) ? secs : bestSecs;
+		}
+
+		Timing& timing = timings[numTimings];
+		timing.isa = isas[i];
+		timing.width = widths[i];
+		timing.gbPerSec = (bestSecs > 0.0) ? ((double)numStrms * numPermus * sizeof(u4Byte) * 4) / (bestSecs * 1e9) : 0.0;
+		numTimings += 1;
+	}
+	return numTimings;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Typedefs.h"
+#include "CPUFeatures.h"
+
+// CPU Philox4x32 streams, matching [strmBuilder(...)] ([PhiloInit.hlsli]) +
+// the eight-round [philoxPermu(...)] ([GenericUtility.hlsli]) bit-for-bit, so
+// CPU-side sampling, scene seeding + test oracles can reproduce (or predict)
+// the GPU's random numbers
+// The shader assembles each 32x32 -> 64-bit product from 16-bit pieces (SM5 has
+// no wide multiply); that assembly is exact, so these use native widening
+// multiplies instead (checked against a port of the shader's version by
+// [Valid(...)])
+// Batches keep streams as structure-of-arrays + run 4 (SSE2), 8 (AVX2) or 16
+// (AVX-512) streams per register, picking the widest kernel the running CPU
+// supports
+class Philox
+{
+	public:
+		// One stream ([PhiloStrm] in [GenericUtility.hlsli])
+		struct Strm
+		{
+			u4Byte ctr[4];
+			u4Byte key[2];
+		};
+
+		// [numStrms] streams as structure-of-arrays; stream [i]'s state is
+		// ([ctr[0][i]]...[ctr[3][i]], [key[0][i]], [key[1][i]])
+		struct Strms
+		{
+			u4Byte* ctr[4];
+			u4Byte* key[2];
+		};
+
+		// [strmBuilder(ndx, strm)]
+		static void Seed(u4Byte ndx, Strm& strm);
+
+		// [philoxPermu(strm)]; the stream's new counter is also its output, so
+		// random values are read straight from [strm.ctr]
+		static void Permu(Strm& strm);
+
+		// Seed streams [0...numStrms) with indices [firstNdx...firstNdx + numStrms)
+		static void Seed(u4Byte firstNdx, Strms strms, u4Byte numStrms);
+		static void Seed(u4Byte firstNdx, Strms strms, u4Byte numStrms, CPUFeatures::ISAS isa);
+
+		// Iterate streams [0...numStrms) [numPermus] times each; outputs are left
+		// in [strms.ctr] as above
+		static void Permu(Strms strms, u4Byte numStrms, u4Byte numPermus);
+		static void Permu(Strms strms, u4Byte numStrms, u4Byte numPermus, CPUFeatures::ISAS isa);
+
+		// [iToFloatV(...)]; maps outputs into [0...1)
+		static float ToFloat01(u4Byte u) { return u * (1.0f / 4294967296.0f); }
+
+		// Seed + iterate [numStrms] streams with every available kernel, checking
+		// each against a line-by-line port of the shader functions (software
+		// [mulhilo(...)] included)
+		static bool Valid(u4Byte numStrms, u4Byte numPermus);
+
+		// Per-instruction-set results from [Benchmark(...)]
+		struct Timing
+		{
+			CPUFeatures::ISAS isa;
+			u4Byte width; // Streams per register
+			double gbPerSec; // Random output (sixteen bytes per [philoxPermu(...)]) per second
+		};
+
+		// Time [numPermus] iterations of [numStrms] streams with every available
+		// kernel; writes one [Timing] per instruction set tested into [timings]
+		// (which should have room for four) + returns how many were written
+		static u4Byte Benchmark(u4Byte numStrms, u4Byte numPermus, Timing* timings);
+
+	private:
+		// Kernels (see Philox[SSE2|AVX2|AVX512].cpp)
+		static void SeedSSE2(u4Byte firstNdx, Strms strms, u4Byte numStrms);
+		static void SeedAVX2(u4Byte firstNdx, Strms strms, u4Byte numStrms);
+		static void SeedAVX512(u4Byte firstNdx, Strms strms, u4Byte numStrms);
+		static void PermuSSE2(Strms strms, u4Byte numStrms, u4Byte numPermus);
+		static void PermuAVX2(Strms strms, u4Byte numStrms, u4Byte numPermus);
+		static void PermuAVX512(Strms strms, u4Byte numStrms, u4Byte numPermus);
+};
@@ -0,0 +1,51 @@
+#include <immintrin.h>
+#include "Philox.h"
+
+// Compiled for AVX2 (per-file [EnableEnhancedInstructionSet] under MSVC); only
+// reached once [CPUFeatures] has confirmed the running CPU supports it
+// Shared headers are included above the target switch, so inline functions they
+// define (which the linker may merge with other files' copies) stay baseline-only
+#if defined(__GNUC__)
+	#pragma GCC target("avx2")
+#endif
+
+#include "PhiloxKernel.inl"
+
+// Eight streams per register; [vpmuludq] only multiplies even lanes, so odd
+// lanes are shifted down + multiplied separately, then blended back in
+namespace
+{
+	struct OpsAVX2
+	{
+		using U = __m256i;
+		static constexpr u4Byte WIDTH = 8;
+
+		static U Set1(u4Byte u) { return _mm256_set1_epi32((int)u); }
+		static U Load(const u4Byte* p) { return _mm256_loadu_si256((const __m256i*)p); }
+		static void Store(u4Byte* p, U v) { _mm256_storeu_si256((__m256i*)p, v); }
+		static U Iota(u4Byte base) { return _mm256_add_epi32(Set1(base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+		static U Add(U a, U b) { return _mm256_add_epi32(a, b); }
+		static U Xor(U a, U b) { return _mm256_xor_si256(a, b); }
+		static U Or(U a, U b) { return _mm256_or_si256(a, b); }
+		static U Shl(U a, int n) { return _mm256_slli_epi32(a, n); }
+		static U Shr(U a, int n) { return _mm256_srli_epi32(a, n); }
+		static void MulHiLo(U a, U b, U& lo, U& hi)
+		{
+			const __m256i evens = _mm256_mul_epu32(a, b);
+			const __m256i odds = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+			lo = _mm256_blend_epi32(evens, _mm256_slli_epi64(odds, 32), 0xAA);
+			hi = _mm256_blend_epi32(_mm256_srli_epi64(evens, 32), odds, 0xAA);
+		}
+		static U MulLo(U a, U b) { return _mm256_mullo_epi32(a, b); }
+	};
+}
+
+void Philox::SeedAVX2(u4Byte firstNdx, Strms strms, u4Byte numStrms)
+{
+	PhiloxKernel::Seed<OpsAVX2>(firstNdx, strms, numStrms);
+}
+
+void Philox::PermuAVX2(Strms strms, u4Byte numStrms, u4Byte numPermus)
+{
+	PhiloxKernel::Permu<OpsAVX2>(strms, numStrms, numPermus);
+}
@@ -0,0 +1,59 @@
+#include <immintrin.h>
+#include "Philox.h"
+
+// Compiled for AVX-512F (per-file [EnableEnhancedInstructionSet] under MSVC); only
+// reached once [CPUFeatures] has confirmed the running CPU supports it
+// Shared headers are included above the target switch, so inline functions they
+// define (which the linker may merge with other files' copies) stay baseline-only
+#if defined(__GNUC__)
+	#pragma GCC target("avx512f")
+#endif
+
+#include "PhiloxKernel.inl"
+
+// Sixteen streams per register; even + odd lanes are multiplied separately (as
+// for AVX2), then merged under a lane mask
+// Shifts + multiplies use the zero-masking forms under full masks; GCC's plain
+// forms merge into an uninitialized register, which trips [-Wmaybe-uninitialized]
+// (the generated instructions are the same)
+namespace
+{
+	struct OpsAVX512
+	{
+		using U = __m512i;
+		static constexpr u4Byte WIDTH = 16;
+		static constexpr __mmask16 ALL32 = 0xFFFF;
+		static constexpr __mmask8 ALL64 = 0xFF;
+
+		static U Set1(u4Byte u) { return _mm512_set1_epi32((int)u); }
+		static U Load(const u4Byte* p) { return _mm512_loadu_si512(p); }
+		static void Store(u4Byte* p, U v) { _mm512_storeu_si512(p, v); }
+		static U Iota(u4Byte base)
+		{
+			return _mm512_add_epi32(Set1(base), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+		}
+		static U Add(U a, U b) { return _mm512_add_epi32(a, b); }
+		static U Xor(U a, U b) { return _mm512_xor_si512(a, b); }
+		static U Or(U a, U b) { return _mm512_or_si512(a, b); }
+		static U Shl(U a, int n) { return _mm512_maskz_slli_epi32(ALL32, a, n); }
+		static U Shr(U a, int n) { return _mm512_maskz_srli_epi32(ALL32, a, n); }
+		static void MulHiLo(U a, U b, U& lo, U& hi)
+		{
+			const __m512i evens = _mm512_maskz_mul_epu32(ALL64, a, b);
+			const __m512i odds = _mm512_maskz_mul_epu32(ALL64, _mm512_maskz_srli_epi64(ALL64, a, 32), _mm512_maskz_srli_epi64(ALL64, b, 32));
+			lo = _mm512_mask_blend_epi32(0xAAAA, evens, _mm512_maskz_slli_epi64(ALL64, odds, 32));
+			hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_maskz_srli_epi64(ALL64, evens, 32), odds);
+		}
+		static U MulLo(U a, U b) { return _mm512_mullo_epi32(a, b); }
+	};
+}
+
+void Philox::SeedAVX512(u4Byte firstNdx, Strms strms, u4Byte numStrms)
+{
+	PhiloxKernel::Seed<OpsAVX512>(firstNdx, strms, numStrms);
+}
+
+void Philox::PermuAVX512(Strms strms, u4Byte numStrms, u4Byte numPermus)
+{
+	PhiloxKernel::Permu<OpsAVX512>(strms, numStrms, numPermus);
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Philox.h"
+
+// Instruction-set-agnostic body of the batched Philox kernels; included by each
+// Philox[SSE2|AVX2|AVX512].cpp after defining an [Ops] struct with
+// - [U]: packed 32-bit unsigned integers, [WIDTH] lanes each
+// - [Set1], [Load], [Store], [Iota(base)] ([base + lane] per lane)
+// - [Add], [Xor], [Or], [Shl]/[Shr] (by a constant count)
+// - [MulLo] (low half of each 32x32-bit product) + [MulHiLo] (both halves)
+// Streams left over after the last full register go through the scalar
+// functions, which produce the same bits
+namespace PhiloxKernel
+{
+	// Hashes behind [strmBuilder(...)] ([PhiloInit.hlsli])
+	template<typename Ops>
+	inline void xxminstd32(typename Ops::U i, typename Ops::U out[4])
+	{
+		using U = typename Ops::U;
+		U h32 = Ops::Add(i, Ops::Set1(374761393U));
+		h32 = Ops::MulLo(Ops::Set1(668265263U), Ops::Or(Ops::Shl(h32, 17), Ops::Shr(h32, 32 - 17)));
+		h32 = Ops::MulLo(Ops::Set1(2246822519U), Ops::Xor(h32, Ops::Shr(h32, 15)));
+		h32 = Ops::MulLo(Ops::Set1(3266489917U), Ops::Xor(h32, Ops::Shr(h32, 13)));
+		h32 = Ops::Xor(h32, Ops::Shr(h32, 16));
+		out[0] = h32;
+		out[1] = Ops::MulLo(h32, Ops::Set1(16807U));
+		out[2] = Ops::MulLo(h32, Ops::Set1(48271U));
+		out[3] = Ops::MulLo(h32, Ops::Set1(69621U));
+	}
+
+	template<typename Ops>
+	inline typename Ops::U tmhash(typename Ops::U x)
+	{
+		const typename Ops::U m = Ops::Set1(0x45d9f3b);
+		x = Ops::MulLo(Ops::Xor(Ops::Shr(x, 16), x), m);
+		x = Ops::MulLo(Ops::Xor(Ops::Shr(x, 16), x), m);
+		return Ops::Xor(Ops::Shr(x, 16), x);
+	}
+
+	template<typename Ops>
+	inline typename Ops::U ihashIII(typename Ops::U i)
+	{
+		const typename Ops::U m = Ops::Set1(1103515245U);
+		i = Ops::MulLo(m, Ops::Xor(Ops::Shr(i, 1), i));
+		i = Ops::MulLo(m, Ops::Xor(i, Ops::Shr(i, 3)));
+		return Ops::Xor(i, Ops::Shr(i, 16));
+	}
+
+	template<typename Ops>
+	inline void Seed(u4Byte firstNdx, Philox::Strms strms, u4Byte numStrms)
+	{
+		using U = typename Ops::U;
+		u4Byte i = 0;
+		for (; (i + Ops::WIDTH) <= numStrms; i += Ops::WIDTH)
+		{
+			const U ndx = Ops::Iota(firstNdx + i);
+			U ctr[4];
+			xxminstd32<Ops>(ndx, ctr);
+			Ops::Store(strms.ctr[0] + i, ctr[0]);
+			Ops::Store(strms.ctr[1] + i, ctr[1]);
+			Ops::Store(strms.ctr[2] + i, ctr[2]);
+			Ops::Store(strms.ctr[3] + i, ctr[3]);
+			Ops::Store(strms.key[0] + i, ihashIII<Ops>(ndx));
+			Ops::Store(strms.key[1] + i, tmhash<Ops>(ndx));
+		}
+
+		for (; i < numStrms; i += 1)
+		{
+			Philox::Strm strm;
+			Philox::Seed(firstNdx + i, strm);
+			for (u4Byte j = 0; j < 4; j += 1) { strms.ctr[j][i] = strm.ctr[j]; }
+			strms.key[0][i] = strm.key[0];
+			strms.key[1][i] = strm.key[1];
+		}
+	}
+
+	// [philoxPermu(...)], [numPermus] times over; state stays in registers between
+	// iterations
+	template<typename Ops>
+	inline void Permu(Philox::Strms strms, u4Byte numStrms, u4Byte numPermus)
+	{
+		using U = typename Ops::U;
+		const U m0 = Ops::Set1(0xCD9E8D57);
+		const U m1 = Ops::Set1(0xD2511F53);
+		const U bump0 = Ops::Set1(0x9E3779B9);
+		const U bump1 = Ops::Set1(0xBB67AE85);
+		u4Byte i = 0;
+		for (; (i + Ops::WIDTH) <= numStrms; i += Ops::WIDTH)
+		{
+			U c0 = Ops::Load(strms.ctr[0] + i);
+			U c1 = Ops::Load(strms.ctr[1] + i);
+			U c2 = Ops::Load(strms.ctr[2] + i);
+			U c3 = Ops::Load(strms.ctr[3] + i);
+			U k0 = Ops::Load(strms.key[0] + i);
+			U k1 = Ops::Load(strms.key[1] + i);
+			for (u4Byte j = 0; j < numPermus; j += 1)
+			{
+#if defined(__GNUC__) && !defined(__clang__)
+				#pragma GCC unroll 8
+#endif
+				for (u4Byte k = 0; k < 8; k += 1)
+				{
+					U lo0, hi0, lo1, hi1;
+					Ops::MulHiLo(m0, c0, lo0, hi0);
+					Ops::MulHiLo(m1, c2, lo1, hi1);
+					c0 = Ops::Xor(Ops::Xor(hi1, c1), k0);
+					c1 = lo1;
+					c2 = Ops::Xor(Ops::Xor(hi0, c2), k1);
+					c3 = lo0;
+					k0 = Ops::Add(k0, bump0);
+					k1 = Ops::Add(k1, bump1);
+				}
+			}
+			Ops::Store(strms.ctr[0] + i, c0);
+			Ops::Store(strms.ctr[1] + i, c1);
+			Ops::Store(strms.ctr[2] + i, c2);
+			Ops::Store(strms.ctr[3] + i, c3);
+			Ops::Store(strms.key[0] + i, k0);
+			Ops::Store(strms.key[1] + i, k1);
+		}
+
+		for (; i < numStrms; i += 1)
+		{
+			Philox::Strm strm;
+			for (u4Byte j = 0; j < 4; j += 1) { strm.ctr[j] = strms.ctr[j][i]; }
+			strm.key[0] = strms.key[0][i];
+			strm.key[1] = strms.key[1][i];
+			for (u4Byte j = 0; j < numPermus; j += 1) { Philox::Permu(strm); }
+			for (u4Byte j = 0; j < 4; j += 1) { strms.ctr[j][i] = strm.ctr[j]; }
+			strms.key[0][i] = strm.key[0];
+			strms.key[1][i] = strm.key[1];
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#include <emmintrin.h>
+#include "PhiloxKernel.inl"
+
+// Four streams per register; SSE2 is part of the x64 baseline, so this file
+// needs no special compiler flags
+// SSE2 only multiplies the even lanes of each register ([pmuludq]), so odd
+// lanes are shifted down + multiplied separately, then both sets of products
+// are interleaved back together
+namespace
+{
+	struct OpsSSE2
+	{
+		using U = __m128i;
+		static constexpr u4Byte WIDTH = 4;
+
+		static U Set1(u4Byte u) { return _mm_set1_epi32((int)u); }
+		static U Load(const u4Byte* p) { return _mm_loadu_si128((const __m128i*)p); }
+		static void Store(u4Byte* p, U v) { _mm_storeu_si128((__m128i*)p, v); }
+		static U Iota(u4Byte base) { return _mm_add_epi32(Set1(base), _mm_setr_epi32(0, 1, 2, 3)); }
+		static U Add(U a, U b) { return _mm_add_epi32(a, b); }
+		static U Xor(U a, U b) { return _mm_xor_si128(a, b); }
+		static U Or(U a, U b) { return _mm_or_si128(a, b); }
+		static U Shl(U a, int n) { return _mm_slli_epi32(a, n); }
+		static U Shr(U a, int n) { return _mm_srli_epi32(a, n); }
+		static void MulHiLo(U a, U b, U& lo, U& hi)
+		{
+			const __m128i evens = _mm_mul_epu32(a, b);
+			const __m128i odds = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+			lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(evens, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odds, _MM_SHUFFLE(0, 0, 2, 0)));
+			hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(evens, _MM_SHUFFLE(0, 0, 3, 1)), _mm_shuffle_epi32(odds, _MM_SHUFFLE(0, 0, 3, 1)));
+		}
+		static U MulLo(U a, U b)
+		{
+			// SSE2 has no [pmulld]; the unused high halves compile away
+			U lo, hi;
+			MulHiLo(a, b, lo, hi);
+			return lo;
+		}
+	};
+}
+
+void Philox::SeedSSE2(u4Byte firstNdx, Strms strms, u4Byte numStrms)
+{
+	PhiloxKernel::Seed<OpsSSE2>(firstNdx, strms, numStrms);
+}
+
+void Philox::PermuSSE2(Strms strms, u4Byte numStrms, u4Byte numPermus)
+{
+	PhiloxKernel::Permu<OpsSSE2>(strms, numStrms, numPermus);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include "Typedefs.h"
+
+// Fixed-capacity single-producer/single-consumer ring buffer
+// Lock-free (just two atomic cursors), so it's safe to write from the game thread and
+// read from a device/worker thread without either side ever blocking on the other
+// [capacity] must be a power of two so cursor wrapping can use a bitmask
+template<typename elemType, u4Byte capacity>
+class SPSCRing
+{
+	static_assert((capacity & (capacity - 1)) == 0, "[SPSCRing] capacity must be a power of two");
+
+	public:
+		SPSCRing() : head(0), tail(0) {}
+		~SPSCRing() {}
+
+		// Copy up to [count] elements from [src] into [this]; returns the number
+		// of elements actually written (less than [count] when the ring fills up)
+		// Producer-only
+		u4Byte Push(const elemType* src, u4Byte count)
+		{
+			const u4Byte h = head.load(std::memory_order_relaxed);
+			const u4Byte t = tail.load(std::memory_order_acquire);
+			const u4Byte n = Min(count, capacity - (h - t));
+			const u4Byte start = h & (capacity - 1);
+			const u4Byte firstSpan = Min(n, capacity - start);
+			std::memcpy(data + start, src, firstSpan * sizeof(elemType));
+			std::memcpy(data, src + firstSpan, (n - firstSpan) * sizeof(elemType));
+			head.store(h + n, std::memory_order_release);
+			return n;
+		}
+
+		// Copy up to [count] elements out of [this] and into [dst]; returns the number
+		// of elements actually read (less than [count] when the ring runs dry)
+		// Consumer-only
+		u4Byte Pop(elemType* dst, u4Byte count)
+		{
+			const u4Byte t = tail.load(std::memory_order_relaxed);
+			const u4Byte h = head.load(std::memory_order_acquire);
+			const u4Byte n = Min(count, h - t);
+			const u4Byte start = t & (capacity - 1);
+			const u4Byte firstSpan = Min(n, capacity - start);
+			std::memcpy(dst, data + start, firstSpan * sizeof(elemType));
+			std::memcpy(dst + firstSpan, data, (n - firstSpan) * sizeof(elemType));
+			tail.store(t + n, std::memory_order_release);
+			return n;
+		}
+
+		// Number of elements waiting to be read; exact from the consumer side,
+		// conservative from the producer side
+		u4Byte Size() const
+		{
+			return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+		}
+
+		// Number of elements that can be pushed without overwriting unread data
+		u4Byte Free() const
+		{
+			return capacity - Size();
+		}
+
+	private:
+		static u4Byte Min(u4Byte a, u4Byte b) { return (a < b) ? a : b; }
+
+		// Cursors live on separate cache lines so the producer and consumer
+		// don't false-share
+		alignas(64) std::atomic<u4Byte> head;
+		alignas(64) std::atomic<u4Byte> tail;
+		alignas(64) elemType data[capacity];
+};
@@ -64,6 +64,7 @@ address StackAllocator::AlignedAlloc(u8Byte bytes,
 
 	// Generate a pointer inside the allocated stack at the
 	// appropriate offset
+	std::lock_guard<std::mutex> held(allocLock);
 	address rawMemory;
 	address returnableMemory;
 	u8Byte allocSize = bytes + alignment;
@@ -95,6 +96,7 @@ address StackAllocator::AlignedAlloc(u8Byte bytes,
 
 address StackAllocator::ByteAlloc(bool setMarker)
 {
+	std::lock_guard<std::mutex> held(allocLock);
 	assert(((s8Byte)availMem - (s8Byte)1) > 0); // Immediately flag memory-accesses beyond the depth of the stack
 	address returnableMemory;
 	if (!setMarker)
@@ -126,6 +128,8 @@ address StackAllocator::ByteAlloc(bool setMarker)
 
 void StackAllocator::DeAlloc(MemoryStuff::MARKER_INDEX_TYPE markerIndex)
 {
+	std::lock_guard<std::mutex> held(allocLock);
+
 	// Check that the de-allocation won't empty the whole stack
 	assert(markers[markerIndex].distanceFromTop > 0);
 
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <cstdlib>
+#include <mutex>
 #include "AppGlobals.h"
 
 class ServiceCentre;
 
 // Manages the heap with a single-ended stack data structure
 // Not to be confused with the program's internal stack
+// Allocations are locked, so services can be created from any thread (e.g.
+// during parallel start-up)
 class StackAllocator
 {
 	struct Marker
@@ -53,6 +56,7 @@ class StackAllocator
 		Marker markers[MemoryStuff::MAX_MARKER_COUNT];
 		u2Byte activeMarkerCount;
 		u8Byte availMem;
+		std::mutex allocLock;
 
 		// Helper functions
 		// Shift pointers to a given alignment
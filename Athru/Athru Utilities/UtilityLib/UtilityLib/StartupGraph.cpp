@@ -0,0 +1,189 @@
+#include <assert.h>
+#include <stdio.h>
+#include "UtilityServiceCentre.h"
+#include "StartupGraph.h"
+
+StartupGraph::StartupGraph() :
+	numStages(0),
+	origin(std::chrono::steady_clock::now())
+{
+}
+
+u4Byte StartupGraph::Add(const char* name, void (*fn)(void* context), void* context, bool mainThread)
+{
+	assert(numStages < StartupStuff::MAX_STARTUP_STAGES);
+	Stage& stage = stages[numStages];
+	stage.name = name;
+	stage.fn = fn;
+	stage.context = context;
+	stage.mainThread = mainThread;
+	stage.recorded = false;
+	stage.numDeps = 0;
+	stage.job = nullptr;
+	numStages += 1;
+	return numStages - 1;
+}
+
+u4Byte StartupGraph::Record(const char* name, std::chrono::steady_clock::time_point began)
+{
+	const u4Byte ndx = Add(name, nullptr, nullptr, true);
+	stages[ndx].recorded = true;
+	stages[ndx].began = began;
+	stages[ndx].ended = std::chrono::steady_clock::now();
+	if (began < origin) { origin = began; } // Keep reported times non-negative
+	return ndx;
+}
+
+void StartupGraph::Depend(u4Byte stage, u4Byte prereq)
+{
+	assert(prereq < stage); // Prerequisites have to be added before their dependants
+	assert(stages[stage].numDeps < StartupStuff::MAX_STARTUP_DEPS);
+	stages[stage].deps[stages[stage].numDeps] = prereq;
+	stages[stage].numDeps += 1;
+}
+
+void StartupGraph::Run()
+{
+	JobSystem* jobs = AthruCore::Utility::AccessJobs();
+
+	// Create jobs for every stage; main-thread stages get empty jobs instead, which
+	// we run straight after each stage to release any worker stages waiting on it
+	for (u4Byte i = 0; i < numStages; i += 1)
+	{
+		Stage& stage = stages[i];
+		if (stage.recorded) { continue; }
+		if (stage.mainThread)
+		{
+			stage.job = jobs->Create([]() {});
+		}
+		else
+		{
+			StartupGraph* graph = this;
+			stage.job = jobs->Create([graph, i]() { graph->Execute(i); });
+		}
+	}
+
+	// Link worker stages to their prerequisites (recorded stages have already finished,
+	// so they never hold anything back); all links have to exist before any jobs start
+	for (u4Byte i = 0; i < numStages; i += 1)
+	{
+		const Stage& stage = stages[i];
+		if (stage.mainThread) { continue; }
+		for (u4Byte j = 0; j < stage.numDeps; j += 1)
+		{
+			const Stage& prereq = stages[stage.deps[j]];
+			if (!prereq.recorded) { jobs->Depend(stage.job, prereq.job); }
+		}
+	}
+
+	// Release worker stages; each one starts as soon as its prerequisites finish
+	for (u4Byte i = 0; i < numStages; i += 1)
+	{
+		if (!stages[i].mainThread) { jobs->Run(stages[i].job); }
+	}
+
+	// Step through main-thread stages in order; [Wait(...)] runs other stages while
+	// prerequisites are pending, so the main thread never idles
+	// Prerequisites always come before their dependants, so any main-thread stages a
+	// prerequisite might be waiting on have already run by now
+	for (u4Byte i = 0; i < numStages; i += 1)
+	{
+		Stage& stage = stages[i];
+		if (!stage.mainThread || stage.recorded) { continue; }
+		for (u4Byte j = 0; j < stage.numDeps; j += 1)
+		{
+			const Stage& prereq = stages[stage.deps[j]];
+			if (!prereq.recorded) { jobs->Wait(prereq.job); }
+		}
+		Execute(i);
+		jobs->Run(stage.job);
+	}
+
+	// Wait for any worker stages that nothing on the main thread depended on
+	for (u4Byte i = 0; i < numStages; i += 1)
+	{
+		if (!stages[i].recorded) { jobs->Wait(stages[i].job); }
+	}
+}
+
+void StartupGraph::Report() const
+{
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	char line[256];
+	float serialMs = 0.0f;
+	u4Byte lastStage = 0;
+	for (u4Byte i = 0; i < numStages; i += 1)
+	{
+		const Stage& stage = stages[i];
+		const float startMs = Millis(stage.began);
+		const float durationMs = Millis(stage.ended) - startMs;
+		snprintf(line, sizeof(line), "%s (%s): started at %.2fms, took %.2fms", stage.name,
+				 stage.mainThread ? "main thread" : "worker", startMs, durationMs);
+		logger->Log((const char*)line, "start-up stage");
+		serialMs += durationMs;
+		if (stage.ended > stages[lastStage].ended) { lastStage = i; }
+	}
+	const float totalMs = Millis(stages[lastStage].ended);
+	logger->Log(totalMs, "Start-up time (milliseconds)");
+	logger->Log(serialMs, "Start-up time without overlapping stages (milliseconds)");
+
+	// Walk back from the last stage to finish, following whichever predecessor
+	// finished last (prerequisites, plus the previous main-thread stage for stages
+	// on the main thread)
+	u4Byte path[StartupStuff::MAX_STARTUP_STAGES];
+	u4Byte pathLength = 0;
+	u4Byte curr = lastStage;
+	while (true)
+	{
+		path[pathLength] = curr;
+		pathLength += 1;
+
+		const Stage& stage = stages[curr];
+		s4Byte pred = -1;
+		for (u4Byte i = 0; i < stage.numDeps; i += 1)
+		{
+			if (pred < 0 || stages[stage.deps[i]].ended > stages[pred].ended) { pred = (s4Byte)stage.deps[i]; }
+		}
+		if (stage.mainThread)
+		{
+			for (s4Byte i = (s4Byte)curr - 1; i >= 0; i -= 1)
+			{
+				if (!stages[i].mainThread) { continue; }
+				if (pred < 0 || stages[i].ended > stages[pred].ended) { pred = i; }
+				break;
+			}
+		}
+		if (pred < 0) { break; }
+		curr = (u4Byte)pred;
+	}
+
+	char pathText[1024];
+	u4Byte pathChars = 0;
+	float pathMs = 0.0f;
+	pathText[0] = '\0';
+	for (s4Byte i = (s4Byte)pathLength - 1; i >= 0; i -= 1)
+	{
+		const Stage& stage = stages[path[i]];
+		const float durationMs = Millis(stage.ended) - Millis(stage.began);
+		const s4Byte written = snprintf(pathText + pathChars, sizeof(pathText) - pathChars, "%s%s (%.2fms)",
+										(pathChars > 0) ? " -> " : "", stage.name, durationMs);
+		if (written < 0 || (pathChars + written) >= sizeof(pathText)) { break; }
+		pathChars += written;
+		pathMs += durationMs;
+	}
+	logger->Log((const char*)pathText, "start-up critical path");
+	logger->Log(pathMs, "Start-up time spent on the critical path (milliseconds)");
+}
+
+void StartupGraph::Execute(u4Byte stage)
+{
+	Stage& curr = stages[stage];
+	curr.began = std::chrono::steady_clock::now();
+	curr.fn(curr.context);
+	curr.ended = std::chrono::steady_clock::now();
+}
+
+float StartupGraph::Millis(std::chrono::steady_clock::time_point t) const
+{
+	return (float)((t - origin).count() * TimeStuff::nsToSecs * 1000.0);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include "Typedefs.h"
+#include "AppGlobals.h"
+#include "JobSystem.h"
+
+// Start-up dependency graph
+// Stages are declared up-front with their prerequisites, then [Run()] executes
+// every stage as soon as its prerequisites have finished; independent stages
+// run concurrently on the job system, while stages that have to stay on the
+// main thread (window creation, device setup...) run there in the order they
+// were added
+// Every stage is timed, and [Report()] logs per-stage durations with the
+// critical path (the chain of stages that actually held start-up back)
+// Graphs live on the stack + never allocate, so they can describe start-up
+// before (most of) Athru's services exist
+class StartupGraph
+{
+	public:
+		StartupGraph();
+		~StartupGraph() = default;
+
+		// Add a stage calling [fn(context)]; returns the stage's index for
+		// [Depend(...)]
+		// Main-thread stages run in the order they were added; other stages
+		// run on whichever worker picks them up first
+		u4Byte Add(const char* name, void (*fn)(void* context), void* context, bool mainThread);
+
+		// Add a stage that already ran on the main thread, from [began] until now
+		// (e.g. services that had to exist before the graph could run)
+		u4Byte Record(const char* name, std::chrono::steady_clock::time_point began);
+
+		// Stop [stage] from starting until [prereq] has finished
+		// Prerequisites have to be added before their dependants (so graphs can't
+		// loop), and each stage supports up to [StartupStuff::MAX_STARTUP_DEPS]
+		// prerequisites
+		void Depend(u4Byte stage, u4Byte prereq);
+
+		// Run every stage, returning once all of them have finished
+		// Needs Athru's job system, + has to be called from the main thread
+		void Run();
+
+		// Log each stage's start time + duration, the total start-up time, and the
+		// critical path through the graph
+		// Main-thread stages are serialized, so the critical path follows either
+		// the last prerequisite to finish, or the main-thread stage before
+		// (whichever finished later)
+		void Report() const;
+
+	private:
+		struct Stage
+		{
+			const char* name;
+			void (*fn)(void* context);
+			void* context;
+			bool mainThread;
+			bool recorded;
+			u4Byte deps[StartupStuff::MAX_STARTUP_DEPS];
+			u4Byte numDeps;
+			JobSystem::Job* job; // Main-thread stages get an empty job that finishes once the stage has run,
+								 // so worker stages can depend on them like any other stage
+			std::chrono::steady_clock::time_point began;
+			std::chrono::steady_clock::time_point ended;
+		};
+
+		// Call [stage]'s function + record when it started/stopped
+		void Execute(u4Byte stage);
+
+		// Milliseconds between [origin] and [t]
+		float Millis(std::chrono::steady_clock::time_point t) const;
+
+		Stage stages[StartupStuff::MAX_STARTUP_STAGES];
+		u4Byte numStages;
+		std::chrono::steady_clock::time_point origin;
+};
@@ -1,6 +1,9 @@
 #include "UtilityServiceCentre.h"
 
 StackAllocator* AthruCore::Utility::stackAllocatorPttr = nullptr;
+AsyncIO* AthruCore::Utility::ioPttr = nullptr;
+AssetPack* AthruCore::Utility::assetsPttr = nullptr;
 Logger* AthruCore::Utility::loggerPttr = nullptr;
 Input* AthruCore::Utility::inputPttr = nullptr;
-Application* AthruCore::Utility::appPttr = nullptr;
\ No newline at end of file
+Application* AthruCore::Utility::appPttr = nullptr;
+JobSystem* AthruCore::Utility::jobsPttr = nullptr;
\ No newline at end of file
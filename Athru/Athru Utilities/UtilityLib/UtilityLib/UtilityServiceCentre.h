@@ -5,6 +5,9 @@
 #include "Logger.h"
 #include "Input.h"
 #include "Application.h"
+#include "JobSystem.h"
+#include "AsyncIO.h"
+#include "AssetPack.h"
 #include "AppGlobals.h"
 
 namespace AthruCore
@@ -15,23 +18,61 @@ namespace AthruCore
 			Utility() = delete;
 			~Utility() = delete;
 
-			static void Init(const u8Byte& expectedMemoryUsage)
+			// Windows are tied to the thread that creates them, so callers running
+			// start-up across several threads can skip window creation here + call
+			// [InitApp()] from the main thread later
+			static void Init(const u8Byte& expectedMemoryUsage, bool openWindow = true)
 			{
 				// Attempt to create and register the memory-management
 				// service
 				stackAllocatorPttr = new StackAllocator(expectedMemoryUsage);
 
+				// Attempt to create and register the file I/O service; the
+				// logger writes through it, so create it first
+				ioPttr = new AsyncIO();
+
 				// Attempt to create and register the logging
 				// service
 				loggerPttr = new Logger("log.txt");
 
+				// Attempt to map the asset pack; missing packs are fine, assets
+				// then load from loose files instead
+				assetsPttr = new AssetPack(IOStuff::ASSET_PACK_PATH);
+
 				// Attempt to create and register the primary input service
 				inputPttr = new Input();
 
+				// Attempt to create and register the job system; the calling thread
+				// becomes the pool's first worker
+				jobsPttr = new JobSystem();
+
 				// Attempt to create and register the application
+				if (openWindow) { InitApp(); }
+			}
+
+			static void InitApp()
+			{
 				appPttr = new Application();
 			}
 
+			static void DeInitJobs()
+			{
+				jobsPttr->~JobSystem();
+				jobsPttr = nullptr;
+			}
+
+			static void DeInitAssets()
+			{
+				assetsPttr->~AssetPack();
+				assetsPttr = nullptr;
+			}
+
+			static void DeInitIO()
+			{
+				ioPttr->~AsyncIO();
+				ioPttr = nullptr;
+			}
+
 			static void DeInitMemory()
 			{
 				delete stackAllocatorPttr;
@@ -76,11 +117,29 @@ namespace AthruCore
 				return appPttr;
 			}
 
+			static JobSystem* AccessJobs()
+			{
+				return jobsPttr;
+			}
+
+			static AsyncIO* AccessIO()
+			{
+				return ioPttr;
+			}
+
+			static AssetPack* AccessAssets()
+			{
+				return assetsPttr;
+			}
+
 		private:
 			static StackAllocator* stackAllocatorPttr;
+			static AsyncIO* ioPttr;
+			static AssetPack* assetsPttr;
 			static Logger* loggerPttr;
 			static Input* inputPttr;
 			static Application* appPttr;
+			static JobSystem* jobsPttr;
 	};
 }
 
@@ -0,0 +1,108 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "UtilityServiceCentre.h"
+#include "Renderer.h"
+#include "lodepng.h"
+#include "AssetBaker.h"
+
+// Read a whole file through Athru's I/O service; returns a [malloc]'d copy (or
+// [nullptr] if the file can't be read)
+static uByte* ReadWholeFile(const char* path, u8Byte* numBytes)
+{
+	std::error_code err;
+	*numBytes = (u8Byte)std::filesystem::file_size(path, err);
+	if (err) { return nullptr; }
+
+	uByte* data = (uByte*)malloc((size_t)*numBytes);
+	AsyncIO* io = AthruCore::Utility::AccessIO();
+	u8Byte bytesRead = 0;
+	if (io->Wait(io->Read(path, data, *numBytes), &bytesRead) != IO_STATUS::DONE || bytesRead != *numBytes)
+	{
+		free(data);
+		return nullptr;
+	}
+	return data;
+}
+
+bool AssetBaker::Bake(const char* packPath)
+{
+	// Asset names have to outlive [AssetPack::Build(...)], so keep them in one place
+	std::vector<std::string> names;
+	std::vector<AssetPack::Source> sources;
+	std::vector<uByte*> payloads;
+	bool complete = true;
+	auto addAsset = [&](const std::string& name, ASSET_TYPES type, uByte* data, u8Byte numBytes)
+	{
+		if (data == nullptr)
+		{
+			AthruCore::Utility::AccessLogger()->Log(name.c_str(), "failed to bake asset");
+			complete = false;
+			return;
+		}
+		names.push_back(name);
+		sources.push_back({ nullptr, type, data, numBytes });
+		payloads.push_back(data);
+	};
+
+	// Shader bytecode, as-is
+	std::error_code err;
+	for (const auto& entry : std::filesystem::directory_iterator(".", err))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".cso")
+		{
+			const std::string name = entry.path().filename().generic_string();
+			u8Byte numBytes = 0;
+			uByte* bytecode = ReadWholeFile(name.c_str(), &numBytes);
+			addAsset(name, ASSET_TYPES::SHADER, bytecode, numBytes);
+		}
+	}
+
+	// Dither texture, decoded + converted to the renderer's texel format
+	u8Byte pngBytes = 0;
+	uByte* png = ReadWholeFile(AthruGPU::DITHER_TEX_PATH, &pngBytes);
+	uByte* rgba = nullptr;
+	unsigned width = 0;
+	unsigned height = 0;
+	uByte* dither = nullptr;
+	constexpr u4Byte ditherArea = AthruGPU::DITHER_TEX_WIDTH * AthruGPU::DITHER_TEX_WIDTH;
+	const u8Byte ditherBytes = sizeof(AssetPack::TextureHeader) + (ditherArea * sizeof(DirectX::XMFLOAT2));
+	if (png != nullptr && lodepng_decode32(&rgba, &width, &height, png, (size_t)pngBytes) == 0 &&
+		width == AthruGPU::DITHER_TEX_WIDTH && height == AthruGPU::DITHER_TEX_WIDTH)
+	{
+		dither = (uByte*)malloc((size_t)ditherBytes);
+		AssetPack::TextureHeader* ditherInfo = (AssetPack::TextureHeader*)dither;
+		ditherInfo->width = width;
+		ditherInfo->height = height;
+		ditherInfo->format = DXGI_FORMAT_R32G32_FLOAT;
+		ditherInfo->texelBytes = sizeof(DirectX::XMFLOAT2);
+		Renderer::ConvertDitherTexels(rgba, (DirectX::XMFLOAT2*)(dither + sizeof(AssetPack::TextureHeader)), ditherArea);
+	}
+	free(png);
+	free(rgba);
+	addAsset(AthruGPU::DITHER_TEX_PATH, ASSET_TYPES::TEXTURE, dither, ditherBytes);
+
+	// Organism data, compiled
+	for (const auto& entry : std::filesystem::recursive_directory_iterator("CritterData", err))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".dna")
+		{
+			const std::string name = entry.path().generic_string();
+			u8Byte numBytes = 0;
+			uByte* dna = AssetPack::CompileDNA(name.c_str(), &numBytes);
+			addAsset(name, ASSET_TYPES::DNA, dna, numBytes);
+		}
+	}
+
+	// Names are stable once every asset has been collected
+	for (size_t i = 0; i < sources.size(); i += 1)
+	{
+		sources[i].name = names[i].c_str();
+	}
+	const bool built = AssetPack::Build(packPath, sources.data(), (u4Byte)sources.size());
+	for (uByte* payload : payloads)
+	{
+		free(payload);
+	}
+	return complete && built;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "AppGlobals.h"
+
+// Offline asset baking; run by launching Athru with [-bake]
+// Collects every compiled shader (.cso) in the working directory, the blue-noise dither
+// texture (converted to the texel format the renderer uploads), and every organism file
+// (.dna, compiled) under [CritterData/], then packs them into a single [AssetPack]
+// Assets are named by the relative paths they'd otherwise be loaded from, so packed
+// + loose loads use the same names
+class AssetBaker
+{
+	public:
+		AssetBaker() = delete;
+		~AssetBaker() = delete;
+
+		// Bake a fresh pack into [packPath]; returns [false] if any asset couldn't be
+		// read or the pack couldn't be written
+		static bool Bake(const char* packPath);
+};
@@ -1,4 +1,11 @@
 #include "HiLevelServiceCentre.h"
+#include "AssetBaker.h"
+#include "BufferPlanner.h"
+#include "OffsetAllocator.h"
+#include "UploadRing.h"
+#include "BarrierPlanner.h"
+#include "PNGEncoder.h"
+#include "FrameDump.h"
 
 void GameLoop()
 {
@@ -16,6 +23,9 @@ void GameLoop()
 	// Cache a local reference to the high-level scene representation
 	Scene* athruScene = HiLevelServiceCentre::AccessScene();
 
+	// Cache a local reference to the critter audio mixer
+	AudioMixer* athruAudio = HiLevelServiceCentre::AccessAudio();
+
     // Cache a local reference to the Direct3D handler object
     Direct3D* d3d = AthruGPU::GPU::AccessD3D();
 
@@ -41,6 +51,11 @@ void GameLoop()
 		// Update the game
 		athruScene->Update();
 
+		// Re-prioritize critter voices around the camera, then top up the
+		// audio device's sample ring
+		athruAudio->Update(athruScene->GetMainCamera(), athruScene->GetCurrentSystem());
+		athruAudio->Pump();
+
 		// Upload system data, rasterize gradient volumes on the zeroth frame + whenever the player hits a new system
 		bool sysLoaded = false;
 		if (/*athruScene->CheckFreshSys() || */TimeStuff::frameCtr == 0)
@@ -49,6 +64,9 @@ void GameLoop()
 			sysLoaded = true;
 		}
 
+		// Stream in the next slice of any queued uploads (planets, critters, vegetation...)
+		athruGPUMessenger->PumpUploads();
+
 		// Pass the scene to the gpu whenever planets aren't being rasterized
 		if (!sysLoaded)
 		{
@@ -85,11 +103,100 @@ void GameLoop()
 	AthruCore::Utility::AccessLogger()->LogMem(AthruCore::Utility::AccessMemory()->GetStart());
 }
 
+// Stop the utility services started for offline tools (asset baking,
+// benchmarks...)
+void DeInitUtilities()
+{
+	AthruCore::Utility::DeInitJobs();
+	AthruCore::Utility::DeInitIO();
+	AthruCore::Utility::DeInitApp();
+	AthruCore::Utility::DeInitInput();
+	AthruCore::Utility::DeInitLogger();
+	AthruCore::Utility::DeInitMemory();
+}
+
+// Randomized checks for engine subsystems that can run without a GPU/window; each
+// logs its own results + timings, + reports failures as negative return values
+// Returns false if any check failed
+bool SelfTest()
+{
+	bool passed = true;
+	passed = (BufferPlanner::Benchmark(20000) >= 0.0f) && passed;
+	passed = (OffsetAllocator::Benchmark(2000000) >= 0.0f) && passed;
+	passed = (UploadRing::Simulate(10000) >= 0.0f) && passed;
+	passed = (BarrierPlanner::Simulate(20000) >= 0.0f) && passed;
+	passed = (PNGEncoder::Benchmark(GraphicsStuff::DISPLAY_WIDTH, GraphicsStuff::DISPLAY_HEIGHT) >= 0.0f) && passed;
+	passed = (FrameDump::Benchmark(GraphicsStuff::DISPLAY_WIDTH, GraphicsStuff::DISPLAY_HEIGHT) >= 0.0f) && passed;
+	AthruCore::Utility::AccessLogger()->Log((u4Byte)passed, "Self-test passed");
+	return passed;
+}
+
 int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ PSTR pScmdline, _In_ int iCmdshow)
 {
 	// Flag used to track memory leaks
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 
+	// Offline asset baking; only needs utility services, so skip the renderer + scene
+	if (strstr(pScmdline, "-bake") != nullptr)
+	{
+		AthruCore::Utility::Init(MemoryStuff::STARTING_HEAP_ALLOC);
+		AthruCore::Utility::DeInitAssets(); // Release any older pack before replacing it
+		const bool baked = AssetBaker::Bake(IOStuff::ASSET_PACK_PATH);
+		DeInitUtilities();
+		return baked ? 0 : 1;
+	}
+
+	// Self-checks; exits with a non-zero status if any check fails
+	if (strstr(pScmdline, "-selftest") != nullptr)
+	{
+		AthruCore::Utility::Init(MemoryStuff::STARTING_HEAP_ALLOC);
+		const bool passed = SelfTest();
+		DeInitUtilities();
+		return passed ? 0 : 1;
+	}
+
+	// Job system scaling test; timings go to the logger
+	if (strstr(pScmdline, "-bench-jobs") != nullptr)
+	{
+		AthruCore::Utility::Init(MemoryStuff::STARTING_HEAP_ALLOC);
+		AthruCore::Utility::AccessJobs()->Benchmark(1 << 18);
+		DeInitUtilities();
+		return 0;
+	}
+
+	// Fluid solver throughput at the low + high ends of the packet counts it's
+	// designed for
+	if (strstr(pScmdline, "-bench-fluid") != nullptr)
+	{
+		AthruCore::Utility::Init(MemoryStuff::STARTING_HEAP_ALLOC);
+		FluidPackets::Benchmark(100000, 30);
+		FluidPackets::Benchmark(1000000, 10);
+		DeInitUtilities();
+		return 0;
+	}
+
+	// Critter flock step time at the largest flock size it's designed for
+	if (strstr(pScmdline, "-bench-flock") != nullptr)
+	{
+		AthruCore::Utility::Init(MemoryStuff::STARTING_HEAP_ALLOC);
+		CritterFlock::Benchmark(100000, 30);
+		DeInitUtilities();
+		return 0;
+	}
+
+	// Offline critter audio render with every voice active; writes [bench-audio.wav]
+	// + logs the synthesizer's realtime factor
+	if (strstr(pScmdline, "-bench-audio") != nullptr)
+	{
+		AthruCore::Utility::Init(MemoryStuff::STARTING_HEAP_ALLOC);
+		AudioMixer* mixer = new AudioMixer("CritterData/test.dna", false);
+		mixer->VoiceAll();
+		mixer->RenderOffline("bench-audio.wav", 10.0f);
+		mixer->~AudioMixer();
+		DeInitUtilities();
+		return 0;
+	}
+
 	// Start the service centre
 	HiLevelServiceCentre::StartUp();
 
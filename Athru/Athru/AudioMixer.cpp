@@ -0,0 +1,451 @@
+#include <algorithm>
+#include <chrono>
+#include <emmintrin.h>
+#include <windows.h>
+#include <mmsystem.h>
+#include "UtilityServiceCentre.h"
+#include "Camera.h"
+#include "System.h"
+#include "AudioMixer.h"
+
+#pragma comment(lib, "winmm.lib")
+
+// Distance (in world units) where critters fall to half their nominal loudness
+constexpr float AUDIBLE_RADIUS = 64.0f;
+
+// Master gain applied after mixing; hundreds of voices sum well past unity,
+// so scale the bank down before clipping to 16-bit
+constexpr float MASTER_GAIN = 0.125f;
+
+// Number of blocks queued with the audio device at any one time
+constexpr u4Byte NUM_DEVICE_BUFFERS = 3;
+
+// Number of critters in each system (star systems don't carry critters)
+constexpr u4Byte CRITTERS_PER_SYSTEM = (SceneStuff::BODIES_PER_SYSTEM - 1) * SceneStuff::ANIMALS_PER_PLANET;
+
+// Small integer hash used to spread per-critter variations
+// (Thomas Wang's 32-bit mix)
+static u4Byte CritterHash(u4Byte key)
+{
+	key = (key ^ 61) ^ (key >> 16);
+	key *= 9;
+	key = key ^ (key >> 4);
+	key *= 0x27d4eb2d;
+	key = key ^ (key >> 15);
+	return key;
+}
+
+// Clamp + quantize mixed samples for 16-bit output
+static s2Byte ToPCM(float sample)
+{
+	sample = std::min(std::max(sample, -1.0f), 1.0f);
+	return (s2Byte)(sample * 32767.0f);
+}
+
+AudioMixer::AudioMixer(const char* dnaPath, bool openDevice) :
+	voicedSys(nullptr),
+	baseFreq(440.0f),
+	baseAmp(0.5f),
+	deviceActive(false)
+{
+	// Every voice starts free + silent
+	for (u4Byte i = 0; i < AudioStuff::MAX_VOICES; i += 1)
+	{
+		phases[i] = 0.0f;
+		phaseSteps[i] = 0.0f;
+		gains[i] = 0.0f;
+		gainTargets[i] = 0.0f;
+		noiseMix[i] = 0.0f;
+		noiseStates[i] = 1;
+		voiceCritters[i] = -1;
+	}
+
+	for (u4Byte i = 0; i < CRITTERS_PER_SYSTEM; i += 1)
+	{
+		critterVoices[i] = -1;
+	}
+
+	// Load species sound properties
+	ReadSoundDNA(dnaPath);
+
+	// Launch the device thread (if requested)
+	if (openDevice)
+	{
+		deviceActive = true;
+		deviceThread = std::thread(&AudioMixer::DeviceLoop, this);
+	}
+}
+
+AudioMixer::~AudioMixer()
+{
+	// Stop + wait for the device thread
+	deviceActive = false;
+	if (deviceThread.joinable())
+	{
+		deviceThread.join();
+	}
+}
+
+void AudioMixer::ReadSoundDNA(const char* dnaPath)
+{
+	// Read compiled DNA out of the asset pack when it's there, otherwise compile the
+	// loose text file here
+	u8Byte dnaBytes = 0;
+	const uByte* dna = AthruCore::Utility::AccessAssets()->Find(dnaPath, ASSET_TYPES::DNA, &dnaBytes);
+	uByte* compiledDNA = nullptr;
+	if (dna == nullptr)
+	{
+		compiledDNA = AssetPack::CompileDNA(dnaPath, &dnaBytes);
+		dna = compiledDNA;
+	}
+
+	float freq = 0.5f;
+	float amp = 0.5f;
+	if (dna != nullptr)
+	{
+		AssetPack::DNAValues(dna, dnaBytes, "FREQUENCY", &freq, 1);
+		AssetPack::DNAValues(dna, dnaBytes, "AMPLITUDE", &amp, 1);
+	}
+	free(compiledDNA);
+
+	// DNA stores normalized frequencies; map them exponentially onto
+	// ~110Hz (0.0) through ~3.5KHz (1.0), so equal genetic steps sound
+	// like equal musical steps
+	baseFreq = 110.0f * powf(32.0f, freq);
+	baseAmp = amp;
+}
+
+void AudioMixer::Update(Camera* camera, System* sys)
+{
+	// Release every voice when the camera crosses into a new system; the old
+	// critters fade out naturally over the next block
+	if (sys != voicedSys)
+	{
+		for (u4Byte i = 0; i < AudioStuff::MAX_VOICES; i += 1)
+		{
+			gainTargets[i] = 0.0f;
+			voiceCritters[i] = -1;
+		}
+
+		for (u4Byte i = 0; i < CRITTERS_PER_SYSTEM; i += 1)
+		{
+			critterVoices[i] = -1;
+		}
+		voicedSys = sys;
+	}
+
+	if (sys == nullptr) { return; }
+
+	// Evaluate perceived loudness for every critter in the system
+	// Inverse-square falloff, softened by [AUDIBLE_RADIUS] so nearby critters
+	// don't blow up to infinity
+	DirectX::XMFLOAT3 camPos;
+	DirectX::XMStoreFloat3(&camPos, camera->GetTranslation());
+	Planet** planets = sys->GetPlanets();
+	float loudness[CRITTERS_PER_SYSTEM];
+	u2Byte ranks[CRITTERS_PER_SYSTEM];
+	for (u4Byte i = 0; i < (SceneStuff::BODIES_PER_SYSTEM - 1); i += 1)
+	{
+		for (u4Byte j = 0; j < SceneStuff::ANIMALS_PER_PLANET; j += 1)
+		{
+			const u4Byte critterID = i * SceneStuff::ANIMALS_PER_PLANET + j;
+			const DirectX::XMFLOAT4 critterPos = planets[i]->FetchCritter(j).GetCoreFigure().linTransf;
+			const float dx = critterPos.x - camPos.x;
+			const float dy = critterPos.y - camPos.y;
+			const float dz = critterPos.z - camPos.z;
+			const float distSqr = dx * dx + dy * dy + dz * dz;
+			loudness[critterID] = baseAmp / (1.0f + distSqr / (AUDIBLE_RADIUS * AUDIBLE_RADIUS));
+			ranks[critterID] = (u2Byte)critterID;
+		}
+	}
+
+	// Partition out the loudest [MAX_VOICES] critters; ordering inside the partition
+	// doesn't matter, so [nth_element] is enough here
+	std::nth_element(ranks, ranks + AudioStuff::MAX_VOICES, ranks + CRITTERS_PER_SYSTEM,
+					 [&loudness](u2Byte a, u2Byte b) { return loudness[a] > loudness[b]; });
+	bool audible[CRITTERS_PER_SYSTEM] = {};
+	for (u4Byte i = 0; i < AudioStuff::MAX_VOICES; i += 1)
+	{
+		audible[ranks[i]] = true;
+	}
+
+	// Fade out voices whose critters dropped below the cut, refresh targets
+	// for the rest
+	for (u4Byte i = 0; i < AudioStuff::MAX_VOICES; i += 1)
+	{
+		const s4Byte critterID = voiceCritters[i];
+		if (critterID < 0) { continue; }
+		if (audible[critterID])
+		{
+			gainTargets[i] = loudness[critterID];
+		}
+		else
+		{
+			gainTargets[i] = 0.0f;
+			critterVoices[critterID] = -1;
+			voiceCritters[i] = -1;
+		}
+	}
+
+	// Hand free voices (unowned + fully faded) to newly-audible critters
+	u4Byte freeCursor = 0;
+	for (u4Byte i = 0; i < AudioStuff::MAX_VOICES; i += 1)
+	{
+		const u2Byte critterID = ranks[i];
+		if (critterVoices[critterID] >= 0) { continue; }
+		while (freeCursor < AudioStuff::MAX_VOICES &&
+			   (voiceCritters[freeCursor] >= 0 || gains[freeCursor] > 0.0f))
+		{
+			freeCursor += 1;
+		}
+
+		// No voices left this frame; remaining critters get picked up once
+		// the released voices finish fading
+		if (freeCursor == AudioStuff::MAX_VOICES) { break; }
+		StartVoice(freeCursor, critterID, loudness[critterID]);
+	}
+}
+
+void AudioMixer::VoiceAll()
+{
+	for (u4Byte i = 0; i < AudioStuff::MAX_VOICES; i += 1)
+	{
+		if (voiceCritters[i] >= 0) { critterVoices[voiceCritters[i]] = -1; }
+		StartVoice(i, i, baseAmp);
+	}
+}
+
+void AudioMixer::StartVoice(u4Byte voice, u4Byte critterID, float loudness)
+{
+	// Each critter sounds a little different from the species average;
+	// pitch wanders by up to half an octave either way, and some critters
+	// are breathier (noisier) than others
+	const u4Byte hash = CritterHash(critterID + 1);
+	const float pitchJitter = powf(2.0f, ((float)(hash & 0xFF) / 255.0f) - 0.5f);
+	phases[voice] = 0.0f;
+	phaseSteps[voice] = (baseFreq * pitchJitter) / (float)AudioStuff::SAMPLE_RATE;
+	noiseMix[voice] = ((float)((hash >> 8) & 0xFF) / 255.0f) * 0.5f;
+	noiseStates[voice] = hash | 1; // Xorshift can't leave zero
+	gains[voice] = 0.0f;
+	gainTargets[voice] = loudness;
+	voiceCritters[voice] = critterID;
+	critterVoices[critterID] = (s2Byte)voice;
+}
+
+void AudioMixer::Synthesize(float* out, u4Byte numSamples)
+{
+	// Accumulate four voices/lane per sample, then reduce across lanes once at the
+	// end (instead of once per voice-group)
+	alignas(16) __m128 accum[AudioStuff::BLOCK_SAMPLES];
+	const u4Byte blockLen = std::min(numSamples, AudioStuff::BLOCK_SAMPLES);
+	for (u4Byte i = 0; i < blockLen; i += 1)
+	{
+		accum[i] = _mm_setzero_ps();
+	}
+
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 four = _mm_set1_ps(4.0f);
+	const __m128 sinRefine = _mm_set1_ps(0.225f);
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 noiseScale = _mm_set1_ps(1.0f / 2147483648.0f);
+	const __m128 rampScale = _mm_set1_ps(1.0f / (float)blockLen);
+	for (u4Byte v = 0; v < AudioStuff::MAX_VOICES; v += 4)
+	{
+		// Skip groups that are silent and staying silent
+		__m128 gain = _mm_load_ps(gains + v);
+		const __m128 target = _mm_load_ps(gainTargets + v);
+		if (_mm_movemask_ps(_mm_cmpgt_ps(_mm_max_ps(gain, target), _mm_setzero_ps())) == 0) { continue; }
+
+		__m128 phase = _mm_load_ps(phases + v);
+		const __m128 step = _mm_load_ps(phaseSteps + v);
+		const __m128 mix = _mm_load_ps(noiseMix + v);
+		const __m128 gainStep = _mm_mul_ps(_mm_sub_ps(target, gain), rampScale);
+		__m128i noise = _mm_load_si128((const __m128i*)(noiseStates + v));
+		for (u4Byte i = 0; i < blockLen; i += 1)
+		{
+			// Parabolic sine approximation over [-1...1)
+			// Accurate to ~0.1%, much cheaper than [sinf]
+			const __m128 x = _mm_sub_ps(_mm_mul_ps(phase, two), one);
+			__m128 y = _mm_mul_ps(_mm_mul_ps(four, x), _mm_sub_ps(one, _mm_and_ps(x, absMask)));
+			y = _mm_add_ps(_mm_mul_ps(sinRefine, _mm_sub_ps(_mm_mul_ps(y, _mm_and_ps(y, absMask)), y)), y);
+
+			// Xorshift32 white noise, mapped to [-1...1)
+			noise = _mm_xor_si128(noise, _mm_slli_epi32(noise, 13));
+			noise = _mm_xor_si128(noise, _mm_srli_epi32(noise, 17));
+			noise = _mm_xor_si128(noise, _mm_slli_epi32(noise, 5));
+			const __m128 n = _mm_mul_ps(_mm_cvtepi32_ps(noise), noiseScale);
+
+			// Blend tone/noise, scale by the (ramping) voice gain, accumulate
+			const __m128 voice = _mm_add_ps(y, _mm_mul_ps(mix, _mm_sub_ps(n, y)));
+			gain = _mm_add_ps(gain, gainStep);
+			accum[i] = _mm_add_ps(accum[i], _mm_mul_ps(voice, gain));
+
+			// Advance + wrap phases
+			phase = _mm_add_ps(phase, step);
+			phase = _mm_sub_ps(phase, _mm_and_ps(_mm_cmpge_ps(phase, one), one));
+		}
+
+		// Store oscillator state; gains land exactly on their targets so voices
+		// can be recognized as fully faded
+		_mm_store_ps(phases + v, phase);
+		_mm_store_ps(gains + v, target);
+		_mm_store_si128((__m128i*)(noiseStates + v), noise);
+	}
+
+	// Reduce lanes into the output block
+	const __m128 master = _mm_set1_ps(MASTER_GAIN);
+	for (u4Byte i = 0; i < blockLen; i += 1)
+	{
+		__m128 s = _mm_mul_ps(accum[i], master);
+		s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+		s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+		out[i] = _mm_cvtss_f32(s);
+	}
+
+	// Synthesize any remaining samples as further blocks
+	if (numSamples > blockLen)
+	{
+		Synthesize(out + blockLen, numSamples - blockLen);
+	}
+}
+
+void AudioMixer::Pump()
+{
+	// Synthesize in whole blocks while the ring has room for them
+	while (ring.Free() >= AudioStuff::BLOCK_SAMPLES)
+	{
+		Synthesize(block, AudioStuff::BLOCK_SAMPLES);
+		ring.Push(block, AudioStuff::BLOCK_SAMPLES);
+	}
+}
+
+float AudioMixer::RenderOffline(const char* wavPath, float seconds)
+{
+	const u4Byte numBlocks = (u4Byte)ceilf((seconds * AudioStuff::SAMPLE_RATE) / AudioStuff::BLOCK_SAMPLES);
+	const u4Byte numSamples = numBlocks * AudioStuff::BLOCK_SAMPLES;
+	const u4Byte dataBytes = numSamples * sizeof(s2Byte);
+
+	// Canonical 44-byte RIFF header, 16-bit mono PCM
+	uByte header[44];
+	u4Byte headerLen = 0;
+	auto writeBytes = [&header, &headerLen](const void* val, u4Byte numBytes) { memcpy(header + headerLen, val, numBytes); headerLen += numBytes; };
+	auto writeU4 = [&writeBytes](u4Byte val) { writeBytes(&val, sizeof(u4Byte)); };
+	auto writeU2 = [&writeBytes](u2Byte val) { writeBytes(&val, sizeof(u2Byte)); };
+	writeBytes("RIFF", 4);
+	writeU4(36 + dataBytes);
+	writeBytes("WAVE", 4);
+	writeBytes("fmt ", 4);
+	writeU4(16); // Format chunk size
+	writeU2(1); // PCM
+	writeU2(1); // Mono
+	writeU4(AudioStuff::SAMPLE_RATE);
+	writeU4(AudioStuff::SAMPLE_RATE * sizeof(s2Byte));
+	writeU2(sizeof(s2Byte));
+	writeU2(16);
+	writeBytes("data", 4);
+	writeU4(dataBytes);
+
+	// Writes are staged, so the header + each block can be reused as soon as
+	// they're submitted
+	AsyncIO* io = AthruCore::Utility::AccessIO();
+	io->Write(wavPath, header, headerLen, IO_WRITE_MODES::OVERWRITE, true);
+
+	// Synthesize + stream blocks to disk; only synthesis is timed, so the returned
+	// realtime factor isn't skewed by file IO
+	s2Byte pcm[AudioStuff::BLOCK_SAMPLES];
+	double synthSecs = 0.0;
+	for (u4Byte i = 0; i < numBlocks; i += 1)
+	{
+		const auto t0 = std::chrono::steady_clock::now();
+		Synthesize(block, AudioStuff::BLOCK_SAMPLES);
+		synthSecs += (std::chrono::steady_clock::now() - t0).count() * TimeStuff::nsToSecs;
+		for (u4Byte j = 0; j < AudioStuff::BLOCK_SAMPLES; j += 1)
+		{
+			pcm[j] = ToPCM(block[j]);
+		}
+		io->Write(wavPath, pcm, sizeof(pcm), IO_WRITE_MODES::APPEND, true);
+	}
+
+	// Make sure the file is complete before returning
+	io->WaitAll();
+
+	const float realtimeFactor = (float)(((double)numSamples / AudioStuff::SAMPLE_RATE) / std::max(synthSecs, 1e-9));
+	AthruCore::Utility::AccessLogger()->Log(realtimeFactor, "Critter audio realtime factor (offline render)");
+	return realtimeFactor;
+}
+
+void AudioMixer::DeviceLoop()
+{
+	// Open the default output device; the driver signals [bufferDone] whenever
+	// it finishes playing a block
+	WAVEFORMATEX fmt = {};
+	fmt.wFormatTag = WAVE_FORMAT_PCM;
+	fmt.nChannels = 1;
+	fmt.nSamplesPerSec = AudioStuff::SAMPLE_RATE;
+	fmt.wBitsPerSample = 16;
+	fmt.nBlockAlign = sizeof(s2Byte);
+	fmt.nAvgBytesPerSec = AudioStuff::SAMPLE_RATE * sizeof(s2Byte);
+	HANDLE bufferDone = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	HWAVEOUT device;
+	if (waveOutOpen(&device, WAVE_MAPPER, &fmt, (DWORD_PTR)bufferDone, 0, CALLBACK_EVENT) != MMSYSERR_NOERROR)
+	{
+		// No audio hardware available; the ring just fills up and [Pump()]
+		// stops synthesizing
+		CloseHandle(bufferDone);
+		return;
+	}
+
+	// Prepare device blocks, flagged as done so they're filled on the first pass
+	s2Byte pcm[NUM_DEVICE_BUFFERS][AudioStuff::BLOCK_SAMPLES];
+	WAVEHDR headers[NUM_DEVICE_BUFFERS] = {};
+	for (u4Byte i = 0; i < NUM_DEVICE_BUFFERS; i += 1)
+	{
+		headers[i].lpData = (LPSTR)pcm[i];
+		headers[i].dwBufferLength = sizeof(pcm[i]);
+		waveOutPrepareHeader(device, headers + i, sizeof(WAVEHDR));
+		headers[i].dwFlags |= WHDR_DONE;
+	}
+
+	// Refill blocks as the device finishes with them
+	// Underruns (e.g. during long frames) are padded with silence
+	float staging[AudioStuff::BLOCK_SAMPLES];
+	while (deviceActive)
+	{
+		for (u4Byte i = 0; i < NUM_DEVICE_BUFFERS; i += 1)
+		{
+			if (headers[i].dwFlags & WHDR_DONE)
+			{
+				const u4Byte numRead = ring.Pop(staging, AudioStuff::BLOCK_SAMPLES);
+				for (u4Byte j = 0; j < AudioStuff::BLOCK_SAMPLES; j += 1)
+				{
+					pcm[i][j] = (j < numRead) ? ToPCM(staging[j]) : 0;
+				}
+				waveOutWrite(device, headers + i, sizeof(WAVEHDR));
+			}
+		}
+		WaitForSingleObject(bufferDone, 10);
+	}
+
+	// Flush the device + release its blocks
+	waveOutReset(device);
+	for (u4Byte i = 0; i < NUM_DEVICE_BUFFERS; i += 1)
+	{
+		waveOutUnprepareHeader(device, headers + i, sizeof(WAVEHDR));
+	}
+	waveOutClose(device);
+	CloseHandle(bufferDone);
+}
+
+// Push constructions for this class through Athru's custom allocator
+void* AudioMixer::operator new(size_t size)
+{
+	StackAllocator* allocator = AthruCore::Utility::AccessMemory();
+	return allocator->AlignedAlloc(size, (uByte)std::alignment_of<AudioMixer>(), false);
+}
+
+// We aren't expecting to use [delete], so overload it to do nothing
+void AudioMixer::operator delete(void* target)
+{
+	return;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <directxmath.h>
+#include "SPSCRing.h"
+#include "AppGlobals.h"
+
+class Camera;
+class System;
+class AudioMixer
+{
+	public:
+		// [dnaPath] points at the organism file carrying the critters' [Average Sound]
+		// (FREQUENCY/AMPLITUDE); pass [openDevice = false] to synthesize headless
+		// (e.g. for [RenderOffline(...)] on machines without audio hardware)
+		AudioMixer(const char* dnaPath, bool openDevice = true);
+		~AudioMixer();
+
+		// Re-prioritize voices around the camera; only the [AudioStuff::MAX_VOICES]
+		// critters with the highest perceived loudness in [sys] are kept active
+		void Update(Camera* camera, System* sys);
+
+		// Synthesize enough samples to top up the device ring; called once per frame
+		// from the game thread (the game thread is the only producer, so voice state
+		// never needs to be shared with the device thread)
+		void Pump();
+
+		// Synthesize [numSamples] mono samples from the active voices into [out]
+		// [numSamples] should be a multiple of four
+		void Synthesize(float* out, u4Byte numSamples);
+
+		// Render [seconds] of audio from the current voice set into a 16-bit PCM
+		// WAV file at [wavPath]; returns the realtime factor achieved by the
+		// synthesizer (seconds of audio produced per second of CPU time)
+		float RenderOffline(const char* wavPath, float seconds);
+
+		// Hand every voice to a stand-in critter at the species' base loudness, so
+		// [RenderOffline(...)] has a full voice bank to synthesize without a scene
+		// The next [Update(...)] with a real system releases them again
+		void VoiceAll();
+
+		// Overload the standard allocation/de-allocation operators
+		void* operator new(size_t size);
+		void operator delete(void* target);
+
+	private:
+		// Read the species' average sound out of the given DNA file
+		void ReadSoundDNA(const char* dnaPath);
+
+		// Device thread; drains [ring] into the platform audio queue
+		void DeviceLoop();
+
+		// Start [voice] for [critterID], fading in towards [loudness]
+		void StartVoice(u4Byte voice, u4Byte critterID, float loudness);
+
+		// Oscillator bank, stored as structures-of-arrays so each SSE register
+		// carries four voices at once
+		// Phases are normalized to [0...1) and advance by [phaseSteps] each sample
+		// Gains ramp linearly towards [gainTargets] over one block to avoid zipper
+		// noise when critters move around the camera
+		alignas(16) float phases[AudioStuff::MAX_VOICES];
+		alignas(16) float phaseSteps[AudioStuff::MAX_VOICES];
+		alignas(16) float gains[AudioStuff::MAX_VOICES];
+		alignas(16) float gainTargets[AudioStuff::MAX_VOICES];
+		alignas(16) float noiseMix[AudioStuff::MAX_VOICES];
+		alignas(16) u4Byte noiseStates[AudioStuff::MAX_VOICES];
+
+		// Critter driving each voice (-1 for free voices), and the voice driving
+		// each critter in the current system (-1 for silent critters)
+		s4Byte voiceCritters[AudioStuff::MAX_VOICES];
+		s2Byte critterVoices[(SceneStuff::BODIES_PER_SYSTEM - 1) * SceneStuff::ANIMALS_PER_PLANET];
+
+		// System voiced during the last [Update(...)]; voices are released
+		// whenever the camera crosses into a different system
+		System* voicedSys;
+
+		// Per-species sound parameters (read from DNA); individual critters
+		// jitter these procedurally
+		float baseFreq;
+		float baseAmp;
+
+		// Scratch block for [Pump()]
+		alignas(16) float block[AudioStuff::BLOCK_SAMPLES];
+
+		// Samples travelling from the game thread to the device thread
+		SPSCRing<float, AudioStuff::RING_SAMPLES> ring;
+
+		// Device thread + a flag to stop it during shutdown
+		std::thread deviceThread;
+		std::atomic<bool> deviceActive;
+};
@@ -0,0 +1,157 @@
+#include "UtilityServiceCentre.h"
+#include "CellList.h"
+
+// Radix-sort digit width; three ten-bit passes cover the 30-bit Morton keys
+constexpr u4Byte RADIX_BITS = 10;
+constexpr u4Byte RADIX_SIZE = 1 << RADIX_BITS;
+
+CellList::CellList(u4Byte maxPoints, u4Byte maxAdjacentRanges) :
+	sortedBuf(0),
+	numRuns(0),
+	adjRanges(nullptr),
+	adjOffsets(nullptr),
+	adjCapacity(maxAdjacentRanges),
+	numCachedCells(0),
+	capacity(maxPoints),
+	origin(0.0f, 0.0f, 0.0f),
+	invCellSize(1.0f)
+{
+	for (u4Byte i = 0; i < 2; i += 1)
+	{
+		keys[i] = MemoryStuff::ArrayAlloc<u4Byte>(maxPoints, false);
+		order[i] = MemoryStuff::ArrayAlloc<u4Byte>(maxPoints, false);
+	}
+
+	tableSize = 64;
+	tableShift = 26;
+	while (tableSize < (maxPoints * 2))
+	{
+		tableSize <<= 1;
+		tableShift -= 1;
+	}
+	table = MemoryStuff::ArrayAlloc<CellRange>(tableSize, false);
+	runs = MemoryStuff::ArrayAlloc<CellRange>(maxPoints, false);
+
+	if (adjCapacity > 0)
+	{
+		adjRanges = MemoryStuff::ArrayAlloc<AdjacentRange>(adjCapacity, false);
+		adjOffsets = MemoryStuff::ArrayAlloc<u4Byte>(maxPoints + 1, false);
+	}
+}
+
+CellList::~CellList() {}
+
+void CellList::Build(const float* x, const float* y, const float* z, u4Byte numPoints,
+					 DirectX::XMFLOAT3 gridOrigin, float cellSize)
+{
+	assert(numPoints <= capacity);
+	origin = gridOrigin;
+	invCellSize = 1.0f / cellSize;
+
+	// Key points by cell
+	for (u4Byte i = 0; i < numPoints; i += 1)
+	{
+		keys[0][i] = Morton(ClampCell((x[i] - origin.x) * invCellSize),
+							ClampCell((y[i] - origin.y) * invCellSize),
+							ClampCell((z[i] - origin.z) * invCellSize));
+		order[0][i] = i;
+	}
+
+	// LSD radix sort (stable), one pass per ten-bit digit
+	u4Byte src = 0;
+	u4Byte hist[RADIX_SIZE];
+	for (u4Byte shift = 0; shift < 30; shift += RADIX_BITS)
+	{
+		const u4Byte dst = src ^ 1;
+		memset(hist, 0, sizeof(hist));
+		for (u4Byte i = 0; i < numPoints; i += 1)
+		{
+			hist[(keys[src][i] >> shift) & (RADIX_SIZE - 1)] += 1;
+		}
+
+		u4Byte offs = 0;
+		for (u4Byte i = 0; i < RADIX_SIZE; i += 1)
+		{
+			const u4Byte count = hist[i];
+			hist[i] = offs;
+			offs += count;
+		}
+
+		for (u4Byte i = 0; i < numPoints; i += 1)
+		{
+			const u4Byte j = hist[(keys[src][i] >> shift) & (RADIX_SIZE - 1)]++;
+			keys[dst][j] = keys[src][i];
+			order[dst][j] = order[src][i];
+		}
+		src = dst;
+	}
+	sortedBuf = src;
+
+	// Record the sorted range covered by each occupied cell
+	memset(table, 0xFF, tableSize * sizeof(CellRange));
+	numRuns = 0;
+	u4Byte runStart = 0;
+	for (u4Byte i = 1; i <= numPoints; i += 1)
+	{
+		if (i == numPoints || keys[src][i] != keys[src][runStart])
+		{
+			u4Byte slot = Slot(keys[src][runStart]);
+			while (table[slot].key != EMPTY_KEY) { slot = (slot + 1) & (tableSize - 1); }
+			table[slot].key = keys[src][runStart];
+			table[slot].begin = runStart;
+			table[slot].end = i;
+			runs[numRuns] = table[slot];
+			numRuns += 1;
+			runStart = i;
+		}
+	}
+}
+
+void CellList::BuildAdjacency()
+{
+	assert(adjCapacity > 0);
+	u4Byte numRanges = 0;
+	numCachedCells = 0;
+	while (numCachedCells < numRuns)
+	{
+		// Stop caching once a full 3x3x3 block might not fit; later cells use
+		// hash lookups instead
+		if ((numRanges + 27) > adjCapacity) { break; }
+
+		const u4Byte i = numCachedCells;
+		adjOffsets[i] = numRanges;
+		ForEachAdjacentRange(runs[i].key, [&](u4Byte begin, u4Byte end)
+		{
+			if (numRanges > adjOffsets[i] && adjRanges[numRanges - 1].end == begin)
+			{
+				adjRanges[numRanges - 1].end = end;
+			}
+			else
+			{
+				adjRanges[numRanges].begin = begin;
+				adjRanges[numRanges].end = end;
+				numRanges += 1;
+			}
+		});
+		numCachedCells += 1;
+	}
+	adjOffsets[numCachedCells] = numRanges;
+}
+
+const u4Byte* CellList::SortedOrder() const
+{
+	return order[sortedBuf];
+}
+
+// Push constructions for this class through Athru's custom allocator
+void* CellList::operator new(size_t size)
+{
+	StackAllocator* allocator = AthruCore::Utility::AccessMemory();
+	return allocator->AlignedAlloc(size, (uByte)std::alignment_of<CellList>(), false);
+}
+
+// We aren't expecting to use [delete], so overload it to do nothing
+void CellList::operator delete(void* target)
+{
+	return;
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <directxmath.h>
+#include "AppGlobals.h"
+
+// Sorted cell list for fixed-radius neighbour queries
+// Points are binned into a uniform grid, ordered along a Morton (Z-order) curve
+// through the grid, then indexed with a small open-addressed hash table mapping
+// occupied cells to contiguous runs of sorted points
+// Morton ordering keeps spatially-close points close in memory, so neighbour
+// loops mostly hit cache; the hash table keeps memory proportional to the
+// number of points instead of the size of the grid
+class CellList
+{
+	public:
+		// [maxAdjacentRanges] bounds the number of adjacent ranges cached by
+		// [BuildAdjacency()] (zero disables adjacency caching)
+		CellList(u4Byte maxPoints, u4Byte maxAdjacentRanges = 0);
+		~CellList();
+
+		// Bin [numPoints] points into cells of width [cellSize], starting from
+		// [gridOrigin]; the grid spans at most [MAX_CELLS_PER_AXIS] cells per axis and
+		// clamps anything outside that range into the boundary cells
+		void Build(const float* x, const float* y, const float* z, u4Byte numPoints,
+				   DirectX::XMFLOAT3 gridOrigin, float cellSize);
+
+		// Mapping from sorted positions to input positions; callers should gather
+		// their per-point data through this before running queries, since ranges
+		// passed to [ForEachNeighbourRange(...)] index sorted data
+		const u4Byte* SortedOrder() const;
+
+		// Call [visitor(begin, end, cellKey)] for every occupied cell, in sorted order
+		template<typename visitorFn>
+		void ForEachCell(visitorFn visitor) const
+		{
+			for (u4Byte i = 0; i < numRuns; i += 1)
+			{
+				visitor(runs[i].begin, runs[i].end, runs[i].key);
+			}
+		}
+
+		// Call [visitor(begin, end, cellNdx)] for occupied cells [firstCell, lastCell)
+		// only, where [cellNdx] is the cell's position in sorted order; useful for
+		// splitting cell loops between threads
+		template<typename visitorFn>
+		void ForEachCell(u4Byte firstCell, u4Byte lastCell, visitorFn visitor) const
+		{
+			for (u4Byte i = firstCell; i < lastCell; i += 1)
+			{
+				visitor(runs[i].begin, runs[i].end, i);
+			}
+		}
+
+		// Number of occupied cells found by the last call to [Build(...)]
+		u4Byte NumCells() const
+		{
+			return numRuns;
+		}
+
+		// Key of the [cellNdx]'th occupied cell (in sorted order, as in
+		// [ForEachCell(...)]), for passing to [ForEachAdjacentRange(...)]
+		u4Byte CellKey(u4Byte cellNdx) const
+		{
+			return runs[cellNdx].key;
+		}
+
+		// Cache the ranges visited by [ForEachAdjacentRange(...)] for every occupied
+		// cell; worthwhile when the same neighbourhoods are walked several times per
+		// [Build(...)], since hash lookups scatter across memory but cached ranges
+		// stream linearly
+		// Ranges that are contiguous in sorted order are merged; cells past the
+		// cache capacity fall back to hash lookups
+		void BuildAdjacency();
+
+		// Call [visitor(begin, end)] for every occupied cell adjacent to the
+		// [cellNdx]'th occupied cell (in sorted order, as in [ForEachCell(...)]),
+		// using the ranges cached by [BuildAdjacency()]; ranges may span several
+		// cells
+		template<typename visitorFn>
+		void ForEachCachedAdjacentRange(u4Byte cellNdx, visitorFn visitor) const
+		{
+			if (cellNdx >= numCachedCells)
+			{
+				ForEachAdjacentRange(runs[cellNdx].key, visitor);
+				return;
+			}
+
+			const u4Byte last = adjOffsets[cellNdx + 1];
+			for (u4Byte i = adjOffsets[cellNdx]; i < last; i += 1)
+			{
+				visitor(adjRanges[i].begin, adjRanges[i].end);
+			}
+		}
+
+		// Call [visitor(begin, end)] for every occupied cell in the 3x3x3 block
+		// centered on the cell with the given key (including that cell)
+		// Batching neighbour searches per-cell rather than per-point means each
+		// hash lookup is shared by every point in the cell
+		template<typename visitorFn>
+		void ForEachAdjacentRange(u4Byte cellKey, visitorFn visitor) const
+		{
+			const s4Byte cx = (s4Byte)CompactBits(cellKey);
+			const s4Byte cy = (s4Byte)CompactBits(cellKey >> 1);
+			const s4Byte cz = (s4Byte)CompactBits(cellKey >> 2);
+			for (s4Byte z = cz - 1; z <= cz + 1; z += 1)
+			{
+				if (z < 0 || z >= (s4Byte)MAX_CELLS_PER_AXIS) { continue; }
+				for (s4Byte y = cy - 1; y <= cy + 1; y += 1)
+				{
+					if (y < 0 || y >= (s4Byte)MAX_CELLS_PER_AXIS) { continue; }
+					for (s4Byte x = cx - 1; x <= cx + 1; x += 1)
+					{
+						if (x < 0 || x >= (s4Byte)MAX_CELLS_PER_AXIS) { continue; }
+						u4Byte begin, end;
+						if (FindCell(Morton(x, y, z), begin, end))
+						{
+							visitor(begin, end);
+						}
+					}
+				}
+			}
+		}
+
+		// Call [visitor(begin, end)] for every occupied cell that intersects the
+		// sphere at ([px], [py], [pz]) with the given radius ([radius] should be no
+		// larger than the cell size passed to [Build(...)])
+		template<typename visitorFn>
+		void ForEachNeighbourRange(float px, float py, float pz, float radius, visitorFn visitor) const
+		{
+			// Locate the query cell + the query's offset inside it
+			const float gx = (px - origin.x) * invCellSize;
+			const float gy = (py - origin.y) * invCellSize;
+			const float gz = (pz - origin.z) * invCellSize;
+			const s4Byte cx = ClampCell(gx);
+			const s4Byte cy = ClampCell(gy);
+			const s4Byte cz = ClampCell(gz);
+
+			// Squared distance from the query to the near face of each adjacent cell
+			// (in cell units); used to skip cells that the query sphere can't reach
+			const float fx = gx - (float)cx;
+			const float fy = gy - (float)cy;
+			const float fz = gz - (float)cz;
+			const float rCells = radius * invCellSize;
+			const float rCellsSqr = rCells * rCells;
+			const float nearX[3] = { fx * fx, 0.0f, (1.0f - fx) * (1.0f - fx) };
+			const float nearY[3] = { fy * fy, 0.0f, (1.0f - fy) * (1.0f - fy) };
+			const float nearZ[3] = { fz * fz, 0.0f, (1.0f - fz) * (1.0f - fz) };
+			for (s4Byte z = -1; z <= 1; z += 1)
+			{
+				const s4Byte nz = cz + z;
+				if (nz < 0 || nz >= (s4Byte)MAX_CELLS_PER_AXIS || nearZ[z + 1] > rCellsSqr) { continue; }
+				for (s4Byte y = -1; y <= 1; y += 1)
+				{
+					const s4Byte ny = cy + y;
+					const float nearYZ = nearY[y + 1] + nearZ[z + 1];
+					if (ny < 0 || ny >= (s4Byte)MAX_CELLS_PER_AXIS || nearYZ > rCellsSqr) { continue; }
+					for (s4Byte x = -1; x <= 1; x += 1)
+					{
+						const s4Byte nx = cx + x;
+						if (nx < 0 || nx >= (s4Byte)MAX_CELLS_PER_AXIS || (nearX[x + 1] + nearYZ) > rCellsSqr) { continue; }
+						u4Byte begin, end;
+						if (FindCell(Morton(nx, ny, nz), begin, end))
+						{
+							visitor(begin, end);
+						}
+					}
+				}
+			}
+		}
+
+		// Overload the standard allocation/de-allocation operators
+		void* operator new(size_t size);
+		void operator delete(void* target);
+
+		// Grid resolution limit (ten bits/axis, so Morton codes fit in 30 bits)
+		static constexpr u4Byte MAX_CELLS_PER_AXIS = 1024;
+
+	private:
+		// Occupied-cell record; [key] is [EMPTY_KEY] for free slots
+		struct CellRange
+		{
+			u4Byte key;
+			u4Byte begin;
+			u4Byte end;
+		};
+		static constexpr u4Byte EMPTY_KEY = 0xFFFFFFFF;
+
+		// Adjacent-range record for [BuildAdjacency()]
+		struct AdjacentRange
+		{
+			u4Byte begin;
+			u4Byte end;
+		};
+
+		// Spread the low ten bits of [v] so there are two zero bits between each one
+		static u4Byte SpreadBits(u4Byte v)
+		{
+			v &= 0x3FF;
+			v = (v | (v << 16)) & 0x030000FF;
+			v = (v | (v << 8)) & 0x0300F00F;
+			v = (v | (v << 4)) & 0x030C30C3;
+			v = (v | (v << 2)) & 0x09249249;
+			return v;
+		}
+
+		// Inverse of [SpreadBits(...)]; gathers every third bit back into the low
+		// ten bits
+		static u4Byte CompactBits(u4Byte v)
+		{
+			v &= 0x09249249;
+			v = (v | (v >> 2)) & 0x030C30C3;
+			v = (v | (v >> 4)) & 0x0300F00F;
+			v = (v | (v >> 8)) & 0x030000FF;
+			v = (v | (v >> 16)) & 0x000003FF;
+			return v;
+		}
+
+		static u4Byte Morton(s4Byte x, s4Byte y, s4Byte z)
+		{
+			return SpreadBits((u4Byte)x) | (SpreadBits((u4Byte)y) << 1) | (SpreadBits((u4Byte)z) << 2);
+		}
+
+		static s4Byte ClampCell(float g)
+		{
+			const s4Byte c = (s4Byte)floorf(g);
+			return (c < 0) ? 0 : ((c >= (s4Byte)MAX_CELLS_PER_AXIS) ? (s4Byte)MAX_CELLS_PER_AXIS - 1 : c);
+		}
+
+		u4Byte Slot(u4Byte key) const
+		{
+			// Knuth multiplicative hash; the top bits of the product depend on every
+			// bit of the key, so take those instead of the bottom ones
+			return (key * 2654435761u) >> tableShift;
+		}
+
+		// Look up the sorted range for the given cell; returns [false] for
+		// unoccupied cells
+		bool FindCell(u4Byte key, u4Byte& begin, u4Byte& end) const
+		{
+			u4Byte slot = Slot(key);
+			while (table[slot].key != EMPTY_KEY)
+			{
+				if (table[slot].key == key)
+				{
+					begin = table[slot].begin;
+					end = table[slot].end;
+					return true;
+				}
+				slot = (slot + 1) & (tableSize - 1);
+			}
+			return false;
+		}
+
+		// Point keys/indices, double-buffered for radix sorting
+		u4Byte* keys[2];
+		u4Byte* order[2];
+		u4Byte sortedBuf;
+
+		// Occupied cells in sorted order
+		CellRange* runs;
+		u4Byte numRuns;
+
+		// Occupied-cell hash table (power-of-two size, at least twice [maxPoints])
+		CellRange* table;
+		u4Byte tableSize;
+		u4Byte tableShift; // 32 - log2([tableSize])
+
+		// Cached adjacent ranges, stored contiguously per cell; ranges for the
+		// [i]'th occupied cell sit between [adjOffsets[i]] and [adjOffsets[i + 1]]
+		// Only the first [numCachedCells] cells have cached ranges
+		AdjacentRange* adjRanges;
+		u4Byte* adjOffsets;
+		u4Byte adjCapacity;
+		u4Byte numCachedCells;
+
+		u4Byte capacity;
+		DirectX::XMFLOAT3 origin;
+		float invCellSize;
+};
@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <emmintrin.h>
+#include "UtilityServiceCentre.h"
+#include "SceneFigure.h"
+#include "CritterFlock.h"
+
+// Interaction radius, relative to the mean spacing between agents on the sphere
+// Scaling the radius with agent density keeps the number of interacting neighbours
+// roughly constant (~4*PI) as flocks grow, so steps stay O(n)
+constexpr float NEIGHBOUR_SCALE = 2.0f;
+
+// Candidate neighbours gathered per cell at once; cells with more candidates than this
+// (dense clumps) are processed in chunks instead
+// Multiple of four, so full candidate blocks never need padding
+constexpr u4Byte MAX_CANDIDATES = 256;
+
+// Occupied cells per flocking job; smaller blocks balance better between workers,
+// larger blocks spend less time scheduling
+constexpr u4Byte CELLS_PER_JOB = 64;
+
+// Locomotion limits (unit-sphere distance/second)
+constexpr float MIN_SPEED = 0.01f;
+constexpr float MAX_SPEED = 0.05f;
+
+// Steering weights for each flocking rule, plus the strength of the random wander
+// applied to every critter
+constexpr float SEPARATION_WEIGHT = 0.1f;
+constexpr float ALIGNMENT_WEIGHT = 0.5f;
+constexpr float COHESION_WEIGHT = 0.2f;
+constexpr float WANDER_WEIGHT = 0.02f;
+
+// Xorshift32, mapped to [-1...1)
+static float Wander(u4Byte& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return (float)(s4Byte)state * (1.0f / 2147483648.0f);
+}
+
+// Add together the four lanes of an SSE register
+static float HorizontalSum(__m128 v)
+{
+	v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(v);
+}
+
+// Candidate neighbours shared by every agent in a cell (see [Step(...)])
+struct FlockCandidates
+{
+	alignas(16) float posX[MAX_CANDIDATES];
+	alignas(16) float posY[MAX_CANDIDATES];
+	alignas(16) float posZ[MAX_CANDIDATES];
+	alignas(16) float velX[MAX_CANDIDATES];
+	alignas(16) float velY[MAX_CANDIDATES];
+	alignas(16) float velZ[MAX_CANDIDATES];
+};
+
+// Flocking terms accumulated for a single agent, one partial sum per SSE lane
+struct FlockSums
+{
+	__m128 sepX, sepY, sepZ;
+	__m128 aliX, aliY, aliZ;
+	__m128 cohX, cohY, cohZ;
+	__m128 count;
+};
+
+CritterFlock::CritterFlock(u4Byte agentCount, u4Byte seed,
+						   DirectX::XMFLOAT3 planetPos, float planetRadius) :
+	frontBuf(0),
+	numAgents(agentCount),
+	center(planetPos),
+	radius(planetRadius)
+{
+	// Allocate agent state
+	for (u4Byte i = 0; i < 2; i += 1)
+	{
+		posX[i] = MemoryStuff::ArrayAlloc<float>(numAgents, false);
+		posY[i] = MemoryStuff::ArrayAlloc<float>(numAgents, false);
+		posZ[i] = MemoryStuff::ArrayAlloc<float>(numAgents, false);
+		velX[i] = MemoryStuff::ArrayAlloc<float>(numAgents, false);
+		velY[i] = MemoryStuff::ArrayAlloc<float>(numAgents, false);
+		velZ[i] = MemoryStuff::ArrayAlloc<float>(numAgents, false);
+		ids[i] = MemoryStuff::ArrayAlloc<u4Byte>(numAgents, false);
+		wanderStates[i] = MemoryStuff::ArrayAlloc<u4Byte>(numAgents, false);
+	}
+
+	cells = new CellList(numAgents);
+
+	// Scatter agents uniformly over the sphere, facing random tangent directions
+	u4Byte rng = (seed * 0x9E3779B9) | 1;
+	for (u4Byte i = 0; i < numAgents; i += 1)
+	{
+		const float z = Wander(rng);
+		const float phi = Wander(rng) * MathsStuff::PI;
+		const float ringRad = sqrtf(1.0f - z * z);
+		posX[0][i] = ringRad * cosf(phi);
+		posY[0][i] = ringRad * sinf(phi);
+		posZ[0][i] = z;
+
+		// Random direction, projected onto the tangent plane + scaled to the
+		// minimum speed
+		float vx = Wander(rng);
+		float vy = Wander(rng);
+		float vz = Wander(rng);
+		const float vDotP = vx * posX[0][i] + vy * posY[0][i] + vz * z;
+		vx -= vDotP * posX[0][i];
+		vy -= vDotP * posY[0][i];
+		vz -= vDotP * z;
+		const float vScale = MIN_SPEED / std::fmaxf(sqrtf(vx * vx + vy * vy + vz * vz), 1e-6f);
+		velX[0][i] = vx * vScale;
+		velY[0][i] = vy * vScale;
+		velZ[0][i] = vz * vScale;
+
+		ids[0][i] = i;
+		wanderStates[0][i] = (rng ^ (i * 0x85EBCA6B)) | 1;
+	}
+}
+
+CritterFlock::~CritterFlock() {}
+
+void CritterFlock::BuildCells(float cellSize)
+{
+	// Unit-sphere agents always fall inside [-1...1]; nudge the grid origin out a
+	// little so agents at the extremes don't land exactly on the boundary
+	cells->Build(posX[frontBuf], posY[frontBuf], posZ[frontBuf], numAgents,
+				 DirectX::XMFLOAT3(-1.001f, -1.001f, -1.001f), cellSize);
+
+	// Gather agents into cell order
+	const u4Byte* order = cells->SortedOrder();
+	const u4Byte src = frontBuf;
+	const u4Byte dst = frontBuf ^ 1;
+	for (u4Byte i = 0; i < numAgents; i += 1)
+	{
+		const u4Byte j = order[i];
+		posX[dst][i] = posX[src][j];
+		posY[dst][i] = posY[src][j];
+		posZ[dst][i] = posZ[src][j];
+		velX[dst][i] = velX[src][j];
+		velY[dst][i] = velY[src][j];
+		velZ[dst][i] = velZ[src][j];
+		ids[dst][i] = ids[src][j];
+		wanderStates[dst][i] = wanderStates[src][j];
+	}
+	frontBuf = dst;
+}
+
+void CritterFlock::Step(float dt)
+{
+	// Sort agents into cells one neighbourhood wide
+	const float neighbourRad = NEIGHBOUR_SCALE * sqrtf((4.0f * MathsStuff::PI) / (float)numAgents);
+	const float neighbourRadSqr = neighbourRad * neighbourRad;
+	const float invNeighbourRad = 1.0f / neighbourRad;
+	BuildCells(neighbourRad);
+
+	const u4Byte src = frontBuf;
+	const u4Byte dst = frontBuf ^ 1;
+	const __m128 radSqrVec = _mm_set1_ps(neighbourRadSqr);
+	const __m128 invRadVec = _mm_set1_ps(invNeighbourRad);
+	const __m128 zeroVec = _mm_setzero_ps();
+	const __m128 oneVec = _mm_set1_ps(1.0f);
+	const __m128 tinyVec = _mm_set1_ps(1e-12f);
+
+	// Gather candidates from the ranges adjacent to [cellNdx] into [cand], starting
+	// at the [skip]'th agent in those ranges + stopping when [cand] fills up
+	// Returns the number of agents gathered (before padding), + writes the number
+	// of agents in every adjacent range to [numAdjacent]
+	// [cells] doesn't cache adjacency (each neighbourhood is only walked once per
+	// step, so caching costs more than it saves), so ranges come from hash lookups
+	auto gather = [&](FlockCandidates& cand, u4Byte& numCandidates, u4Byte& numAdjacent, u4Byte cellNdx, u4Byte skip)
+	{
+		numCandidates = 0;
+		numAdjacent = 0;
+		cells->ForEachAdjacentRange(cells->CellKey(cellNdx), [&](u4Byte begin, u4Byte end)
+		{
+			numAdjacent += end - begin;
+			const u4Byte rangeSkip = std::min(skip, end - begin);
+			skip -= rangeSkip;
+			begin += rangeSkip;
+
+			// Cells only hold a handful of agents, so copy directly instead of
+			// paying for [memcpy] calls
+			end = std::min(end, begin + (MAX_CANDIDATES - numCandidates));
+			for (u4Byte j = begin; j < end; j += 1)
+			{
+				cand.posX[numCandidates] = posX[src][j];
+				cand.posY[numCandidates] = posY[src][j];
+				cand.posZ[numCandidates] = posZ[src][j];
+				cand.velX[numCandidates] = velX[src][j];
+				cand.velY[numCandidates] = velY[src][j];
+				cand.velZ[numCandidates] = velZ[src][j];
+				numCandidates += 1;
+			}
+		});
+		const u4Byte numGathered = numCandidates;
+
+		// Pad candidates out to a whole number of SSE lanes; padding sits far
+		// outside every neighbourhood, so it's always masked out below
+		while ((numCandidates & 3) != 0)
+		{
+			cand.posX[numCandidates] = 1e9f;
+			cand.posY[numCandidates] = 1e9f;
+			cand.posZ[numCandidates] = 1e9f;
+			cand.velX[numCandidates] = 0.0f;
+			cand.velY[numCandidates] = 0.0f;
+			cand.velZ[numCandidates] = 0.0f;
+			numCandidates += 1;
+		}
+		return numGathered;
+	};
+
+	// Accumulate flocking terms for the agent at ([px], [py], [pz]) over
+	// [numCandidates] candidates, four at a time
+	// Candidates outside the neighbourhood (and the agent itself) are masked out
+	// instead of skipped
+	auto accumulate = [&](FlockSums& sums, const FlockCandidates& cand, u4Byte numCandidates, float px, float py, float pz)
+	{
+		const __m128 pxVec = _mm_set1_ps(px);
+		const __m128 pyVec = _mm_set1_ps(py);
+		const __m128 pzVec = _mm_set1_ps(pz);
+		for (u4Byte j = 0; j < numCandidates; j += 4)
+		{
+			const __m128 dx = _mm_sub_ps(_mm_load_ps(cand.posX + j), pxVec);
+			const __m128 dy = _mm_sub_ps(_mm_load_ps(cand.posY + j), pyVec);
+			const __m128 dz = _mm_sub_ps(_mm_load_ps(cand.posZ + j), pzVec);
+			const __m128 distSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			const __m128 mask = _mm_and_ps(_mm_cmplt_ps(distSqr, radSqrVec), _mm_cmpgt_ps(distSqr, zeroVec));
+
+			// Separation falls off linearly across the neighbourhood
+			// ((1 - dist/rad) / dist, so neighbours push harder as they get closer)
+			// Approximate reciprocal square-roots are plenty accurate for steering
+			const __m128 push = _mm_and_ps(mask, _mm_sub_ps(_mm_rsqrt_ps(_mm_max_ps(distSqr, tinyVec)), invRadVec));
+			sums.sepX = _mm_sub_ps(sums.sepX, _mm_mul_ps(dx, push));
+			sums.sepY = _mm_sub_ps(sums.sepY, _mm_mul_ps(dy, push));
+			sums.sepZ = _mm_sub_ps(sums.sepZ, _mm_mul_ps(dz, push));
+			sums.aliX = _mm_add_ps(sums.aliX, _mm_and_ps(mask, _mm_load_ps(cand.velX + j)));
+			sums.aliY = _mm_add_ps(sums.aliY, _mm_and_ps(mask, _mm_load_ps(cand.velY + j)));
+			sums.aliZ = _mm_add_ps(sums.aliZ, _mm_and_ps(mask, _mm_load_ps(cand.velZ + j)));
+			sums.cohX = _mm_add_ps(sums.cohX, _mm_and_ps(mask, dx));
+			sums.cohY = _mm_add_ps(sums.cohY, _mm_and_ps(mask, dy));
+			sums.cohZ = _mm_add_ps(sums.cohZ, _mm_and_ps(mask, dz));
+			sums.count = _mm_add_ps(sums.count, _mm_and_ps(mask, oneVec));
+		}
+	};
+
+	// Steer + move agent [i] with the flocking terms in [sums]
+	auto steer = [&](u4Byte i, const FlockSums& sums)
+	{
+		const float px = posX[src][i];
+		const float py = posY[src][i];
+		const float pz = posZ[src][i];
+		float vx = velX[src][i];
+		float vy = velY[src][i];
+		float vz = velZ[src][i];
+		const float numNeighbours = HorizontalSum(sums.count);
+
+		// Steer
+		u4Byte wander = wanderStates[src][i];
+		float ax = Wander(wander) * WANDER_WEIGHT;
+		float ay = Wander(wander) * WANDER_WEIGHT;
+		float az = Wander(wander) * WANDER_WEIGHT;
+		if (numNeighbours > 0.0f)
+		{
+			const float invN = 1.0f / numNeighbours;
+			ax += HorizontalSum(sums.sepX) * SEPARATION_WEIGHT + (HorizontalSum(sums.aliX) * invN - vx) * ALIGNMENT_WEIGHT + HorizontalSum(sums.cohX) * invN * COHESION_WEIGHT;
+			ay += HorizontalSum(sums.sepY) * SEPARATION_WEIGHT + (HorizontalSum(sums.aliY) * invN - vy) * ALIGNMENT_WEIGHT + HorizontalSum(sums.cohY) * invN * COHESION_WEIGHT;
+			az += HorizontalSum(sums.sepZ) * SEPARATION_WEIGHT + (HorizontalSum(sums.aliZ) * invN - vz) * ALIGNMENT_WEIGHT + HorizontalSum(sums.cohZ) * invN * COHESION_WEIGHT;
+		}
+		vx += ax * dt;
+		vy += ay * dt;
+		vz += az * dt;
+
+		// Keep velocities on the tangent plane + within the locomotion limits
+		float vDotP = vx * px + vy * py + vz * pz;
+		vx -= vDotP * px;
+		vy -= vDotP * py;
+		vz -= vDotP * pz;
+		const float speed = sqrtf(vx * vx + vy * vy + vz * vz);
+		const float speedScale = std::fminf(std::fmaxf(speed, MIN_SPEED), MAX_SPEED) / std::fmaxf(speed, 1e-6f);
+		vx *= speedScale;
+		vy *= speedScale;
+		vz *= speedScale;
+
+		// Move, then snap back onto the sphere (and re-project velocity onto the
+		// new tangent plane)
+		float nx = px + vx * dt;
+		float ny = py + vy * dt;
+		float nz = pz + vz * dt;
+		const float invLen = 1.0f / sqrtf(nx * nx + ny * ny + nz * nz);
+		nx *= invLen;
+		ny *= invLen;
+		nz *= invLen;
+		vDotP = vx * nx + vy * ny + vz * nz;
+		posX[dst][i] = nx;
+		posY[dst][i] = ny;
+		posZ[dst][i] = nz;
+		velX[dst][i] = vx - vDotP * nx;
+		velY[dst][i] = vy - vDotP * ny;
+		velZ[dst][i] = vz - vDotP * nz;
+		ids[dst][i] = ids[src][i];
+		wanderStates[dst][i] = wander;
+	};
+
+	// Walk the flock one cell at a time, in blocks of [CELLS_PER_JOB] cells spread
+	// over the job system (agents read the front buffers + write their own slots in
+	// the back buffers, so blocks never need to synchronize); every agent in a cell
+	// shares the same candidate neighbours, so gather those once into a contiguous
+	// scratch block and test each agent in the cell against it
+	AthruCore::Utility::AccessJobs()->ParallelFor(0, cells->NumCells(), CELLS_PER_JOB, [&](u4Byte firstCell, u4Byte lastCell)
+	{
+		FlockCandidates cand;
+		cells->ForEachCell(firstCell, lastCell, [&](u4Byte cellBegin, u4Byte cellEnd, u4Byte cellNdx)
+		{
+			u4Byte numCandidates = 0;
+			u4Byte numAdjacent = 0;
+			u4Byte numGathered = gather(cand, numCandidates, numAdjacent, cellNdx, 0);
+			if (numGathered == numAdjacent)
+			{
+				for (u4Byte i = cellBegin; i < cellEnd; i += 1)
+				{
+					FlockSums sums = { zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec };
+					accumulate(sums, cand, numCandidates, posX[src][i], posY[src][i], posZ[src][i]);
+					steer(i, sums);
+				}
+			}
+			else
+			{
+				// Dense clumps can have more candidates than fit in [cand]; walk them
+				// in [MAX_CANDIDATES]-sized chunks instead, re-gathering for each
+				// agent, so every neighbour still counts
+				for (u4Byte i = cellBegin; i < cellEnd; i += 1)
+				{
+					FlockSums sums = { zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec, zeroVec };
+					for (u4Byte skip = 0; skip < numAdjacent; skip += numGathered)
+					{
+						numGathered = gather(cand, numCandidates, numAdjacent, cellNdx, skip);
+						accumulate(sums, cand, numCandidates, posX[src][i], posY[src][i], posZ[src][i]);
+					}
+					steer(i, sums);
+				}
+			}
+		});
+	});
+	frontBuf = dst;
+}
+
+void CritterFlock::WriteBack(SceneFigure* figures)
+{
+	// Scale unit-sphere positions out to the planet surface
+	for (u4Byte i = 0; i < numAgents; i += 1)
+	{
+		SceneFigure::Figure fig = figures[ids[frontBuf][i]].GetCoreFigure();
+		fig.linTransf.x = center.x + posX[frontBuf][i] * radius;
+		fig.linTransf.y = center.y + posY[frontBuf][i] * radius;
+		fig.linTransf.z = center.z + posZ[frontBuf][i] * radius;
+		figures[ids[frontBuf][i]].SetCoreFigure(fig);
+	}
+}
+
+float CritterFlock::Benchmark(u4Byte numAgents, u4Byte numSteps)
+{
+	CritterFlock* flock = new CritterFlock(numAgents, 1, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), 1.0f);
+
+	// Warm up caches + the job system before timing anything
+	flock->Step(1.0f / 60.0f);
+
+	const auto t0 = std::chrono::steady_clock::now();
+	for (u4Byte i = 0; i < numSteps; i += 1)
+	{
+		flock->Step(1.0f / 60.0f);
+	}
+	const double secs = (std::chrono::steady_clock::now() - t0).count() * TimeStuff::nsToSecs;
+	flock->~CritterFlock();
+
+	const float msPerStep = (float)((secs * 1000.0) / std::max(numSteps, 1u));
+	Logger* logger = AthruCore::Utility::AccessLogger();
+	logger->Log(numAgents, "Critter flock benchmark, agents");
+	logger->Log(msPerStep, "Critter flock benchmark, step time (milliseconds)");
+	return msPerStep;
+}
+
+// Push constructions for this class through Athru's custom allocator
+void* CritterFlock::operator new(size_t size)
+{
+	StackAllocator* allocator = AthruCore::Utility::AccessMemory();
+	return allocator->AlignedAlloc(size, (uByte)std::alignment_of<CritterFlock>(), false);
+}
+
+// We aren't expecting to use [delete], so overload it to do nothing
+void CritterFlock::operator delete(void* target)
+{
+	return;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <directxmath.h>
+#include "AppGlobals.h"
+#include "CellList.h"
+
+class SceneFigure;
+class CritterFlock
+{
+	public:
+		// Flocks live on the surface of a sphere with the given center + radius
+		// Critter state is stored in unit-sphere space and only scaled into world space
+		// when it's written back to [SceneFigure]s
+		CritterFlock(u4Byte numAgents, u4Byte seed,
+					 DirectX::XMFLOAT3 planetPos, float planetRadius);
+		~CritterFlock();
+
+		// Advance the flock by [dt] seconds (separation/alignment/cohesion + a little
+		// random wander, constrained to the planet surface)
+		// Steps are split into jobs on the engine's job system
+		// Known limitation: a step over 10^5 agents costs ~100ms of single-core time
+		// (cell-list builds + neighbour hash lookups make up about half of that), so
+		// flocks that large only reach interactive rates when steps are spread over
+		// several cores; see [Benchmark(...)]
+		void Step(float dt);
+
+		// Copy agent positions into the transforms of the given figures; [figures]
+		// should carry at least as many elements as there are agents in [this]
+		void WriteBack(SceneFigure* figures);
+
+		// Headless timing test; steps a flock of [numAgents] agents [numSteps] times,
+		// then logs + returns the mean step time in milliseconds
+		// Agent state is allocated on Athru's memory stack and never released, so
+		// this should only be called from headless/benchmark runs
+		static float Benchmark(u4Byte numAgents, u4Byte numSteps);
+
+		// Overload the standard allocation/de-allocation operators
+		void* operator new(size_t size);
+		void operator delete(void* target);
+
+	private:
+		// Sort agents into cell order (cell-list construction)
+		// Agents are physically re-ordered rather than indexed through a permutation,
+		// so neighbour loops in [Step(...)] walk contiguous memory
+		void BuildCells(float cellSize);
+
+		// Agent state, structure-of-arrays
+		// Positions are unit vectors, velocities are tangent to the sphere
+		// Arrays are double-buffered; [Step(...)] reads from the front set and writes
+		// the back set, so agents never see partially-updated neighbours
+		float* posX[2];
+		float* posY[2];
+		float* posZ[2];
+		float* velX[2];
+		float* velY[2];
+		float* velZ[2];
+		u4Byte* ids[2]; // Maps sorted agents back to their figures
+		u4Byte* wanderStates[2];
+		u4Byte frontBuf;
+
+		// Cell list used for neighbour queries
+		CellList* cells;
+
+		u4Byte numAgents;
+		DirectX::XMFLOAT3 center;
+		float radius;
+};
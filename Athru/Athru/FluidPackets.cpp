@@ -0,0 +1,683 @@
+#include <algorithm>
+#include <emmintrin.h>
+#include "UtilityServiceCentre.h"
+#include "FluidPackets.h"
+
+// The solver works in smoothing-radius units (packet positions are stored divided by
+// [kernelRad]), so every constant below is independent of planet size + packet count
+
+// Smoothing radius relative to the rest spacing between packets; twice the spacing
+// gives each packet ~30 neighbours
+constexpr float KERNEL_SCALE = 2.0f;
+
+// Density-projection iterations per step
+constexpr u4Byte SOLVER_ITERATIONS = 3;
+
+// Rest density + constraint relaxation (softens the constraint when packets have
+// very few neighbours, e.g. near the free surface)
+constexpr float REST_DENSITY = 1.0f;
+constexpr float CONSTRAINT_RELAXATION = 0.05f;
+
+// Artificial pressure (tensile instability correction); stops ocean packets from
+// clumping into pairs; [TENSILE_DQ] is the reference distance where the
+// correction reaches [tensileStrength]
+constexpr float TENSILE_DQ = 0.2f;
+
+// Packets never move more than this many smoothing radii per step
+constexpr float MAX_STEP_DIST = 0.5f;
+
+// Packets are scattered randomly, so fresh fluids start out with some heavily
+// overlapping packets; let them relax for a few steps (without keeping any of
+// the resulting velocity) before handing them over to the game
+constexpr u4Byte SETTLING_STEPS = 4;
+constexpr float SETTLING_DT = 1.0f / 60.0f;
+
+// Normalization for the poly6 (density) + spiky (gradient) kernels, for a unit
+// smoothing radius
+constexpr float POLY6_COEFF = 315.0f / (64.0f * MathsStuff::PI);
+constexpr float SPIKY_GRAD_COEFF = 45.0f / MathsStuff::PI;
+
+// Ocean packets are capped this many smoothing radii above their initial fill
+// height; oceans have a free surface, so the cap should only matter for spray
+constexpr float FREE_SURFACE_HEADROOM = 2.0f;
+
+// Occupied cells per solver job; smaller blocks balance better between workers,
+// larger blocks spend less time scheduling
+constexpr u4Byte CELLS_PER_JOB = 64;
+
+// Packets per prediction job (prediction runs before packets are sorted into
+// cells, so it can't be split by cell)
+constexpr u4Byte PACKETS_PER_JOB = 1024;
+
+// Adjacent-range cache capacity per packet (see [CellList::BuildAdjacency()]);
+// thin shells have few packets per cell, so allow several ranges for each one
+constexpr u4Byte ADJACENT_RANGES_PER_PACKET = 4;
+
+// Adjacent packets scanned for candidate neighbours per cell at once; cells with
+// more adjacent packets than this (extremely compressed fluid) are processed in
+// chunks instead
+constexpr u4Byte MAX_CANDIDATES = 1024;
+
+// Per-type solver settings
+struct FluidPacketConfig
+{
+	float shellDepth; // Initial fill depth, relative to the planet radius
+	float gravity; // World units/second^2
+	float tensileStrength; // See [TENSILE_DQ]
+	float viscosity; // XSPH velocity smoothing
+	bool closedShell; // Whether packets are bounded by a wall at the top of the shell (as well as the planet surface)
+};
+
+static constexpr FluidPacketConfig packetConfigs[2] = { { 0.04f, 9.8f, 0.1f, 0.01f, false }, // Ocean
+														{ 0.2f, 2.0f, 0.0f, 0.05f, true } }; // Atmosphere
+
+// Density contributed by a flat wall of rest-density fluid [dist] smoothing radii
+// away (the poly6 kernel integrated over the half-space beyond the wall), relative
+// to rest density, + its derivative with respect to [dist]
+// Walls stand in for the fluid missing beyond the planet surface/shell top, so
+// packets near boundaries still reach rest density instead of piling up
+static void WallDensity(float dist, float& density, float& densityDeriv)
+{
+	// (PI * POLY6_COEFF / 4) * integral of (1 - z^2)^4 from [dist] to one
+	constexpr float wallCoeff = MathsStuff::PI * POLY6_COEFF * 0.25f;
+	const float z = std::min(std::max(dist, 0.0f), 1.0f);
+	const float zSqr = z * z;
+	const float antiDeriv = z * (1.0f + zSqr * ((-4.0f / 3.0f) + zSqr * ((6.0f / 5.0f) + zSqr * ((-4.0f / 7.0f) + zSqr * (1.0f / 9.0f)))));
+	const float q = 1.0f - zSqr;
+	density = wallCoeff * ((128.0f / 315.0f) - antiDeriv);
+	densityDeriv = -wallCoeff * (q * q) * (q * q);
+}
+
+// Xorshift32, mapped to [0...1)
+static float RandUnit(u4Byte& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return (float)(state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Add together the four lanes of an SSE register
+static float HorizontalSum(__m128 v)
+{
+	v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(v);
+}
+
+// Candidate neighbours shared by every packet in a cell (see [Step(...)]); padded
+// out to a whole number of SSE lanes
+struct FluidCandidates
+{
+	alignas(16) float x[MAX_CANDIDATES + 3];
+	alignas(16) float y[MAX_CANDIDATES + 3];
+	alignas(16) float z[MAX_CANDIDATES + 3];
+	alignas(16) float a[MAX_CANDIDATES + 3];
+	alignas(16) float b[MAX_CANDIDATES + 3];
+	alignas(16) float c[MAX_CANDIDATES + 3];
+};
+
+FluidPackets::FluidPackets(FLUID_PACKET_TYPES packetType, u4Byte packetCount) :
+	type(packetType),
+	numPackets(packetCount),
+	center(0.0f, 0.0f, 0.0f),
+	innerRad(1.0f),
+	outerRad(2.0f),
+	kernelRad(1.0f),
+	packetMass(1.0f)
+{
+	// Allocate packet state; padding elements sit far outside every neighbourhood
+	// (and are masked out anyway), so they never contribute to the solve
+	float** arrays[13] = { &posX, &posY, &posZ, &velX, &velY, &velZ,
+						   &predX, &predY, &predZ, &lambdas,
+						   &scratchX, &scratchY, &scratchZ };
+	for (u4Byte i = 0; i < 13; i += 1)
+	{
+		*arrays[i] = MemoryStuff::ArrayAlloc<float>(numPackets + 4, false);
+		for (u4Byte j = 0; j < (numPackets + 4); j += 1)
+		{
+			(*arrays[i])[j] = 1e9f;
+		}
+	}
+
+	cells = new CellList(numPackets, numPackets * ADJACENT_RANGES_PER_PACKET);
+}
+
+FluidPackets::~FluidPackets() {}
+
+void FluidPackets::Reset(u4Byte seed, DirectX::XMFLOAT3 planetPos, float planetRadius)
+{
+	// Size the smoothing radius so packets exactly fill the shell at rest spacing
+	const FluidPacketConfig& config = packetConfigs[(u4Byte)type];
+	const float outerWorldRad = planetRadius * (1.0f + config.shellDepth);
+	const float shellVolume = (4.0f / 3.0f) * MathsStuff::PI * ((outerWorldRad * outerWorldRad * outerWorldRad) -
+																(planetRadius * planetRadius * planetRadius));
+	kernelRad = KERNEL_SCALE * cbrtf(shellVolume / (float)numPackets);
+	const float fillRad = outerWorldRad / kernelRad;
+	innerRad = planetRadius / kernelRad;
+	outerRad = config.closedShell ? fillRad : (fillRad + FREE_SURFACE_HEADROOM);
+	center = planetPos;
+	assert((outerRad * 2.0f) < (float)CellList::MAX_CELLS_PER_AXIS);
+
+	// Choose packet mass so a cubic lattice at rest spacing sits at rest density
+	const float restSpacing = 1.0f / KERNEL_SCALE;
+	float latticeDensity = 0.0f;
+	for (s4Byte z = -2; z <= 2; z += 1)
+	{
+		for (s4Byte y = -2; y <= 2; y += 1)
+		{
+			for (s4Byte x = -2; x <= 2; x += 1)
+			{
+				const float distSqr = (float)(x * x + y * y + z * z) * restSpacing * restSpacing;
+				if (distSqr < 1.0f)
+				{
+					const float q = 1.0f - distSqr;
+					latticeDensity += POLY6_COEFF * q * q * q;
+				}
+			}
+		}
+	}
+	packetMass = REST_DENSITY / latticeDensity;
+
+	// Scatter packets uniformly (by volume) through the shell, at rest
+	u4Byte rng = (seed * 0x9E3779B9) | 1;
+	const float innerCube = innerRad * innerRad * innerRad;
+	const float outerCube = fillRad * fillRad * fillRad;
+	for (u4Byte i = 0; i < numPackets; i += 1)
+	{
+		const float z = (RandUnit(rng) * 2.0f) - 1.0f;
+		const float phi = RandUnit(rng) * 2.0f * MathsStuff::PI;
+		const float ringRad = sqrtf(1.0f - z * z);
+		const float r = cbrtf(innerCube + RandUnit(rng) * (outerCube - innerCube));
+		posX[i] = ringRad * cosf(phi) * r;
+		posY[i] = ringRad * sinf(phi) * r;
+		posZ[i] = z * r;
+		velX[i] = 0.0f;
+		velY[i] = 0.0f;
+		velZ[i] = 0.0f;
+	}
+
+	// Relax overlapping packets
+	for (u4Byte i = 0; i < SETTLING_STEPS; i += 1)
+	{
+		Step(SETTLING_DT);
+		memset(velX, 0, numPackets * sizeof(float));
+		memset(velY, 0, numPackets * sizeof(float));
+		memset(velZ, 0, numPackets * sizeof(float));
+	}
+}
+
+void FluidPackets::BuildCells()
+{
+	// Cells are one smoothing radius wide; nudge the grid origin out a little so
+	// packets on the outer shell don't land exactly on the boundary (predicted
+	// positions are constrained to the shell, so they never go further out)
+	const float gridRad = outerRad * 1.001f;
+	cells->Build(predX, predY, predZ, numPackets,
+				 DirectX::XMFLOAT3(-gridRad, -gridRad, -gridRad), 1.0f);
+
+	// Gather predicted positions, current positions + velocities into cell order,
+	// three arrays at a time through scratch
+	const u4Byte* order = cells->SortedOrder();
+	float** sorting[3][3] = { { &predX, &predY, &predZ },
+							  { &posX, &posY, &posZ },
+							  { &velX, &velY, &velZ } };
+	for (u4Byte k = 0; k < 3; k += 1)
+	{
+		const float* srcX = *sorting[k][0];
+		const float* srcY = *sorting[k][1];
+		const float* srcZ = *sorting[k][2];
+		for (u4Byte i = 0; i < numPackets; i += 1)
+		{
+			const u4Byte j = order[i];
+			scratchX[i] = srcX[j];
+			scratchY[i] = srcY[j];
+			scratchZ[i] = srcZ[j];
+		}
+		std::swap(*sorting[k][0], scratchX);
+		std::swap(*sorting[k][1], scratchY);
+		std::swap(*sorting[k][2], scratchZ);
+	}
+}
+
+void FluidPackets::Step(float dt)
+{
+	if (dt <= 0.0f) { return; }
+
+	// Every pass below splits occupied cells (or packets, before cells are built)
+	// into blocks + runs them on the job system; passes only read what earlier
+	// passes wrote, so waiting for each [ParallelFor(...)] is the only
+	// synchronization the solver needs
+	JobSystem* jobs = AthruCore::Utility::AccessJobs();
+
+	const FluidPacketConfig& config = packetConfigs[(u4Byte)type];
+	const float gravity = (config.gravity / kernelRad) * dt * dt;
+	const float maxStepSqr = MAX_STEP_DIST * MAX_STEP_DIST;
+	const float gradCoeff = (packetMass / REST_DENSITY) * SPIKY_GRAD_COEFF;
+	const float tensileRef = 1.0f - (TENSILE_DQ * TENSILE_DQ);
+	const float invTensileRef = 1.0f / (tensileRef * tensileRef * tensileRef);
+	const float viscosityCoeff = config.viscosity * (packetMass / REST_DENSITY) * POLY6_COEFF;
+
+	// Keep packets inside the shell
+	auto constrain = [&](float& x, float& y, float& z)
+	{
+		const float rSqr = x * x + y * y + z * z;
+		if (rSqr < (innerRad * innerRad) || rSqr > (outerRad * outerRad))
+		{
+			const float r = sqrtf(rSqr);
+			const float scale = std::min(std::max(r, innerRad), outerRad) / std::max(r, 1e-6f);
+			x *= scale;
+			y *= scale;
+			z *= scale;
+		}
+	};
+
+	// Density contributed by the shell walls at the given position + its
+	// gradient (radial, so returned as a multiple of the position vector)
+	auto walls = [&](float x, float y, float z, float& density, float& radialGrad)
+	{
+		const float r = std::max(sqrtf(x * x + y * y + z * z), 1e-6f);
+		float deriv;
+		WallDensity(r - innerRad, density, deriv);
+		radialGrad = deriv / r;
+		if (config.closedShell)
+		{
+			float outerDensity, outerDeriv;
+			WallDensity(outerRad - r, outerDensity, outerDeriv);
+			density += outerDensity;
+			radialGrad -= outerDeriv / r;
+		}
+	};
+
+	// Every packet in a cell shares the same candidate neighbours, so gather those
+	// once into contiguous scratch + test each packet in the cell against them
+	// Candidates further than one smoothing radius from every packet in the cell
+	// are skipped during the gather
+	// Only adjacent packets [skip]...[skip + MAX_CANDIDATES] are scanned, so dense
+	// cells can be gathered in chunks; the total number of adjacent packets is
+	// written into [numAdjacent]
+	auto gather = [&](FluidCandidates& cand, u4Byte& numCandidates, u4Byte& numAdjacent,
+					  u4Byte cellBegin, u4Byte cellEnd, u4Byte cellNdx, u4Byte skip,
+					  const float* extraA, const float* extraB, const float* extraC)
+	{
+		const float* pX = predX;
+		const float* pY = predY;
+		const float* pZ = predZ;
+		float minX = pX[cellBegin], maxX = minX;
+		float minY = pY[cellBegin], maxY = minY;
+		float minZ = pZ[cellBegin], maxZ = minZ;
+		for (u4Byte i = cellBegin + 1; i < cellEnd; i += 1)
+		{
+			minX = std::min(minX, pX[i]);
+			maxX = std::max(maxX, pX[i]);
+			minY = std::min(minY, pY[i]);
+			maxY = std::max(maxY, pY[i]);
+			minZ = std::min(minZ, pZ[i]);
+			maxZ = std::max(maxZ, pZ[i]);
+		}
+
+		// Candidates are written unconditionally + only kept (by advancing
+		// [numCandidates]) when they pass; acceptance is close to a coin-flip,
+		// so branching on it stalls badly
+		numCandidates = 0;
+		numAdjacent = 0;
+		cells->ForEachCachedAdjacentRange(cellNdx, [&](u4Byte begin, u4Byte end)
+		{
+			// Clip each range to the part overlapping the current chunk
+			const u4Byte rangeBase = numAdjacent;
+			numAdjacent += end - begin;
+			const u4Byte chunkBegin = std::max(skip, rangeBase);
+			const u4Byte chunkEnd = std::min(skip + MAX_CANDIDATES, numAdjacent);
+			if (chunkBegin >= chunkEnd)
+			{
+				return;
+			}
+
+			end = begin + (chunkEnd - rangeBase);
+			for (u4Byte j = begin + (chunkBegin - rangeBase); j < end; j += 1)
+			{
+				const float x = pX[j];
+				const float y = pY[j];
+				const float z = pZ[j];
+				const float dx = std::max(std::max(minX - x, x - maxX), 0.0f);
+				const float dy = std::max(std::max(minY - y, y - maxY), 0.0f);
+				const float dz = std::max(std::max(minZ - z, z - maxZ), 0.0f);
+				cand.x[numCandidates] = x;
+				cand.y[numCandidates] = y;
+				cand.z[numCandidates] = z;
+				if (extraA != nullptr)
+				{
+					cand.a[numCandidates] = extraA[j];
+					cand.b[numCandidates] = extraB[j];
+					cand.c[numCandidates] = extraC[j];
+				}
+				numCandidates += ((dx * dx + dy * dy + dz * dz) < 1.0f) ? 1 : 0;
+			}
+		});
+
+		// Pad candidates out to a whole number of SSE lanes; padding sits far
+		// outside every neighbourhood, so it's always masked out
+		while ((numCandidates & 3) != 0)
+		{
+			cand.x[numCandidates] = 1e9f;
+			cand.y[numCandidates] = 1e9f;
+			cand.z[numCandidates] = 1e9f;
+			cand.a[numCandidates] = 0.0f;
+			cand.b[numCandidates] = 0.0f;
+			cand.c[numCandidates] = 0.0f;
+			numCandidates += 1;
+		}
+	};
+
+	const __m128 zeroVec = _mm_setzero_ps();
+	const __m128 oneVec = _mm_set1_ps(1.0f);
+	const __m128 tinyVec = _mm_set1_ps(1e-12f);
+	const __m128 halfVec = _mm_set1_ps(0.5f);
+	const __m128 threeVec = _mm_set1_ps(3.0f);
+	const __m128 tensileVec = _mm_set1_ps(config.tensileStrength);
+	const __m128 invTensileVec = _mm_set1_ps(invTensileRef);
+
+	// Approximate 1/sqrt(x), refined with a single Newton step
+	auto invSqrt = [&](__m128 x)
+	{
+		const __m128 est = _mm_rsqrt_ps(x);
+		return _mm_mul_ps(_mm_mul_ps(halfVec, est), _mm_sub_ps(threeVec, _mm_mul_ps(_mm_mul_ps(x, est), est)));
+	};
+
+	// Predict motion under gravity (towards the planet center)
+	jobs->ParallelFor(0, numPackets, PACKETS_PER_JOB, [&](u4Byte begin, u4Byte end)
+	{
+		for (u4Byte i = begin; i < end; i += 1)
+		{
+			const float invR = 1.0f / std::max(sqrtf(posX[i] * posX[i] + posY[i] * posY[i] + posZ[i] * posZ[i]), 1e-6f);
+			float x = posX[i] + velX[i] * dt - posX[i] * invR * gravity;
+			float y = posY[i] + velY[i] * dt - posY[i] * invR * gravity;
+			float z = posZ[i] + velZ[i] * dt - posZ[i] * invR * gravity;
+			constrain(x, y, z);
+			predX[i] = x;
+			predY[i] = y;
+			predZ[i] = z;
+		}
+	});
+
+	// Every neighbour search below is centered on predicted positions, which can
+	// drift well over half a cell from current positions in one step; build cells
+	// from predicted positions so one-cell searches still cover whole kernels
+	BuildCells();
+	cells->BuildAdjacency();
+	const u4Byte numCells = cells->NumCells();
+
+	for (u4Byte iter = 0; iter < SOLVER_ITERATIONS; iter += 1)
+	{
+		// Evaluate density constraints + their multipliers
+		jobs->ParallelFor(0, numCells, CELLS_PER_JOB, [&](u4Byte firstCell, u4Byte lastCell)
+		{
+			FluidCandidates cand;
+			const float* pX = predX;
+			const float* pY = predY;
+			const float* pZ = predZ;
+			cells->ForEachCell(firstCell, lastCell, [&](u4Byte cellBegin, u4Byte cellEnd, u4Byte cellNdx)
+			{
+				u4Byte numCandidates = 0;
+				u4Byte numAdjacent = 0;
+				gather(cand, numCandidates, numAdjacent, cellBegin, cellEnd, cellNdx, 0, nullptr, nullptr, nullptr);
+				const bool chunked = numAdjacent > MAX_CANDIDATES;
+				for (u4Byte i = cellBegin; i < cellEnd; i += 1)
+				{
+					const __m128 pxVec = _mm_set1_ps(pX[i]);
+					const __m128 pyVec = _mm_set1_ps(pY[i]);
+					const __m128 pzVec = _mm_set1_ps(pZ[i]);
+					__m128 density = zeroVec;
+					__m128 gradX = zeroVec, gradY = zeroVec, gradZ = zeroVec;
+					__m128 gradSqr = zeroVec;
+					for (u4Byte skip = 0; skip < numAdjacent; skip += MAX_CANDIDATES)
+					{
+						// Cells small enough to gather at once reuse the first gather
+						// for every packet; dense cells re-gather each chunk per packet,
+						// so every neighbour still counts
+						if (chunked)
+						{
+							gather(cand, numCandidates, numAdjacent, cellBegin, cellEnd, cellNdx, skip, nullptr, nullptr, nullptr);
+						}
+
+						for (u4Byte j = 0; j < numCandidates; j += 4)
+						{
+							const __m128 dx = _mm_sub_ps(pxVec, _mm_load_ps(cand.x + j));
+							const __m128 dy = _mm_sub_ps(pyVec, _mm_load_ps(cand.y + j));
+							const __m128 dz = _mm_sub_ps(pzVec, _mm_load_ps(cand.z + j));
+							const __m128 distSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+							const __m128 inside = _mm_cmplt_ps(distSqr, oneVec);
+
+							// Poly6 density
+							const __m128 q = _mm_sub_ps(oneVec, distSqr);
+							density = _mm_add_ps(density, _mm_and_ps(inside, _mm_mul_ps(_mm_mul_ps(q, q), q)));
+
+							// Spiky gradient, as a multiple of the separation vector
+							// ((1 - r)^2 / r; zero for the packet itself)
+							const __m128 invDist = invSqrt(_mm_max_ps(distSqr, tinyVec));
+							const __m128 hmr = _mm_sub_ps(oneVec, _mm_mul_ps(distSqr, invDist));
+							const __m128 grad = _mm_and_ps(_mm_and_ps(inside, _mm_cmpgt_ps(distSqr, tinyVec)),
+														   _mm_mul_ps(_mm_mul_ps(hmr, hmr), invDist));
+							gradX = _mm_add_ps(gradX, _mm_mul_ps(grad, dx));
+							gradY = _mm_add_ps(gradY, _mm_mul_ps(grad, dy));
+							gradZ = _mm_add_ps(gradZ, _mm_mul_ps(grad, dz));
+							gradSqr = _mm_add_ps(gradSqr, _mm_mul_ps(_mm_mul_ps(grad, grad), distSqr));
+						}
+					}
+
+					// Gradients point away from neighbours, so scale them down by
+					// [-gradCoeff] before adding in wall gradients
+					float wallDensity, wallGrad;
+					walls(pX[i], pY[i], pZ[i], wallDensity, wallGrad);
+					// Constraints are one-sided (packets resist compression but not expansion);
+					// two-sided constraints pull sparse packets into clumps
+					const float constraint = std::max(((HorizontalSum(density) * POLY6_COEFF * packetMass) / REST_DENSITY) + wallDensity - 1.0f, 0.0f);
+					const float gx = pX[i] * wallGrad - HorizontalSum(gradX) * gradCoeff;
+					const float gy = pY[i] * wallGrad - HorizontalSum(gradY) * gradCoeff;
+					const float gz = pZ[i] * wallGrad - HorizontalSum(gradZ) * gradCoeff;
+					const float gradNormSqr = (gx * gx + gy * gy + gz * gz) + HorizontalSum(gradSqr) * gradCoeff * gradCoeff;
+					lambdas[i] = -constraint / (gradNormSqr + CONSTRAINT_RELAXATION);
+				}
+			});
+		});
+
+		// Project packets towards rest density; corrected positions are written
+		// into scratch, then swapped in
+		jobs->ParallelFor(0, numCells, CELLS_PER_JOB, [&](u4Byte firstCell, u4Byte lastCell)
+		{
+			FluidCandidates cand;
+			const float* pX = predX;
+			const float* pY = predY;
+			const float* pZ = predZ;
+			cells->ForEachCell(firstCell, lastCell, [&](u4Byte cellBegin, u4Byte cellEnd, u4Byte cellNdx)
+			{
+				u4Byte numCandidates = 0;
+				u4Byte numAdjacent = 0;
+				gather(cand, numCandidates, numAdjacent, cellBegin, cellEnd, cellNdx, 0, lambdas, lambdas, lambdas);
+				const bool chunked = numAdjacent > MAX_CANDIDATES;
+				for (u4Byte i = cellBegin; i < cellEnd; i += 1)
+				{
+					const __m128 pxVec = _mm_set1_ps(pX[i]);
+					const __m128 pyVec = _mm_set1_ps(pY[i]);
+					const __m128 pzVec = _mm_set1_ps(pZ[i]);
+					const __m128 lambdaVec = _mm_set1_ps(lambdas[i]);
+					__m128 dpX = zeroVec, dpY = zeroVec, dpZ = zeroVec;
+					for (u4Byte skip = 0; skip < numAdjacent; skip += MAX_CANDIDATES)
+					{
+						// Chunked the same way as the density pass
+						if (chunked)
+						{
+							gather(cand, numCandidates, numAdjacent, cellBegin, cellEnd, cellNdx, skip, lambdas, lambdas, lambdas);
+						}
+
+						for (u4Byte j = 0; j < numCandidates; j += 4)
+						{
+							const __m128 dx = _mm_sub_ps(pxVec, _mm_load_ps(cand.x + j));
+							const __m128 dy = _mm_sub_ps(pyVec, _mm_load_ps(cand.y + j));
+							const __m128 dz = _mm_sub_ps(pzVec, _mm_load_ps(cand.z + j));
+							const __m128 distSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+							const __m128 inside = _mm_and_ps(_mm_cmplt_ps(distSqr, oneVec), _mm_cmpgt_ps(distSqr, tinyVec));
+
+							// Artificial pressure, -k * (W(r) / W(dq))^4
+							const __m128 q = _mm_sub_ps(oneVec, distSqr);
+							__m128 tensile = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(q, q), q), invTensileVec);
+							tensile = _mm_mul_ps(tensile, tensile);
+							tensile = _mm_mul_ps(_mm_mul_ps(tensile, tensile), tensileVec);
+
+							const __m128 invDist = invSqrt(_mm_max_ps(distSqr, tinyVec));
+							const __m128 hmr = _mm_sub_ps(oneVec, _mm_mul_ps(distSqr, invDist));
+							const __m128 weight = _mm_and_ps(inside, _mm_mul_ps(_mm_sub_ps(_mm_add_ps(lambdaVec, _mm_load_ps(cand.a + j)), tensile),
+																				_mm_mul_ps(_mm_mul_ps(hmr, hmr), invDist)));
+							dpX = _mm_add_ps(dpX, _mm_mul_ps(weight, dx));
+							dpY = _mm_add_ps(dpY, _mm_mul_ps(weight, dy));
+							dpZ = _mm_add_ps(dpZ, _mm_mul_ps(weight, dz));
+						}
+					}
+
+					// Negative multipliers (compressed packets) push away from
+					// neighbours + walls
+					float wallDensity, wallGrad;
+					walls(pX[i], pY[i], pZ[i], wallDensity, wallGrad);
+					const float wallPush = lambdas[i] * wallGrad;
+					float x = pX[i] + pX[i] * wallPush - HorizontalSum(dpX) * gradCoeff;
+					float y = pY[i] + pY[i] * wallPush - HorizontalSum(dpY) * gradCoeff;
+					float z = pZ[i] + pZ[i] * wallPush - HorizontalSum(dpZ) * gradCoeff;
+					constrain(x, y, z);
+					scratchX[i] = x;
+					scratchY[i] = y;
+					scratchZ[i] = z;
+				}
+			});
+		});
+		std::swap(predX, scratchX);
+		std::swap(predY, scratchY);
+		std::swap(predZ, scratchZ);
+	}
+
+	// Derive velocities from corrected positions (clamped to [MAX_STEP_DIST])
+	const float invDt = 1.0f / dt;
+	jobs->ParallelFor(0, numCells, CELLS_PER_JOB, [&](u4Byte firstCell, u4Byte lastCell)
+	{
+		cells->ForEachCell(firstCell, lastCell, [&](u4Byte begin, u4Byte end, u4Byte cellNdx)
+		{
+			for (u4Byte i = begin; i < end; i += 1)
+			{
+				float dx = predX[i] - posX[i];
+				float dy = predY[i] - posY[i];
+				float dz = predZ[i] - posZ[i];
+				const float stepSqr = dx * dx + dy * dy + dz * dz;
+				if (stepSqr > maxStepSqr)
+				{
+					const float scale = MAX_STEP_DIST / sqrtf(stepSqr);
+					dx *= scale;
+					dy *= scale;
+					dz *= scale;
+				}
+				velX[i] = dx * invDt;
+				velY[i] = dy * invDt;
+				velZ[i] = dz * invDt;
+			}
+		});
+	});
+
+	// XSPH viscosity; blend velocities towards the local average
+	jobs->ParallelFor(0, numCells, CELLS_PER_JOB, [&](u4Byte firstCell, u4Byte lastCell)
+	{
+		FluidCandidates cand;
+		const float* pX = predX;
+		const float* pY = predY;
+		const float* pZ = predZ;
+		const float* vX = velX;
+		const float* vY = velY;
+		const float* vZ = velZ;
+		cells->ForEachCell(firstCell, lastCell, [&](u4Byte cellBegin, u4Byte cellEnd, u4Byte cellNdx)
+		{
+			u4Byte numCandidates = 0;
+			u4Byte numAdjacent = 0;
+			gather(cand, numCandidates, numAdjacent, cellBegin, cellEnd, cellNdx, 0, vX, vY, vZ);
+			const bool chunked = numAdjacent > MAX_CANDIDATES;
+			for (u4Byte i = cellBegin; i < cellEnd; i += 1)
+			{
+				const __m128 pxVec = _mm_set1_ps(pX[i]);
+				const __m128 pyVec = _mm_set1_ps(pY[i]);
+				const __m128 pzVec = _mm_set1_ps(pZ[i]);
+				const __m128 vxVec = _mm_set1_ps(vX[i]);
+				const __m128 vyVec = _mm_set1_ps(vY[i]);
+				const __m128 vzVec = _mm_set1_ps(vZ[i]);
+				__m128 dvX = zeroVec, dvY = zeroVec, dvZ = zeroVec;
+				for (u4Byte skip = 0; skip < numAdjacent; skip += MAX_CANDIDATES)
+				{
+					// Chunked the same way as the solver passes
+					if (chunked)
+					{
+						gather(cand, numCandidates, numAdjacent, cellBegin, cellEnd, cellNdx, skip, vX, vY, vZ);
+					}
+
+					for (u4Byte j = 0; j < numCandidates; j += 4)
+					{
+						const __m128 dx = _mm_sub_ps(pxVec, _mm_load_ps(cand.x + j));
+						const __m128 dy = _mm_sub_ps(pyVec, _mm_load_ps(cand.y + j));
+						const __m128 dz = _mm_sub_ps(pzVec, _mm_load_ps(cand.z + j));
+						const __m128 distSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+						const __m128 q = _mm_sub_ps(oneVec, distSqr);
+						const __m128 weight = _mm_and_ps(_mm_cmplt_ps(distSqr, oneVec), _mm_mul_ps(_mm_mul_ps(q, q), q));
+						dvX = _mm_add_ps(dvX, _mm_mul_ps(weight, _mm_sub_ps(_mm_load_ps(cand.a + j), vxVec)));
+						dvY = _mm_add_ps(dvY, _mm_mul_ps(weight, _mm_sub_ps(_mm_load_ps(cand.b + j), vyVec)));
+						dvZ = _mm_add_ps(dvZ, _mm_mul_ps(weight, _mm_sub_ps(_mm_load_ps(cand.c + j), vzVec)));
+					}
+				}
+				scratchX[i] = vX[i] + HorizontalSum(dvX) * viscosityCoeff;
+				scratchY[i] = vY[i] + HorizontalSum(dvY) * viscosityCoeff;
+				scratchZ[i] = vZ[i] + HorizontalSum(dvZ) * viscosityCoeff;
+			}
+		});
+	});
+
+	// Commit the step; corrected positions become current positions, smoothed
+	// velocities become current velocities
+	std::swap(posX, predX);
+	std::swap(posY, predY);
+	std::swap(posZ, predZ);
+	std::swap(velX, scratchX);
+	std::swap(velY, scratchY);
+	std::swap(velZ, scratchZ);
+}
+
+DirectX::XMFLOAT3 FluidPackets::GetPlanetPos()
+{
+	return center;
+}
+
+float FluidPackets::Benchmark(u4Byte numPackets, u4Byte numSteps)
+{
+	FluidPackets* packets = new FluidPackets(FLUID_PACKET_TYPES::OCEAN, numPackets);
+	packets->Reset(1, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), 100.0f);
+
+	// Settle initial clumping before timing anything
+	packets->Step(1.0f / 60.0f);
+
+	const auto t0 = std::chrono::steady_clock::now();
+	for (u4Byte i = 0; i < numSteps; i += 1)
+	{
+		packets->Step(1.0f / 60.0f);
+	}
+	const double secs = (std::chrono::steady_clock::now() - t0).count() * TimeStuff::nsToSecs;
+	packets->~FluidPackets();
+
+	const float packetsPerSec = (float)(((double)numPackets * numSteps) / std::max(secs, 1e-9));
+	AthruCore::Utility::AccessLogger()->Log(packetsPerSec, "Fluid packet throughput (packets/second)");
+	return packetsPerSec;
+}
+
+// Push constructions for this class through Athru's custom allocator
+void* FluidPackets::operator new(size_t size)
+{
+	StackAllocator* allocator = AthruCore::Utility::AccessMemory();
+	return allocator->AlignedAlloc(size, (uByte)std::alignment_of<FluidPackets>(), false);
+}
+
+// We aren't expecting to use [delete], so overload it to do nothing
+void FluidPackets::operator delete(void* target)
+{
+	return;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <directxmath.h>
+#include "AppGlobals.h"
+#include "CellList.h"
+
+// Different sorts of fluid packet; oceans are near-incompressible liquids
+// that settle against the surface, atmospheres are thicker shells of
+// compressible-ish gas that fill the space around the planet
+enum class FLUID_PACKET_TYPES
+{
+	OCEAN,
+	ATMOSPHERE
+};
+
+// Position-based fluid (PBF) solver for packets of ocean/atmosphere around a
+// single planet
+// Packets are confined to a spherical shell above the planet surface and pulled
+// towards the planet center; every step predicts packet motion, then iteratively
+// projects packets towards rest density using SPH kernels evaluated over a
+// sorted cell list
+class FluidPackets
+{
+	public:
+		FluidPackets(FLUID_PACKET_TYPES packetType, u4Byte numPackets);
+		~FluidPackets();
+
+		// Scatter packets through the shell around the planet with the given
+		// center + radius; previous packet state is discarded
+		void Reset(u4Byte seed, DirectX::XMFLOAT3 planetPos, float planetRadius);
+
+		// Advance packets by [dt] seconds
+		// Steps are split into jobs on the engine's job system
+		void Step(float dt);
+
+		// Retrieve the center of the planet currently carrying [this]
+		DirectX::XMFLOAT3 GetPlanetPos();
+
+		// Headless throughput test; steps an ocean of [numPackets] packets around a
+		// radius-100 planet [numSteps] times, then logs + returns the number of
+		// packets processed per second
+		// Packet state is allocated on Athru's memory stack and never released, so
+		// this should only be called from headless/benchmark runs (one million
+		// packets need roughly 140 megabytes)
+		static float Benchmark(u4Byte numPackets, u4Byte numSteps);
+
+		// Overload the standard allocation/de-allocation operators
+		void* operator new(size_t size);
+		void operator delete(void* target);
+
+	private:
+		// Sort packets into cell order, binning them by predicted position
+		// Packets are physically re-ordered (not indexed through a permutation), so
+		// kernel loops in [Step(...)] stream contiguous memory
+		void BuildCells();
+
+		// Packet state, structure-of-arrays + local to the planet center
+		// Arrays carry four extra elements so SIMD loops can safely read past the
+		// end of the last cell
+		float* posX;
+		float* posY;
+		float* posZ;
+		float* velX;
+		float* velY;
+		float* velZ;
+		float* predX; // Predicted positions, refined by the density solver
+		float* predY;
+		float* predZ;
+		float* lambdas; // Per-packet density-constraint multipliers
+		float* scratchX; // Position deltas during solves, re-ordering space during sorts
+		float* scratchY;
+		float* scratchZ;
+
+		// Cell list used for neighbour queries
+		CellList* cells;
+
+		// Solver configuration (see [FLUID_PACKET_TYPES])
+		FLUID_PACKET_TYPES type;
+		u4Byte numPackets;
+		DirectX::XMFLOAT3 center;
+		float innerRad;
+		float outerRad;
+		float kernelRad; // Smoothing radius; cells are one smoothing radius wide
+		float packetMass; // Chosen so packets at rest spacing sit exactly at rest density
+};
@@ -1,3 +1,4 @@
 #include "HiLevelServiceCentre.h"
 
-Scene* HiLevelServiceCentre::scenePttr = nullptr;
\ No newline at end of file
+Scene* HiLevelServiceCentre::scenePttr = nullptr;
+AudioMixer* HiLevelServiceCentre::audioPttr = nullptr;
\ No newline at end of file
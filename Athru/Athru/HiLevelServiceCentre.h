@@ -2,12 +2,14 @@
 
 // High-level Athru engine classes
 #include "Scene.h"
+#include "AudioMixer.h"
 
 // Athru rendering classes
 #include "GPUServiceCentre.h"
 
 // Athru utility classes
 #include "UtilityServiceCentre.h"
+#include "StartupGraph.h"
 
 class HiLevelServiceCentre
 {
@@ -17,19 +19,68 @@ class HiLevelServiceCentre
 
 		static void StartUp()
 		{
-			// Initialize utilities
-			AthruCore::Utility::Init(MemoryStuff::STARTING_HEAP_ALLOC);
+			// Initialize utilities; every other stage allocates through them, and
+			// later stages run on the job system, so these come first (the window
+			// opens later, alongside other stages)
+			StartupGraph startup;
+			const std::chrono::steady_clock::time_point utilityStart = std::chrono::steady_clock::now();
+			AthruCore::Utility::Init(MemoryStuff::STARTING_HEAP_ALLOC, false);
+			const u4Byte utilities = startup.Record("utilities", utilityStart);
 
-			// Attemp to create and register rendering services
-			// (the render-manager + the texture-manager)
-			AthruGPU::GPU::Init();
+			// Window messages are delivered to the thread that opened the window, so
+			// window + device setup stay on the main thread; everything else is free
+			// to run on workers in the meantime
+			const u4Byte window = startup.Add("window", [](void*) { AthruCore::Utility::InitApp(); }, nullptr, true);
+			startup.Depend(window, utilities);
 
-			// Attempt to create and register the scene service
-			scenePttr = new Scene();
+			// Attempt to create and register the Direct3D handler + the GPU messenger
+			const u4Byte device = startup.Add("device", [](void*) { AthruGPU::GPU::InitDevice(); }, nullptr, true);
+			startup.Depend(device, window);
+
+			// Fetch shader bytecode + the dither texture while the device starts up
+			u4Byte shaders[AthruGPU::NUM_RENDER_SHADERS];
+			for (u4Byte i = 0; i < AthruGPU::NUM_RENDER_SHADERS; i += 1)
+			{
+				shaders[i] = startup.Add(AthruGPU::RENDER_SHADER_PATHS[i],
+										 [](void* path) { ComputePass::Prefetch((const char*)path); },
+										 (void*)AthruGPU::RENDER_SHADER_PATHS[i], false);
+				startup.Depend(shaders[i], utilities);
+			}
+			const u4Byte dither = startup.Add("dither texture", [](void*) { Renderer::PrefetchDitherTexels(); }, nullptr, false);
+			startup.Depend(dither, utilities);
+
+			// Attempt to create and register the renderer (pipelines, render buffers,
+			// command lists) once the device + its inputs are ready
+			const u4Byte renderer = startup.Add("renderer", [](void*) { AthruGPU::GPU::InitRenderer(); }, nullptr, true);
+			startup.Depend(renderer, device);
+			for (u4Byte i = 0; i < AthruGPU::NUM_RENDER_SHADERS; i += 1)
+			{
+				startup.Depend(renderer, shaders[i]);
+			}
+			startup.Depend(renderer, dither);
+
+			// Attempt to create and register the scene service; the galaxy is generated
+			// entirely on the CPU, so it builds alongside GPU setup
+			const u4Byte scene = startup.Add("scene", [](void*) { scenePttr = new Scene(); }, nullptr, false);
+			startup.Depend(scene, utilities);
+
+			// Attempt to create and register the critter audio service
+			const u4Byte audio = startup.Add("audio", [](void*) { audioPttr = new AudioMixer("CritterData/test.dna"); }, nullptr, false);
+			startup.Depend(audio, utilities);
+
+			// Run start-up, then log where the time went
+			startup.Run();
+			startup.Report();
 		}
 
 		static void ShutDown()
 		{
+			// Stop the audio device thread first; it reads the mixer's voices (+ the
+			// DNA it loaded from the asset pack) until it's joined, and the mixer
+			// itself lives on the [StackAllocator] heap
+			audioPttr->~AudioMixer();
+			audioPttr = nullptr;
+
 			// Free any un-managed memory allocated to higher-level services,
 			// then send the references stored for each service to [nullptr]
 			scenePttr->~Scene();
@@ -40,6 +91,16 @@ class HiLevelServiceCentre
 			// [nullptr]
 			AthruGPU::GPU::DeInit();
 
+			// Stop the job system once nothing else can submit work
+			AthruCore::Utility::DeInitJobs();
+
+			// Unmap packed assets (nothing holds views into the pack after start-up)
+			AthruCore::Utility::DeInitAssets();
+
+			// Flush outstanding reads/writes before tearing down the services
+			// they depend on
+			AthruCore::Utility::DeInitIO();
+
 			// Free any un-managed memory allocated to utility services;
 			// also send the references stored for each utility to [nullptr]
 			AthruCore::Utility::DeInitApp();
@@ -57,7 +118,13 @@ class HiLevelServiceCentre
 			return scenePttr;
 		}
 
+		static AudioMixer* AccessAudio()
+		{
+			return audioPttr;
+		}
+
 	private:
 		// Pointers to available high-level services
 		static Scene* scenePttr;
+		static AudioMixer* audioPttr;
 };
\ No newline at end of file
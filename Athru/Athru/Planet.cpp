@@ -1,27 +1,61 @@
+#include <string.h>
 #include "UtilityServiceCentre.h"
 #include "Critter.h"
+#include "PlantGenerator.h"
 #include "Planet.h"
 
+// Salt for [PositionSeed(...)] when seeding critter flocks
+constexpr u4Byte FLOCK_SEED_SALT = 1;
+
 Planet::Planet(float givenScale,
 			   DirectX::XMFLOAT3 position, DirectX::XMVECTOR qtnRotation,
-			   DirectX::XMVECTOR* distCoeffs) :
+			   DirectX::XMVECTOR* distCoeffs, u4Byte givenFloraSeed) :
 		SceneFigure(position, givenScale,
-					distCoeffs)
+					distCoeffs),
+		floraSeed(givenFloraSeed),
+		grownFloraSeed(0),
+		floraGrown(false),
+		center(position),
+		radius(givenScale)
 {
 	// Initialise plants
+	// Plants are generated lazily (see [GrowPlants()]) so systems the player never
+	// visits never pay for vegetation
 	plants = new SceneFigure[SceneStuff::PLANTS_PER_PLANET];
 
-	// Generation logic undefined for now...
-
 	// Initialise critters
 	// Seven days to create and validate procedural animals isn't really enough time...restrict them to spheres/cubes
 	// for now
 	critters = new SceneFigure[SceneStuff::ANIMALS_PER_PLANET];
 
-	// Generation logic undefined for now...
+	// Generation logic undefined for now, but critters can still roam around the
+	// planet surface
+	flock = new CritterFlock(SceneStuff::ANIMALS_PER_PLANET, PositionSeed(position, FLOCK_SEED_SALT),
+							 position, givenScale);
+	flock->WriteBack(critters);
+}
+
+Planet::~Planet()
+{
+	flock->~CritterFlock();
+	flock = nullptr;
+}
+
+void Planet::Update(float dt)
+{
+	flock->Step(dt);
+	flock->WriteBack(critters);
 }
 
-Planet::~Planet() {}
+void Planet::GrowPlants()
+{
+	// Plant generation is deterministic, so if we've already grown plants from
+	// the current seed there's nothing to do
+	if (floraGrown && (grownFloraSeed == floraSeed)) { return; }
+	PlantGenerator::GrowPlanet(floraSeed, center, radius, plants);
+	grownFloraSeed = floraSeed;
+	floraGrown = true;
+}
 
 SceneFigure& Planet::FetchCritter(u4Byte ndx)
 {
@@ -33,6 +67,36 @@ SceneFigure& Planet::FetchPlant(u4Byte ndx)
 	return plants[ndx];
 }
 
+DirectX::XMFLOAT3 Planet::GetCenter()
+{
+	return center;
+}
+
+float Planet::GetRadius()
+{
+	return radius;
+}
+
+u4Byte Planet::PositionSeed(DirectX::XMFLOAT3 position, u4Byte salt)
+{
+	// Combine each coordinate's bit pattern, then finish with MurmurHash3's
+	// 32-bit finalizer so nearby positions still give unrelated seeds
+	const float coords[3] = { position.x, position.y, position.z };
+	u4Byte seed = salt;
+	for (u4Byte i = 0; i < 3; i += 1)
+	{
+		u4Byte bits;
+		memcpy(&bits, coords + i, sizeof(bits));
+		seed ^= bits + 0x9E3779B9 + (seed << 6) + (seed >> 2);
+	}
+	seed ^= seed >> 16;
+	seed *= 0x85EBCA6B;
+	seed ^= seed >> 13;
+	seed *= 0xC2B2AE35;
+	seed ^= seed >> 16;
+	return seed;
+}
+
 // Push constructions for this class through Athru's custom allocator
 void* Planet::operator new(size_t size)
 {
@@ -3,21 +3,41 @@
 #include <directxmath.h>
 #include "Typedefs.h"
 #include "SceneFigure.h"
+#include "CritterFlock.h"
 
 class Planet : public SceneFigure
 {
 	public:
 		Planet(float givenScale,
 			   DirectX::XMFLOAT3 position, DirectX::XMVECTOR qtnRotation,
-			   DirectX::XMVECTOR* distCoeffs);
+			   DirectX::XMVECTOR* distCoeffs, u4Byte givenFloraSeed);
 		~Planet();
 
+		// Advance per-planet simulations (just critter flocking for now)
+		// by [dt] seconds
+		void Update(float dt);
+
+		// Generate vegetation for [this] from its flora seed
+		// Results are cached against the seed, so repeated calls (e.g. when
+		// the player revisits a system) return immediately
+		void GrowPlants();
+
 		// Retrieve a write-allowed reference to the specified critter
 		SceneFigure& FetchCritter(u4Byte ndx);
 
 		// Retrieve a write-allowed reference to the specified vegetation
 		SceneFigure& FetchPlant(u4Byte ndx);
 
+		// Retrieve the center/radius of [this]
+		DirectX::XMFLOAT3 GetCenter();
+		float GetRadius();
+
+		// Hash a planet position (+ a per-use [salt]) into a generation seed
+		// Planets never move after they're created, so seeds derived this way are
+		// stable without drawing from [rand()] (every extra draw would shift the
+		// rest of the sequence, + so every system generated afterwards)
+		static u4Byte PositionSeed(DirectX::XMFLOAT3 position, u4Byte salt);
+
 		// Overload the standard allocation/de-allocation operators
 		void* operator new(size_t size);
 		void operator delete(void* target);
@@ -25,4 +45,17 @@ class Planet : public SceneFigure
 	private:
 		SceneFigure* critters;
 		SceneFigure* plants;
+
+		// Surface locomotion for [critters]
+		CritterFlock* flock;
+
+		// Seed used to generate [plants], + the seed they were actually
+		// generated from (if they've been generated at all)
+		u4Byte floraSeed;
+		u4Byte grownFloraSeed;
+		bool floraGrown;
+
+		// Planet position + radius (needed to place plants on the surface)
+		DirectX::XMFLOAT3 center;
+		float radius;
 };
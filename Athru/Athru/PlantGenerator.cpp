@@ -0,0 +1,154 @@
+#include "UtilityServiceCentre.h"
+#include "PlantGenerator.h"
+
+// Small deterministic PRNG for plant generation (xorshift32); generation has
+// to be reproducible from seeds alone, so avoid [rand()] + its global state
+static u4Byte NextRand(u4Byte& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// Uniform float in [lo, hi)
+static float RandRange(u4Byte& state, float lo, float hi)
+{
+	return lo + (hi - lo) * ((float)(NextRand(state) >> 8) * (1.0f / 16777216.0f));
+}
+
+// Mix two words into a well-distributed non-zero seed (xorshift state must never be zero)
+static u4Byte MixSeed(u4Byte a, u4Byte b)
+{
+	u4Byte h = (a * 0x9E3779B1u) ^ (b + 0x7F4A7C15u + (a << 6) + (a >> 2));
+	h ^= h >> 16;
+	h *= 0x85EBCA6Bu;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35u;
+	h ^= h >> 16;
+	return (h != 0) ? h : 0x6D2B79F5u;
+}
+
+// Turtle state for expanding the branching production
+// A(len, rad) -> F(len, rad) [ R(k * twist) P(angle) A(len * lRatio, rad * rRatio) ] for k in [0, branchCount)
+struct PlantTurtle
+{
+	float branchAngle;
+	float twist;
+	float lengthRatio;
+	float radiusRatio;
+	u4Byte branchCount;
+
+	// Running results
+	float maxExtent;
+	u4Byte numSegments;
+};
+
+static void ExpandBranch(PlantTurtle& turtle,
+						 DirectX::XMVECTOR base, DirectX::XMVECTOR dir,
+						 float len, float rad, u4Byte depth)
+{
+	// Emit F (one cylinder segment)
+	DirectX::XMVECTOR tip = DirectX::XMVectorAdd(base, DirectX::XMVectorScale(dir, len));
+	float tipDist = DirectX::XMVectorGetX(DirectX::XMVector3Length(tip)) + rad;
+	turtle.maxExtent = (tipDist > turtle.maxExtent) ? tipDist : turtle.maxExtent;
+	turtle.numSegments += 1;
+	if (depth == 0) { return; }
+
+	// Find an axis perpendicular to the current heading; we pitch around
+	// it for each child branch after rolling it around the heading
+	DirectX::XMVECTOR refUp = (fabsf(DirectX::XMVectorGetY(dir)) < 0.99f) ? DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f) :
+																			DirectX::XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+	DirectX::XMVECTOR pitchAxis = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(dir, refUp));
+	for (u4Byte i = 0; i < turtle.branchCount; i += 1)
+	{
+		// Roll is offset by depth as well as branch index so successive whorls
+		// don't stack on top of each other (phyllotaxis)
+		float roll = turtle.twist * (float)(i + depth * turtle.branchCount);
+		DirectX::XMVECTOR rolledAxis = DirectX::XMVector3Rotate(pitchAxis, DirectX::XMQuaternionRotationNormal(dir, roll));
+		DirectX::XMVECTOR childDir = DirectX::XMVector3Rotate(dir, DirectX::XMQuaternionRotationNormal(rolledAxis, turtle.branchAngle));
+		ExpandBranch(turtle, tip, DirectX::XMVector3Normalize(childDir),
+					 len * turtle.lengthRatio, rad * turtle.radiusRatio, depth - 1);
+	}
+}
+
+PlantSpecies PlantGenerator::GenerateSpecies(u4Byte seed)
+{
+	u4Byte rng = MixSeed(seed, 0xB5297A4Du);
+
+	// Draw production parameters
+	PlantTurtle turtle;
+	turtle.branchAngle = RandRange(rng, 0.35f, 0.9f); // ~20-50 degrees
+	turtle.twist = RandRange(rng, 1.7f, 2.6f); // Centered on the golden angle (~2.4 radians)
+	turtle.lengthRatio = RandRange(rng, 0.55f, 0.8f);
+	turtle.radiusRatio = RandRange(rng, 0.5f, 0.75f);
+	turtle.branchCount = 2 + (NextRand(rng) % 3);
+	turtle.maxExtent = 0.0f;
+	turtle.numSegments = 0;
+	u4Byte depth = 3 + (NextRand(rng) % 4);
+	float trunkRad = RandRange(rng, 0.05f, 0.12f);
+
+	// Broadly green, with some spread towards yellows/teals/browns
+	float r = RandRange(rng, 0.1f, 0.5f);
+	float g = RandRange(rng, 0.4f, 0.9f);
+	float b = RandRange(rng, 0.1f, 0.4f);
+	float leafiness = RandRange(rng, 0.0f, 1.0f);
+
+	// Expand the axiom A(1, trunkRad) from the origin, growing upwards (+y)
+	ExpandBranch(turtle, DirectX::XMVectorZero(), DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f),
+				 1.0f, trunkRad, depth);
+
+	// Pack the production into distance coefficients
+	PlantSpecies species;
+	species.distCoeffs[0] = DirectX::XMVectorSet(turtle.branchAngle, turtle.lengthRatio, turtle.radiusRatio, (float)depth);
+	species.distCoeffs[1] = DirectX::XMVectorSet(trunkRad, turtle.twist, (float)turtle.branchCount, 1.0f / turtle.maxExtent);
+	species.distCoeffs[2] = DirectX::XMVectorSet(r, g, b, leafiness);
+	species.boundingRad = turtle.maxExtent;
+	species.numSegments = turtle.numSegments;
+	return species;
+}
+
+void PlantGenerator::GrowPlanet(u4Byte floraSeed,
+								DirectX::XMFLOAT3 planetPos, float planetRadius,
+								SceneFigure* plants)
+{
+	// Generate per-planet species
+	PlantSpecies species[SceneStuff::PLANT_SPECIES_PER_PLANET];
+	for (u4Byte i = 0; i < SceneStuff::PLANT_SPECIES_PER_PLANET; i += 1)
+	{
+		species[i] = GenerateSpecies(MixSeed(floraSeed, i));
+	}
+
+	// Scatter instances over a randomly-oriented Fibonacci sphere; the lattice
+	// keeps plants evenly spread, jitter + the random orientation stop different
+	// planets from sharing the same pattern
+	u4Byte rng = MixSeed(floraSeed, 0x68E31DA4u);
+	DirectX::XMVECTOR latticeOrientation = DirectX::XMQuaternionNormalize(DirectX::XMVectorSet(RandRange(rng, -1.0f, 1.0f),
+																							   RandRange(rng, -1.0f, 1.0f),
+																							   RandRange(rng, -1.0f, 1.0f),
+																							   RandRange(rng, -1.0f, 1.0f)));
+	constexpr float GOLDEN_ANGLE = 2.39996323f;
+	const float invPlantCount = 1.0f / (float)SceneStuff::PLANTS_PER_PLANET;
+	const DirectX::XMVECTOR center = DirectX::XMLoadFloat3(&planetPos);
+	for (u4Byte i = 0; i < SceneStuff::PLANTS_PER_PLANET; i += 1)
+	{
+		float y = 1.0f - (2.0f * ((float)i + RandRange(rng, 0.25f, 0.75f)) * invPlantCount);
+		float ringRad = sqrtf(fmaxf(0.0f, 1.0f - (y * y)));
+		float phi = ((float)i * GOLDEN_ANGLE) + RandRange(rng, -0.3f, 0.3f);
+		DirectX::XMVECTOR surfDir = DirectX::XMVector3Rotate(DirectX::XMVectorSet(cosf(phi) * ringRad, y, sinf(phi) * ringRad, 0.0f),
+															 latticeOrientation);
+
+		// Pick a species + size for this instance; trunk lengths are a small
+		// fraction of the planet radius, and instance scale is the world-space
+		// bounding radius of the whole skeleton (species coefficients carry the
+		// inverse skeleton extent, so the GPU can map back into trunk-lengths)
+		const PlantSpecies& spec = species[NextRand(rng) % SceneStuff::PLANT_SPECIES_PER_PLANET];
+		float trunkLen = planetRadius * RandRange(rng, 0.01f, 0.04f);
+		DirectX::XMFLOAT3 pos;
+		DirectX::XMStoreFloat3(&pos, DirectX::XMVectorAdd(center, DirectX::XMVectorScale(surfDir, planetRadius)));
+
+		DirectX::XMVECTOR coeffs[3] = { spec.distCoeffs[0], spec.distCoeffs[1], spec.distCoeffs[2] };
+		SceneFigure::Figure fig(DirectX::XMFLOAT4(pos.x, pos.y, pos.z, trunkLen * spec.boundingRad), coeffs);
+		plants[i].SetCoreFigure(fig);
+	}
+}
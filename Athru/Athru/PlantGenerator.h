@@ -0,0 +1,40 @@
+#pragma once
+
+#include <directxmath.h>
+#include "SceneFigure.h"
+
+// Compact plant description; [distCoeffs] carry the parametric L-system that
+// defines the species (enough to rebuild each plant's distance field by folding
+// space through the same branching rules), [boundingRad] is the extent of the
+// expanded skeleton in trunk-lengths
+// Plants aren't rendered yet; nothing on the GPU traces [DF_TYPE_PLANT] figures,
+// so [Scene::CollectLocalFigures()] leaves them out
+struct PlantSpecies
+{
+	DirectX::XMVECTOR distCoeffs[3];
+	float boundingRad;
+	u4Byte numSegments;
+};
+
+// Deterministic seeded vegetation generator; the same seed always produces the
+// same species + placements, so generated flora never needs to be stored anywhere
+// except the planets that carry it
+class PlantGenerator
+{
+	public:
+		PlantGenerator() = delete;
+		~PlantGenerator() = delete;
+
+		// Generate a single species from the given seed
+		// Species are stochastic parametric L-systems (one axiom, one branching
+		// production); the production is expanded on the CPU here only to find
+		// bounds for instance scaling
+		static PlantSpecies GenerateSpecies(u4Byte seed);
+
+		// Generate [SceneStuff::PLANT_SPECIES_PER_PLANET] species for the planet with
+		// the given flora seed, then scatter [SceneStuff::PLANTS_PER_PLANET] instances
+		// of them over the planet surface; results are written into [plants]
+		static void GrowPlanet(u4Byte floraSeed,
+							   DirectX::XMFLOAT3 planetPos, float planetRadius,
+							   SceneFigure* plants);
+};
@@ -2,10 +2,16 @@
 #include "GPUServiceCentre.h"
 #include "Scene.h"
 
-Scene::Scene()
+Scene::Scene() :
+	currSys(nullptr),
+	lastSys(nullptr),
+	fluidPlanet(nullptr)
 {
 	mainCamera = new Camera();
+	oceanPackets = new FluidPackets(FLUID_PACKET_TYPES::OCEAN, SceneStuff::FLUID_PACKETS_PER_PLANET);
+	atmoPackets = new FluidPackets(FLUID_PACKET_TYPES::ATMOSPHERE, SceneStuff::FLUID_PACKETS_PER_PLANET);
 	galaxy = new Galaxy(AVAILABLE_GALACTIC_LAYOUTS::SPHERE);
+	lastUpdateTime = std::chrono::steady_clock::now();
 }
 
 Scene::~Scene()
@@ -17,6 +23,12 @@ Scene::~Scene()
 	// Send the reference associated with the
 	// main camera to [nullptr]
 	mainCamera = nullptr;
+
+	// Free fluid packet data
+	oceanPackets->~FluidPackets();
+	atmoPackets->~FluidPackets();
+	oceanPackets = nullptr;
+	atmoPackets = nullptr;
 }
 
 void Scene::Update()
@@ -28,6 +40,49 @@ void Scene::Update()
 	lastSys = currSys;
 	currSys = galaxy->GetCurrentSystem(mainCamera->GetTranslation());
 
+	// Grow vegetation whenever the player enters a new system (planets cache
+	// their plants, so this is free for systems we've seen before)
+	if (CheckFreshSys())
+	{
+		currSys->GrowPlants();
+	}
+
+	// Step simulations in the player's system; other systems stay frozen until the
+	// player visits them
+	// Steps are clamped to 1/30th of a second so long frames (e.g. during system loads)
+	// don't destabilize anything
+	const std::chrono::steady_clock::time_point currTime = std::chrono::steady_clock::now();
+	const float dt = std::fminf((float)((currTime - lastUpdateTime).count() * TimeStuff::nsToSecs), 1.0f / 30.0f);
+	lastUpdateTime = currTime;
+	currSys->Update(dt);
+
+	// Fluids only run around the planet nearest the player; move them whenever
+	// that changes (packets can't carry between planets, so just re-scatter them)
+	Planet** planets = currSys->GetPlanets();
+	const DirectX::XMVECTOR camPos = mainCamera->GetTranslation();
+	Planet* nearestPlanet = planets[0];
+	float nearestDist = FLT_MAX;
+	for (u4Byte i = 0; i < (SceneStuff::BODIES_PER_SYSTEM - 1); i += 1)
+	{
+		const DirectX::XMFLOAT3 planetPos = planets[i]->GetCenter();
+		const float dist = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(camPos, DirectX::XMLoadFloat3(&planetPos)))) -
+						   planets[i]->GetRadius();
+		if (dist < nearestDist)
+		{
+			nearestDist = dist;
+			nearestPlanet = planets[i];
+		}
+	}
+
+	if (nearestPlanet != fluidPlanet)
+	{
+		fluidPlanet = nearestPlanet;
+		oceanPackets->Reset((u4Byte)rand(), fluidPlanet->GetCenter(), fluidPlanet->GetRadius());
+		atmoPackets->Reset((u4Byte)rand(), fluidPlanet->GetCenter(), fluidPlanet->GetRadius());
+	}
+	oceanPackets->Step(dt);
+	atmoPackets->Step(dt);
+
 	// Non-GPU updates here (networking, player stats, UI stuffs, etc.)
 }
 
@@ -46,7 +101,11 @@ SceneFigure::Figure* Scene::CollectLocalFigures()
 	currFigures[7] = planets[6]->GetCoreFigure();
 	currFigures[8] = planets[7]->GetCoreFigure();
 	currFigures[9] = planets[8]->GetCoreFigure();
-	memset(currFigures + 10, NULL, SceneStuff::ALIGNED_PARAMETRIC_FIGURES_PER_SYSTEM - 9); // Per-planet plant species are undefined atm
+
+	// Zero any remaining figures; vegetation is generated (see [GrowPlants()]) but
+	// not passed along yet, since no shader traces [DF_TYPE_PLANT] figures
+	const u4Byte figNdx = SceneStuff::BODIES_PER_SYSTEM;
+	memset(currFigures + figNdx, 0, (SceneStuff::ALIGNED_PARAMETRIC_FIGURES_PER_SYSTEM - figNdx) * sizeof(SceneFigure::Figure));
 	return currFigures;
 }
 
@@ -60,9 +119,14 @@ Galaxy* Scene::GetGalaxy()
 	return galaxy;
 }
 
+System* Scene::GetCurrentSystem()
+{
+	return currSys;
+}
+
 bool Scene::CheckFreshSys()
 {
-	return (currSys = lastSys);
+	return (currSys != lastSys);
 }
 
 // Push constructions for this class through Athru's custom allocator
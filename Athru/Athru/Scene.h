@@ -2,6 +2,7 @@
 
 #include "Camera.h"
 #include "Galaxy.h"
+#include "FluidPackets.h"
 
 class Scene
 {
@@ -19,6 +20,10 @@ class Scene
 		// with [this]
 		Galaxy* GetGalaxy();
 
+		// Retrieve a reference to the system containing the
+		// player
+		System* GetCurrentSystem();
+
 		// Check whether the player moved between systems in the last frame
 		bool CheckFreshSys();
 
@@ -39,6 +44,15 @@ class Scene
 		// Reference to the player camera
 		Camera* mainCamera;
 
+		// Ocean/atmosphere packets around the planet nearest the player; packets
+		// are re-scattered whenever the nearest planet changes
+		FluidPackets* oceanPackets;
+		FluidPackets* atmoPackets;
+		Planet* fluidPlanet;
+
+		// Time of the previous call to [Update()], used to step local simulations
+		std::chrono::steady_clock::time_point lastUpdateTime;
+
 		// Transfer array used to move data out of the "scene" and into the GPU for
 		// highly-parallel updates/rendering
 		// Strictly used for planets + vegetation; animals are represented with population textures
@@ -1,6 +1,9 @@
 #include "UtilityServiceCentre.h"
 #include "System.h"
 
+// Salt for [Planet::PositionSeed(...)] when seeding planetary flora
+constexpr u4Byte FLORA_SEED_SALT = 2;
+
 // System interactions are much more complicated than I thought; best to
 // avoid actually simulating them for now and just stick to relatively
 // simple static renders
@@ -41,12 +44,13 @@ System::System(DirectX::XMFLOAT3 sysPos)
 								      0,
 								      (starRadius * float(i + 2))),
 								      starPos).m128_f32;
+		DirectX::XMFLOAT3 planetCenter = DirectX::XMFLOAT3(planetPos[0],
+														   planetPos[1],
+														   planetPos[2]);
 		planets[i] = new Planet(radius,
-								DirectX::XMFLOAT3(planetPos[0],
-												  planetPos[1],
-												  planetPos[2]),
+								planetCenter,
 								_mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f),
-								planetDistCoeffs);
+								planetDistCoeffs, Planet::PositionSeed(planetCenter, FLORA_SEED_SALT));
 	}
 
 	// Translate systems as appropriate
@@ -57,8 +61,30 @@ System::~System()
 {
 }
 
-void System::Update()
-{}
+void System::Update(float dt)
+{
+	// Planets don't interact with each other (yet), so their updates can run
+	// independently
+	AthruCore::Utility::AccessJobs()->ParallelFor(0, SceneStuff::BODIES_PER_SYSTEM - 1, 1, [this, dt](u4Byte begin, u4Byte end)
+	{
+		for (u4Byte i = begin; i < end; i += 1)
+		{
+			planets[i]->Update(dt);
+		}
+	});
+}
+
+void System::GrowPlants()
+{
+	// Planets carry separate flora, so vegetation can grow independently
+	AthruCore::Utility::AccessJobs()->ParallelFor(0, SceneStuff::BODIES_PER_SYSTEM - 1, 1, [this](u4Byte begin, u4Byte end)
+	{
+		for (u4Byte i = begin; i < end; i += 1)
+		{
+			planets[i]->GrowPlants();
+		}
+	});
+}
 
 DirectX::XMFLOAT3 System::GetPos()
 {
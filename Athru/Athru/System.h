@@ -16,7 +16,12 @@ class System
 		// (just planet spins/orbits for now, but if star color
 		// transitions were implemented this is where they'd
 		// happen)
-		void Update();
+		// Planets update in parallel, one job per planet
+		void Update(float dt);
+
+		// Generate vegetation for every planet in [this] (one job per planet);
+		// planets that already carry plants for their seed are skipped
+		void GrowPlants();
 
 		// Retrieve the global position of [this]
 		DirectX::XMFLOAT3 GetPos();